@@ -0,0 +1,204 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Animation.h
+Keyframe animation clips, and a system for playing them back on
+many objects at once.
+*/
+
+#pragma once
+
+#include "Transform.h"
+#include "SkinnedMesh.h"
+
+#include <string>
+#include <vector>
+
+namespace nou
+{
+	class CSkinnedMeshRenderer;
+
+	//A set of keyframed animation channels.
+	//Each channel animates the position, rotation, or scale of one target
+	//(e.g., a joint in a skeleton). Targets are numbered from 0, and
+	//given names so that we can match them up with what we're animating.
+	class AnimationClip
+	{
+		public:
+
+		enum class Path
+		{
+			TRANSLATION,
+			ROTATION,
+			SCALE
+		};
+
+		enum class Interpolation
+		{
+			STEP,
+			LINEAR
+		};
+
+		struct Channel
+		{
+			int target;
+			Path path;
+			Interpolation interp;
+
+			//Where this channel's keys start in the clip's key arrays, and how many it has.
+			size_t firstKey;
+			size_t keyCount;
+		};
+
+		AnimationClip(const std::string& name = "");
+
+		//Adds a target for channels to animate, returning its number.
+		int AddTarget(const std::string& name);
+
+		//Returns the number of the target with the given name, or -1 if there isn't one.
+		int FindTarget(const std::string& name) const;
+
+		//Adds a channel to the clip.
+		//times must be in increasing order, with a value for each time.
+		//Rotations are given as quaternions packed into vec4s as (x, y, z, w),
+		//positions and scales just leave w unused.
+		void AddChannel(int target, Path path, Interpolation interp,
+						const std::vector<float>& times, const std::vector<glm::vec4>& values);
+
+		//Samples a channel at the given time (clamped to the channel's keys).
+		//This searches for the keys every time, so it's handy for one-off lookups,
+		//but use an Animator to play clips back efficiently.
+		glm::vec4 Sample(size_t channel, float time) const;
+
+		const std::string& GetName() const { return m_name; }
+		float GetDuration() const { return m_duration; }
+		const std::vector<std::string>& GetTargetNames() const { return m_targetNames; }
+		const std::vector<Channel>& GetChannels() const { return m_channels; }
+
+		const float* GetTimes(const Channel& channel) const { return &m_times[channel.firstKey]; }
+		const glm::vec4* GetValues(const Channel& channel) const { return &m_values[channel.firstKey]; }
+
+		protected:
+
+		std::string m_name;
+		float m_duration;
+
+		std::vector<std::string> m_targetNames;
+		std::vector<Channel> m_channels;
+
+		//The keys of every channel, stored back to back.
+		//We keep the times apart from the values, since we only need to look at
+		//the times when searching for the keys around the current time.
+		std::vector<float> m_times;
+		std::vector<glm::vec4> m_values;
+	};
+
+	//Plays animation clips back on any number of objects.
+	//Rather than sampling each object on its own, Update works out which keys
+	//every object needs first, then blends all of them in one go. The blending
+	//loops run over plain arrays of floats, which the compiler can vectorize.
+	class Animator
+	{
+		public:
+
+		//Where to write the animated position, rotation, and scale of a target.
+		//Any of these can be nullptr if you don't want that part animated.
+		struct Target
+		{
+			glm::vec3* pos = nullptr;
+			glm::quat* rotation = nullptr;
+			glm::vec3* scale = nullptr;
+
+			static Target Of(Transform& transform);
+			static Target Of(JointPose& pose);
+		};
+
+		Animator() = default;
+		~Animator() = default;
+
+		//Starts playing a clip. targets[i] receives the animation of the clip's target i
+		//(see AnimationClip::GetTargetNames), so there should be one for each target.
+		//Returns a handle for the playing instance.
+		//The clip must stay alive for as long as it is being played.
+		int Play(const AnimationClip& clip, const std::vector<Target>& targets,
+				 bool loop = true, float speed = 1.0f, float startTime = 0.0f);
+
+		//Stops an instance. Its handle won't be reused until Clear is called.
+		void Stop(int instance);
+
+		//Stops every instance.
+		void Clear();
+
+		float GetTime(int instance) const;
+		void SetSpeed(int instance, float speed);
+
+		//Advances every instance by deltaTime seconds and updates their targets.
+		void Update(float deltaTime);
+
+		//Matches up the targets of a clip with the joints of a skinned mesh renderer, by name.
+		//Targets without a matching joint are left empty.
+		static std::vector<Target> BindJoints(const AnimationClip& clip, CSkinnedMeshRenderer& renderer);
+
+		//Animates the given number of transforms with a clip for a number of frames,
+		//and prints how many transforms per millisecond we get through, compared to
+		//sampling each one with AnimationClip::Sample.
+		static void Benchmark(int transforms = 10000, int frames = 100);
+
+		protected:
+
+		struct Instance
+		{
+			const AnimationClip* clip;
+			std::vector<Target> targets;
+
+			//The key each channel was at last time we sampled it.
+			//Playback usually only moves forward a little each frame, so we can
+			//almost always find the new key by checking this one and the next,
+			//rather than searching all of them.
+			std::vector<size_t> cursors;
+
+			float time;
+			float speed;
+			bool loop;
+			bool active;
+		};
+
+		//The blends we need to do this frame, in structure-of-arrays form.
+		//Each job blends from a to b by t, and writes the result to dest.
+		struct VecJobs
+		{
+			std::vector<float> ax, ay, az, bx, by, bz, t;
+			std::vector<glm::vec3*> dest;
+			size_t count = 0;
+
+			//Empties the list, making sure there's room for at least n jobs.
+			//The arrays only ever grow, so after the first frame we never allocate.
+			void Reset(size_t n);
+			void Add(const glm::vec4& a, const glm::vec4& b, float t, glm::vec3* dest);
+		};
+
+		struct QuatJobs
+		{
+			std::vector<float> ax, ay, az, aw, bx, by, bz, bw, t;
+			std::vector<glm::quat*> dest;
+			size_t count = 0;
+
+			void Reset(size_t n);
+			void Add(const glm::vec4& a, const glm::vec4& b, float t, glm::quat* dest);
+		};
+
+		std::vector<Instance> m_instances;
+
+		VecJobs m_vecJobs;
+		QuatJobs m_quatJobs;
+
+		//Finds the key at or before time in a channel, starting from the cursor given.
+		//Returns the blend factor between that key and the next one.
+		static float FindKey(const AnimationClip& clip, const AnimationClip::Channel& channel,
+							 float time, size_t& cursor);
+
+		void BlendVecs();
+		void BlendQuats();
+	};
+}
@@ -0,0 +1,95 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+CMorphMeshRenderer.h
+Mesh renderer component for meshes with morph targets.
+Each renderer has its own set of target weights, so many
+entities can share one mesh while pulling different faces.
+
+There are two ways to blend the targets:
+- On the CPU (the default), we blend the vertices ourselves and
+  stream the results to the GPU every frame. This works with any shader,
+  and with any number of targets.
+- On the GPU, the deltas of the (up to Morphing::MAX_GPU_TARGETS)
+  most heavily weighted targets are sent to the shader, which blends
+  every vertex as it's drawn. Your material needs to use a shader
+  that does the blending (see morph.vert).
+*/
+
+#pragma once
+
+#include "CMeshRenderer.h"
+#include "Morphing.h"
+
+namespace nou
+{
+	class CMorphMeshRenderer : public CMeshRenderer
+	{
+		public:
+
+		enum class MorphMode
+		{
+			GPU,
+			CPU
+		};
+
+		CMorphMeshRenderer(Entity& owner, const MorphMesh& mesh, Material& mat,
+						   MorphMode mode = MorphMode::CPU);
+		virtual ~CMorphMeshRenderer() = default;
+
+		CMorphMeshRenderer(CMorphMeshRenderer&&) = default;
+		CMorphMeshRenderer& operator=(CMorphMeshRenderer&&) = default;
+
+		//Switches between blending on the GPU and the CPU.
+		//Remember to switch to a material with a matching shader as well!
+		//Returns false if the mode isn't available for this mesh.
+		bool SetMode(MorphMode mode);
+		MorphMode GetMode() const { return m_mode; }
+
+		void SetMaterial(Material& mat);
+
+		//Sets how far towards a target the mesh is pulled (usually from 0 to 1).
+		//The changes will show up after the next call to UpdateMorph.
+		void SetWeight(int target, float weight);
+		float GetWeight(int target) const;
+		size_t GetTargetCount() const { return m_weights.size(); }
+
+		//Blends the targets with the current weights.
+		//Call this once per frame, after setting the weights and before drawing.
+		void UpdateMorph();
+
+		virtual void Draw() override;
+
+		//Draws this renderer the given number of times per frame with each way of
+		//blending, and prints how many morphing characters each could keep up with at 60 Hz.
+		//Call this with a window open and a current camera. The materials need
+		//shaders matching their morph modes.
+		void Benchmark(Material& gpuMat, Material& cpuMat, int characters = 100, int frames = 30);
+
+		protected:
+
+		const MorphMesh* m_mesh;
+		MorphMode m_mode;
+
+		std::vector<float> m_weights;
+
+		//When blending on the GPU, which target is in each of the shader's slots,
+		//and its weight.
+		int m_gpuTargets[Morphing::MAX_GPU_TARGETS];
+		glm::vec4 m_gpuWeights;
+
+		//When blending on the CPU, we blend into these first, then copy the results
+		//into the streaming buffers. The streaming buffers may live in uncached memory,
+		//which is fine to write to in order, but very slow to read back as we
+		//add each target on.
+		std::vector<glm::vec4> m_blendedVerts;
+		std::vector<glm::vec4> m_blendedNormals;
+		std::unique_ptr<StreamingVertexBuffer> m_vertStream;
+		std::unique_ptr<StreamingVertexBuffer> m_normalStream;
+
+		void BindBuffers();
+		void PickGPUTargets();
+		void StreamCPUBlend();
+	};
+}
@@ -0,0 +1,98 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+CSkinnedMeshRenderer.h
+Mesh renderer component for skinned meshes.
+Each renderer has its own copy of the skeleton's pose, so many
+entities can share one mesh while striking different poses.
+
+There are two ways to skin the mesh:
+- On the GPU (the default), the joint matrices are sent to the shader
+  and every vertex is skinned as it's drawn. Your material needs to use
+  a shader that does the skinning (see skinned.vert).
+- On the CPU, we skin the vertices ourselves and send the results to
+  the GPU every frame. This works with any shader, and is handy as a
+  reference or as a fallback for skeletons too big for the skinning shader.
+*/
+
+#pragma once
+
+#include "CMeshRenderer.h"
+#include "SkinnedMesh.h"
+
+namespace nou
+{
+	class CSkinnedMeshRenderer : public CMeshRenderer
+	{
+		public:
+
+		enum class SkinningMode
+		{
+			GPU,
+			CPU
+		};
+
+		CSkinnedMeshRenderer(Entity& owner, const SkinnedMesh& mesh, Material& mat,
+							 SkinningMode mode = SkinningMode::GPU);
+		virtual ~CSkinnedMeshRenderer() = default;
+
+		CSkinnedMeshRenderer(CSkinnedMeshRenderer&&) = default;
+		CSkinnedMeshRenderer& operator=(CSkinnedMeshRenderer&&) = default;
+
+		//Switches between skinning on the GPU and the CPU.
+		//Remember to switch to a material with a matching shader as well!
+		//Returns false if the mode isn't available for this mesh.
+		bool SetMode(SkinningMode mode);
+		SkinningMode GetMode() const { return m_mode; }
+
+		void SetMaterial(Material& mat);
+
+		//Fetches the pose of a joint, which you can change to move it.
+		//The changes will show up after the next call to UpdateSkin.
+		JointPose& GetJointPose(int joint);
+		size_t GetJointCount() const { return m_pose.size(); }
+
+		//Returns the index of the joint with the given name, or -1 if there isn't one.
+		int FindJoint(const std::string& name) const { return m_mesh->FindJoint(name); }
+
+		//Puts every joint back in its bind pose.
+		void ResetPose();
+
+		//Fetches the transform of a joint relative to the mesh, as of the last UpdateSkin.
+		const glm::mat4& GetJointGlobal(int joint) const;
+
+		//Recomputes the joint matrices from the current pose.
+		//When skinning on the CPU, this also skins the mesh.
+		//Call this once per frame, after posing the skeleton and before drawing.
+		void UpdateSkin();
+
+		virtual void Draw() override;
+
+		//Draws this renderer the given number of times per frame with each skinning mode,
+		//and prints how many skinned characters each mode could keep up with at 60 Hz.
+		//Call this with a window open and a current camera. The materials need
+		//shaders matching their skinning modes.
+		void Benchmark(Material& gpuMat, Material& cpuMat, int characters = 100, int frames = 30);
+
+		protected:
+
+		const SkinnedMesh* m_mesh;
+		SkinningMode m_mode;
+
+		std::vector<JointPose> m_pose;
+		std::vector<glm::mat4> m_globals;
+
+		//The global transform of each joint times its inverse bind matrix.
+		//This is what actually gets applied to the vertices.
+		std::vector<glm::mat4> m_jointMatrices;
+
+		//Our skinned copies of the mesh data, when skinning on the CPU.
+		std::vector<glm::vec3> m_skinnedVerts;
+		std::vector<glm::vec3> m_skinnedNormals;
+		std::unique_ptr<VertexBuffer> m_skinnedVertVBO;
+		std::unique_ptr<VertexBuffer> m_skinnedNormalVBO;
+
+		void BindBuffers();
+	};
+}
@@ -0,0 +1,85 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+FKEvaluator.h
+Updates the global transforms of whole hierarchies in one flat pass.
+
+Transform::DoFK recurses down the hierarchy, and Transform::RecomputeGlobal
+walks all the way up to the root every time it's called - so calling it on
+every node in a chain of D transforms costs about D*D/2 matrix multiplies.
+Instead, we sort the hierarchy once so that every transform comes after its
+parent, then compute all of the globals from front to back (the same trick as
+CSkinnedMeshRenderer::UpdateSkin uses for skeletons).
+
+We also remember the position, rotation, and scale we last saw on each
+transform, so anything that hasn't moved (and whose parent hasn't moved)
+keeps its global from last time instead of being recomputed.
+*/
+
+#pragma once
+
+#include "Transform.h"
+
+#include <vector>
+
+namespace nou
+{
+	class FKEvaluator
+	{
+		public:
+
+		FKEvaluator() = default;
+
+		//Sets the transforms at the top of the hierarchies we'll be updating.
+		//Everything below them gets updated as well. The roots need to stay alive
+		//for as long as the evaluator uses them.
+		void SetRoots(const std::vector<Transform*>& roots);
+		void SetRoot(Transform& root) { SetRoots({ &root }); }
+
+		//Recomputes the global transform of everything that moved since the last
+		//update, along with everything below it. If any transform has changed
+		//parents since the last update, the hierarchy is sorted again first.
+		//Call this once per frame, after animating and before drawing.
+		void Update();
+
+		//Makes the next update recompute everything, whether it moved or not.
+		void MarkAllDirty();
+
+		//Returns the number of transforms in the hierarchy.
+		size_t GetTransformCount() const { return m_transforms.size(); }
+
+		//Returns the number of global transforms the last update recomputed.
+		size_t GetUpdatedCount() const { return m_updatedCount; }
+
+		//Times updating a number of chains of transforms with RecomputeGlobal on each
+		//transform, DoFK on each root, and an FKEvaluator, and prints the results.
+		static void Benchmark(int depth = 100, int chains = 100, int frames = 100);
+
+		protected:
+
+		std::vector<Transform*> m_roots;
+
+		//The sorted hierarchy. Each transform comes after its parent, and
+		//m_parents holds the index of that parent (or -1 for the roots).
+		std::vector<Transform*> m_transforms;
+		std::vector<int> m_parents;
+
+		//What each transform looked like at the last update, and the local
+		//matrix we built from it.
+		std::vector<glm::vec3> m_lastPos;
+		std::vector<glm::quat> m_lastRotation;
+		std::vector<glm::vec3> m_lastScale;
+		std::vector<glm::mat4> m_locals;
+
+		//Whether each transform's global was recomputed this update, so its children know to follow.
+		std::vector<char> m_moved;
+
+		size_t m_hierarchyVersion = 0;
+		size_t m_updatedCount = 0;
+		bool m_allDirty = true;
+
+		//Sorts the hierarchies under our roots so parents come before their children.
+		void Flatten();
+	};
+}
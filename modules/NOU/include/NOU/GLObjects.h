@@ -13,6 +13,7 @@ You'll be learning a LOT more about this in your graphics class.
 #include <vector>
 #include <map>
 #include <string>
+#include <type_traits>
 
 #include "glad/glad.h"
 
@@ -34,12 +35,13 @@ namespace nou
 			m_elementLen = elementLen;
 			m_startIndex = 0;
 			m_len = 0;
+			m_capacity = 0;
 
 			glGenBuffers(1, &m_id);
 			UpdateData(data);
 		}
 
-		~VertexBuffer()
+		virtual ~VertexBuffer()
 		{
 			glDeleteBuffers(1, &m_id);
 		}
@@ -85,12 +87,37 @@ namespace nou
 			m_len = (GLsizei)data.size();
 			m_elementSize = sizeof(T);
 
+			GLsizeiptr size = (GLsizeiptr)(data.size() * m_elementSize);
+
 			glBindBuffer(GL_ARRAY_BUFFER, m_id);
-			glBufferData(GL_ARRAY_BUFFER, data.size() * m_elementSize, &(data[0]), GL_STATIC_DRAW);
+
+			//If the new data fits in the buffer we already have, we just overwrite it.
+			//glBufferData would throw the old buffer away and allocate a new one.
+			//If you're updating a buffer every frame, though, have a look at
+			//StreamingVertexBuffer below.
+			if (size <= m_capacity)
+				glBufferSubData(GL_ARRAY_BUFFER, 0, size, &(data[0]));
+			else
+			{
+				glBufferData(GL_ARRAY_BUFFER, size, &(data[0]), GL_STATIC_DRAW);
+				m_capacity = size;
+			}
 		}
 
 		protected:
 
+		//Creates an empty buffer, for classes that manage their own storage.
+		VertexBuffer(GLint elementLen, GLsizei elementSize)
+		{
+			m_elementLen = elementLen;
+			m_elementSize = elementSize;
+			m_startIndex = 0;
+			m_len = 0;
+			m_capacity = 0;
+
+			glGenBuffers(1, &m_id);
+		}
+
 		//The OpenGL ID of our VBO.
 		GLuint m_id;
 
@@ -105,6 +132,216 @@ namespace nou
 		//Any offset we should take to get to the "first" element in our buffer.
 		//(Usually this will be 0 unless you are doing something Fancy(TM).)
 		GLsizei m_startIndex;
+
+		//How many bytes of storage OpenGL has given us.
+		GLsizeiptr m_capacity;
+	};
+
+	//Class for vertex data that changes every frame (e.g., vertices animated on the CPU).
+	//Re-uploading a regular VertexBuffer every frame can stall, because the GPU may still
+	//be drawing with last frame's data when we try to overwrite it.
+	//Instead, this buffer holds three copies of the data (one being written by us,
+	//and up to two still waiting to be drawn) and cycles through them. We keep the
+	//buffer mapped into our address space the whole time, so writing to it is
+	//just writing to memory, and a fence tells us when the GPU has finished with
+	//a copy so that we can reuse it.
+	//(Keeping a buffer mapped needs OpenGL 4.4. On older versions, we map and
+	//unmap each copy as we write it, which still avoids the stall.)
+	//As with VertexBuffer, this class is intended to be used via pointers.
+	class StreamingVertexBuffer : public VertexBuffer
+	{
+		public:
+
+		static const int REGION_COUNT = 3;
+
+		//Makes a buffer with room for len elements of elementSize bytes,
+		//each with elementLen float components.
+		StreamingVertexBuffer(GLint elementLen, GLsizei elementSize, GLsizei len)
+			: VertexBuffer(elementLen, elementSize)
+		{
+			m_len = len;
+			m_regionSize = (GLsizeiptr)len * elementSize;
+			m_capacity = m_regionSize * REGION_COUNT;
+			m_region = 0;
+			m_mapped = nullptr;
+
+			for (GLsync& fence : m_fences)
+				fence = nullptr;
+
+			glBindBuffer(GL_ARRAY_BUFFER, m_id);
+
+			if (GLAD_GL_VERSION_4_4)
+			{
+				GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+				glBufferStorage(GL_ARRAY_BUFFER, m_capacity, nullptr, flags);
+				m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, m_capacity, flags));
+			}
+			else
+				glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+		}
+
+		virtual ~StreamingVertexBuffer()
+		{
+			//Deleting the buffer (in ~VertexBuffer) unmaps it for us.
+			for (GLsync fence : m_fences)
+			{
+				if (fence != nullptr)
+					glDeleteSync(fence);
+			}
+		}
+
+		StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+
+		bool IsPersistent() const { return m_mapped != nullptr; }
+
+		//Moves on to the next copy of the data, and returns where to write it
+		//(Length() * ElementSize() bytes). If the GPU is still drawing with that copy,
+		//this waits until it's done.
+		//It's best to write the data in order and not read it back, since the
+		//memory may be uncached (reads are very slow).
+		void* BeginWrite()
+		{
+			m_region = (m_region + 1) % REGION_COUNT;
+
+			WaitForRegion(m_region);
+
+			GLintptr offset = m_region * m_regionSize;
+
+			if (IsPersistent())
+				return m_mapped + offset;
+
+			//We've already waited on the fence, so we can tell OpenGL not to.
+			glBindBuffer(GL_ARRAY_BUFFER, m_id);
+			return glMapBufferRange(GL_ARRAY_BUFFER, offset, m_regionSize,
+									GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		}
+
+		//Finishes writing the data from BeginWrite.
+		//The data is in a different place than last time, so bind the buffer to
+		//your VAO again after calling this.
+		void EndWrite()
+		{
+			if (!IsPersistent())
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, m_id);
+				glUnmapBuffer(GL_ARRAY_BUFFER);
+			}
+
+			m_startIndex = m_region * m_len;
+		}
+
+		//Call this after the draw calls using the data you just wrote,
+		//so we know when the GPU is finished with it.
+		void Fence()
+		{
+			if (m_fences[m_region] != nullptr)
+				glDeleteSync(m_fences[m_region]);
+
+			m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		protected:
+
+		GLsync m_fences[REGION_COUNT];
+		int m_region;
+
+		GLsizeiptr m_regionSize;
+		unsigned char* m_mapped;
+
+		void WaitForRegion(int region)
+		{
+			GLsync& fence = m_fences[region];
+
+			if (fence == nullptr)
+				return;
+
+			//The first wait flushes any commands OpenGL is holding on to,
+			//otherwise we could be waiting for something that was never sent.
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+			while (true)
+			{
+				GLenum result = glClientWaitSync(fence, flags, 1000000);
+
+				if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+					break;
+
+				flags = 0;
+			}
+
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	};
+
+	//Class for managing OpenGL index buffers (also called element buffers).
+	//An index buffer lists which vertices make up each face of a model.
+	//Vertices shared between faces only need to be stored once, and the GPU
+	//can reuse the vertex shader output for a vertex it has seen recently.
+	//As with VertexBuffer, this class is intended to be used via pointers.
+	class IndexBuffer
+	{
+		public:
+
+		template<typename T>
+		IndexBuffer(const std::vector<T>& data)
+		{
+			m_len = 0;
+			m_elementType = GL_UNSIGNED_INT;
+
+			glGenBuffers(1, &m_id);
+			UpdateData(data);
+		}
+
+		~IndexBuffer()
+		{
+			glDeleteBuffers(1, &m_id);
+		}
+
+		IndexBuffer(const IndexBuffer&) = delete;
+
+		GLsizei Length() const { return m_len; }
+
+		//The OpenGL type of a single index (GL_UNSIGNED_BYTE, _SHORT, or _INT).
+		GLenum ElementType() const { return m_elementType; }
+
+		GLuint GetID() const { return m_id; }
+
+		//This uploads the indices specified into our OpenGL buffer on the GPU.
+		//The type of index is picked from the type of the vector.
+		template<typename T>
+		void UpdateData(const std::vector<T>& data)
+		{
+			static_assert(std::is_same_v<T, GLubyte> || std::is_same_v<T, GLushort> || std::is_same_v<T, GLuint>,
+						  "Indices must be 8, 16, or 32-bit unsigned integers.");
+
+			m_len = (GLsizei)data.size();
+
+			if constexpr (std::is_same_v<T, GLubyte>)
+				m_elementType = GL_UNSIGNED_BYTE;
+			else if constexpr (std::is_same_v<T, GLushort>)
+				m_elementType = GL_UNSIGNED_SHORT;
+			else
+				m_elementType = GL_UNSIGNED_INT;
+
+			//The index buffer binding is part of a VAO's state, so we make sure
+			//no VAO is bound before we touch it. Otherwise, we would swap out the
+			//indices of whichever VAO happened to be bound.
+			glBindVertexArray(0);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW);
+		}
+
+		protected:
+
+		//The OpenGL ID of our index buffer.
+		GLuint m_id;
+
+		//The number of indices in our buffer.
+		GLsizei m_len;
+
+		GLenum m_elementType;
 	};
 
 	//Class for managing OpenGL Vertex Array Objects (VAOs).
@@ -130,6 +367,7 @@ namespace nou
 			m_drawMode = DrawMode::TRIANGLES;
 			glGenVertexArrays(1, &m_id);
 			m_len = 0;
+			m_ibo = nullptr;
 		}
 
 		~VertexArray()
@@ -234,6 +472,17 @@ namespace nou
 														 (long long)buf.ElementSize()));
 		}
 
+		//This associates an IndexBuffer with our vertex array object,
+		//so that we draw the vertices in the order it lists rather than in the
+		//order they are stored. Pass nullptr to go back to drawing them in order.
+		void BindIndices(const IndexBuffer* buf)
+		{
+			m_ibo = buf;
+
+			glBindVertexArray(m_id);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf != nullptr ? buf->GetID() : 0);
+		}
+
 		void SetDrawMode(DrawMode drawMode)
 		{
 			m_drawMode = drawMode;
@@ -242,7 +491,11 @@ namespace nou
 		void Draw()
 		{
 			glBindVertexArray(m_id);
-			glDrawArrays((int)m_drawMode, 0, m_len);
+
+			if (m_ibo != nullptr)
+				glDrawElements((int)m_drawMode, m_ibo->Length(), m_ibo->ElementType(), nullptr);
+			else
+				glDrawArrays((int)m_drawMode, 0, m_len);
 		}
 
 		protected:
@@ -255,6 +508,9 @@ namespace nou
 
 		//A record of the VBOs associated with this VAO.
 		std::map<GLint, const VertexBuffer*> m_vbos;
+
+		//The index buffer associated with this VAO, if we have one.
+		const IndexBuffer* m_ibo;
 	};
 }
 
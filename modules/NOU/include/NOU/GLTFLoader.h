@@ -9,9 +9,13 @@ Helpful reference: https://www.khronos.org/files/gltf20-reference-guide.pdf
 
 #pragma once
 
-#include "Mesh.h"
+#include "SkinnedMesh.h"
+#include "MorphMesh.h"
+#include "Animation.h"
+#include "MappedFile.h"
 
 #include <string>
+#include <memory>
 
 //Forward declaration of objects defined by the tinyGLTF library.
 namespace tinygltf
@@ -30,22 +34,108 @@ namespace nou::GLTF
 		int elementSize;
 	};
 
+	struct LoadOptions
+	{
+		//Whether to decode the images referenced by the file.
+		//Decoding a large texture can take far longer than parsing the geometry,
+		//so turn this off if you're only after the mesh.
+		//(Image files are still read, just not decoded.)
+		bool loadImages = true;
+	};
+
+	class Asset;
+
+	//Parses the file with tinyGLTF.
+	//Files starting with the binary glTF header are loaded as .glb files,
+	//anything else is loaded as a .gltf file.
+	bool ParseGLTF(const std::string& filename, Asset& asset,
+				   std::string& err, std::string& warn,
+				   const LoadOptions& options = LoadOptions());
+
+	//A parsed glTF file.
+	//Binary (.glb) files stay memory-mapped for as long as the asset is alive.
+	//Their binary chunk is read straight out of the mapping, rather than out
+	//of a copy held by tinyGLTF, so any DataGetters you build from an asset
+	//are only valid while it exists.
+	class Asset
+	{
+		public:
+
+		Asset();
+		~Asset();
+
+		Asset(const Asset&) = delete;
+		Asset& operator=(const Asset&) = delete;
+
+		tinygltf::Model& GetModel() { return *m_model; }
+		const tinygltf::Model& GetModel() const { return *m_model; }
+
+		//Whether the buffer data is being read straight out of a mapped .glb file.
+		bool IsMapped() const { return m_file.IsOpen(); }
+
+		//Returns the start of the data for the buffer with the given index.
+		const unsigned char* GetBufferData(int buffer) const;
+
+		private:
+
+		friend bool ParseGLTF(const std::string& filename, Asset& asset,
+							  std::string& err, std::string& warn,
+							  const LoadOptions& options);
+
+		std::unique_ptr<tinygltf::Model> m_model;
+		MappedFile m_file;
+
+		//The buffer backed by the binary chunk of a .glb file, if there is one.
+		int m_binBuffer = -1;
+		const unsigned char* m_binData = nullptr;
+	};
+
 	//Loads a 3D model into the mesh object given.
-	void LoadMesh(const std::string& filename, Mesh& mesh, bool flipUVY = true);
+	//Since we only need the geometry, images are never decoded.
+	//If you won't need to read the mesh data back on the CPU, set keepCPUData
+	//to false to free it once it has been sent to the GPU.
+	void LoadMesh(const std::string& filename, Mesh& mesh, bool flipUVY = true, bool keepCPUData = true);
 	
+	//Loads a 3D model along with the first skin (skeleton) in the file.
+	//The CPU-side data is always kept, since skinning on the CPU needs it.
+	void LoadSkinnedMesh(const std::string& filename, SkinnedMesh& mesh, bool flipUVY = true);
+
+	//Loads a 3D model along with its morph targets (blend shapes).
+	//The CPU-side data is always kept, since blending on the CPU needs it.
+	void LoadMorphMesh(const std::string& filename, MorphMesh& mesh, bool flipUVY = true);
+
+	//Loads every animation in a file, adding them to the list of clips given.
+	//Each node an animation moves becomes one of the clip's targets, named after the node.
+	void LoadAnimations(const std::string& filename, std::vector<AnimationClip>& clips);
+
 	void DumpErrorsAndWarnings(const std::string& filename,
 							   const std::string& err,
 							   const std::string& warn);
 
-	//Parses the file with tinyGLTF.
-	bool ParseGLTF(const std::string& filename, tinygltf::Model& gltf,
-				   std::string& err, std::string& warn);
-
-	//Takes a glTF model and extracts vertex positions, normals, and texture coordinates.
-	bool ExtractGeometry(const tinygltf::Model& gltf, Mesh& mesh, bool flipUVY,
+	//Takes a glTF model and extracts vertex positions, normals, texture coordinates, and indices.
+	//Every triangle primitive of every mesh node in the default scene is merged into the
+	//mesh given, transformed by the node's world matrix (skinned meshes are left as they
+	//are, since their joints put them in place). Files without scenes load each mesh once.
+	bool ExtractGeometry(const Asset& gltf, Mesh& mesh, bool flipUVY,
 					     std::string& err, std::string& warn);
 
+	//Takes a glTF model and extracts the joints of its first skin, and the joints and
+	//weights of each vertex. Call this after ExtractGeometry, since the per-vertex data
+	//is matched up with the vertices it extracted.
+	//Joints are reordered so that each one comes after its parent.
+	bool ExtractSkin(const Asset& gltf, SkinnedMesh& mesh,
+					 std::string& err, std::string& warn);
+
+	//Takes a glTF model and extracts the morph targets of its primitives.
+	//Call this after ExtractGeometry, for the same reason as ExtractSkin.
+	bool ExtractMorphTargets(const Asset& gltf, MorphMesh& mesh,
+							 std::string& err, std::string& warn);
+
+	//Takes a glTF model and extracts its animations into clips.
+	bool ExtractAnimations(const Asset& gltf, std::vector<AnimationClip>& clips,
+						   std::string& err, std::string& warn);
+
 	//Utility functions for more easily accessing data stored in glTF buffers.
 	int FindAccessor(const tinygltf::Primitive& geom, const std::string& name);
-	DataGetter BuildGetter(const tinygltf::Model& gltf, int accIndex);
+	DataGetter BuildGetter(const Asset& gltf, int accIndex);
 }
\ No newline at end of file
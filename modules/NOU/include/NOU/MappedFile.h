@@ -0,0 +1,50 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+MappedFile.h
+Read-only memory-mapped files.
+*/
+
+#pragma once
+
+#include <string>
+
+namespace nou
+{
+	//Maps a whole file into memory for reading.
+	//Rather than copying the file into a buffer we allocate ourselves,
+	//the operating system pages the file in as we touch it, and can share
+	//those pages with its own file cache.
+	//Like the vertex buffers in GLObjects.h, this can't be copied, since
+	//two copies would both try to unmap the same view.
+	class MappedFile
+	{
+		public:
+
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//Maps the file given, closing any file that was already open.
+		//Returns false (and leaves the object empty) if the file can't be opened.
+		bool Open(const std::string& filename);
+		void Close();
+
+		bool IsOpen() const { return m_data != nullptr; }
+		const unsigned char* GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+
+		private:
+
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+
+		#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+		#endif
+	};
+}
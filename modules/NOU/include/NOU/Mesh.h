@@ -31,7 +31,11 @@ namespace nou
 			NORMAL = 1,
 			UV = 2,
 			JOINT_INFLUENCE = 3,
-			SKIN_WEIGHT = 4
+			SKIN_WEIGHT = 4,
+			//Morph targets blended on the GPU take up a run of locations each,
+			//one per target (see Morphing::MAX_GPU_TARGETS and morph.vert).
+			MORPH_POSITION = 5,
+			MORPH_NORMAL = 9
 		};
 
 		Mesh() = default;
@@ -41,18 +45,38 @@ namespace nou
 		void SetNormals(const std::vector<glm::vec3>& normals);
 		void SetUVs(const std::vector<glm::vec2>& uvs);
 
+		//Sets the indices of the vertices making up each face.
+		//Without indices, every three vertices are drawn as a triangle.
+		void SetIndices(const std::vector<GLuint>& indices);
+
+		//Frees our CPU-side copies of the mesh data.
+		//The data we've already sent to the GPU is unaffected, so you can call
+		//this once a mesh is loaded if you won't need to read it back.
+		virtual void ReleaseCPUData();
+
+		//Fetches our CPU-side copies of the mesh data.
+		const std::vector<glm::vec3>& GetVerts() const { return m_verts; }
+		const std::vector<glm::vec3>& GetNormals() const { return m_normals; }
+		const std::vector<glm::vec2>& GetUVs() const { return m_uvs; }
+		const std::vector<GLuint>& GetIndices() const { return m_indices; }
+
 		//Fetches a vertex buffer associated with the desired attribute.
 		//Used by mesh rendering components to grab the requisite data
 		//associated with this model in OpenGL.
 		const VertexBuffer* GetVBO(Attrib attrib) const;
 
+		//Fetches the index buffer for this mesh, or nullptr if the mesh isn't indexed.
+		const IndexBuffer* GetIBO() const;
+
 		protected:
 
 		std::vector<glm::vec3> m_verts;
 		std::vector<glm::vec3> m_normals;
 		std::vector<glm::vec2> m_uvs;
+		std::vector<GLuint> m_indices;
 
 		std::map<Attrib, std::unique_ptr<VertexBuffer>> m_vbo;
+		std::unique_ptr<IndexBuffer> m_ibo;
 
 		//Sets up a VertexBuffer for the desired attribute.
 		template<typename T>
@@ -76,5 +100,21 @@ namespace nou
 			else
 				it->second->UpdateData(data);
 		}
+
+		//Sets up our IndexBuffer, the same way SetVBO does for vertex data.
+		template<typename T>
+		void SetIBO(const std::vector<T>& data)
+		{
+			if (data.size() == 0)
+			{
+				m_ibo.reset();
+				return;
+			}
+
+			if (m_ibo == nullptr)
+				m_ibo = std::make_unique<IndexBuffer>(data);
+			else
+				m_ibo->UpdateData(data);
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+MorphMesh.h
+Mesh with morph targets (also called blend shapes), for vertex animation.
+*/
+
+#pragma once
+
+#include "Mesh.h"
+
+namespace nou
+{
+	class MorphMesh : public Mesh
+	{
+		public:
+
+		//A morph target stores how far each vertex moves away from the base mesh.
+		//Most targets only move some of the vertices (e.g., a smile only moves
+		//the mouth), so we only keep the vertices that actually move.
+		struct Target
+		{
+			std::string name;
+
+			//The vertices this target moves, in increasing order.
+			std::vector<GLuint> indices;
+
+			//How far each of those vertices (and its normal) moves.
+			//These are padded out to 4 floats so that we can load each one
+			//straight into an SSE register when blending.
+			std::vector<glm::vec4> posDeltas;
+			std::vector<glm::vec4> normalDeltas;
+		};
+
+		MorphMesh() = default;
+		virtual ~MorphMesh() = default;
+
+		//Adds a morph target, given how far each vertex of the mesh moves.
+		//Call this after SetVerts (and SetNormals), with one delta per vertex.
+		//normalDeltas can be left empty if the normals don't change.
+		//Returns the number of the new target, or -1 if the deltas don't fit the mesh.
+		int AddTarget(const std::string& name,
+					  const std::vector<glm::vec3>& posDeltas,
+					  const std::vector<glm::vec3>& normalDeltas = {});
+
+		//Adds a morph target that moves the mesh into the same shape as another mesh
+		//(e.g., another keyframe exported from the same model). Both meshes need the
+		//same vertices in the same order.
+		int AddTargetFromPose(const std::string& name, const Mesh& pose);
+
+		const std::vector<Target>& GetTargets() const { return m_targets; }
+
+		//Returns the number of the target with the given name, or -1 if there isn't one.
+		int FindTarget(const std::string& name) const;
+
+		//Fetches the full (one per vertex) deltas of a target on the GPU,
+		//for blending in the vertex shader.
+		const VertexBuffer* GetTargetVBO(int target, bool normals) const;
+
+		//Blending on the CPU reads the CPU-side copy of the mesh and its targets,
+		//so only call this if you're blending on the GPU.
+		void ReleaseCPUData() override;
+
+		protected:
+
+		std::vector<Target> m_targets;
+
+		std::vector<std::unique_ptr<VertexBuffer>> m_targetPosVBOs;
+		std::vector<std::unique_ptr<VertexBuffer>> m_targetNormalVBOs;
+	};
+}
@@ -0,0 +1,28 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Morphing.h
+Morph target blending on the CPU.
+*/
+
+#pragma once
+
+#include "MorphMesh.h"
+
+namespace nou::Morphing
+{
+	//The most morph targets our morph shader can blend at once (see morph.vert).
+	//Each target takes up two vertex attributes (position and normal deltas),
+	//and OpenGL only promises us 16 attributes, 5 of which our meshes already use.
+	const int MAX_GPU_TARGETS = 4;
+
+	//Blends the morph targets of a mesh into its base shape.
+	//weights should hold one weight per target - 0 leaves the target out,
+	//1 moves the vertices all the way to it.
+	//The results are written as vec4s (w = 1 for positions, 0 for normals), which
+	//can go straight to a vertex buffer with 4 components per element.
+	//outNormals can be nullptr if you don't need the normals.
+	void BlendTargets(const MorphMesh& mesh, const float* weights,
+					  glm::vec4* outVerts, glm::vec4* outNormals);
+}
@@ -0,0 +1,88 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+SkinnedMesh.h
+Mesh with a skeleton, for skeletal animation.
+*/
+
+#pragma once
+
+#include "Mesh.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include "GLM/gtx/quaternion.hpp"
+
+namespace nou
+{
+	//The position, rotation, and scale of a joint relative to its parent.
+	struct JointPose
+	{
+		glm::vec3 pos = glm::vec3(0.0f);
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+
+		glm::mat4 ToMatrix() const;
+	};
+
+	class SkinnedMesh : public Mesh
+	{
+		public:
+
+		struct Joint
+		{
+			std::string name;
+
+			//The index of this joint's parent, or -1 if this is a root joint.
+			int parent = -1;
+
+			//The pose of the joint when the mesh was bound to the skeleton.
+			JointPose bindPose;
+
+			//Any transform between this joint and its parent that isn't part of
+			//the skeleton (e.g., the armature object a skeleton was exported under).
+			//This is applied before the pose, so animating the joint doesn't undo it.
+			glm::mat4 offset = glm::mat4(1.0f);
+
+			//Takes a vertex from the space of the mesh into the space of this
+			//joint in its bind pose - so that when the joint moves, the vertex
+			//moves with it.
+			glm::mat4 inverseBind = glm::mat4(1.0f);
+		};
+
+		SkinnedMesh() = default;
+		virtual ~SkinnedMesh() = default;
+
+		//Sets which joints influence each vertex (up to 4 per vertex).
+		//The indices are stored as floats, since that's what our vertex arrays expect.
+		void SetJointInfluences(const std::vector<glm::vec4>& joints);
+
+		//Sets how strongly each of the joints in SetJointInfluences
+		//pulls on each vertex. Each vertex's weights should add up to 1.
+		void SetSkinWeights(const std::vector<glm::vec4>& weights);
+
+		//Sets the skeleton. Every joint must come after its parent, so that we
+		//can pose the whole skeleton in a single pass from front to back.
+		//Returns false (and leaves the skeleton alone) if that isn't the case.
+		bool SetJoints(const std::vector<Joint>& joints);
+
+		const std::vector<Joint>& GetJoints() const { return m_joints; }
+		const std::vector<glm::vec4>& GetJointInfluences() const { return m_jointInfluences; }
+		const std::vector<glm::vec4>& GetSkinWeights() const { return m_skinWeights; }
+
+		//Returns the index of the joint with the given name, or -1 if there isn't one.
+		int FindJoint(const std::string& name) const;
+
+		//Skinning on the CPU reads the CPU-side copy of the mesh, so only call
+		//this if you're skinning on the GPU.
+		void ReleaseCPUData() override;
+
+		protected:
+
+		std::vector<glm::vec4> m_jointInfluences;
+		std::vector<glm::vec4> m_skinWeights;
+
+		std::vector<Joint> m_joints;
+	};
+}
@@ -0,0 +1,34 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Skinning.h
+Linear blend skinning on the CPU.
+*/
+
+#pragma once
+
+#include "SkinnedMesh.h"
+
+namespace nou::Skinning
+{
+	//The most joints our skinning shader can handle (see skinned.vert).
+	//OpenGL only promises room for 1024 floats worth of uniforms in a vertex shader,
+	//and each joint matrix takes up 16 of those. We keep a little room free for
+	//our other uniforms (model, normal, viewproj).
+	const int MAX_GPU_JOINTS = 60;
+
+	//Vertex count below which we don't bother splitting the work between threads.
+	//Starting a thread costs more than skinning a small mesh.
+	const size_t PARALLEL_MIN_VERTS = 16 * 1024;
+
+	//Skins the vertices (and normals, if the mesh has them) of a mesh.
+	//Each vertex is moved by a blend of its joints' matrices, weighted by its skin weights.
+	//jointMatrices should hold, for each joint, the joint's global transform
+	//multiplied by its inverse bind matrix.
+	//Large meshes are split across up to threadCount threads
+	//(0 means one per hardware thread).
+	void SkinVertices(const SkinnedMesh& mesh, const glm::mat4* jointMatrices,
+					  glm::vec3* outVerts, glm::vec3* outNormals,
+					  unsigned threadCount = 0);
+}
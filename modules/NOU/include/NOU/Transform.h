@@ -21,6 +21,9 @@ namespace nou
 {
 	class Transform
 	{
+		//The evaluator fills in our globals directly, and needs to see our children to sort the hierarchy.
+		friend class FKEvaluator;
+
 		public:
 
 		glm::vec3 m_pos;
@@ -41,6 +44,8 @@ namespace nou
 
 		//This will recompute and return the global transform
 		//of this object.
+		//Since this recomputes every parent up to the root as well, use DoFK
+		//or an FKEvaluator to update lots of objects in the same hierarchy.
 		const glm::mat4& RecomputeGlobal();
 
 		//This will return the current global transform of the
@@ -65,6 +70,10 @@ namespace nou
 
 		glm::mat4 m_global;
 
+		//Goes up by one whenever any transform changes parents,
+		//so that FKEvaluators know when they need to sort their hierarchies again.
+		static size_t m_hierarchyVersion;
+
 		//These functions are protected since they will be handled
 		//by SetParent - we don't want to have to manually update this ourselves
 		//whenever we switch an object's parent!
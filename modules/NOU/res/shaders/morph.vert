@@ -0,0 +1,53 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+morph.vert
+Vertex shader.
+Blends each vertex with up to four morph targets, then
+passes world vertex position, transformed normal direction, and UV
+coordinates to the fragment shader (e.g., texturedlit.frag).
+*/
+
+#version 420 core
+
+//This needs to match Morphing::MAX_GPU_TARGETS.
+#define MAX_TARGETS 4
+
+uniform mat4 model;
+uniform mat3 normal;
+uniform mat4 viewproj;
+
+//How strongly each target pulls on the mesh.
+uniform vec4 morphWeights;
+
+layout(location = 0) in vec4 inPos;
+layout(location = 1) in vec3 inNorm;
+layout(location = 2) in vec2 inUV;
+
+//How far each target moves this vertex and its normal.
+//These need to match Mesh::Attrib::MORPH_POSITION and MORPH_NORMAL.
+layout(location = 5) in vec3 inPosDelta[MAX_TARGETS];
+layout(location = 9) in vec3 inNormDelta[MAX_TARGETS];
+
+layout(location = 0) out vec4 outPos;
+layout(location = 1) out vec3 outNorm;
+layout(location = 2) out vec2 outUV;
+
+void main()
+{
+    vec3 pos = inPos.xyz;
+    vec3 norm = inNorm;
+
+    for (int i = 0; i < MAX_TARGETS; ++i)
+    {
+        pos += morphWeights[i] * inPosDelta[i];
+        norm += morphWeights[i] * inNormDelta[i];
+    }
+
+    outNorm = normal * norm;
+    outPos = model * vec4(pos, 1.0);
+    outUV = inUV;
+
+    gl_Position = viewproj * outPos;
+}
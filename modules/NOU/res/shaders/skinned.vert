@@ -0,0 +1,46 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+skinned.vert
+Vertex shader.
+Skins each vertex using the joint matrices of its skeleton, then
+passes world vertex position, transformed normal direction, and UV
+coordinates to the fragment shader (e.g., texturedlit.frag).
+*/
+
+#version 420 core
+
+//This needs to match Skinning::MAX_GPU_JOINTS.
+#define MAX_JOINTS 60
+
+uniform mat4 model;
+uniform mat3 normal;
+uniform mat4 viewproj;
+
+uniform mat4 joints[MAX_JOINTS];
+
+layout(location = 0) in vec4 inPos;
+layout(location = 1) in vec3 inNorm;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec4 inJoints;
+layout(location = 4) in vec4 inWeights;
+
+layout(location = 0) out vec4 outPos;
+layout(location = 1) out vec3 outNorm;
+layout(location = 2) out vec2 outUV;
+
+void main()
+{
+    //Blend together the matrices of the joints influencing this vertex.
+    mat4 skin = inWeights.x * joints[int(inJoints.x)] +
+                inWeights.y * joints[int(inJoints.y)] +
+                inWeights.z * joints[int(inJoints.z)] +
+                inWeights.w * joints[int(inJoints.w)];
+
+    outNorm = normal * (mat3(skin) * inNorm);
+    outPos = model * (skin * inPos);
+    outUV = inUV;
+
+    gl_Position = viewproj * outPos;
+}
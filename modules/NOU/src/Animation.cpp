@@ -0,0 +1,460 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Animation.cpp
+Keyframe animation clips, and a system for playing them back on
+many objects at once.
+*/
+
+#include "NOU/Animation.h"
+#include "NOU/CSkinnedMeshRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace nou
+{
+	namespace
+	{
+		glm::quat ToQuat(const glm::vec4& v)
+		{
+			//GLM's quaternion constructor takes w first.
+			return glm::quat(v.w, v.x, v.y, v.z);
+		}
+
+		glm::vec4 FromQuat(const glm::quat& q)
+		{
+			return glm::vec4(q.x, q.y, q.z, q.w);
+		}
+	}
+
+	AnimationClip::AnimationClip(const std::string& name)
+	{
+		m_name = name;
+		m_duration = 0.0f;
+	}
+
+	int AnimationClip::AddTarget(const std::string& name)
+	{
+		m_targetNames.push_back(name);
+		return (int)m_targetNames.size() - 1;
+	}
+
+	int AnimationClip::FindTarget(const std::string& name) const
+	{
+		for (size_t i = 0; i < m_targetNames.size(); ++i)
+		{
+			if (m_targetNames[i] == name)
+				return (int)i;
+		}
+
+		return -1;
+	}
+
+	void AnimationClip::AddChannel(int target, Path path, Interpolation interp,
+								   const std::vector<float>& times, const std::vector<glm::vec4>& values)
+	{
+		if (times.size() == 0 || times.size() != values.size())
+		{
+			printf("Animation channel needs one value per key time.\n");
+			return;
+		}
+
+		m_channels.push_back({ target, path, interp, m_times.size(), times.size() });
+
+		m_times.insert(m_times.end(), times.begin(), times.end());
+		m_values.insert(m_values.end(), values.begin(), values.end());
+
+		m_duration = std::max(m_duration, times.back());
+	}
+
+	glm::vec4 AnimationClip::Sample(size_t channel, float time) const
+	{
+		const Channel& ch = m_channels[channel];
+		const float* times = GetTimes(ch);
+		const glm::vec4* values = GetValues(ch);
+
+		if (time <= times[0])
+			return values[0];
+		if (time >= times[ch.keyCount - 1])
+			return values[ch.keyCount - 1];
+
+		//Binary search for the first key after the time given.
+		size_t next = std::upper_bound(times, times + ch.keyCount, time) - times;
+		size_t key = next - 1;
+
+		if (ch.interp == Interpolation::STEP)
+			return values[key];
+
+		float t = (time - times[key]) / (times[next] - times[key]);
+
+		if (ch.path == Path::ROTATION)
+			return FromQuat(glm::slerp(ToQuat(values[key]), ToQuat(values[next]), t));
+
+		return glm::mix(values[key], values[next], t);
+	}
+
+	Animator::Target Animator::Target::Of(Transform& transform)
+	{
+		return { &transform.m_pos, &transform.m_rotation, &transform.m_scale };
+	}
+
+	Animator::Target Animator::Target::Of(JointPose& pose)
+	{
+		return { &pose.pos, &pose.rotation, &pose.scale };
+	}
+
+	int Animator::Play(const AnimationClip& clip, const std::vector<Target>& targets,
+					   bool loop, float speed, float startTime)
+	{
+		Instance instance;
+		instance.clip = &clip;
+		instance.targets = targets;
+		instance.targets.resize(clip.GetTargetNames().size());
+		instance.cursors.resize(clip.GetChannels().size(), 0);
+		instance.time = startTime;
+		instance.speed = speed;
+		instance.loop = loop;
+		instance.active = true;
+
+		m_instances.push_back(std::move(instance));
+
+		return (int)m_instances.size() - 1;
+	}
+
+	void Animator::Stop(int instance)
+	{
+		m_instances[instance].active = false;
+	}
+
+	void Animator::Clear()
+	{
+		m_instances.clear();
+	}
+
+	float Animator::GetTime(int instance) const
+	{
+		return m_instances[instance].time;
+	}
+
+	void Animator::SetSpeed(int instance, float speed)
+	{
+		m_instances[instance].speed = speed;
+	}
+
+	float Animator::FindKey(const AnimationClip& clip, const AnimationClip::Channel& channel,
+							float time, size_t& cursor)
+	{
+		const float* times = clip.GetTimes(channel);
+		size_t last = channel.keyCount - 1;
+
+		//Before the first key or after the last one, we just hold that key.
+		if (time <= times[0])
+		{
+			cursor = 0;
+			return 0.0f;
+		}
+
+		if (time >= times[last])
+		{
+			cursor = last;
+			return 0.0f;
+		}
+
+		size_t key = std::min(cursor, last - 1);
+
+		//Most of the time, we're still between the same two keys as last frame,
+		//or we've moved on to the next pair. Only if neither is the case
+		//(e.g., we looped back to the start) do we need to search.
+		if (times[key] > time || time >= times[key + 1])
+		{
+			if (key + 2 <= last && times[key + 1] <= time && time < times[key + 2])
+				++key;
+			else
+				key = (std::upper_bound(times, times + channel.keyCount, time) - times) - 1;
+		}
+
+		cursor = key;
+
+		if (channel.interp == AnimationClip::Interpolation::STEP)
+			return 0.0f;
+
+		return (time - times[key]) / (times[key + 1] - times[key]);
+	}
+
+	void Animator::VecJobs::Reset(size_t n)
+	{
+		count = 0;
+
+		if (t.size() >= n)
+			return;
+
+		for (auto* v : { &ax, &ay, &az, &bx, &by, &bz, &t })
+			v->resize(n);
+
+		dest.resize(n);
+	}
+
+	void Animator::VecJobs::Add(const glm::vec4& a, const glm::vec4& b, float time, glm::vec3* d)
+	{
+		size_t i = count++;
+
+		ax[i] = a.x; ay[i] = a.y; az[i] = a.z;
+		bx[i] = b.x; by[i] = b.y; bz[i] = b.z;
+		t[i] = time;
+		dest[i] = d;
+	}
+
+	void Animator::QuatJobs::Reset(size_t n)
+	{
+		count = 0;
+
+		if (t.size() >= n)
+			return;
+
+		for (auto* v : { &ax, &ay, &az, &aw, &bx, &by, &bz, &bw, &t })
+			v->resize(n);
+
+		dest.resize(n);
+	}
+
+	void Animator::QuatJobs::Add(const glm::vec4& a, const glm::vec4& b, float time, glm::quat* d)
+	{
+		size_t i = count++;
+
+		ax[i] = a.x; ay[i] = a.y; az[i] = a.z; aw[i] = a.w;
+		bx[i] = b.x; by[i] = b.y; bz[i] = b.z; bw[i] = b.w;
+		t[i] = time;
+		dest[i] = d;
+	}
+
+	void Animator::Update(float deltaTime)
+	{
+		//Every channel needs at most one blend, so make room for all of them up front.
+		size_t channelCount = 0;
+
+		for (const Instance& instance : m_instances)
+		{
+			if (instance.active)
+				channelCount += instance.clip->GetChannels().size();
+		}
+
+		m_vecJobs.Reset(channelCount);
+		m_quatJobs.Reset(channelCount);
+
+		//First pass: move every instance along, and work out which keys
+		//each of its channels is between.
+		for (Instance& instance : m_instances)
+		{
+			if (!instance.active)
+				continue;
+
+			const AnimationClip& clip = *instance.clip;
+			float duration = clip.GetDuration();
+
+			instance.time += deltaTime * instance.speed;
+
+			if (instance.loop && duration > 0.0f)
+			{
+				instance.time = std::fmod(instance.time, duration);
+
+				if (instance.time < 0.0f)
+					instance.time += duration;
+			}
+			else
+				instance.time = std::clamp(instance.time, 0.0f, duration);
+
+			const auto& channels = clip.GetChannels();
+
+			for (size_t c = 0; c < channels.size(); ++c)
+			{
+				const AnimationClip::Channel& channel = channels[c];
+				const Target& target = instance.targets[channel.target];
+
+				if (channel.path == AnimationClip::Path::ROTATION ? target.rotation == nullptr :
+					channel.path == AnimationClip::Path::TRANSLATION ? target.pos == nullptr : target.scale == nullptr)
+					continue;
+
+				size_t& cursor = instance.cursors[c];
+				float t = FindKey(clip, channel, instance.time, cursor);
+
+				const glm::vec4* values = clip.GetValues(channel);
+				const glm::vec4& a = values[cursor];
+				const glm::vec4& b = values[std::min(cursor + 1, channel.keyCount - 1)];
+
+				if (channel.path == AnimationClip::Path::ROTATION)
+					m_quatJobs.Add(a, b, t, target.rotation);
+				else
+					m_vecJobs.Add(a, b, t, channel.path == AnimationClip::Path::TRANSLATION ? target.pos : target.scale);
+			}
+		}
+
+		//Second pass: blend everything at once.
+		BlendVecs();
+		BlendQuats();
+	}
+
+	void Animator::BlendVecs()
+	{
+		VecJobs& j = m_vecJobs;
+		size_t count = j.count;
+
+		float* ax = j.ax.data(); float* ay = j.ay.data(); float* az = j.az.data();
+		const float* bx = j.bx.data(); const float* by = j.by.data(); const float* bz = j.bz.data();
+		const float* t = j.t.data();
+
+		//Plain LERP, with the result written over a.
+		for (size_t i = 0; i < count; ++i)
+		{
+			ax[i] += (bx[i] - ax[i]) * t[i];
+			ay[i] += (by[i] - ay[i]) * t[i];
+			az[i] += (bz[i] - az[i]) * t[i];
+		}
+
+		for (size_t i = 0; i < count; ++i)
+			*j.dest[i] = glm::vec3(ax[i], ay[i], az[i]);
+	}
+
+	void Animator::BlendQuats()
+	{
+		QuatJobs& j = m_quatJobs;
+		size_t count = j.count;
+
+		float* ax = j.ax.data(); float* ay = j.ay.data(); float* az = j.az.data(); float* aw = j.aw.data();
+		const float* bx = j.bx.data(); const float* by = j.by.data(); const float* bz = j.bz.data(); const float* bw = j.bw.data();
+		const float* t = j.t.data();
+
+		//SLERP needs sin(t * angle) / sin(angle) for both keys, which means an acos and
+		//three sins per quaternion - and neither vectorizes well. Instead, we use
+		//David Eberly's polynomial for it ("A Fast and Accurate Algorithm for Computing SLERP"),
+		//which only needs multiplies and adds, and is within about 1e-5 of the real thing.
+		//u[k] = 1 / ((k + 1)(2k + 3)), v[k] = (k + 1) / (2k + 3), with the last term
+		//scaled up a little to make up for the terms we leave off.
+		const float mu = 1.90110745351730037f;
+		const float u[8] = { 1.0f / 3.0f, 1.0f / 10.0f, 1.0f / 21.0f, 1.0f / 36.0f,
+							 1.0f / 55.0f, 1.0f / 78.0f, 1.0f / 105.0f, mu / 136.0f };
+		const float v[8] = { 1.0f / 3.0f, 2.0f / 5.0f, 3.0f / 7.0f, 4.0f / 9.0f,
+							 5.0f / 11.0f, 6.0f / 13.0f, 7.0f / 15.0f, mu * 8.0f / 17.0f };
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			float cosTheta = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+
+			//q and -q are the same rotation. If the two keys are more than
+			//180 degrees apart, flip one of them so we take the short way around.
+			float flip = cosTheta < 0.0f ? -1.0f : 1.0f;
+			float xm1 = cosTheta * flip - 1.0f;
+
+			float tb = t[i];
+			float ta = 1.0f - tb;
+			float ta2 = ta * ta;
+			float tb2 = tb * tb;
+
+			float wa = 1.0f;
+			float wb = 1.0f;
+
+			for (int k = 7; k >= 0; --k)
+			{
+				wa = 1.0f + (u[k] * ta2 - v[k]) * xm1 * wa;
+				wb = 1.0f + (u[k] * tb2 - v[k]) * xm1 * wb;
+			}
+
+			wa *= ta;
+			wb *= tb * flip;
+
+			ax[i] = wa * ax[i] + wb * bx[i];
+			ay[i] = wa * ay[i] + wb * by[i];
+			az[i] = wa * az[i] + wb * bz[i];
+			aw[i] = wa * aw[i] + wb * bw[i];
+		}
+
+		for (size_t i = 0; i < count; ++i)
+			*j.dest[i] = glm::quat(aw[i], ax[i], ay[i], az[i]);
+	}
+
+	std::vector<Animator::Target> Animator::BindJoints(const AnimationClip& clip, CSkinnedMeshRenderer& renderer)
+	{
+		const auto& names = clip.GetTargetNames();
+		std::vector<Target> targets(names.size());
+
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			int joint = renderer.FindJoint(names[i]);
+
+			if (joint != -1)
+				targets[i] = Target::Of(renderer.GetJointPose(joint));
+		}
+
+		return targets;
+	}
+
+	void Animator::Benchmark(int transforms, int frames)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		//A clip with a position, rotation, and scale channel, 2 seconds long at 30 keys per second.
+		AnimationClip clip("Benchmark");
+		int target = clip.AddTarget("Target");
+
+		std::vector<float> times;
+		std::vector<glm::vec4> positions, rotations, scales;
+
+		for (int i = 0; i <= 60; ++i)
+		{
+			float time = i / 30.0f;
+			times.push_back(time);
+			positions.push_back(glm::vec4(std::sin(time), std::cos(time), time, 0.0f));
+			rotations.push_back(FromQuat(glm::angleAxis(time * 3.0f, glm::normalize(glm::vec3(1.0f, time, 0.5f)))));
+			scales.push_back(glm::vec4(glm::vec3(1.0f + 0.5f * std::sin(time * 4.0f)), 0.0f));
+		}
+
+		clip.AddChannel(target, AnimationClip::Path::TRANSLATION, AnimationClip::Interpolation::LINEAR, times, positions);
+		clip.AddChannel(target, AnimationClip::Path::ROTATION, AnimationClip::Interpolation::LINEAR, times, rotations);
+		clip.AddChannel(target, AnimationClip::Path::SCALE, AnimationClip::Interpolation::LINEAR, times, scales);
+
+		std::vector<Transform> objects(transforms);
+		const float deltaTime = 1.0f / 60.0f;
+
+		//Start everyone at a different point in the clip, so we aren't just
+		//sampling the same keys over and over.
+		Animator animator;
+
+		for (int i = 0; i < transforms; ++i)
+			animator.Play(clip, { Target::Of(objects[i]) }, true, 1.0f, clip.GetDuration() * i / transforms);
+
+		auto start = Clock::now();
+
+		for (int f = 0; f < frames; ++f)
+			animator.Update(deltaTime);
+
+		double animatorMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+
+		//The same thing, one transform at a time.
+		std::vector<float> clocks(transforms);
+
+		for (int i = 0; i < transforms; ++i)
+			clocks[i] = clip.GetDuration() * i / transforms;
+
+		start = Clock::now();
+
+		for (int f = 0; f < frames; ++f)
+		{
+			for (int i = 0; i < transforms; ++i)
+			{
+				clocks[i] = std::fmod(clocks[i] + deltaTime, clip.GetDuration());
+
+				objects[i].m_pos = glm::vec3(clip.Sample(0, clocks[i]));
+				objects[i].m_rotation = ToQuat(clip.Sample(1, clocks[i]));
+				objects[i].m_scale = glm::vec3(clip.Sample(2, clocks[i]));
+			}
+		}
+
+		double sampleMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+
+		printf("Animation benchmark: %d transforms, 3 channels of %zu keys each.\n", transforms, times.size());
+		printf("  Animator: %.3f ms per frame, %.0f transforms per ms.\n", animatorMs, transforms / animatorMs);
+		printf("  AnimationClip::Sample: %.3f ms per frame, %.0f transforms per ms.\n", sampleMs, transforms / sampleMs);
+	}
+}
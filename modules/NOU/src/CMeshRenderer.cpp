@@ -32,7 +32,7 @@ namespace nou
 		SetMesh(mesh);	
 	}
 
-	//This will fetch and bind all of our data (vertices, normals, UVs)
+	//This will fetch and bind all of our data (vertices, normals, UVs, indices)
 	//to the VAO used for this renderer.
 	//Basically, this makes sure that OpenGL will be able to find all of
 	//the data needed to draw our 3D model.
@@ -48,6 +48,9 @@ namespace nou
 
 		if ((vbo = mesh.GetVBO(Mesh::Attrib::UV)) != nullptr)
 			m_vao->BindAttrib(*vbo, (GLint)Mesh::Attrib::UV);
+
+		//If the mesh is indexed, we'll draw it with the indices rather than vertex by vertex.
+		m_vao->BindIndices(mesh.GetIBO());
 	}
 
 	void CMeshRenderer::Draw()
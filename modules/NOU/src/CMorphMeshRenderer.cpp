@@ -0,0 +1,380 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+CMorphMeshRenderer.cpp
+Mesh renderer component for meshes with morph targets.
+*/
+
+#include "NOU/CMorphMeshRenderer.h"
+#include "NOU/CCamera.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace nou
+{
+	CMorphMeshRenderer::CMorphMeshRenderer(Entity& owner,
+										   const MorphMesh& mesh,
+										   Material& mat,
+										   MorphMode mode)
+	{
+		m_owner = &owner;
+		m_mat = &mat;
+		m_vao = std::make_unique<VertexArray>();
+		m_mesh = &mesh;
+		m_mode = mode;
+
+		m_weights.resize(mesh.GetTargets().size(), 0.0f);
+
+		for (int& target : m_gpuTargets)
+			target = -1;
+
+		m_gpuWeights = glm::vec4(0.0f);
+
+		//If the mode we asked for won't work with this mesh, the other one might.
+		if (!SetMode(mode))
+			SetMode(mode == MorphMode::GPU ? MorphMode::CPU : MorphMode::GPU);
+	}
+
+	bool CMorphMeshRenderer::SetMode(MorphMode mode)
+	{
+		size_t vertCount = m_mesh->GetVerts().size();
+
+		if (mode == MorphMode::CPU && vertCount == 0)
+		{
+			printf("Can't blend a mesh on the CPU once its CPU-side data has been released.\n");
+			return false;
+		}
+
+		m_mode = mode;
+
+		if (m_mode == MorphMode::CPU)
+		{
+			m_blendedVerts.resize(vertCount);
+			m_vertStream = std::make_unique<StreamingVertexBuffer>(4, (GLsizei)sizeof(glm::vec4), (GLsizei)vertCount);
+
+			if (m_mesh->GetNormals().size() == vertCount)
+			{
+				m_blendedNormals.resize(vertCount);
+				m_normalStream = std::make_unique<StreamingVertexBuffer>(4, (GLsizei)sizeof(glm::vec4), (GLsizei)vertCount);
+			}
+		}
+		else
+		{
+			//We won't need these until we switch back to the CPU.
+			std::vector<glm::vec4>().swap(m_blendedVerts);
+			std::vector<glm::vec4>().swap(m_blendedNormals);
+			m_vertStream.reset();
+			m_normalStream.reset();
+
+			//Make sure every slot gets bound again.
+			for (int& target : m_gpuTargets)
+				target = -1;
+		}
+
+		BindBuffers();
+		UpdateMorph();
+
+		return true;
+	}
+
+	void CMorphMeshRenderer::SetMaterial(Material& mat)
+	{
+		m_mat = &mat;
+	}
+
+	void CMorphMeshRenderer::SetWeight(int target, float weight)
+	{
+		m_weights[target] = weight;
+	}
+
+	float CMorphMeshRenderer::GetWeight(int target) const
+	{
+		return m_weights[target];
+	}
+
+	void CMorphMeshRenderer::UpdateMorph()
+	{
+		if (m_mode == MorphMode::CPU)
+			StreamCPUBlend();
+		else
+			PickGPUTargets();
+	}
+
+	void CMorphMeshRenderer::BindBuffers()
+	{
+		//Start with the mesh's own buffers, just like a regular mesh renderer...
+		SetMesh(*m_mesh);
+
+		//...then swap the positions and normals for our blended copies.
+		//(On the GPU, the targets are bound as they're picked in PickGPUTargets.)
+		if (m_mode == MorphMode::CPU)
+		{
+			m_vao->BindAttrib(*m_vertStream, (GLint)Mesh::Attrib::POSITION);
+
+			if (m_normalStream != nullptr)
+				m_vao->BindAttrib(*m_normalStream, (GLint)Mesh::Attrib::NORMAL);
+		}
+	}
+
+	void CMorphMeshRenderer::PickGPUTargets()
+	{
+		const int slotCount = Morphing::MAX_GPU_TARGETS;
+		int targetCount = (int)m_weights.size();
+
+		//Find the most heavily weighted targets. With only a handful of slots,
+		//picking the biggest weight a few times over is quicker than sorting.
+		int picked[slotCount];
+		int pickedCount = 0;
+
+		for (; pickedCount < slotCount && pickedCount < targetCount; ++pickedCount)
+		{
+			int best = -1;
+
+			for (int t = 0; t < targetCount; ++t)
+			{
+				bool taken = false;
+
+				for (int p = 0; p < pickedCount; ++p)
+					taken = taken || picked[p] == t;
+
+				if (!taken && (best == -1 || std::abs(m_weights[t]) > std::abs(m_weights[best])))
+					best = t;
+			}
+
+			picked[pickedCount] = best;
+		}
+
+		//Targets that are already in a slot stay where they are, so that we
+		//only have to rebind the slots that actually change.
+		int slots[slotCount];
+		bool placed[slotCount] = {};
+
+		for (int s = 0; s < slotCount; ++s)
+		{
+			slots[s] = -1;
+
+			for (int p = 0; p < pickedCount; ++p)
+			{
+				if (!placed[p] && picked[p] == m_gpuTargets[s])
+				{
+					slots[s] = picked[p];
+					placed[p] = true;
+				}
+			}
+		}
+
+		for (int p = 0; p < pickedCount; ++p)
+		{
+			for (int s = 0; s < slotCount && !placed[p]; ++s)
+			{
+				if (slots[s] == -1)
+				{
+					slots[s] = picked[p];
+					placed[p] = true;
+				}
+			}
+		}
+
+		for (int s = 0; s < slotCount; ++s)
+		{
+			if (slots[s] != m_gpuTargets[s] && slots[s] != -1)
+			{
+				m_vao->BindAttrib(*m_mesh->GetTargetVBO(slots[s], false), (GLint)Mesh::Attrib::MORPH_POSITION + s);
+
+				const VertexBuffer* normals = m_mesh->GetTargetVBO(slots[s], true);
+
+				if (normals != nullptr)
+					m_vao->BindAttrib(*normals, (GLint)Mesh::Attrib::MORPH_NORMAL + s);
+			}
+
+			m_gpuTargets[s] = slots[s];
+			m_gpuWeights[s] = slots[s] != -1 ? m_weights[slots[s]] : 0.0f;
+		}
+	}
+
+	void CMorphMeshRenderer::StreamCPUBlend()
+	{
+		Morphing::BlendTargets(*m_mesh, m_weights.data(), m_blendedVerts.data(),
+							   m_normalStream != nullptr ? m_blendedNormals.data() : nullptr);
+
+		//Copy the results over in one go, then point the VAO at wherever they ended up.
+		memcpy(m_vertStream->BeginWrite(), m_blendedVerts.data(), m_blendedVerts.size() * sizeof(glm::vec4));
+		m_vertStream->EndWrite();
+		m_vao->BindAttrib(*m_vertStream, (GLint)Mesh::Attrib::POSITION);
+
+		if (m_normalStream != nullptr)
+		{
+			memcpy(m_normalStream->BeginWrite(), m_blendedNormals.data(), m_blendedNormals.size() * sizeof(glm::vec4));
+			m_normalStream->EndWrite();
+			m_vao->BindAttrib(*m_normalStream, (GLint)Mesh::Attrib::NORMAL);
+		}
+	}
+
+	void CMorphMeshRenderer::Draw()
+	{
+		m_mat->Use();
+
+		auto& transform = m_owner->transform;
+
+		ShaderProgram::Current()->SetUniform("viewproj", CCamera::current->Get<CCamera>().GetVP());
+		ShaderProgram::Current()->SetUniform("model", transform.GetGlobal());
+		ShaderProgram::Current()->SetUniform("normal", transform.GetNormal());
+
+		if (m_mode == MorphMode::GPU)
+			ShaderProgram::Current()->SetUniform("morphWeights", m_gpuWeights);
+
+		m_vao->Draw();
+
+		//Let the streaming buffers know the GPU is reading what we wrote.
+		//If we're drawn more than once, the latest fence covers all of the draws.
+		if (m_mode == MorphMode::CPU)
+		{
+			m_vertStream->Fence();
+
+			if (m_normalStream != nullptr)
+				m_normalStream->Fence();
+		}
+	}
+
+	void CMorphMeshRenderer::Benchmark(Material& gpuMat, Material& cpuMat, int characters, int frames)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		const double frameMs = 1000.0 / 60.0;
+
+		//Turn every target halfway on, so there's something to blend.
+		std::vector<float> weights(m_weights.size(), 0.5f);
+
+		printf("Morph benchmark: %zu vertices, %zu targets, %d characters for %d frames.\n",
+			   m_mesh->GetVerts().size(), weights.size(), characters, frames);
+
+		auto report = [&](const char* name, Clock::time_point start, double count)
+		{
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / count;
+
+			printf("  %s: %.3f ms per character, about %d characters at 60 Hz.\n",
+				   name, ms, (int)(frameMs / ms));
+		};
+
+		auto setUniforms = [&]()
+		{
+			ShaderProgram::Current()->SetUniform("viewproj", CCamera::current->Get<CCamera>().GetVP());
+			ShaderProgram::Current()->SetUniform("model", m_owner->transform.GetGlobal());
+			ShaderProgram::Current()->SetUniform("normal", m_owner->transform.GetNormal());
+		};
+
+		size_t vertCount = m_mesh->GetVerts().size();
+		bool hasNormals = m_mesh->GetNormals().size() == vertCount;
+
+		if (vertCount > 0)
+		{
+			std::vector<glm::vec4> verts(vertCount), normals(hasNormals ? vertCount : 0);
+
+			//First, just the blending on the CPU...
+			auto start = Clock::now();
+
+			for (int i = 0; i < frames; ++i)
+				Morphing::BlendTargets(*m_mesh, weights.data(), verts.data(), hasNormals ? normals.data() : nullptr);
+
+			report("CPU blending only", start, frames);
+
+			//...then blending and drawing, sending the results to the GPU the old way,
+			//with a VertexBuffer per character that we call UpdateData on every frame.
+			std::vector<std::unique_ptr<VertexBuffer>> vertVBOs, normalVBOs;
+
+			for (int c = 0; c < characters; ++c)
+			{
+				vertVBOs.push_back(std::make_unique<VertexBuffer>(4, verts));
+
+				if (hasNormals)
+					normalVBOs.push_back(std::make_unique<VertexBuffer>(4, normals));
+			}
+
+			VertexArray vao;
+			vao.BindIndices(m_mesh->GetIBO());
+
+			if (m_mesh->GetVBO(Mesh::Attrib::UV) != nullptr)
+				vao.BindAttrib(*m_mesh->GetVBO(Mesh::Attrib::UV), (GLint)Mesh::Attrib::UV);
+
+			cpuMat.Use();
+			glFinish();
+
+			start = Clock::now();
+
+			for (int i = 0; i < frames; ++i)
+			{
+				for (int c = 0; c < characters; ++c)
+				{
+					Morphing::BlendTargets(*m_mesh, weights.data(), verts.data(), hasNormals ? normals.data() : nullptr);
+
+					vertVBOs[c]->UpdateData(verts);
+					vao.BindAttrib(*vertVBOs[c], (GLint)Mesh::Attrib::POSITION);
+
+					if (hasNormals)
+					{
+						normalVBOs[c]->UpdateData(normals);
+						vao.BindAttrib(*normalVBOs[c], (GLint)Mesh::Attrib::NORMAL);
+					}
+
+					cpuMat.Use();
+					setUniforms();
+					vao.Draw();
+				}
+
+				glFinish();
+			}
+
+			report("CPU blending, re-uploaded with UpdateData", start, (double)frames * characters);
+		}
+
+		//Then the whole thing, with a crowd of renderers in each mode.
+		for (MorphMode mode : { MorphMode::CPU, MorphMode::GPU })
+		{
+			const char* name = mode == MorphMode::GPU ? "GPU blending" : "CPU blending, streamed";
+			std::vector<std::unique_ptr<CMorphMeshRenderer>> crowd;
+
+			for (int c = 0; c < characters; ++c)
+			{
+				crowd.push_back(std::make_unique<CMorphMeshRenderer>(*m_owner, *m_mesh,
+									mode == MorphMode::GPU ? gpuMat : cpuMat, mode));
+				crowd.back()->m_weights = weights;
+			}
+
+			if (crowd.size() == 0)
+				continue;
+
+			if (crowd[0]->GetMode() != mode)
+			{
+				printf("  %s isn't available for this mesh.\n", name);
+				continue;
+			}
+
+			//Warm up, and make sure the GPU is done with anything else before we start the clock.
+			for (auto& renderer : crowd)
+			{
+				renderer->UpdateMorph();
+				renderer->Draw();
+			}
+
+			glFinish();
+
+			auto start = Clock::now();
+
+			for (int i = 0; i < frames; ++i)
+			{
+				for (auto& renderer : crowd)
+				{
+					renderer->UpdateMorph();
+					renderer->Draw();
+				}
+
+				glFinish();
+			}
+
+			report(name, start, (double)frames * characters);
+		}
+	}
+}
@@ -0,0 +1,251 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+CSkinnedMeshRenderer.cpp
+Mesh renderer component for skinned meshes.
+*/
+
+#include "NOU/CSkinnedMeshRenderer.h"
+#include "NOU/CCamera.h"
+#include "NOU/Skinning.h"
+
+#include <chrono>
+
+namespace nou
+{
+	CSkinnedMeshRenderer::CSkinnedMeshRenderer(Entity& owner,
+											   const SkinnedMesh& mesh,
+											   Material& mat,
+											   SkinningMode mode)
+	{
+		m_owner = &owner;
+		m_mat = &mat;
+		m_vao = std::make_unique<VertexArray>();
+		m_mesh = &mesh;
+		m_mode = mode;
+
+		m_globals.resize(mesh.GetJoints().size());
+		m_jointMatrices.resize(mesh.GetJoints().size());
+		ResetPose();
+
+		//If the mode we asked for won't work with this mesh, the other one might.
+		if (!SetMode(mode))
+			SetMode(mode == SkinningMode::GPU ? SkinningMode::CPU : SkinningMode::GPU);
+	}
+
+	bool CSkinnedMeshRenderer::SetMode(SkinningMode mode)
+	{
+		if (mode == SkinningMode::GPU && m_mesh->GetJoints().size() > Skinning::MAX_GPU_JOINTS)
+		{
+			printf("Skeleton has %zu joints, but we can only skin %d on the GPU.\n",
+				   m_mesh->GetJoints().size(), Skinning::MAX_GPU_JOINTS);
+			return false;
+		}
+
+		if (mode == SkinningMode::CPU && (m_mesh->GetVerts().size() == 0 ||
+			m_mesh->GetJointInfluences().size() != m_mesh->GetVerts().size()))
+		{
+			printf("Can't skin a mesh on the CPU once its CPU-side data has been released.\n");
+			return false;
+		}
+
+		m_mode = mode;
+
+		if (m_mode == SkinningMode::CPU)
+		{
+			m_skinnedVerts.resize(m_mesh->GetVerts().size());
+			m_skinnedNormals.resize(m_mesh->GetNormals().size());
+		}
+		else
+		{
+			//We won't need these until we switch back to the CPU.
+			std::vector<glm::vec3>().swap(m_skinnedVerts);
+			std::vector<glm::vec3>().swap(m_skinnedNormals);
+			m_skinnedVertVBO.reset();
+			m_skinnedNormalVBO.reset();
+		}
+
+		UpdateSkin();
+		BindBuffers();
+
+		return true;
+	}
+
+	void CSkinnedMeshRenderer::SetMaterial(Material& mat)
+	{
+		m_mat = &mat;
+	}
+
+	JointPose& CSkinnedMeshRenderer::GetJointPose(int joint)
+	{
+		return m_pose[joint];
+	}
+
+	void CSkinnedMeshRenderer::ResetPose()
+	{
+		const auto& joints = m_mesh->GetJoints();
+
+		m_pose.resize(joints.size());
+
+		for (size_t i = 0; i < joints.size(); ++i)
+			m_pose[i] = joints[i].bindPose;
+	}
+
+	const glm::mat4& CSkinnedMeshRenderer::GetJointGlobal(int joint) const
+	{
+		return m_globals[joint];
+	}
+
+	void CSkinnedMeshRenderer::UpdateSkin()
+	{
+		const auto& joints = m_mesh->GetJoints();
+
+		//This is the same idea as Transform::DoFK, but since every joint comes after
+		//its parent, we can do the whole skeleton in one loop instead of recursing.
+		for (size_t i = 0; i < joints.size(); ++i)
+		{
+			glm::mat4 local = joints[i].offset * m_pose[i].ToMatrix();
+
+			if (joints[i].parent >= 0)
+				m_globals[i] = m_globals[joints[i].parent] * local;
+			else
+				m_globals[i] = local;
+
+			m_jointMatrices[i] = m_globals[i] * joints[i].inverseBind;
+		}
+
+		if (m_mode != SkinningMode::CPU || m_skinnedVerts.size() == 0)
+			return;
+
+		Skinning::SkinVertices(*m_mesh, m_jointMatrices.data(), m_skinnedVerts.data(),
+							   m_skinnedNormals.size() > 0 ? m_skinnedNormals.data() : nullptr);
+
+		if (m_skinnedVertVBO != nullptr)
+			m_skinnedVertVBO->UpdateData(m_skinnedVerts);
+
+		if (m_skinnedNormalVBO != nullptr)
+			m_skinnedNormalVBO->UpdateData(m_skinnedNormals);
+	}
+
+	void CSkinnedMeshRenderer::BindBuffers()
+	{
+		//Start with the mesh's own buffers, just like a regular mesh renderer...
+		SetMesh(*m_mesh);
+
+		const VertexBuffer* vbo;
+
+		//...then add in the joint data for the skinning shader...
+		if (m_mode == SkinningMode::GPU)
+		{
+			if ((vbo = m_mesh->GetVBO(Mesh::Attrib::JOINT_INFLUENCE)) != nullptr)
+				m_vao->BindAttrib(*vbo, (GLint)Mesh::Attrib::JOINT_INFLUENCE);
+
+			if ((vbo = m_mesh->GetVBO(Mesh::Attrib::SKIN_WEIGHT)) != nullptr)
+				m_vao->BindAttrib(*vbo, (GLint)Mesh::Attrib::SKIN_WEIGHT);
+
+			return;
+		}
+
+		//...or swap the positions and normals for our skinned copies.
+		if (m_skinnedVertVBO == nullptr)
+			m_skinnedVertVBO = std::make_unique<VertexBuffer>(3, m_skinnedVerts);
+
+		m_vao->BindAttrib(*m_skinnedVertVBO, (GLint)Mesh::Attrib::POSITION);
+
+		if (m_skinnedNormals.size() > 0)
+		{
+			if (m_skinnedNormalVBO == nullptr)
+				m_skinnedNormalVBO = std::make_unique<VertexBuffer>(3, m_skinnedNormals);
+
+			m_vao->BindAttrib(*m_skinnedNormalVBO, (GLint)Mesh::Attrib::NORMAL);
+		}
+	}
+
+	void CSkinnedMeshRenderer::Draw()
+	{
+		m_mat->Use();
+
+		auto& transform = m_owner->transform;
+
+		ShaderProgram::Current()->SetUniform("viewproj", CCamera::current->Get<CCamera>().GetVP());
+		ShaderProgram::Current()->SetUniform("model", transform.GetGlobal());
+		ShaderProgram::Current()->SetUniform("normal", transform.GetNormal());
+
+		if (m_mode == SkinningMode::GPU && m_jointMatrices.size() > 0)
+			ShaderProgram::Current()->SetUniformArray("joints", m_jointMatrices.data(), (int)m_jointMatrices.size());
+
+		m_vao->Draw();
+	}
+
+	void CSkinnedMeshRenderer::Benchmark(Material& gpuMat, Material& cpuMat, int characters, int frames)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		SkinningMode oldMode = m_mode;
+		Material* oldMat = m_mat;
+
+		const double frameMs = 1000.0 / 60.0;
+
+		printf("Skinning benchmark: %zu vertices, %zu joints, %d characters for %d frames.\n",
+			   m_mesh->GetVerts().size(), m_mesh->GetJoints().size(), characters, frames);
+
+		//First, just the vertex crunching on the CPU, to show what threading buys us.
+		if (SetMode(SkinningMode::CPU))
+		{
+			for (unsigned threads : { 1u, 0u })
+			{
+				auto start = Clock::now();
+
+				for (int i = 0; i < frames; ++i)
+					Skinning::SkinVertices(*m_mesh, m_jointMatrices.data(), m_skinnedVerts.data(),
+										   m_skinnedNormals.size() > 0 ? m_skinnedNormals.data() : nullptr, threads);
+
+				double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+
+				printf("  CPU skinning only (%s): %.3f ms per character, about %d characters at 60 Hz.\n",
+					   threads == 1 ? "1 thread" : "all threads", ms, (int)(frameMs / ms));
+			}
+		}
+
+		//Then the whole thing - posing, skinning, uploading, and drawing.
+		for (SkinningMode mode : { SkinningMode::CPU, SkinningMode::GPU })
+		{
+			const char* name = mode == SkinningMode::GPU ? "GPU" : "CPU";
+
+			if (!SetMode(mode))
+			{
+				printf("  %s skinning isn't available for this mesh.\n", name);
+				continue;
+			}
+
+			SetMaterial(mode == SkinningMode::GPU ? gpuMat : cpuMat);
+
+			//Warm up, and make sure the GPU is done with anything else before we start the clock.
+			UpdateSkin();
+			Draw();
+			glFinish();
+
+			auto start = Clock::now();
+
+			for (int i = 0; i < frames; ++i)
+			{
+				for (int c = 0; c < characters; ++c)
+				{
+					UpdateSkin();
+					Draw();
+				}
+
+				glFinish();
+			}
+
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / ((double)frames * characters);
+
+			printf("  %s skinning: %.3f ms per character, about %d characters at 60 Hz.\n",
+				   name, ms, (int)(frameMs / ms));
+		}
+
+		SetMode(oldMode);
+		SetMaterial(*oldMat);
+	}
+}
@@ -0,0 +1,229 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+FKEvaluator.cpp
+Updates the global transforms of whole hierarchies in one flat pass.
+*/
+
+#include "NOU/FKEvaluator.h"
+
+#include "GLM/gtx/transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+namespace nou
+{
+	void FKEvaluator::SetRoots(const std::vector<Transform*>& roots)
+	{
+		m_roots = roots;
+		Flatten();
+	}
+
+	void FKEvaluator::MarkAllDirty()
+	{
+		m_allDirty = true;
+	}
+
+	void FKEvaluator::Flatten()
+	{
+		m_transforms.clear();
+		m_parents.clear();
+
+		//A depth-first walk, the same order DoFK goes in - every transform we add
+		//is a child of one we've already added, so parents always end up in front
+		//of their children. Each entry on the stack is a transform and the index of its parent.
+		std::vector<std::pair<Transform*, int>> stack;
+
+		for (auto it = m_roots.rbegin(); it != m_roots.rend(); ++it)
+			stack.push_back({ *it, -1 });
+
+		while (!stack.empty())
+		{
+			auto [transform, parent] = stack.back();
+			stack.pop_back();
+
+			int index = (int)m_transforms.size();
+			m_transforms.push_back(transform);
+			m_parents.push_back(parent);
+
+			//Pushing the children backwards means they come back off in order.
+			for (auto it = transform->m_children.rbegin(); it != transform->m_children.rend(); ++it)
+				stack.push_back({ *it, index });
+		}
+
+		m_lastPos.resize(m_transforms.size());
+		m_lastRotation.resize(m_transforms.size());
+		m_lastScale.resize(m_transforms.size());
+		m_locals.resize(m_transforms.size());
+		m_moved.resize(m_transforms.size());
+
+		//The indices have all shuffled around, so what we remembered is no good anymore.
+		m_allDirty = true;
+		m_hierarchyVersion = Transform::m_hierarchyVersion;
+	}
+
+	void FKEvaluator::Update()
+	{
+		if (m_hierarchyVersion != Transform::m_hierarchyVersion)
+			Flatten();
+
+		m_updatedCount = 0;
+
+		for (size_t i = 0; i < m_transforms.size(); ++i)
+		{
+			Transform& transform = *m_transforms[i];
+			int parent = m_parents[i];
+
+			//Only rebuild the local matrix if the transform has actually moved...
+			bool changed = m_allDirty ||
+						   transform.m_pos != m_lastPos[i] ||
+						   transform.m_rotation != m_lastRotation[i] ||
+						   transform.m_scale != m_lastScale[i];
+
+			if (changed)
+			{
+				m_lastPos[i] = transform.m_pos;
+				m_lastRotation[i] = transform.m_rotation;
+				m_lastScale[i] = transform.m_scale;
+
+				m_locals[i] = glm::translate(transform.m_pos) *
+							  glm::toMat4(glm::normalize(transform.m_rotation)) *
+							  glm::scale(transform.m_scale);
+			}
+
+			//...but the global also needs redoing if the parent's did.
+			//A root might have a parent outside of the hierarchy, which we can't keep track of,
+			//so those always get redone (there shouldn't be many of them).
+			if (parent >= 0)
+				changed = changed || m_moved[parent];
+			else
+				changed = changed || transform.m_parent != nullptr;
+
+			m_moved[i] = changed;
+
+			if (!changed)
+				continue;
+
+			if (parent >= 0)
+				transform.m_global = m_transforms[parent]->m_global * m_locals[i];
+			else if (transform.m_parent != nullptr)
+				transform.m_global = transform.m_parent->m_global * m_locals[i];
+			else
+				transform.m_global = m_locals[i];
+
+			++m_updatedCount;
+		}
+
+		m_allDirty = false;
+	}
+
+	void FKEvaluator::Benchmark(int depth, int chains, int frames)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		//A bunch of long chains of transforms, like the spine of a very bendy character.
+		std::vector<Transform> transforms(depth * chains);
+		std::vector<Transform*> roots;
+
+		for (int c = 0; c < chains; ++c)
+		{
+			roots.push_back(&transforms[c * depth]);
+
+			for (int d = 0; d < depth; ++d)
+			{
+				Transform& transform = transforms[c * depth + d];
+				transform.m_pos = glm::vec3(d == 0 ? (float)c : 0.0f, 0.1f, 0.0f);
+
+				if (d > 0)
+					transform.SetParent(&transforms[c * depth + d - 1]);
+			}
+		}
+
+		FKEvaluator evaluator;
+		evaluator.SetRoots(roots);
+
+		//Bends every joint a little differently each frame.
+		auto animate = [&](int frame, int every)
+		{
+			for (size_t i = 0; i < transforms.size(); i += every)
+			{
+				transforms[i].m_rotation = glm::angleAxis(0.01f * std::sin(frame * 0.1f + i), glm::vec3(0.0f, 0.0f, 1.0f));
+			}
+		};
+
+		auto time = [&](auto update)
+		{
+			auto start = Clock::now();
+
+			for (int f = 0; f < frames; ++f)
+				update(f);
+
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+		};
+
+		double recomputeMs = time([&](int f)
+		{
+			animate(f, 1);
+
+			for (auto& transform : transforms)
+				transform.RecomputeGlobal();
+		});
+
+		double fkMs = time([&](int f)
+		{
+			animate(f, 1);
+
+			for (auto* root : roots)
+				root->DoFK();
+		});
+
+		//Keep DoFK's results around to check ours against.
+		std::vector<glm::mat4> expected(transforms.size());
+
+		for (size_t i = 0; i < transforms.size(); ++i)
+			expected[i] = transforms[i].GetGlobal();
+
+		double evaluatorMs = time([&](int f)
+		{
+			animate(f, 1);
+			evaluator.Update();
+		});
+
+		float maxError = 0.0f;
+
+		for (size_t i = 0; i < transforms.size(); ++i)
+		{
+			for (int col = 0; col < 4; ++col)
+			{
+				for (int row = 0; row < 4; ++row)
+					maxError = std::max(maxError, std::abs(transforms[i].GetGlobal()[col][row] - expected[i][col][row]));
+			}
+		}
+
+		//Now only move the tips of the chains, like a character that's only waving a hand.
+		double tipsMs = time([&](int f)
+		{
+			for (int c = 0; c < chains; ++c)
+				transforms[c * depth + depth - 1].m_rotation = glm::angleAxis(0.1f * std::sin(f * 0.1f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+			evaluator.Update();
+		});
+
+		printf("FK benchmark: %d chains of %d transforms, %d frames.\n", chains, depth, frames);
+		printf("  RecomputeGlobal on every transform: %.3f ms per frame.\n", recomputeMs);
+		printf("  DoFK on every root: %.3f ms per frame.\n", fkMs);
+		printf("  FKEvaluator: %.3f ms per frame (largest difference from DoFK: %g).\n", evaluatorMs, maxError);
+		printf("  FKEvaluator, only moving the tips: %.3f ms per frame (%zu of %zu transforms updated).\n",
+			   tipsMs, evaluator.GetUpdatedCount(), evaluator.GetTransformCount());
+
+		//Transforms don't let go of their children when they're destroyed,
+		//so take the chains apart from the bottom up before the vector cleans them up.
+		for (auto it = transforms.rbegin(); it != transforms.rend(); ++it)
+			it->SetParent(nullptr);
+	}
+}
@@ -10,18 +10,398 @@ Helpful reference: https://www.khronos.org/files/gltf20-reference-guide.pdf
 #include "NOU/GLTFLoader.h"
 
 #include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 #include "tiny_gltf.h"
 
+#include "GLM/gtx/matrix_decompose.hpp"
+
 namespace nou::GLTF
 {
-	void LoadMesh(const std::string& filename, Mesh& mesh, bool flipUVY)
+	namespace
+	{
+		//Every .glb file starts with a 12 byte header ("glTF", version, length),
+		//followed by a JSON chunk and an optional binary chunk.
+		//Each chunk starts with its length and type.
+		const uint32_t GLB_MAGIC = 0x46546C67;
+		const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+		const size_t GLB_HEADER_SIZE = 12;
+		const size_t GLB_CHUNK_HEADER_SIZE = 8;
+
+		uint32_t ReadUInt32(const unsigned char* data)
+		{
+			uint32_t result;
+			memcpy(&result, data, sizeof(uint32_t));
+			return result;
+		}
+
+		//Finds the binary chunk of a .glb file, returning nullptr if there isn't one.
+		const unsigned char* FindBinaryChunk(const unsigned char* data, size_t size, size_t& chunkSize)
+		{
+			size_t offset = GLB_HEADER_SIZE;
+
+			if (size < offset + GLB_CHUNK_HEADER_SIZE)
+				return nullptr;
+
+			//Skip over the JSON chunk.
+			offset += GLB_CHUNK_HEADER_SIZE + ReadUInt32(data + offset);
+
+			if (size < offset + GLB_CHUNK_HEADER_SIZE ||
+				ReadUInt32(data + offset + 4) != GLB_CHUNK_BIN)
+				return nullptr;
+
+			chunkSize = ReadUInt32(data + offset);
+			offset += GLB_CHUNK_HEADER_SIZE;
+
+			if (size < offset + chunkSize)
+				return nullptr;
+
+			return data + offset;
+		}
+
+		//Image loader we hand to tinyGLTF when we don't want images decoded.
+		bool SkipImage(tinygltf::Image*, const int, std::string*, std::string*,
+					   int, int, const unsigned char*, int, void*)
+		{
+			return true;
+		}
+
+		//Checks that an accessor's data is stored with the component and element types given.
+		bool HasFormat(const tinygltf::Model& gltf, int accIndex, int componentType, int type)
+		{
+			const tinygltf::Accessor& acc = gltf.accessors[accIndex];
+
+			//An accessor without a buffer view is all zeroes, which isn't much use to us.
+			return acc.bufferView != -1 && acc.componentType == componentType && acc.type == type;
+		}
+
+		bool HasIndexFormat(const tinygltf::Model& gltf, int accIndex)
+		{
+			return HasFormat(gltf, accIndex, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_SCALAR) ||
+				   HasFormat(gltf, accIndex, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_TYPE_SCALAR) ||
+				   HasFormat(gltf, accIndex, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TYPE_SCALAR);
+		}
+
+		//glTF buffers make no promises about alignment, so we copy values out rather than casting.
+		template<typename T>
+		T ReadValue(const unsigned char* data)
+		{
+			T result;
+			memcpy(&result, data, sizeof(T));
+			return result;
+		}
+
+		//Gets the position, rotation, and scale of a node relative to its parent.
+		JointPose GetNodePose(const tinygltf::Node& node)
+		{
+			JointPose pose;
+
+			if (node.translation.size() == 3)
+				pose.pos = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+
+			//glTF stores quaternions as (x, y, z, w), but GLM's constructor takes w first.
+			if (node.rotation.size() == 4)
+				pose.rotation = glm::quat((float)node.rotation[3], (float)node.rotation[0],
+										  (float)node.rotation[1], (float)node.rotation[2]);
+
+			if (node.scale.size() == 3)
+				pose.scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+
+			return pose;
+		}
+
+		//Gets the transform of a node relative to its parent.
+		glm::mat4 GetNodeMatrix(const tinygltf::Node& node)
+		{
+			//A node can give us its matrix directly instead of a position/rotation/scale.
+			//glTF matrices are column-major, just like GLM's.
+			if (node.matrix.size() == 16)
+			{
+				glm::mat4 result;
+
+				for (int i = 0; i < 16; ++i)
+					result[i / 4][i % 4] = (float)node.matrix[i];
+
+				return result;
+			}
+
+			return GetNodePose(node).ToMatrix();
+		}
+
+		//The primitives we can load from a model, and how much space they need.
+		struct PrimitiveSet
+		{
+			std::vector<const tinygltf::Primitive*> prims;
+			//Where each primitive's node puts it in the model.
+			std::vector<glm::mat4> transforms;
+			size_t vertCount = 0;
+			size_t indexCount = 0;
+
+			//Since all the primitives share the same buffers, we only keep
+			//normals or UVs if every primitive has them.
+			bool hasNormals = true;
+			bool hasUVs = true;
+		};
+
+		//Adds a primitive to the set, if it's one we can load.
+		void AddPrimitive(const tinygltf::Model& gltf, const tinygltf::Mesh& meshData,
+						  const tinygltf::Primitive& geom, const glm::mat4& transform,
+						  PrimitiveSet& set, std::string& warn)
+		{
+			if (geom.mode != TINYGLTF_MODE_TRIANGLES && geom.mode != -1)
+			{
+				warn += "\nSkipping a primitive in mesh \"" + meshData.name + "\" that isn't made of triangles.";
+				return;
+			}
+
+			int vID = FindAccessor(geom, "POSITION");
+
+			if (vID == -1 || !HasFormat(gltf, vID, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3))
+			{
+				warn += "\nSkipping a primitive in mesh \"" + meshData.name + "\" with missing or unsupported vertex positions.";
+				return;
+			}
+
+			if (geom.indices != -1 && !HasIndexFormat(gltf, geom.indices))
+			{
+				warn += "\nSkipping a primitive in mesh \"" + meshData.name + "\" with indices in an unsupported format.";
+				return;
+			}
+
+			if (set.hasNormals)
+			{
+				int nID = FindAccessor(geom, "NORMAL");
+
+				if (nID == -1)
+				{
+					set.hasNormals = false;
+					warn += "\nNo normals found in mesh.";
+				}
+				else if (!HasFormat(gltf, nID, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3))
+				{
+					set.hasNormals = false;
+					warn += "\nNormal data is in a currently unsupported format." \
+					   "Consider changing your GLTF export settings, or else check for " \
+					   "and support this format in your GLTF loader implementation.";
+				}
+			}
+
+			if (set.hasUVs)
+			{
+				int uvID = FindAccessor(geom, "TEXCOORD_0");
+
+				if (uvID == -1)
+				{
+					set.hasUVs = false;
+					warn += "\nNo UVs found in mesh.";
+				}
+				else if (!HasFormat(gltf, uvID, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2))
+				{
+					set.hasUVs = false;
+					warn += "\nUV data is in a currently unsupported format." \
+						"Consider changing your GLTF export settings, or else check for " \
+						"and support this format in your GLTF loader implementation.";
+				}
+			}
+
+			size_t primVerts = gltf.accessors[vID].count;
+
+			set.prims.push_back(&geom);
+			set.transforms.push_back(transform);
+			set.vertCount += primVerts;
+			//Primitives without indices draw their vertices in order,
+			//so we'll make up indices that do the same.
+			set.indexCount += geom.indices != -1 ? gltf.accessors[geom.indices].count : primVerts;
+		}
+
+		//Figures out which primitives in a model we can load, and where they go.
+		//We walk the node hierarchy of the default scene, so a mesh shows up
+		//wherever a node uses it (and more than once if several nodes do).
+		//Skins are read through this too, so that their joint data lines up
+		//with the vertices we extract.
+		PrimitiveSet GatherPrimitives(const tinygltf::Model& gltf, std::string& warn)
+		{
+			PrimitiveSet set;
+
+			//A file without any scenes doesn't say where its meshes go,
+			//so we just load each of them once, as they are.
+			if (gltf.scenes.empty())
+			{
+				for (const tinygltf::Mesh& meshData : gltf.meshes)
+				{
+					for (const tinygltf::Primitive& geom : meshData.primitives)
+						AddPrimitive(gltf, meshData, geom, glm::mat4(1.0f), set, warn);
+				}
+
+				return set;
+			}
+
+			int scene = gltf.defaultScene >= 0 && gltf.defaultScene < (int)gltf.scenes.size() ? gltf.defaultScene : 0;
+
+			//A depth-first walk, so the primitives come out in the same order every time.
+			//Each entry on the stack is a node and the world matrix of its parent.
+			std::vector<std::pair<int, glm::mat4>> stack;
+			std::vector<bool> visited(gltf.nodes.size(), false);
+
+			const std::vector<int>& roots = gltf.scenes[scene].nodes;
+
+			for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+				stack.push_back({ *it, glm::mat4(1.0f) });
+
+			while (!stack.empty())
+			{
+				auto [index, parentWorld] = stack.back();
+				stack.pop_back();
+
+				//A broken file could use a node twice, or loop back on itself.
+				if (index < 0 || index >= (int)gltf.nodes.size() || visited[index])
+					continue;
+
+				visited[index] = true;
+
+				const tinygltf::Node& node = gltf.nodes[index];
+				glm::mat4 world = parentWorld * GetNodeMatrix(node);
+
+				if (node.mesh >= 0 && node.mesh < (int)gltf.meshes.size())
+				{
+					//A skinned mesh gets put in place by its joints instead,
+					//so glTF says to ignore the transform of its node.
+					glm::mat4 transform = node.skin >= 0 ? glm::mat4(1.0f) : world;
+					const tinygltf::Mesh& meshData = gltf.meshes[node.mesh];
+
+					for (const tinygltf::Primitive& geom : meshData.primitives)
+						AddPrimitive(gltf, meshData, geom, transform, set, warn);
+				}
+
+				for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+					stack.push_back({ *it, world });
+			}
+
+			return set;
+		}
+
+		//Gets the matrix that normals (and normal deltas) are transformed by.
+		glm::mat3 GetNormalMatrix(const glm::mat4& transform)
+		{
+			return glm::transpose(glm::inverse(glm::mat3(transform)));
+		}
+
+		//Reads a vec4 stored as floats, or as unsigned bytes/shorts.
+		//If normalize is set, integers are mapped from their full range to [0, 1]
+		//(e.g., a byte of 255 becomes 1.0f), otherwise they are kept as they are.
+		glm::vec4 ReadVec4(const unsigned char* data, int componentType, bool normalize)
+		{
+			glm::vec4 result;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+					result[i] = normalize ? data[i] / 255.0f : data[i];
+				else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+				{
+					float value = ReadValue<GLushort>(data + i * sizeof(GLushort));
+					result[i] = normalize ? value / 65535.0f : value;
+				}
+				else
+					memcpy(&result[i], data + i * sizeof(float), sizeof(float));
+			}
+
+			return result;
+		}
+
+		//Reads up to count vec3s of float data from an accessor into out.
+		//Unlike BuildGetter, this handles sparse accessors, which store only the
+		//elements that differ from a base (or from zero). Morph targets often use them,
+		//since most targets only move a few vertices.
+		bool ReadVec3s(const Asset& asset, int accIndex, glm::vec3* out, size_t count)
+		{
+			const tinygltf::Model& gltf = asset.GetModel();
+			const tinygltf::Accessor& acc = gltf.accessors[accIndex];
+
+			if (acc.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || acc.type != TINYGLTF_TYPE_VEC3)
+				return false;
+			count = std::min(count, acc.count);
+
+			if (acc.bufferView != -1)
+			{
+				DataGetter getter = BuildGetter(asset, accIndex);
+
+				for (size_t i = 0; i < count; ++i)
+					memcpy(&out[i], &getter.data[i * getter.stride], sizeof(glm::vec3));
+			}
+			else
+				std::fill(out, out + count, glm::vec3(0.0f));
+
+			if (!acc.sparse.isSparse)
+				return true;
+
+			const auto& indices = acc.sparse.indices;
+			const auto& values = acc.sparse.values;
+
+			if (indices.bufferView < 0 || values.bufferView < 0)
+				return false;
+
+			const tinygltf::BufferView& iView = gltf.bufferViews[indices.bufferView];
+			const tinygltf::BufferView& vView = gltf.bufferViews[values.bufferView];
+			const unsigned char* iData = asset.GetBufferData(iView.buffer) + iView.byteOffset + indices.byteOffset;
+			const unsigned char* vData = asset.GetBufferData(vView.buffer) + vView.byteOffset + values.byteOffset;
+
+			for (int i = 0; i < acc.sparse.count; ++i)
+			{
+				size_t index;
+
+				if (indices.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+					index = iData[i];
+				else if (indices.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+					index = ReadValue<GLushort>(iData + i * sizeof(GLushort));
+				else
+					index = ReadValue<GLuint>(iData + i * sizeof(GLuint));
+
+				if (index < count)
+					memcpy(&out[index], vData + i * sizeof(glm::vec3), sizeof(glm::vec3));
+			}
+
+			return true;
+		}
+
+		std::string GetBaseDir(const std::string& filename)
+		{
+			size_t slash = filename.find_last_of("/\\");
+
+			if (slash == std::string::npos)
+				return "";
+
+			return filename.substr(0, slash + 1);
+		}
+	}
+
+	Asset::Asset()
+	{
+		m_model = std::make_unique<tinygltf::Model>();
+	}
+
+	Asset::~Asset() = default;
+
+	const unsigned char* Asset::GetBufferData(int buffer) const
 	{
-		auto gltf = std::make_unique<tinygltf::Model>();
+		if (buffer == m_binBuffer)
+			return m_binData;
+
+		return m_model->buffers[buffer].data.data();
+	}
+
+	void LoadMesh(const std::string& filename, Mesh& mesh, bool flipUVY, bool keepCPUData)
+	{
+		Asset asset;
 
 		std::string err, warn;
 
-		bool result = ParseGLTF(filename, *gltf, err, warn);
+		LoadOptions options;
+		options.loadImages = false;
+
+		bool result = ParseGLTF(filename, asset, err, warn, options);
 
 		if (!result)
 		{
@@ -29,7 +409,7 @@ namespace nou::GLTF
 			return;
 		}
 
-		result = ExtractGeometry(*gltf, mesh, flipUVY, err, warn);
+		result = ExtractGeometry(asset, mesh, flipUVY, err, warn);
 
 		if (!result)
 		{
@@ -37,10 +417,69 @@ namespace nou::GLTF
 			return;
 		}
 
+		if (!keepCPUData)
+			mesh.ReleaseCPUData();
+
 		DumpErrorsAndWarnings(filename, err, warn);
 		printf("Loaded mesh from %s.\n", filename.c_str());
 	}
 
+	void LoadSkinnedMesh(const std::string& filename, SkinnedMesh& mesh, bool flipUVY)
+	{
+		Asset asset;
+
+		std::string err, warn;
+
+		LoadOptions options;
+		options.loadImages = false;
+
+		bool result = ParseGLTF(filename, asset, err, warn, options) &&
+					  ExtractGeometry(asset, mesh, flipUVY, err, warn) &&
+					  ExtractSkin(asset, mesh, err, warn);
+
+		DumpErrorsAndWarnings(filename, err, warn);
+
+		if (result)
+			printf("Loaded skinned mesh from %s.\n", filename.c_str());
+	}
+
+	void LoadMorphMesh(const std::string& filename, MorphMesh& mesh, bool flipUVY)
+	{
+		Asset asset;
+
+		std::string err, warn;
+
+		LoadOptions options;
+		options.loadImages = false;
+
+		bool result = ParseGLTF(filename, asset, err, warn, options) &&
+					  ExtractGeometry(asset, mesh, flipUVY, err, warn) &&
+					  ExtractMorphTargets(asset, mesh, err, warn);
+
+		DumpErrorsAndWarnings(filename, err, warn);
+
+		if (result)
+			printf("Loaded mesh with %zu morph targets from %s.\n", mesh.GetTargets().size(), filename.c_str());
+	}
+
+	void LoadAnimations(const std::string& filename, std::vector<AnimationClip>& clips)
+	{
+		Asset asset;
+
+		std::string err, warn;
+
+		LoadOptions options;
+		options.loadImages = false;
+
+		bool result = ParseGLTF(filename, asset, err, warn, options) &&
+					  ExtractAnimations(asset, clips, err, warn);
+
+		DumpErrorsAndWarnings(filename, err, warn);
+
+		if (result)
+			printf("Loaded animations from %s.\n", filename.c_str());
+	}
+
 	void DumpErrorsAndWarnings(const std::string& filename,
 							   const std::string& err,
 							   const std::string& warn)
@@ -53,13 +492,61 @@ namespace nou::GLTF
 				filename.c_str(), warn.c_str());
 	}
 
-	bool ParseGLTF(const std::string& filename, tinygltf::Model& gltf, 
-				   std::string& err, std::string& warn)
+	bool ParseGLTF(const std::string& filename, Asset& asset,
+				   std::string& err, std::string& warn,
+				   const LoadOptions& options)
 	{
 		auto loader = std::make_unique<tinygltf::TinyGLTF>();
 
+		if (!options.loadImages)
+			loader->SetImageLoader(SkipImage, nullptr);
+
+		tinygltf::Model& gltf = *asset.m_model;
+		asset.m_binBuffer = -1;
+		asset.m_binData = nullptr;
+
 		std::string tinygltfErr, tinygltfWarn;
-		bool result = loader->LoadASCIIFromFile(&gltf, &tinygltfErr, &tinygltfWarn, filename.c_str());
+		bool result = false;
+
+		//We map the file either way, since it saves reading it into a buffer of our own.
+		//Only .glb files need to stay mapped once we're done parsing, though.
+		if (!asset.m_file.Open(filename))
+		{
+			tinygltfErr = "File not found: " + filename;
+		}
+		else if (asset.m_file.GetSize() >= GLB_HEADER_SIZE &&
+				 ReadUInt32(asset.m_file.GetData()) == GLB_MAGIC)
+		{
+			const unsigned char* data = asset.m_file.GetData();
+			size_t size = asset.m_file.GetSize();
+
+			result = loader->LoadBinaryFromMemory(&gltf, &tinygltfErr, &tinygltfWarn, data,
+												  static_cast<unsigned int>(size), GetBaseDir(filename));
+
+			//tinyGLTF hands the binary chunk to the first buffer, as long as that buffer
+			//doesn't name a file of its own. We drop tinyGLTF's copy of the chunk and
+			//read from the mapping instead.
+			size_t binSize = 0;
+			const unsigned char* bin = FindBinaryChunk(data, size, binSize);
+
+			if (result && bin != nullptr && !gltf.buffers.empty() &&
+				gltf.buffers[0].uri.empty() && gltf.buffers[0].data.size() <= binSize)
+			{
+				std::vector<unsigned char>().swap(gltf.buffers[0].data);
+				asset.m_binBuffer = 0;
+				asset.m_binData = bin;
+			}
+		}
+		else
+		{
+			result = loader->LoadASCIIFromString(&gltf, &tinygltfErr, &tinygltfWarn,
+												 reinterpret_cast<const char*>(asset.m_file.GetData()),
+												 static_cast<unsigned int>(asset.m_file.GetSize()),
+												 GetBaseDir(filename));
+		}
+
+		if (asset.m_binData == nullptr)
+			asset.m_file.Close();
 
 		if (!tinygltfErr.empty())
 		{
@@ -76,155 +563,594 @@ namespace nou::GLTF
 		}
 
 		if (!result)
-			printf("Failed to load .gltf: %s\n", filename.c_str());
+			printf("Failed to load glTF: %s\n", filename.c_str());
 
 		return result;
 	}
 
-	bool ExtractGeometry(const tinygltf::Model& gltf, Mesh& mesh, bool flipUVY,
+	bool ExtractGeometry(const Asset& asset, Mesh& mesh, bool flipUVY,
 						 std::string& err, std::string& warn)
 	{
+		const tinygltf::Model& gltf = asset.GetModel();
+
 		if (gltf.meshes.size() == 0)
 		{
 			err = "No meshes in file.";
 			return false;
 		}
-			
-		const tinygltf::Mesh& meshData = gltf.meshes[0];
 
-		if (meshData.primitives.size() == 0)
+		//We load every primitive of every mesh into one set of buffers, so the
+		//whole model still draws with a single call. Each primitive is moved to
+		//where its node puts it, so the model comes out the way it was laid out.
+		PrimitiveSet set = GatherPrimitives(gltf, warn);
+		const std::vector<const tinygltf::Primitive*>& prims = set.prims;
+		bool hasNormals = set.hasNormals, hasUVs = set.hasUVs;
+		size_t vertCount = set.vertCount, indexCount = set.indexCount;
+
+		if (prims.size() == 0)
 		{
 			err = "No geometry data associated with mesh.";
 			return false;
 		}
 
-		const tinygltf::Primitive& geom = meshData.primitives[0];
+		std::vector<glm::vec3> verts(vertCount);
+		std::vector<glm::vec3> normals(hasNormals ? vertCount : 0);
+		std::vector<glm::vec2> uvs(hasUVs ? vertCount : 0);
+		std::vector<GLuint> indices(indexCount);
 
-		//glTF stores data per-vertex.
-		//This indexer will allow us to access the data that tells
-		//us which vertices make up the faces of the object.
-		//This allows us to specify our data in the order we need it
-		//for OpenGL vertex buffers - in other words, spelling out the vertex
-		//data as a set of triangles.
-		DataGetter faceIndexer = BuildGetter(gltf, geom.indices);
+		//This is the bit where we actually get to extracting our data.
+		//Unlike the faces, glTF stores vertex data in the same layout OpenGL
+		//wants, so we can copy the vertices over as they are and keep the
+		//indices pointing at them. Each primitive's indices just need to be
+		//offset by the number of vertices that came before it.
+		size_t baseVert = 0, baseIndex = 0;
 
-		if (faceIndexer.elementSize != sizeof(GLshort))
+		for (size_t p = 0; p < prims.size(); ++p)
 		{
-			err = "Primitive indices are in a currently unsupported format." \
-				"Consider changing your GLTF export settings, or else check for " \
-				"and support this format in your GLTF loader implementation.";
+			const tinygltf::Primitive* geom = prims[p];
+			const glm::mat4& transform = set.transforms[p];
+			bool moved = transform != glm::mat4(1.0f);
+
+			DataGetter vGetter = BuildGetter(asset, FindAccessor(*geom, "POSITION"));
+
+			for (size_t i = 0; i < vGetter.len; ++i)
+			{
+				glm::vec3& vert = verts[baseVert + i];
+				memcpy(&vert, &vGetter.data[i * vGetter.stride], sizeof(glm::vec3));
+
+				if (moved)
+					vert = glm::vec3(transform * glm::vec4(vert, 1.0f));
+			}
+
+			if (hasNormals)
+			{
+				DataGetter nGetter = BuildGetter(asset, FindAccessor(*geom, "NORMAL"));
+
+				//A malformed file could have fewer normals than positions, so we
+				//make sure not to read past the end of them.
+				for (size_t i = 0; i < vGetter.len && i < nGetter.len; ++i)
+					memcpy(&normals[baseVert + i], &nGetter.data[i * nGetter.stride], sizeof(glm::vec3));
+
+				if (moved)
+				{
+					//Scaling a node unevenly would skew its normals if we used the
+					//same matrix as the positions, so they get their own.
+					glm::mat3 normalMatrix = GetNormalMatrix(transform);
+
+					for (size_t i = 0; i < vGetter.len; ++i)
+					{
+						glm::vec3& normal = normals[baseVert + i];
+						normal = normalMatrix * normal;
+
+						if (glm::dot(normal, normal) > 0.0f)
+							normal = glm::normalize(normal);
+					}
+				}
+			}
+
+			if (hasUVs)
+			{
+				DataGetter uvGetter = BuildGetter(asset, FindAccessor(*geom, "TEXCOORD_0"));
+
+				for (size_t i = 0; i < vGetter.len && i < uvGetter.len; ++i)
+				{
+					glm::vec2& uv = uvs[baseVert + i];
+					memcpy(&uv, &uvGetter.data[i * uvGetter.stride], sizeof(glm::vec2));
+
+					//We may need to flip our vertical UV-coordinate.
+					//You will probably need to do this, depending on your export settings/texture.
+					if (flipUVY)
+						uv.y = 1.0f - uv.y;
+				}
+			}
+
+			if (geom->indices == -1)
+			{
+				for (size_t i = 0; i < vGetter.len; ++i)
+					indices[baseIndex + i] = (GLuint)(baseVert + i);
+
+				baseIndex += vGetter.len;
+			}
+			else
+			{
+				//glTF lets each primitive pick the size of its indices.
+				DataGetter faceIndexer = BuildGetter(asset, geom->indices);
+
+				for (size_t i = 0; i < faceIndexer.len; ++i)
+				{
+					const unsigned char* index = &faceIndexer.data[i * faceIndexer.stride];
+					size_t vert;
+
+					if (faceIndexer.elementSize == sizeof(GLubyte))
+						vert = *index;
+					else if (faceIndexer.elementSize == sizeof(GLushort))
+						vert = ReadValue<GLushort>(index);
+					else
+						vert = ReadValue<GLuint>(index);
+
+					if (vert >= vGetter.len)
+					{
+						err = "Primitive indices refer to vertices that don't exist.";
+						return false;
+					}
+
+					indices[baseIndex + i] = (GLuint)(baseVert + vert);
+				}
+
+				baseIndex += faceIndexer.len;
+			}
+
+			//A node that mirrors its mesh turns the triangles inside out,
+			//so we flip them back around.
+			if (glm::determinant(glm::mat3(transform)) < 0.0f)
+			{
+				size_t primIndices = geom->indices != -1 ? gltf.accessors[geom->indices].count : vGetter.len;
+
+				for (size_t i = baseIndex - primIndices; i + 2 < baseIndex; i += 3)
+					std::swap(indices[i + 1], indices[i + 2]);
+			}
+
+			baseVert += vGetter.len;
+		}
+
+		mesh.SetVerts(verts);
+
+		if(hasNormals)
+			mesh.SetNormals(normals);
+
+		if(hasUVs)
+			mesh.SetUVs(uvs);
+
+		mesh.SetIndices(indices);
 
+		return true;
+	}
+
+	bool ExtractSkin(const Asset& asset, SkinnedMesh& mesh,
+					 std::string& err, std::string& warn)
+	{
+		const tinygltf::Model& gltf = asset.GetModel();
+
+		if (gltf.skins.size() == 0)
+		{
+			err = "No skins in file.";
 			return false;
 		}
 
-		int vID = FindAccessor(geom, "POSITION");
+		if (gltf.skins.size() > 1)
+			warn += "\nFile has more than one skin, only the first will be loaded.";
 
-		if (vID == -1)
+		const tinygltf::Skin& skin = gltf.skins[0];
+		size_t jointCount = skin.joints.size();
+
+		if (jointCount == 0)
 		{
-			err = "No vertex positions found in mesh.";
+			err = "Skin has no joints.";
 			return false;
 		}
 
-		int nID = FindAccessor(geom, "NORMAL");
-		bool hasNormals = nID != -1;
+		//glTF only stores the children of each node, so we work out each node's parent...
+		std::vector<int> nodeParent(gltf.nodes.size(), -1);
 
-		if (!hasNormals)
-			warn += "\nNo normals found in mesh.";
+		for (size_t i = 0; i < gltf.nodes.size(); ++i)
+		{
+			for (int child : gltf.nodes[i].children)
+				nodeParent[child] = (int)i;
+		}
 
-		int uvID = FindAccessor(geom, "TEXCOORD_0");
-		bool hasUVs = uvID != -1;
+		//...and which joint each node is (if it's a joint at all).
+		std::vector<int> nodeJoint(gltf.nodes.size(), -1);
 
-		if (uvID == -1)
-			warn += "\nNo UVs found in mesh.";
+		for (size_t i = 0; i < jointCount; ++i)
+			nodeJoint[skin.joints[i]] = (int)i;
 
-		DataGetter vGetter, nGetter, uvGetter;
+		const tinygltf::Accessor* ibmAcc = nullptr;
+		DataGetter ibmGetter = {};
 
-		vGetter = BuildGetter(gltf, vID);
+		if (skin.inverseBindMatrices != -1)
+		{
+			if (!HasFormat(gltf, skin.inverseBindMatrices, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_MAT4) ||
+				gltf.accessors[skin.inverseBindMatrices].count < jointCount)
+			{
+				err = "Inverse bind matrices are missing or in an unsupported format.";
+				return false;
+			}
 
-		if (vGetter.elementSize != sizeof(glm::vec3))
+			ibmAcc = &gltf.accessors[skin.inverseBindMatrices];
+			ibmGetter = BuildGetter(asset, skin.inverseBindMatrices);
+		}
+
+		std::vector<SkinnedMesh::Joint> joints(jointCount);
+		std::vector<int> depth(jointCount, 0);
+
+		for (size_t i = 0; i < jointCount; ++i)
 		{
-			err = "Vertex position data is in a currently unsupported format." \
-				  "Consider changing your GLTF export settings, or else check for " \
-				  "and support this format in your GLTF loader implementation.";
+			int node = skin.joints[i];
+			SkinnedMesh::Joint& joint = joints[i];
 
-			return false;
+			joint.name = gltf.nodes[node].name;
+			joint.inverseBind = glm::mat4(1.0f);
+
+			if (ibmAcc != nullptr)
+				memcpy(&joint.inverseBind, &ibmGetter.data[i * ibmGetter.stride], sizeof(glm::mat4));
+
+			//The joint's own pose is what animations will change.
+			//A node can give us a matrix rather than a position/rotation/scale,
+			//in which case we need to split it up.
+			const tinygltf::Node& jointNode = gltf.nodes[node];
+
+			if (jointNode.matrix.size() == 16)
+			{
+				glm::vec3 skew;
+				glm::vec4 perspective;
+				glm::decompose(GetNodeMatrix(jointNode), joint.bindPose.scale, joint.bindPose.rotation,
+							   joint.bindPose.pos, skew, perspective);
+			}
+			else
+				joint.bindPose = GetNodePose(jointNode);
+
+			//Find the nearest ancestor that is also a joint.
+			//Any nodes we pass on the way (e.g., the armature at the root of a skeleton
+			//exported from Blender) still move the joint, so we keep track of them too.
+			joint.offset = glm::mat4(1.0f);
+			int parent = nodeParent[node];
+
+			while (parent != -1 && nodeJoint[parent] == -1)
+			{
+				joint.offset = GetNodeMatrix(gltf.nodes[parent]) * joint.offset;
+				parent = nodeParent[parent];
+			}
+
+			joint.parent = parent != -1 ? nodeJoint[parent] : -1;
+		}
+
+		//We need every joint to come after its parent (see SkinnedMesh::SetJoints),
+		//but glTF doesn't promise that. Sorting the joints by how deep they are in
+		//the skeleton takes care of it.
+		for (size_t i = 0; i < jointCount; ++i)
+		{
+			for (int p = joints[i].parent; p != -1; p = joints[p].parent)
+			{
+				++depth[i];
+
+				if (depth[i] > (int)jointCount)
+				{
+					err = "Skeleton has a loop in it.";
+					return false;
+				}
+			}
+		}
+
+		std::vector<int> order(jointCount);
+
+		for (size_t i = 0; i < jointCount; ++i)
+			order[i] = (int)i;
+
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return depth[a] < depth[b]; });
+
+		//remap[old index] = new index
+		std::vector<int> remap(jointCount);
+
+		for (size_t i = 0; i < jointCount; ++i)
+			remap[order[i]] = (int)i;
+
+		std::vector<SkinnedMesh::Joint> sortedJoints(jointCount);
+
+		for (size_t i = 0; i < jointCount; ++i)
+		{
+			sortedJoints[i] = joints[order[i]];
+
+			if (sortedJoints[i].parent != -1)
+				sortedJoints[i].parent = remap[sortedJoints[i].parent];
 		}
 
-		if (hasNormals)
+		//Now for the joints and weights of each vertex, which have to line up with
+		//the vertices from ExtractGeometry.
+		std::string ignoredWarn;
+		PrimitiveSet set = GatherPrimitives(gltf, ignoredWarn);
+
+		std::vector<glm::vec4> influences;
+		std::vector<glm::vec4> weights;
+		influences.reserve(set.vertCount);
+		weights.reserve(set.vertCount);
+
+		for (const tinygltf::Primitive* geom : set.prims)
 		{
-			nGetter = BuildGetter(gltf, nID);
+			size_t primVerts = gltf.accessors[FindAccessor(*geom, "POSITION")].count;
+
+			int jID = FindAccessor(*geom, "JOINTS_0");
+			int wID = FindAccessor(*geom, "WEIGHTS_0");
+
+			bool jointsOK = jID != -1 &&
+							(HasFormat(gltf, jID, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_VEC4) ||
+							 HasFormat(gltf, jID, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_TYPE_VEC4));
+
+			bool weightsOK = wID != -1 &&
+							 (HasFormat(gltf, wID, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC4) ||
+							  HasFormat(gltf, wID, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_VEC4) ||
+							  HasFormat(gltf, wID, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_TYPE_VEC4));
+
+			if (!jointsOK || !weightsOK ||
+				gltf.accessors[jID].count < primVerts || gltf.accessors[wID].count < primVerts)
+			{
+				//We can still draw the primitive, it just won't bend.
+				//We attach it to the root joint so it at least moves with the skeleton.
+				warn += "\nA primitive has missing or unsupported joints/weights, it will follow the root joint.";
+				influences.insert(influences.end(), primVerts, glm::vec4(0.0f));
+				weights.insert(weights.end(), primVerts, glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
+				continue;
+			}
 
-			if (nGetter.elementSize != sizeof(glm::vec3))
+			int jType = gltf.accessors[jID].componentType;
+			int wType = gltf.accessors[wID].componentType;
+			DataGetter jGetter = BuildGetter(asset, jID);
+			DataGetter wGetter = BuildGetter(asset, wID);
+
+			for (size_t i = 0; i < primVerts; ++i)
 			{
-				hasNormals = false;
-				warn += "\nNormal data is in a currently unsupported format." \
-				   "Consider changing your GLTF export settings, or else check for " \
-				   "and support this format in your GLTF loader implementation.";
+				glm::vec4 joint = ReadVec4(&jGetter.data[i * jGetter.stride], jType, false);
+				glm::vec4 weight = ReadVec4(&wGetter.data[i * wGetter.stride], wType, true);
+
+				for (int k = 0; k < 4; ++k)
+				{
+					if (joint[k] >= jointCount)
+					{
+						err = "Vertex joint indices refer to joints that don't exist.";
+						return false;
+					}
+
+					joint[k] = (float)remap[(size_t)joint[k]];
+				}
+
+				//Quantized weights don't always add up to exactly 1, which would
+				//shrink or grow the vertex a little, so we rescale them.
+				float total = weight.x + weight.y + weight.z + weight.w;
+
+				if (total > 0.0f)
+					weight /= total;
+				else
+					weight = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+				influences.push_back(joint);
+				weights.push_back(weight);
 			}
 		}
-			
 
-		if(hasUVs)
+		if (!mesh.SetJoints(sortedJoints))
+		{
+			err = "Could not set up the skeleton.";
+			return false;
+		}
+
+		mesh.SetJointInfluences(influences);
+		mesh.SetSkinWeights(weights);
+
+		return true;
+	}
+
+	bool ExtractMorphTargets(const Asset& asset, MorphMesh& mesh,
+							 std::string& err, std::string& warn)
+	{
+		const tinygltf::Model& gltf = asset.GetModel();
+
+		//Like the joints of a skin, the targets have to line up with the
+		//vertices from ExtractGeometry, so we go through the same primitives.
+		std::string ignoredWarn;
+		PrimitiveSet set = GatherPrimitives(gltf, ignoredWarn);
+
+		//glTF gives each primitive its own targets, but the primitives of a mesh
+		//should all have the same number of them. Target i of every primitive
+		//becomes target i of our mesh, and a primitive without it just doesn't move.
+		size_t targetCount = 0;
+
+		for (const tinygltf::Primitive* geom : set.prims)
+			targetCount = std::max(targetCount, geom->targets.size());
+
+		if (targetCount == 0)
+		{
+			err = "No morph targets in file.";
+			return false;
+		}
+
+		//Exporters (e.g., Blender) usually keep the target names in the mesh's extras.
+		std::vector<std::string> names(targetCount);
+
+		for (size_t t = 0; t < targetCount; ++t)
+			names[t] = "Target " + std::to_string(t);
+
+		for (const tinygltf::Mesh& meshData : gltf.meshes)
 		{
-			uvGetter = BuildGetter(gltf, uvID);
+			if (!meshData.extras.Has("targetNames"))
+				continue;
+
+			const tinygltf::Value& targetNames = meshData.extras.Get("targetNames");
 
-			if (uvGetter.elementSize != sizeof(glm::vec2))
+			for (size_t t = 0; t < targetCount && t < targetNames.ArrayLen(); ++t)
 			{
-				hasUVs = false;
-				warn += "\nUV data is in a currently unsupported format." \
-					"Consider changing your GLTF export settings, or else check for " \
-					"and support this format in your GLTF loader implementation.";
+				if (targetNames.Get((int)t).IsString())
+					names[t] = targetNames.Get((int)t).Get<std::string>();
 			}
+
+			break;
 		}
 
-		std::vector<glm::vec3> verts;
-		verts.resize(faceIndexer.len);
-		
-		std::vector<glm::vec3> normals;
+		bool hasNormals = mesh.GetNormals().size() == set.vertCount;
 
-		if(hasNormals)
-			normals.resize(faceIndexer.len);
+		std::vector<glm::vec3> posDeltas(set.vertCount);
+		std::vector<glm::vec3> normalDeltas(hasNormals ? set.vertCount : 0);
 
-		std::vector<glm::vec2> uvs;
+		for (size_t t = 0; t < targetCount; ++t)
+		{
+			std::fill(posDeltas.begin(), posDeltas.end(), glm::vec3(0.0f));
+			std::fill(normalDeltas.begin(), normalDeltas.end(), glm::vec3(0.0f));
 
-		if(hasUVs)
-			uvs.resize(faceIndexer.len);
+			size_t baseVert = 0;
 
-		//This is the bit where we actually get to extracting our data.
-		for (size_t i = 0; i < faceIndexer.len; ++i)
-		{
-			//What vertex do we need to look at?
-			GLshort vertIndex;
-			memcpy(&vertIndex, &faceIndexer.data[i * faceIndexer.stride], sizeof(GLshort));
-
-			size_t vert = vertIndex;
-			
-			//Grab our vertex position.
-			memcpy(&verts[i], &vGetter.data[vert * vGetter.stride], sizeof(glm::vec3));
-			
-			//Grab our vertex normal.
-			if(hasNormals)
-				memcpy(&normals[i], &nGetter.data[vert * nGetter.stride], sizeof(glm::vec3));
-
-			//Grab our texture coordinates.
-			if (hasUVs)
+			for (size_t p = 0; p < set.prims.size(); ++p)
 			{
-				memcpy(&uvs[i], &uvGetter.data[vert * uvGetter.stride], sizeof(glm::vec2));
-				
-				//We may need to flip our vertical UV-coordinate.
-				//You will probably need to do this, depending on your export settings/texture.
-				if(flipUVY)
-					uvs[i].y = 1.0f - uvs[i].y;
-			}							
+				const tinygltf::Primitive* geom = set.prims[p];
+				size_t primVerts = gltf.accessors[FindAccessor(*geom, "POSITION")].count;
+
+				if (t < geom->targets.size())
+				{
+					const auto& target = geom->targets[t];
+					auto pos = target.find("POSITION");
+					auto norm = target.find("NORMAL");
+
+					if (pos != target.end() && !ReadVec3s(asset, pos->second, &posDeltas[baseVert], primVerts))
+						warn += "\nMorph target \"" + names[t] + "\" has positions in an unsupported format.";
+
+					if (hasNormals && norm != target.end() &&
+						!ReadVec3s(asset, norm->second, &normalDeltas[baseVert], primVerts))
+						warn += "\nMorph target \"" + names[t] + "\" has normals in an unsupported format.";
+
+					//The deltas get moved along with the vertices they belong to,
+					//minus the translation, since they're offsets.
+					const glm::mat4& transform = set.transforms[p];
+
+					if (transform != glm::mat4(1.0f))
+					{
+						glm::mat3 linear = glm::mat3(transform);
+						glm::mat3 normalMatrix = GetNormalMatrix(transform);
+
+						for (size_t i = 0; i < primVerts; ++i)
+						{
+							posDeltas[baseVert + i] = linear * posDeltas[baseVert + i];
+
+							if (hasNormals)
+								normalDeltas[baseVert + i] = normalMatrix * normalDeltas[baseVert + i];
+						}
+					}
+				}
+
+				baseVert += primVerts;
+			}
+
+			if (mesh.AddTarget(names[t], posDeltas, normalDeltas) == -1)
+			{
+				err = "Couldn't add morph target \"" + names[t] + "\" to the mesh.";
+				return false;
+			}
 		}
 
-		mesh.SetVerts(verts);
+		return true;
+	}
 
-		if(hasNormals)
-			mesh.SetNormals(normals);
+	bool ExtractAnimations(const Asset& asset, std::vector<AnimationClip>& clips,
+						   std::string& err, std::string& warn)
+	{
+		const tinygltf::Model& gltf = asset.GetModel();
 
-		if(hasUVs)
-			mesh.SetUVs(uvs);
+		if (gltf.animations.size() == 0)
+		{
+			err = "No animations in file.";
+			return false;
+		}
+
+		for (size_t a = 0; a < gltf.animations.size(); ++a)
+		{
+			const tinygltf::Animation& anim = gltf.animations[a];
+			AnimationClip clip(anim.name.empty() ? "Animation " + std::to_string(a) : anim.name);
+
+			//Each node that this animation moves becomes one of the clip's targets.
+			std::vector<int> nodeTarget(gltf.nodes.size(), -1);
+
+			for (const tinygltf::AnimationChannel& channel : anim.channels)
+			{
+				if (channel.target_node < 0 || channel.target_node >= (int)gltf.nodes.size())
+					continue;
+
+				AnimationClip::Path path;
+				int type;
+
+				if (channel.target_path == "translation")
+				{
+					path = AnimationClip::Path::TRANSLATION;
+					type = TINYGLTF_TYPE_VEC3;
+				}
+				else if (channel.target_path == "rotation")
+				{
+					path = AnimationClip::Path::ROTATION;
+					type = TINYGLTF_TYPE_VEC4;
+				}
+				else if (channel.target_path == "scale")
+				{
+					path = AnimationClip::Path::SCALE;
+					type = TINYGLTF_TYPE_VEC3;
+				}
+				else
+				{
+					warn += "\nSkipping a \"" + channel.target_path + "\" channel in animation \"" + clip.GetName() + "\".";
+					continue;
+				}
+
+				const tinygltf::AnimationSampler& sampler = anim.samplers[channel.sampler];
+
+				//Cubic spline channels store an in-tangent, value, and out-tangent for each key.
+				//We only keep the values, and blend between them like a LINEAR channel.
+				bool cubic = sampler.interpolation == "CUBICSPLINE";
+				size_t valuesPerKey = cubic ? 3 : 1;
+
+				if (cubic)
+					warn += "\nCubic spline channels in animation \"" + clip.GetName() + "\" will be played back as linear.";
+
+				if (!HasFormat(gltf, sampler.input, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_SCALAR) ||
+					!HasFormat(gltf, sampler.output, TINYGLTF_COMPONENT_TYPE_FLOAT, type) ||
+					gltf.accessors[sampler.output].count < gltf.accessors[sampler.input].count * valuesPerKey)
+				{
+					warn += "\nSkipping a channel in animation \"" + clip.GetName() + "\" with keys in an unsupported format.";
+					continue;
+				}
+
+				DataGetter timeGetter = BuildGetter(asset, sampler.input);
+				DataGetter valueGetter = BuildGetter(asset, sampler.output);
+
+				std::vector<float> times(timeGetter.len);
+				std::vector<glm::vec4> values(timeGetter.len, glm::vec4(0.0f));
+
+				for (size_t i = 0; i < timeGetter.len; ++i)
+				{
+					memcpy(&times[i], &timeGetter.data[i * timeGetter.stride], sizeof(float));
+
+					size_t v = i * valuesPerKey + (cubic ? 1 : 0);
+					memcpy(&values[i], &valueGetter.data[v * valueGetter.stride], valueGetter.elementSize);
+				}
+
+				int& target = nodeTarget[channel.target_node];
+
+				if (target == -1)
+				{
+					const std::string& name = gltf.nodes[channel.target_node].name;
+					target = clip.AddTarget(name.empty() ? "Node " + std::to_string(channel.target_node) : name);
+				}
+
+				clip.AddChannel(target, path,
+								sampler.interpolation == "STEP" ? AnimationClip::Interpolation::STEP : AnimationClip::Interpolation::LINEAR,
+								times, values);
+			}
+
+			clips.push_back(std::move(clip));
+		}
 
 		return true;
 	}
@@ -239,13 +1165,13 @@ namespace nou::GLTF
 		return it->second;
 	}
 
-	DataGetter BuildGetter(const tinygltf::Model& gltf, int accIndex)
+	DataGetter BuildGetter(const Asset& asset, int accIndex)
 	{
+		const tinygltf::Model& gltf = asset.GetModel();
 		const tinygltf::Accessor& acc = gltf.accessors[accIndex];
 		const tinygltf::BufferView& bv = gltf.bufferViews[acc.bufferView];
-		const tinygltf::Buffer& buf = gltf.buffers[bv.buffer];
 
-		const unsigned char* data = &(buf.data[bv.byteOffset + acc.byteOffset]);
+		const unsigned char* data = asset.GetBufferData(bv.buffer) + bv.byteOffset + acc.byteOffset;
 		size_t len = acc.count;
 		int stride = acc.ByteStride(bv);
 		int size = tinygltf::GetComponentSizeInBytes(acc.componentType) *
@@ -0,0 +1,133 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+MappedFile.cpp
+Read-only memory-mapped files.
+*/
+
+#include "NOU/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nou
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	#ifdef _WIN32
+
+	bool MappedFile::Open(const std::string& filename)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+								  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+
+		//We can't map an empty file, so we treat it the same as a missing one.
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+		if (view == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file = file;
+		m_mapping = mapping;
+		m_data = static_cast<const unsigned char*>(view);
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		if (m_file != nullptr)
+			CloseHandle(m_file);
+
+		m_data = nullptr;
+		m_size = 0;
+		m_mapping = nullptr;
+		m_file = nullptr;
+	}
+
+	#else
+
+	bool MappedFile::Open(const std::string& filename)
+	{
+		Close();
+
+		int file = open(filename.c_str(), O_RDONLY);
+
+		if (file == -1)
+			return false;
+
+		struct stat info;
+
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+		//The mapping holds its own reference to the file, so we don't need the descriptor anymore.
+		close(file);
+
+		if (view == MAP_FAILED)
+			return false;
+
+		m_data = static_cast<const unsigned char*>(view);
+		m_size = static_cast<size_t>(info.st_size);
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_data != nullptr)
+			munmap(const_cast<unsigned char*>(m_data), m_size);
+
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	#endif
+}
@@ -8,6 +8,9 @@ Very basic class for managing the data associated with a 3D model.
 
 #include "NOU/Mesh.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace nou
 {
 	void Mesh::SetVerts(const std::vector<glm::vec3>& verts)
@@ -28,6 +31,35 @@ namespace nou
 		SetVBO(Attrib::UV, 2, m_uvs);
 	}
 
+	void Mesh::SetIndices(const std::vector<GLuint>& indices)
+	{
+		m_indices = indices;
+
+		if (m_indices.size() == 0)
+		{
+			SetIBO(m_indices);
+			return;
+		}
+
+		//Most models have few enough vertices to fit their indices in 16 bits,
+		//in which case we can send half as much index data to the GPU.
+		GLuint maxIndex = *std::max_element(m_indices.begin(), m_indices.end());
+
+		if (maxIndex <= std::numeric_limits<GLushort>::max())
+			SetIBO(std::vector<GLushort>(m_indices.begin(), m_indices.end()));
+		else
+			SetIBO(m_indices);
+	}
+
+	void Mesh::ReleaseCPUData()
+	{
+		//clear() keeps the memory around for reuse, so we swap with empty vectors instead.
+		std::vector<glm::vec3>().swap(m_verts);
+		std::vector<glm::vec3>().swap(m_normals);
+		std::vector<glm::vec2>().swap(m_uvs);
+		std::vector<GLuint>().swap(m_indices);
+	}
+
 	const VertexBuffer* Mesh::GetVBO(Mesh::Attrib attrib) const
 	{
 		auto it = m_vbo.find(attrib);
@@ -37,4 +69,9 @@ namespace nou
 
 		return it->second.get();
 	}
+
+	const IndexBuffer* Mesh::GetIBO() const
+	{
+		return m_ibo.get();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+MorphMesh.cpp
+Mesh with morph targets (also called blend shapes), for vertex animation.
+*/
+
+#include "NOU/MorphMesh.h"
+
+namespace nou
+{
+	int MorphMesh::AddTarget(const std::string& name,
+							 const std::vector<glm::vec3>& posDeltas,
+							 const std::vector<glm::vec3>& normalDeltas)
+	{
+		size_t count = m_verts.size();
+
+		if (count == 0 || posDeltas.size() != count)
+		{
+			printf("Morph target %s needs one position delta for each vertex of the mesh.\n", name.c_str());
+			return -1;
+		}
+
+		bool hasNormals = normalDeltas.size() > 0;
+
+		if (hasNormals && normalDeltas.size() != count)
+		{
+			printf("Morph target %s needs one normal delta for each vertex of the mesh.\n", name.c_str());
+			return -1;
+		}
+
+		Target target;
+		target.name = name;
+
+		//Anything that moves less than this is as good as still.
+		const float epsilon = 1e-6f;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			glm::vec3 normalDelta = hasNormals ? normalDeltas[i] : glm::vec3(0.0f);
+
+			if (glm::all(glm::lessThan(glm::abs(posDeltas[i]), glm::vec3(epsilon))) &&
+				glm::all(glm::lessThan(glm::abs(normalDelta), glm::vec3(epsilon))))
+				continue;
+
+			target.indices.push_back((GLuint)i);
+			target.posDeltas.push_back(glm::vec4(posDeltas[i], 0.0f));
+
+			if (hasNormals)
+				target.normalDeltas.push_back(glm::vec4(normalDelta, 0.0f));
+		}
+
+		m_targets.push_back(std::move(target));
+
+		//The vertex shader can't skip over vertices that don't move,
+		//so the GPU gets the full list of deltas.
+		m_targetPosVBOs.push_back(std::make_unique<VertexBuffer>(3, posDeltas));
+
+		//If the mesh has normals, its targets always get normal deltas on the GPU
+		//(even if they're all zero), so that every target can be drawn the same way.
+		if (hasNormals)
+			m_targetNormalVBOs.push_back(std::make_unique<VertexBuffer>(3, normalDeltas));
+		else if (m_normals.size() == count)
+			m_targetNormalVBOs.push_back(std::make_unique<VertexBuffer>(3, std::vector<glm::vec3>(count, glm::vec3(0.0f))));
+		else
+			m_targetNormalVBOs.push_back(nullptr);
+
+		return (int)m_targets.size() - 1;
+	}
+
+	int MorphMesh::AddTargetFromPose(const std::string& name, const Mesh& pose)
+	{
+		const std::vector<glm::vec3>& poseVerts = pose.GetVerts();
+		const std::vector<glm::vec3>& poseNormals = pose.GetNormals();
+
+		if (poseVerts.size() != m_verts.size())
+		{
+			printf("Morph target %s has %zu vertices, but the mesh has %zu.\n",
+				   name.c_str(), poseVerts.size(), m_verts.size());
+			return -1;
+		}
+
+		std::vector<glm::vec3> posDeltas(m_verts.size());
+		std::vector<glm::vec3> normalDeltas;
+
+		for (size_t i = 0; i < m_verts.size(); ++i)
+			posDeltas[i] = poseVerts[i] - m_verts[i];
+
+		if (poseNormals.size() == m_normals.size() && m_normals.size() == m_verts.size())
+		{
+			normalDeltas.resize(m_normals.size());
+
+			for (size_t i = 0; i < m_normals.size(); ++i)
+				normalDeltas[i] = poseNormals[i] - m_normals[i];
+		}
+
+		return AddTarget(name, posDeltas, normalDeltas);
+	}
+
+	int MorphMesh::FindTarget(const std::string& name) const
+	{
+		for (size_t i = 0; i < m_targets.size(); ++i)
+		{
+			if (m_targets[i].name == name)
+				return (int)i;
+		}
+
+		return -1;
+	}
+
+	const VertexBuffer* MorphMesh::GetTargetVBO(int target, bool normals) const
+	{
+		return normals ? m_targetNormalVBOs[target].get() : m_targetPosVBOs[target].get();
+	}
+
+	void MorphMesh::ReleaseCPUData()
+	{
+		Mesh::ReleaseCPUData();
+
+		//We keep the names, so targets can still be found.
+		for (Target& target : m_targets)
+		{
+			std::vector<GLuint>().swap(target.indices);
+			std::vector<glm::vec4>().swap(target.posDeltas);
+			std::vector<glm::vec4>().swap(target.normalDeltas);
+		}
+	}
+}
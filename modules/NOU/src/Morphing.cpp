@@ -0,0 +1,86 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Morphing.cpp
+Morph target blending on the CPU.
+*/
+
+#include "NOU/Morphing.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define NOU_MORPHING_SSE
+#endif
+
+namespace nou::Morphing
+{
+	namespace
+	{
+		//Adds weight * each delta onto the vertices it belongs to.
+		void AddDeltas(const GLuint* indices, const glm::vec4* deltas, size_t count,
+					   float weight, glm::vec4* out)
+		{
+			#ifdef NOU_MORPHING_SSE
+			//Since the deltas are padded out to 4 floats, each one is a single
+			//SSE load, multiply, and add.
+			__m128 w = _mm_set1_ps(weight);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				float* dest = &out[indices[i]].x;
+				__m128 delta = _mm_loadu_ps(&deltas[i].x);
+
+				_mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_mul_ps(w, delta)));
+			}
+			#else
+			for (size_t i = 0; i < count; ++i)
+				out[indices[i]] += weight * deltas[i];
+			#endif
+		}
+	}
+
+	void BlendTargets(const MorphMesh& mesh, const float* weights,
+					  glm::vec4* outVerts, glm::vec4* outNormals)
+	{
+		const std::vector<glm::vec3>& verts = mesh.GetVerts();
+		const std::vector<glm::vec3>& normals = mesh.GetNormals();
+
+		if (normals.size() != verts.size())
+			outNormals = nullptr;
+
+		//Start from the base shape...
+		for (size_t i = 0; i < verts.size(); ++i)
+			outVerts[i] = glm::vec4(verts[i], 1.0f);
+
+		if (outNormals != nullptr)
+		{
+			for (size_t i = 0; i < normals.size(); ++i)
+				outNormals[i] = glm::vec4(normals[i], 0.0f);
+		}
+
+		//...then add on each target, skipping the ones that are turned off.
+		//Each target only touches the vertices it moves, so a target that
+		//moves a few vertices of a big mesh is cheap.
+		const std::vector<MorphMesh::Target>& targets = mesh.GetTargets();
+
+		for (size_t t = 0; t < targets.size(); ++t)
+		{
+			const MorphMesh::Target& target = targets[t];
+
+			if (std::abs(weights[t]) < 1e-5f)
+				continue;
+
+			AddDeltas(target.indices.data(), target.posDeltas.data(), target.posDeltas.size(),
+					  weights[t], outVerts);
+
+			//The blended normals won't quite be unit length any more,
+			//but our lighting shader normalizes them anyway.
+			if (outNormals != nullptr && target.normalDeltas.size() > 0)
+				AddDeltas(target.indices.data(), target.normalDeltas.data(), target.normalDeltas.size(),
+						  weights[t], outNormals);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+SkinnedMesh.cpp
+Mesh with a skeleton, for skeletal animation.
+*/
+
+#include "NOU/SkinnedMesh.h"
+
+#include "GLM/gtx/transform.hpp"
+
+namespace nou
+{
+	glm::mat4 JointPose::ToMatrix() const
+	{
+		return glm::translate(pos) *
+			   glm::toMat4(glm::normalize(rotation)) *
+			   glm::scale(scale);
+	}
+
+	void SkinnedMesh::SetJointInfluences(const std::vector<glm::vec4>& joints)
+	{
+		m_jointInfluences = joints;
+		SetVBO(Attrib::JOINT_INFLUENCE, 4, m_jointInfluences);
+	}
+
+	void SkinnedMesh::SetSkinWeights(const std::vector<glm::vec4>& weights)
+	{
+		m_skinWeights = weights;
+		SetVBO(Attrib::SKIN_WEIGHT, 4, m_skinWeights);
+	}
+
+	bool SkinnedMesh::SetJoints(const std::vector<Joint>& joints)
+	{
+		for (size_t i = 0; i < joints.size(); ++i)
+		{
+			if (joints[i].parent >= (int)i)
+			{
+				printf("Joint %s comes before its parent in the skeleton.\n", joints[i].name.c_str());
+				return false;
+			}
+		}
+
+		m_joints = joints;
+		return true;
+	}
+
+	int SkinnedMesh::FindJoint(const std::string& name) const
+	{
+		for (size_t i = 0; i < m_joints.size(); ++i)
+		{
+			if (m_joints[i].name == name)
+				return (int)i;
+		}
+
+		return -1;
+	}
+
+	void SkinnedMesh::ReleaseCPUData()
+	{
+		Mesh::ReleaseCPUData();
+
+		std::vector<glm::vec4>().swap(m_jointInfluences);
+		std::vector<glm::vec4>().swap(m_skinWeights);
+	}
+}
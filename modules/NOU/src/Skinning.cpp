@@ -0,0 +1,142 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Skinning.cpp
+Linear blend skinning on the CPU.
+*/
+
+#include "NOU/Skinning.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define NOU_SKINNING_SSE
+#endif
+
+namespace nou::Skinning
+{
+	namespace
+	{
+		//Skins the vertices from begin up to (but not including) end.
+		void SkinRange(const glm::vec3* verts, const glm::vec3* normals,
+					   const glm::vec4* joints, const glm::vec4* weights,
+					   const glm::mat4* jointMatrices,
+					   glm::vec3* outVerts, glm::vec3* outNormals,
+					   size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const glm::vec4& joint = joints[i];
+				const glm::vec4& weight = weights[i];
+
+				const glm::mat4& m0 = jointMatrices[(int)joint.x];
+				const glm::mat4& m1 = jointMatrices[(int)joint.y];
+				const glm::mat4& m2 = jointMatrices[(int)joint.z];
+				const glm::mat4& m3 = jointMatrices[(int)joint.w];
+
+				#ifdef NOU_SKINNING_SSE
+				//With SSE, we can work on a whole column of a matrix at once.
+				//First we blend the four joint matrices together, column by column...
+				__m128 w0 = _mm_set1_ps(weight.x);
+				__m128 w1 = _mm_set1_ps(weight.y);
+				__m128 w2 = _mm_set1_ps(weight.z);
+				__m128 w3 = _mm_set1_ps(weight.w);
+
+				__m128 col[4];
+
+				for (int c = 0; c < 4; ++c)
+				{
+					col[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, _mm_loadu_ps(&m0[c][0])),
+												   _mm_mul_ps(w1, _mm_loadu_ps(&m1[c][0]))),
+										_mm_add_ps(_mm_mul_ps(w2, _mm_loadu_ps(&m2[c][0])),
+												   _mm_mul_ps(w3, _mm_loadu_ps(&m3[c][0]))));
+				}
+
+				//...then transform the vertex by the blended matrix.
+				//We can't store 4 floats into a vec3 without stomping on the next
+				//vertex (or running off the end of the array), so we go through
+				//a temporary.
+				alignas(16) float result[4];
+
+				const glm::vec3& v = verts[i];
+				__m128 pos = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0], _mm_set1_ps(v.x)),
+												   _mm_mul_ps(col[1], _mm_set1_ps(v.y))),
+										_mm_add_ps(_mm_mul_ps(col[2], _mm_set1_ps(v.z)), col[3]));
+				_mm_store_ps(result, pos);
+				memcpy(&outVerts[i], result, sizeof(glm::vec3));
+
+				//Normals are directions, so they ignore the translation column.
+				if (outNormals != nullptr)
+				{
+					const glm::vec3& n = normals[i];
+					__m128 norm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0], _mm_set1_ps(n.x)),
+														_mm_mul_ps(col[1], _mm_set1_ps(n.y))),
+											 _mm_mul_ps(col[2], _mm_set1_ps(n.z)));
+					_mm_store_ps(result, norm);
+					memcpy(&outNormals[i], result, sizeof(glm::vec3));
+				}
+				#else
+				glm::mat4 skin = weight.x * m0 + weight.y * m1 + weight.z * m2 + weight.w * m3;
+
+				outVerts[i] = glm::vec3(skin * glm::vec4(verts[i], 1.0f));
+
+				if (outNormals != nullptr)
+					outNormals[i] = glm::mat3(skin) * normals[i];
+				#endif
+			}
+		}
+	}
+
+	void SkinVertices(const SkinnedMesh& mesh, const glm::mat4* jointMatrices,
+					  glm::vec3* outVerts, glm::vec3* outNormals,
+					  unsigned threadCount)
+	{
+		const std::vector<glm::vec3>& verts = mesh.GetVerts();
+		const std::vector<glm::vec3>& normals = mesh.GetNormals();
+		const std::vector<glm::vec4>& joints = mesh.GetJointInfluences();
+		const std::vector<glm::vec4>& weights = mesh.GetSkinWeights();
+
+		size_t count = verts.size();
+
+		if (joints.size() != count || weights.size() != count)
+		{
+			printf("Can't skin a mesh without joint influences and skin weights for every vertex.\n");
+			return;
+		}
+
+		if (normals.size() != count)
+			outNormals = nullptr;
+
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		threadCount = (unsigned)std::min<size_t>(threadCount, std::max<size_t>(count / PARALLEL_MIN_VERTS, 1));
+
+		//Each thread gets its own chunk of vertices. Since every vertex is skinned
+		//independently of the others, the threads never need to wait on each other.
+		size_t chunkSize = (count + threadCount - 1) / threadCount;
+		std::vector<std::future<void>> tasks;
+
+		for (unsigned t = 1; t < threadCount; ++t)
+		{
+			size_t begin = t * chunkSize;
+			size_t end = std::min(begin + chunkSize, count);
+
+			tasks.push_back(std::async(std::launch::async, SkinRange,
+									   verts.data(), normals.data(), joints.data(), weights.data(),
+									   jointMatrices, outVerts, outNormals, begin, end));
+		}
+
+		//This thread takes the first chunk rather than sitting idle.
+		SkinRange(verts.data(), normals.data(), joints.data(), weights.data(),
+				  jointMatrices, outVerts, outNormals, 0, std::min(chunkSize, count));
+
+		for (auto& task : tasks)
+			task.wait();
+	}
+}
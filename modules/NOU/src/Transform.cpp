@@ -12,6 +12,8 @@ Simple class for managing object transforms with basic hierarchy support.
 
 namespace nou
 {
+	size_t Transform::m_hierarchyVersion = 0;
+
 	Transform::Transform()
 	{
 		m_parent = nullptr;
@@ -106,6 +108,7 @@ namespace nou
 			m_parent->RemoveChild(this);
 
 		m_parent = parent;
+		++m_hierarchyVersion;
 
 		//If we have a parent now, add this as a child to that object.
 		if(m_parent != nullptr)
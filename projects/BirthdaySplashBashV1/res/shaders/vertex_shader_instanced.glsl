@@ -0,0 +1,39 @@
+#version 410
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+
+// Per-instance transforms, filled in by the InstancedRenderer (a mat4 takes up slots 4-7, and a mat3 takes up 8-10)
+layout(location = 4) in mat4 inModel;
+layout(location = 8) in mat3 inNormalMatrix;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec2 outUV;
+
+uniform mat4 u_ViewProjection;
+uniform mat4 u_View;
+uniform vec3 u_LightPos;
+
+
+void main() {
+
+	// Pass vertex pos in world space to frag shader
+	vec4 worldPos = inModel * vec4(inPosition, 1.0);
+	outPos = worldPos.xyz;
+
+	gl_Position = u_ViewProjection * worldPos;
+
+	// Normals
+	outNormal = inNormalMatrix * inNormal;
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+
+	///////////
+	outColor = inColor;
+
+}
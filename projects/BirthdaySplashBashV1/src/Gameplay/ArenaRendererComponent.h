@@ -0,0 +1,16 @@
+#pragma once
+#include "Graphics/GeometryArena.h"
+#include "ShaderMaterial.h"
+
+/// <summary>
+/// Like the RendererComponent, but for meshes that live in a GeometryArena. These are drawn by an IndirectRenderer,
+/// which submits every entity that shares a material and arena with a single glMultiDrawElementsIndirect call
+/// </summary>
+struct ArenaRendererComponent
+{
+	ArenaMesh::sptr         Mesh;
+	ShaderMaterial::sptr    Material;
+
+	ArenaRendererComponent& SetMesh(const ArenaMesh::sptr& mesh) { Mesh = mesh; return *this; }
+	ArenaRendererComponent& SetMaterial(const ShaderMaterial::sptr& material) { Material = material; return *this; }
+};
@@ -28,6 +28,8 @@ public:
 	/*
 	 * Invoked during the variable rate update. This is generally where we want to add our updates.
 	 * To get the time since the last update, use florp::app::Timing::DeltaTime
+	 * If the behaviour's type has been declared with SystemScheduler::DeclareBehaviour, this may be called from a
+	 * worker thread, alongside other behaviours of the same type on other entities
 	 * @param entity The entity that the behaviour is bound to
 	 */
 	virtual void Update(entt::handle entity) {}
@@ -0,0 +1,10 @@
+#pragma once
+
+/// <summary>
+/// Marks an entity to be drawn through an InstancedRenderer, which draws every instanced entity that shares a mesh and
+/// material with a single draw call. The render groups exclude entities with this component, since the instanced
+/// renderer draws them instead
+/// </summary>
+struct InstancedTag
+{
+};
@@ -1,12 +1,32 @@
 #pragma once
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/MeshLodGroup.h"
 #include "Gameplay/ShaderMaterial.h"
+#include "Gameplay/Transform.h"
 
 class RendererComponent {
 public:
 	VertexArrayObject::sptr Mesh;
 	ShaderMaterial::sptr    Material;
+	// Optional levels of detail, when set UpdateLod will swap Mesh for the level that suits the object's size on screen
+	MeshLodGroup::sptr      Lods;
+	size_t                  LodLevel = 0;
 
-	RendererComponent& SetMesh(const VertexArrayObject::sptr& mesh) { Mesh = mesh; return *this; }
+	RendererComponent& SetMesh(const VertexArrayObject::sptr& mesh) { Mesh = mesh; Lods = nullptr; LodLevel = 0; return *this; }
 	RendererComponent& SetMaterial(const ShaderMaterial::sptr& material) { Material = material; return *this; }
-};
\ No newline at end of file
+	RendererComponent& SetLods(const MeshLodGroup::sptr& lods) { Lods = lods; LodLevel = 0; Mesh = lods->GetLevel(0).Mesh; return *this; }
+
+	/// <summary>
+	/// Picks the level of detail to draw this frame, does nothing if the renderer has no LODs
+	/// </summary>
+	/// <param name="transform">The transform of the object, the world matrix must be up to date</param>
+	/// <param name="cameraPosition">The world space position of the camera</param>
+	/// <param name="projection">The camera's projection matrix</param>
+	void UpdateLod(const Transform& transform, const glm::vec3& cameraPosition, const glm::mat4& projection) {
+		if (Lods == nullptr) {
+			return;
+		}
+		LodLevel = Lods->SelectLevel(transform.WorldTransform(), cameraPosition, projection, LodLevel);
+		Mesh = Lods->GetLevel(LodLevel).Mesh;
+	}
+};
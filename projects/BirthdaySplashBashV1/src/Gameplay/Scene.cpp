@@ -10,7 +10,7 @@ std::unordered_map<entt::id_type, StampFunction> GameScene::_stampFunctions;
 GameScene::GameScene(const std::string& name) {
 	Name = name;
 
-	RegisterComponentType<Transform>();
+	RegisterComponentType<Transform>(&Transform::Stamp);
 	RegisterComponentType<GameObjectTag>();
 }
 
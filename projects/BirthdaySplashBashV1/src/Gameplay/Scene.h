@@ -1,6 +1,7 @@
 #pragma once
 #include "entt.hpp"
 #include "Utilities/Macros.h"
+#include "Gameplay/SystemScheduler.h"
 
 /// <summary>
 /// Represents a callback that may be used to customize how entity stamping works between registries
@@ -27,6 +28,19 @@ public:
 
 	entt::registry& Registry() { return _registry; }
 
+	/// <summary>
+	/// Gets the scheduler that runs this scene's behaviours and systems, add any systems for the scene to this
+	/// </summary>
+	SystemScheduler& Scheduler() { return _scheduler; }
+
+	/// <summary>
+	/// Runs Update on every enabled behaviour in the scene and every system in the scheduler, spreading the work across
+	/// threads wherever the declared component access allows it (see SystemScheduler)
+	/// </summary>
+	void Update() {
+		_scheduler.Run(_registry);
+	}
+
 	/// <summary>
 	/// Perform any tasks that should happen at the end of a loop, such as deleting queued objects
 	/// </summary>
@@ -54,6 +68,7 @@ public:
 	
 private:
 	entt::registry _registry;
+	SystemScheduler _scheduler;
 	std::vector<entt::entity> _deletionQueue;
 
 	static entt::registry _prefabRegistry;
@@ -7,6 +7,20 @@ void SubmitUniforms(const Shader::sptr& shader, const std::unordered_map<ShaderP
 	}
 }
 
+template<typename T>
+void SubmitUniformsByName(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
+	for (auto& kvp : values) {
+		shader->SetUniform(kvp.first.Name, kvp.second);
+	}
+}
+
+template<typename T>
+void SubmitUniformsMatByName(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
+	for (auto& kvp : values) {
+		shader->SetUniformMatrix(kvp.first.Name, kvp.second);
+	}
+}
+
 template<typename T>
 void SubmitUniformsMat(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
 	for (auto& kvp : values) {
@@ -42,6 +56,26 @@ void ShaderMaterial::Apply()
 	SubmitUniformsMat(Shader, Mat3Params);
 }
 
+void ShaderMaterial::Apply(const Shader::sptr& shader)
+{
+	int slot = 1;
+	for (auto& kvp : Textures) {
+		int location = shader->GetUniformLocation(kvp.first.Name);
+		if (location != -1 && kvp.second != nullptr) {
+			shader->SetUniform(location, slot);
+			kvp.second->Bind(slot);
+			slot++;
+		}
+	}
+
+	SubmitUniformsByName(shader, FloatParams);
+	SubmitUniformsByName(shader, Vec2Params);
+	SubmitUniformsByName(shader, Vec3Params);
+	SubmitUniformsByName(shader, Vec4Params);
+	SubmitUniformsMatByName(shader, Mat4Params);
+	SubmitUniformsMatByName(shader, Mat3Params);
+}
+
 void ShaderMaterial::Set(const std::string& name, const ITexture::sptr& texture) {
 	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
 	ShaderParamName pName = name;
@@ -50,6 +50,12 @@ public:
 	std::string DebugName;
 
 	void Apply();
+	/// <summary>
+	/// Applies this material's parameters to a different shader than the one it was made for, such as an instanced variant
+	/// of Shader. Uniforms are looked up by name, so this is a bit slower than Apply
+	/// </summary>
+	/// <param name="shader">The shader to apply the parameters to, must already be bound</param>
+	void Apply(const Shader::sptr& shader);
 
 	void Set(const std::string& name, const ITexture::sptr& texture);
 	void Set(const std::string& name, float value);
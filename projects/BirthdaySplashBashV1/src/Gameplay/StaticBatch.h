@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <entt.hpp>
+
+/// <summary>
+/// Marks an entity as never moving, so that StaticBatcher can merge its mesh with the other static entities that use
+/// the same material. Moving a static entity after it has been baked has no visible effect until the next bake
+/// </summary>
+struct StaticTag
+{
+};
+
+/// <summary>
+/// Added to a static entity once its mesh has been merged into a batch. The render groups exclude entities with this
+/// component, since the batch draws them instead
+/// </summary>
+struct StaticBatched
+{
+	// The entity holding the batch that this entity was merged into
+	entt::entity Batch = entt::null;
+};
+
+/// <summary>
+/// Stored on the entity that draws a combined mesh, records where each of the source entities ended up within it. For
+/// batches with levels of detail, the index ranges are within the full detail level
+/// </summary>
+struct StaticBatch
+{
+	struct Range
+	{
+		entt::entity Source;
+		std::string  Name;
+		uint32_t     FirstIndex;
+		uint32_t     IndexCount;
+		uint32_t     FirstVertex;
+		uint32_t     VertexCount;
+	};
+
+	std::vector<Range> Ranges;
+};
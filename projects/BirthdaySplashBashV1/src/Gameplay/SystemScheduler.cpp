@@ -0,0 +1,288 @@
+#include "SystemScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Gameplay/Transform.h"
+#include "Logging.h"
+
+std::vector<ComponentAccess> SystemScheduler::_behaviourAccess;
+std::unordered_map<std::type_index, size_t> SystemScheduler::_behaviourIndices;
+
+bool ComponentAccess::ConflictsWith(const ComponentAccess& other) const {
+	if (_isExclusive || other._isExclusive) {
+		return true;
+	}
+	const auto contains = [](const std::vector<entt::id_type>& list, entt::id_type type) {
+		return std::find(list.begin(), list.end(), type) != list.end();
+	};
+	for (const entt::id_type type : _writes) {
+		if (contains(other._writes, type) || contains(other._reads, type)) {
+			return true;
+		}
+	}
+	for (const entt::id_type type : other._writes) {
+		if (contains(_reads, type)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ComponentAccess::PreparePools(entt::registry& registry) const {
+	for (const auto prepare : _preparePools) {
+		prepare(registry);
+	}
+}
+
+void SystemScheduler::AddSystem(const std::string& name, const ComponentAccess& access, const SystemFunc& update) {
+	System system;
+	system.Name = name;
+	system.Access = access;
+	system.ChunkSize = 1;
+	system.Prepare = [](entt::registry&) { return static_cast<size_t>(1); };
+	system.Update = [update](entt::registry& registry, size_t, size_t) { update(registry); };
+	_systems.push_back(std::move(system));
+}
+
+void SystemScheduler::Run(entt::registry& registry, ThreadPool& pool) {
+	// The undeclared behaviours might add or remove anything, so if there are any they go first, and then the rest
+	// have to be gathered again
+	if (_GatherBehaviours(registry)) {
+		_RunUndeclaredBehaviours(registry);
+		_GatherBehaviours(registry);
+	}
+
+	_nodeCount = 0;
+	for (size_t ix = 0; ix < _declaredBehaviours.size(); ix++) {
+		const BehaviourList& behaviours = _declaredBehaviours[ix];
+		if (!behaviours.empty()) {
+			_AddNode(_behaviourAccess[ix], behaviours.size(), DEFAULT_CHUNK_SIZE, [&registry, &behaviours](size_t begin, size_t end) {
+				for (size_t jx = begin; jx < end; jx++) {
+					behaviours[jx].second->Update(entt::handle(registry, behaviours[jx].first));
+				}
+			});
+		}
+	}
+	for (System& system : _systems) {
+		const size_t count = system.Prepare(registry);
+		if (count > 0) {
+			_AddNode(system.Access, count, system.ChunkSize, [&registry, &system](size_t begin, size_t end) {
+				system.Update(registry, begin, end);
+			});
+		}
+	}
+	if (_nodeCount == 0) {
+		return;
+	}
+
+	// Build the dependency graph, where each node waits on every earlier node that it conflicts with
+	std::vector<size_t> ready;
+	for (size_t ix = 0; ix < _nodeCount; ix++) {
+		Node& node = *_nodes[ix];
+		node.Access->PreparePools(registry);
+		for (size_t earlier = 0; earlier < ix; earlier++) {
+			if (_nodes[earlier]->Access->ConflictsWith(*node.Access)) {
+				_nodes[earlier]->Dependents.push_back(ix);
+				node.WaitingOn++;
+			}
+		}
+		if (node.WaitingOn == 0) {
+			ready.push_back(ix);
+		}
+	}
+
+	// The ready list has to be finished before anything starts, otherwise a node that gets freed up by a fast worker
+	// could be started twice
+	_nodesLeft = _nodeCount;
+	for (const size_t ix : ready) {
+		_Start(ix, pool);
+	}
+
+	// Run anything that needs the main thread, and help out with the chunks in the meantime
+	while (_nodesLeft.load() > 0) {
+		size_t index = _nodeCount;
+		{
+			std::lock_guard<std::mutex> lock(_mainThreadMutex);
+			if (!_mainThreadNodes.empty()) {
+				index = _mainThreadNodes.back();
+				_mainThreadNodes.pop_back();
+			}
+		}
+		if (index < _nodeCount) {
+			_nodes[index]->Work(0, _nodes[index]->Count);
+			_Finish(index, pool);
+		} else if (!pool.TryRunOne()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool SystemScheduler::_GatherBehaviours(entt::registry& registry) {
+	_declaredBehaviours.resize(_behaviourAccess.size());
+	for (BehaviourList& behaviours : _declaredBehaviours) {
+		behaviours.clear();
+	}
+
+	// Entities usually have the same kinds of behaviours as their neighbours, so remember the last type we looked up
+	const std::type_info* lastType = nullptr;
+	BehaviourList* lastList = nullptr;
+	bool foundUndeclared = false;
+	registry.view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
+		for (const auto& behaviour : binding.Behaviours) {
+			if (!behaviour->Enabled) {
+				continue;
+			}
+			const std::type_info& type = typeid(*behaviour);
+			if (&type != lastType) {
+				lastType = &type;
+				const auto it = _behaviourIndices.find(std::type_index(type));
+				lastList = it != _behaviourIndices.end() ? &_declaredBehaviours[it->second] : nullptr;
+			}
+			if (lastList != nullptr) {
+				lastList->emplace_back(entity, behaviour.get());
+			} else {
+				foundUndeclared = true;
+			}
+		}
+	});
+	return foundUndeclared;
+}
+
+void SystemScheduler::_RunUndeclaredBehaviours(entt::registry& registry) {
+	registry.view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
+		for (const auto& behaviour : binding.Behaviours) {
+			if (behaviour->Enabled && _behaviourIndices.find(std::type_index(typeid(*behaviour))) == _behaviourIndices.end()) {
+				behaviour->Update(entt::handle(registry, entity));
+			}
+		}
+	});
+}
+
+SystemScheduler::Node& SystemScheduler::_AddNode(const ComponentAccess& access, size_t count, size_t chunkSize, std::function<void(size_t, size_t)> work) {
+	if (_nodeCount == _nodes.size()) {
+		_nodes.push_back(std::make_unique<Node>());
+	}
+	Node& node = *_nodes[_nodeCount++];
+	node.Access = &access;
+	node.Count = count;
+	node.ChunkSize = std::max<size_t>(chunkSize, 1);
+	node.Work = std::move(work);
+	node.Dependents.clear();
+	node.WaitingOn = 0;
+	node.ChunksLeft = 0;
+	return node;
+}
+
+void SystemScheduler::_Start(size_t index, ThreadPool& pool) {
+	Node& node = *_nodes[index];
+	if (node.Access->IsMainThread()) {
+		std::lock_guard<std::mutex> lock(_mainThreadMutex);
+		_mainThreadNodes.push_back(index);
+		return;
+	}
+
+	// Aim for a few chunks per thread so that there's something left to steal, without going under the chunk size
+	const size_t targetChunks = pool.ThreadCount() * 4;
+	const size_t chunkSize = std::max(node.ChunkSize, (node.Count + targetChunks - 1) / targetChunks);
+	node.ChunksLeft = (node.Count + chunkSize - 1) / chunkSize;
+	for (size_t begin = 0; begin < node.Count; begin += chunkSize) {
+		const size_t end = std::min(begin + chunkSize, node.Count);
+		pool.Submit([this, &pool, index, begin, end]() {
+			Node& node = *_nodes[index];
+			node.Work(begin, end);
+			if (node.ChunksLeft.fetch_sub(1) == 1) {
+				_Finish(index, pool);
+			}
+		});
+	}
+}
+
+void SystemScheduler::_Finish(size_t index, ThreadPool& pool) {
+	for (const size_t dependent : _nodes[index]->Dependents) {
+		if (_nodes[dependent]->WaitingOn.fetch_sub(1) == 1) {
+			_Start(dependent, pool);
+		}
+	}
+	// This has to come last, since Run can return as soon as it hits zero
+	_nodesLeft.fetch_sub(1);
+}
+
+namespace {
+	// Wobbles its entity around a little every frame, with a bit of math to stand in for real gameplay code
+	class BenchmarkBehaviour final : public IBehaviour {
+	public:
+		float Phase = 0.0f;
+
+		void Update(entt::handle entity) override {
+			Transform& transform = entity.get<Transform>();
+			Phase += 0.1f;
+			transform.SetLocalPosition(transform.GetLocalPosition() + glm::vec3(sinf(Phase), cosf(Phase), 0.0f) * 0.01f);
+			transform.RotateLocal(0.0f, 1.0f, 0.0f);
+		}
+	};
+
+	template <typename Func>
+	double TimeFrames(int iterations, const Func& update) {
+		using Clock = std::chrono::high_resolution_clock;
+		const auto start = Clock::now();
+		for (int ix = 0; ix < iterations; ix++) {
+			update();
+		}
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+	}
+}
+
+void SystemScheduler::Benchmark(size_t count, int iterations)
+{
+	DeclareBehaviour<BenchmarkBehaviour>(ComponentAccess().Writes<Transform>());
+
+	// One scene for the serial loop, and one for each of the scheduler runs, so they all start from the same place
+	entt::registry registries[3];
+	for (entt::registry& registry : registries) {
+		for (size_t ix = 0; ix < count; ix++) {
+			const entt::entity entity = registry.create();
+			registry.emplace<Transform>(entity, entt::handle(registry, entity)).SetLocalPosition(static_cast<float>(ix), 0.0f, 0.0f);
+			BehaviourBinding::Bind<BenchmarkBehaviour>(entt::handle(registry, entity))->Phase = static_cast<float>(ix % 64);
+		}
+	}
+
+	LOG_INFO("SystemScheduler benchmark ({} behaviours, {} frames)", count, iterations);
+
+	const double serialTime = TimeFrames(iterations, [&]() {
+		registries[0].view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
+			for (const auto& behaviour : binding.Behaviours) {
+				if (behaviour->Enabled) {
+					behaviour->Update(entt::handle(registries[0], entity));
+				}
+			}
+		});
+	});
+
+	ThreadPool noWorkers(0);
+	SystemScheduler singleScheduler;
+	const double singleTime = TimeFrames(iterations, [&]() { singleScheduler.Run(registries[1], noWorkers); });
+
+	SystemScheduler scheduler;
+	const double parallelTime = TimeFrames(iterations, [&]() { scheduler.Run(registries[2]); });
+
+	LOG_INFO("\t{:.2f} ms one at a time, {:.2f} ms scheduled on 1 thread, {:.2f} ms scheduled on {} threads",
+		serialTime, singleTime, parallelTime, ThreadPool::Instance().ThreadCount());
+
+	// Every behaviour only depends on its own entity, so the order they ran in should make no difference
+	float maxError = 0.0f;
+	const auto serialView = registries[0].view<Transform>();
+	for (size_t ix = 1; ix < 3; ix++) {
+		for (const entt::entity entity : serialView) {
+			const Transform& expected = registries[0].get<Transform>(entity);
+			const Transform& actual = registries[ix].get<Transform>(entity);
+			maxError = std::max(maxError, glm::length(actual.GetLocalPosition() - expected.GetLocalPosition()));
+			maxError = std::max(maxError, glm::length(actual.GetLocalRotation() - expected.GetLocalRotation()));
+		}
+	}
+	if (maxError > 0.0f) {
+		LOG_ERROR("\tScheduled behaviours do not match the serial behaviours (difference of {})", maxError);
+	}
+}
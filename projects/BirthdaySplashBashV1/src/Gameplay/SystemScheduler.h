@@ -0,0 +1,241 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include <entt.hpp>
+
+#include "Gameplay/IBehaviour.h"
+#include "Utilities/Macros.h"
+#include "Utilities/ThreadPool.h"
+
+/// <summary>
+/// Describes which components a system or behaviour reads and writes during its update, so that the SystemScheduler
+/// knows what it can safely run at the same time. Two pieces of work conflict if either one writes a component that
+/// the other one reads or writes
+/// </summary>
+class ComponentAccess
+{
+public:
+	ComponentAccess() = default;
+
+	/// <summary>
+	/// Declares that the work only reads the given components
+	/// </summary>
+	template <typename ... Components>
+	ComponentAccess& Reads() {
+		(_Add<Components>(_reads), ...);
+		return *this;
+	}
+	/// <summary>
+	/// Declares that the work reads and writes the given components
+	/// </summary>
+	template <typename ... Components>
+	ComponentAccess& Writes() {
+		(_Add<Components>(_writes), ...);
+		return *this;
+	}
+	/// <summary>
+	/// Declares that the work has to run on the main thread, ie. anything that polls GLFW for input. Main thread work
+	/// still runs alongside anything it does not conflict with
+	/// </summary>
+	ComponentAccess& OnMainThread() {
+		_isMainThread = true;
+		return *this;
+	}
+	/// <summary>
+	/// Declares that the work may touch anything in the registry, including creating and destroying entities. Exclusive
+	/// work runs by itself on the main thread, after everything before it and before everything after it
+	/// </summary>
+	ComponentAccess& Exclusive() {
+		_isExclusive = true;
+		return *this;
+	}
+
+	bool IsMainThread() const { return _isMainThread || _isExclusive; }
+	bool IsExclusive() const { return _isExclusive; }
+
+	/// <summary>
+	/// Returns true if this work and the other work cannot run at the same time
+	/// </summary>
+	bool ConflictsWith(const ComponentAccess& other) const;
+
+	/// <summary>
+	/// Makes sure that the registry has a pool for every component that was declared. Adding a pool is not safe while
+	/// other threads are looking up components, so the scheduler does this on the main thread before the work starts
+	/// </summary>
+	void PreparePools(entt::registry& registry) const;
+
+private:
+	std::vector<entt::id_type> _reads;
+	std::vector<entt::id_type> _writes;
+	std::vector<void(*)(entt::registry&)> _preparePools;
+	bool _isMainThread = false;
+	bool _isExclusive = false;
+
+	template <typename Component>
+	void _Add(std::vector<entt::id_type>& list) {
+		typedef std::remove_const_t<Component> Type;
+		list.push_back(entt::type_info<Type>::id());
+		_preparePools.push_back([](entt::registry& registry) { static_cast<void>(registry.view<Type>()); });
+	}
+};
+
+/// <summary>
+/// Runs the behaviours and systems for a scene each frame, spreading them across a ThreadPool.
+///
+/// Every piece of work declares which components it reads and writes (see ComponentAccess). Each frame, the scheduler
+/// builds a dependency graph where anything that conflicts with earlier work waits for it to finish, and everything else
+/// starts as soon as the pool has room. Large batches of work are split into chunks of entities, which idle workers can
+/// steal from each other. Gameplay code never has to lock anything, as long as the declarations are honest.
+///
+/// Behaviours with no declared access run first, one entity at a time on the main thread, the same as they always have.
+/// After that, anything that conflicts runs in this order:
+///  - Each declared behaviour type, in the order they were declared
+///  - Systems, in the order they were added
+///
+/// Declared behaviours and per-entity systems must only touch the components of the entity they were handed, since
+/// different entities get updated at the same time. They must not add or remove components, entities or behaviours, or
+/// change the parent of a transform, either. Systems that do need to be declared as Exclusive, and behaviours that do
+/// should be left undeclared
+/// </summary>
+class SystemScheduler final
+{
+	SMART_MEMORY_MANAGED(SystemScheduler)
+
+public:
+	typedef std::function<void(entt::registry&)> SystemFunc;
+
+	// The smallest number of entities that will be handed to a thread at once, anything smaller is not worth the overhead
+	static constexpr size_t DEFAULT_CHUNK_SIZE = 64;
+
+	SystemScheduler() = default;
+	~SystemScheduler() = default;
+
+	/// <summary>
+	/// Adds a system that runs once per frame as a single task
+	/// </summary>
+	/// <param name="name">The name of the system, for debugging</param>
+	/// <param name="access">The components that the system reads and writes</param>
+	/// <param name="update">The function to run each frame</param>
+	void AddSystem(const std::string& name, const ComponentAccess& access, const SystemFunc& update);
+
+	/// <summary>
+	/// Adds a system that runs once per frame for every entity with the given components. The entities are split into
+	/// chunks that run in parallel, so the update must only touch the entity that it was given
+	/// </summary>
+	/// <typeparam name="Components">The components an entity needs to have for the system to run on it</typeparam>
+	/// <param name="name">The name of the system, for debugging</param>
+	/// <param name="access">The components that the system reads and writes</param>
+	/// <param name="update">The function to run on each entity, taking the entity followed by a reference to each of the components</param>
+	/// <param name="chunkSize">The smallest number of entities to hand to a thread at once</param>
+	template <typename ... Components, typename Func>
+	void AddSystemEach(const std::string& name, const ComponentAccess& access, Func update, size_t chunkSize = DEFAULT_CHUNK_SIZE) {
+		// The entities get gathered on the main thread at the start of the frame, then the chunks index into them
+		auto entities = std::make_shared<std::vector<entt::entity>>();
+		System system;
+		system.Name = name;
+		system.Access = access;
+		system.ChunkSize = chunkSize;
+		system.Prepare = [entities](entt::registry& registry) {
+			auto view = registry.view<Components...>();
+			entities->assign(view.begin(), view.end());
+			return entities->size();
+		};
+		system.Update = [entities, update](entt::registry& registry, size_t begin, size_t end) {
+			auto view = registry.view<Components...>();
+			for (size_t ix = begin; ix < end; ix++) {
+				const entt::entity entity = (*entities)[ix];
+				update(entity, view.template get<Components>(entity)...);
+			}
+		};
+		_systems.push_back(std::move(system));
+	}
+
+	/// <summary>
+	/// Declares which components a behaviour type reads and writes in IBehaviour::Update, so that behaviours of that type
+	/// can be updated in parallel. Behaviour types that are never declared keep running one at a time on the main thread
+	/// </summary>
+	/// <typeparam name="T">The type of behaviour to declare</typeparam>
+	/// <param name="access">The components of its own entity that the behaviour reads and writes</param>
+	template <typename T, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
+	static void DeclareBehaviour(const ComponentAccess& access) {
+		const std::type_index type = std::type_index(typeid(T));
+		auto it = _behaviourIndices.find(type);
+		if (it != _behaviourIndices.end()) {
+			_behaviourAccess[it->second] = access;
+		} else {
+			_behaviourIndices[type] = _behaviourAccess.size();
+			_behaviourAccess.push_back(access);
+		}
+	}
+
+	/// <summary>
+	/// Runs every enabled behaviour and every system for a frame, returning once they have all finished. Must be called
+	/// from the main thread
+	/// </summary>
+	/// <param name="registry">The registry to update</param>
+	/// <param name="pool">The pool to run the work on</param>
+	void Run(entt::registry& registry, ThreadPool& pool = ThreadPool::Instance());
+
+	/// <summary>
+	/// Times updating a scene full of behaviours one entity at a time (the way main.cpp used to) against the scheduler,
+	/// and logs an error if the two ever disagree
+	/// </summary>
+	/// <param name="count">The number of entities in the scene</param>
+	/// <param name="iterations">The number of frames to run each test for</param>
+	static void Benchmark(size_t count = 100000, int iterations = 10);
+
+private:
+	struct System {
+		std::string Name;
+		ComponentAccess Access;
+		size_t ChunkSize;
+		// Runs on the main thread at the start of the frame, returns the number of items to split into chunks
+		std::function<size_t(entt::registry&)> Prepare;
+		// Updates the items in [begin, end)
+		std::function<void(entt::registry&, size_t, size_t)> Update;
+	};
+
+	// A batch of work in this frame's dependency graph
+	struct Node {
+		const ComponentAccess* Access;
+		size_t Count;
+		size_t ChunkSize;
+		std::function<void(size_t, size_t)> Work;
+		std::vector<size_t> Dependents;
+		// The number of earlier nodes this one still has to wait for
+		std::atomic<size_t> WaitingOn;
+		// The number of chunks of this node that are still running
+		std::atomic<size_t> ChunksLeft;
+	};
+
+	typedef std::vector<std::pair<entt::entity, IBehaviour*>> BehaviourList;
+
+	std::vector<System> _systems;
+
+	// The enabled behaviours for this frame, one list per declared type
+	std::vector<BehaviourList> _declaredBehaviours;
+
+	// The nodes are kept between frames, since the atomics cannot be moved around
+	std::vector<std::unique_ptr<Node>> _nodes;
+	size_t _nodeCount = 0;
+	std::atomic<size_t> _nodesLeft { 0 };
+	std::mutex _mainThreadMutex;
+	std::vector<size_t> _mainThreadNodes;
+
+	static std::vector<ComponentAccess> _behaviourAccess;
+	static std::unordered_map<std::type_index, size_t> _behaviourIndices;
+
+	// Sorts the enabled behaviours into lists by their declared type, returns true if any of them were not declared
+	bool _GatherBehaviours(entt::registry& registry);
+	void _RunUndeclaredBehaviours(entt::registry& registry);
+	Node& _AddNode(const ComponentAccess& access, size_t count, size_t chunkSize, std::function<void(size_t, size_t)> work);
+	void _Start(size_t index, ThreadPool& pool);
+	void _Finish(size_t index, ThreadPool& pool);
+};
@@ -1,49 +1,91 @@
 #include "Transform.h"
 
-#include <GLM/gtc/matrix_transform.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <GLM/gtx/quaternion.hpp>
 
 #include "Logging.h"
 
-const glm::mat4 IDENTITY = glm::mat4(1.0f);
+Transform::Transform(const Transform& other) :
+	_gameObject(other._gameObject),
+	_system(other._system),
+	_node(other._system->Clone(other._node, other._gameObject.entity())),
+	_rotationEulerDeg(other._rotationEulerDeg)
+{ }
+
+Transform::Transform(Transform&& other) noexcept :
+	_gameObject(other._gameObject),
+	_system(std::move(other._system)),
+	_node(other._node),
+	_rotationEulerDeg(other._rotationEulerDeg)
+{
+	other._node = TransformSystem::INVALID_NODE;
+}
+
+Transform& Transform::operator=(const Transform& other) {
+	if (this != &other) {
+		_system->SetPosition(_node, other.GetLocalPosition());
+		_system->SetRotation(_node, other.GetLocalRotationQuat());
+		_system->SetScale(_node, other.GetLocalScale());
+		_rotationEulerDeg = other._rotationEulerDeg;
+		if (other._system == _system) {
+			_system->SetParent(_node, _system->GetParent(other._node));
+		}
+	}
+	return *this;
+}
+
+Transform& Transform::operator=(Transform&& other) noexcept {
+	if (this != &other) {
+		if (_system != nullptr && _node != TransformSystem::INVALID_NODE) {
+			_system->Remove(_node);
+		}
+		_gameObject = other._gameObject;
+		_system = std::move(other._system);
+		_node = other._node;
+		_rotationEulerDeg = other._rotationEulerDeg;
+		other._node = TransformSystem::INVALID_NODE;
+	}
+	return *this;
+}
+
+Transform::~Transform() {
+	if (_system != nullptr && _node != TransformSystem::INVALID_NODE) {
+		_system->Remove(_node);
+	}
+}
+
+void Transform::Stamp(const entt::registry& from, const entt::entity src, entt::registry& to, const entt::entity dst) {
+	const Transform& source = from.get<Transform>(src);
+	Transform& result = to.emplace_or_replace<Transform>(dst, entt::handle(to, dst));
+	result.SetLocalPosition(source.GetLocalPosition());
+	result.SetLocalScale(source.GetLocalScale());
+	result._system->SetRotation(result._node, source.GetLocalRotationQuat());
+	result._rotationEulerDeg = source._rotationEulerDeg;
+}
 
 Transform& Transform::SetLocalRotation(const glm::vec3 eulerDegrees) {
 	_rotationEulerDeg = eulerDegrees;
-	_rotation = glm::quat(glm::radians(eulerDegrees));
-	_isLocalDirty = true;
+	_system->SetRotation(_node, glm::quat(glm::radians(eulerDegrees)));
 	return *this;
 }
 
 Transform& Transform::SetLocalRotation(const glm::quat& quaternion) {
-	_rotation = quaternion;
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	_SetRotation(quaternion);
 	return *this;
 }
 
 Transform& Transform::SetLocalRotation(float yawDeg, float pitchDeg, float rollDeg) {
-	_rotationEulerDeg.x = yawDeg;
-	_rotationEulerDeg.y = pitchDeg;
-	_rotationEulerDeg.z = rollDeg;
-	_rotation = glm::quat(glm::radians(_rotationEulerDeg));
-	_isLocalDirty = true;
+	SetLocalRotation(glm::vec3(yawDeg, pitchDeg, rollDeg));
 	return *this;
 }
 
 Transform& Transform::SetLocalPosition(float x, float y, float z) {
-	_position.x = x;
-	_position.y = y;
-	_position.z = z;
-	_isLocalDirty = true;
+	_system->SetPosition(_node, glm::vec3(x, y, z));
 	return *this;
 }
 
 Transform& Transform::SetLocalScale(float x, float y, float z) {
-	_scale.x = x;
-	_scale.y = y;
-	_scale.z = z;
-	_isLocalDirty = true;
+	_system->SetScale(_node, glm::vec3(x, y, z));
 	return *this;
 }
 
@@ -53,9 +95,7 @@ Transform& Transform::RotateLocal(float yawDeg, float pitchDeg, float rollDeg) {
 }
 
 Transform& Transform::RotateLocalFixed(const glm::vec3& rotationDeg) {
-	_rotation = glm::quat(glm::radians(rotationDeg)) * _rotation;
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	_SetRotation(glm::quat(glm::radians(rotationDeg)) * GetLocalRotationQuat());
 	return *this;
 }
 
@@ -65,28 +105,23 @@ Transform& Transform::RotateLocalFixed(float yawDeg, float pitchDeg, float rollD
 }
 
 Transform& Transform::SetLocalPosition(const glm::vec3 value) {
-	_position = value;
-	_isLocalDirty = true;
+	_system->SetPosition(_node, value);
 	return *this;
 }
 
 Transform& Transform::SetLocalScale(const glm::vec3 value) {
-	_scale = value;
-	_isLocalDirty = true;
+	_system->SetScale(_node, value);
 	return *this;
 }
 
 Transform& Transform::RotateLocal(const glm::vec3& rotation) {
-	_rotation = _rotation * glm::quat(glm::radians(rotation));
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	_SetRotation(GetLocalRotationQuat() * glm::quat(glm::radians(rotation)));
 	return *this;
 }
 
 Transform& Transform::MoveLocal(const glm::vec3& localMovement)
 {
-	_position += _rotation * localMovement;
-	_isLocalDirty = true;
+	_system->SetPosition(_node, GetLocalPosition() + GetLocalRotationQuat() * localMovement);
 	return *this;
 }
 
@@ -97,81 +132,51 @@ Transform& Transform::MoveLocal(float x, float y, float z) {
 
 Transform& Transform::MoveLocalFixed(const glm::vec3& localMovement)
 {
-	_position += localMovement;
-	_isLocalDirty = true;
+	_system->SetPosition(_node, GetLocalPosition() + localMovement);
 	return *this;
 }
 
 Transform& Transform::MoveLocalFixed(float x, float y, float z) {
-	_position.x += x;
-	_position.y += y;
-	_position.z += z;
-	_isLocalDirty = true;
+	MoveLocalFixed(glm::vec3(x, y, z));
 	return *this;
 }
 
 Transform& Transform::LookAt(const glm::vec3& localSpace)
 {
-	_rotation = glm::quatLookAt(-glm::normalize(_position - localSpace), glm::normalize(_rotation * glm::vec3(0, 0, 1)));
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	const glm::quat rotation = GetLocalRotationQuat();
+	_SetRotation(glm::quatLookAt(-glm::normalize(GetLocalPosition() - localSpace), glm::normalize(rotation * glm::vec3(0, 0, 1))));
 	return *this;
 }
 
 void Transform::Recalculate() const {
-	_UpdateLocalTransformIfDirty();
+	_system->UpdateLocal(_node);
 }
 
 const glm::mat4& Transform::LocalTransform() const {
-	_UpdateLocalTransformIfDirty();
-	return _localTransform;
+	return _system->UpdateLocal(_node);
 }
 
-const glm::mat3& Transform::NormalMatrix() const {
-	_UpdateLocalTransformIfDirty();
-	return _normalMatrix;	
+glm::mat3 Transform::NormalMatrix() const {
+	return TransformSystem::AffineNormalMatrix(LocalTransform());
 }
 
 void Transform::SetParent(entt::handle parent)
 {
-	_parent = parent;
 	// If we passed in a handle, make sure it has a transform and belongs to the same scene
 	if (&parent.registry() != nullptr && parent.entity() != entt::null) {
 		LOG_ASSERT(parent.has<Transform>(), "Parent entity must have a transform component");
 		LOG_ASSERT(&parent.registry() == &_gameObject.registry(), "Parent entity must be in same registry!");
-		_hierarchyDepth = parent.get<Transform>()._hierarchyDepth + 1;
+		_system->SetParent(_node, parent.get<Transform>()._node);
 	} else {
-		_hierarchyDepth = 0;
+		_system->SetParent(_node, TransformSystem::INVALID_NODE);
 	}
-	
-	// Re-calculate hierarchy depth for all children recursively
-	_gameObject.registry().view<Transform>().each([&](entt::entity entity, Transform& t) {
-		if (t._parent == _gameObject) {
-			t.SetParent(entt::handle(parent.registry(), _gameObject));
-		}
-	});
-	// Re-sort components
-	_gameObject.registry().sort<Transform>([](const Transform& l, const Transform& r) {
-		return l.GetHierarchyDepth() < r.GetHierarchyDepth();
-	});
 }
 
 void Transform::UpdateWorldMatrix() const {
-	if (_parent != entt::null) {
-		_worldTransform = _gameObject.registry().get<Transform>(_parent)._worldTransform * LocalTransform();
-		_worldNormalMatrix = glm::mat3(glm::transpose(glm::inverse(_worldTransform)));
-	} else {
-		_worldTransform = LocalTransform();
-		_worldNormalMatrix = _normalMatrix;
-	}
+	_system->UpdateWorld(_node);
 }
 
-void Transform::_UpdateLocalTransformIfDirty() const {
-	if (_isLocalDirty) {
-		// TRS
-		_localTransform = glm::translate(IDENTITY, _position) * glm::toMat4(_rotation) * glm::scale(IDENTITY, _scale);
-		_normalMatrix = glm::mat3(glm::transpose(glm::inverse(_localTransform)));
-
-		_isLocalDirty = false;
-	}
+void Transform::_SetRotation(const glm::quat& rotation) {
+	_system->SetRotation(_node, rotation);
+	_rotationEulerDeg = glm::degrees(glm::eulerAngles(rotation));
 }
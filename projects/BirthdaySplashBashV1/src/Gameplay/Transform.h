@@ -4,8 +4,11 @@
 #include <GLM/glm.hpp>
 #include <GLM/gtc/quaternion.hpp>
 
+#include "TransformSystem.h"
+
 /// <summary>
-/// A simple transformation class, without parent/child relationships
+/// A simple transformation class, with an optional parent. The transform data itself lives in the TransformSystem for
+/// the registry this belongs to, this component just holds on to a node in it
 /// </summary>
 class Transform final
 {
@@ -13,25 +16,30 @@ public:
 	struct TransformDirtyTag { };
 	
 	Transform(entt::handle gameObject) :
-		_isLocalDirty(true),
-		_localTransform(glm::mat4(1.0f)),
-		_normalMatrix(glm::mat3(1.0f)),
-		_isWorldDirty(true),
-		_worldTransform(glm::mat4(1.0f)),
-		_worldNormalMatrix(glm::mat3(1.0f)),
-		_rotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)),
-		_rotationEulerDeg(glm::vec3(0.0f)),
-		_position(glm::vec3(0.0f)),
-		_scale(glm::vec3(1.0f)),
-		_parent(entt::null),
 		_gameObject(gameObject),
-		_hierarchyDepth(0)
-	{}
-	Transform(const Transform& other) = default;
-	Transform(Transform&& other) = default;
-	Transform& operator =(const Transform & other) = default;
-	Transform& operator =(Transform && other) = default;
-	virtual ~Transform() = default;
+		_system(TransformSystem::Get(gameObject.registry())),
+		_node(TransformSystem::INVALID_NODE),
+		_rotationEulerDeg(glm::vec3(0.0f))
+	{
+		_node = _system->Add(gameObject.entity());
+	}
+	/// <summary>
+	/// Copies a transform, the copy gets its own node with the same local transform and parent
+	/// </summary>
+	Transform(const Transform& other);
+	Transform(Transform&& other) noexcept;
+	/// <summary>
+	/// Copies the local transform and parent of another transform, this keeps its own node and game object
+	/// </summary>
+	Transform& operator =(const Transform & other);
+	Transform& operator =(Transform && other) noexcept;
+	virtual ~Transform();
+
+	/// <summary>
+	/// Stamps a transform into another registry, see GameScene::RegisterComponentType. Only the local transform is
+	/// copied, since the parent belongs to the source registry
+	/// </summary>
+	static void Stamp(const entt::registry& from, const entt::entity src, entt::registry& to, const entt::entity dst);
 
 	// Rotation Getters/Setters
 
@@ -42,7 +50,7 @@ public:
 	/// <summary>
 	/// Returns the local rotation as a quaternion
 	/// </summary>
-	const glm::quat& GetLocalRotationQuat() const { return _rotation; }
+	glm::quat GetLocalRotationQuat() const { return _system->GetRotation(_node); }
 	/// <summary>
 	/// Sets the local rotation of this transform to the given value in euler degrees
 	/// </summary>
@@ -69,7 +77,7 @@ public:
 	/// <summary>
 	/// Gets the local position of this transform
 	/// </summary>
-	const glm::vec3& GetLocalPosition() const { return _position; }
+	glm::vec3 GetLocalPosition() const { return _system->GetPosition(_node); }
 	/// <summary>
 	/// Sets this transforms translation within it's local space
 	/// </summary>
@@ -90,7 +98,7 @@ public:
 	/// <summary>
 	/// Gets the local scale for this transform, along each axis
 	/// </summary>
-	const glm::vec3& GetLocalScale() const { return _scale; }
+	glm::vec3 GetLocalScale() const { return _system->GetScale(_node); }
 	/// <summary>
 	/// Sets this transforms scale within it's local space
 	/// </summary>
@@ -179,46 +187,43 @@ public:
 	void Recalculate() const;
 
 	/// <summary>
-	/// Gets the local transformation matrix for this transform, updating it if required
+	/// Gets the local transformation matrix for this transform
 	/// </summary>
 	const glm::mat4& LocalTransform() const;
 	/// <summary>
-	/// Gets the local rotation matrix for this transform, updating it if required.
-	/// This is useful for calculating the normal matrix
+	/// Gets the matrix for transforming normals into the transform's parent space
 	/// </summary>
-	const glm::mat3& NormalMatrix() const;
+	glm::mat3 NormalMatrix() const;
 
 	void SetParent(entt::handle parent);
 
+	/// <summary>
+	/// Re-calculates the world matrix for just this transform, from the current world matrix of its parent. To update a
+	/// whole scene, call Update on its TransformSystem instead
+	/// </summary>
 	void UpdateWorldMatrix() const;
 
-	const glm::mat4& WorldTransform() const { return _worldTransform; }
-	const glm::mat3& WorldNormalMatrix() const { return _worldNormalMatrix; };
+	const glm::mat4& WorldTransform() const { return _system->GetWorld(_node); }
+	const glm::mat3& WorldNormalMatrix() const { return _system->GetWorldNormal(_node); };
+	/// <summary>
+	/// Returns true if the world matrix of this transform changed during the last TransformSystem update
+	/// </summary>
+	bool HasChanged() const { return _system->HasChanged(_node); }
 
 	/// <summary>
 	/// Gets the depth of this transform within the scene hierarchy (ie. how many parents
 	/// to the root)
 	/// </summary>
 	/// <returns></returns>
-	int GetHierarchyDepth() const { return _hierarchyDepth; }
+	int GetHierarchyDepth() const { return _system->GetDepth(_node); }
 
 private:
-	mutable bool _isLocalDirty;
-	mutable glm::mat4 _localTransform;
-	mutable glm::mat3 _normalMatrix;
+	entt::handle _gameObject;
+	TransformSystem::sptr _system;
+	TransformSystem::NodeId _node;
 
-	mutable bool _isWorldDirty;
-	mutable glm::mat4 _worldTransform;
-	mutable glm::mat3 _worldNormalMatrix;
-	
-	glm::quat _rotation;
+	// Kept alongside the quaternion so that the angles we hand back are the ones that were set
 	glm::vec3 _rotationEulerDeg;
-	glm::vec3 _position;
-	glm::vec3 _scale;
-
-	entt::entity _parent;
-	entt::handle _gameObject;
-	int _hierarchyDepth;
 
-	void _UpdateLocalTransformIfDirty() const;
+	void _SetRotation(const glm::quat& rotation);
 };
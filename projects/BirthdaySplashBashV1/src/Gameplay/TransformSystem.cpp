@@ -0,0 +1,657 @@
+#include "TransformSystem.h"
+
+#include <GLM/gtc/matrix_transform.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <GLM/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "Logging.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSFORM_SYSTEM_SSE
+#endif
+
+namespace {
+	// Depth levels with fewer nodes than this (per thread) will not be split up, since the overhead of spinning up
+	// threads would outweigh the gains
+	constexpr size_t PARALLEL_MIN_TRANSFORMS = 16 * 1024;
+
+	/*
+	 * Runs task(begin, end) over even ranges of [begin, end) across up to threadCount threads. The ranges are kept to
+	 * multiples of 4, so that only the last range has a tail that the SIMD path needs to pick up
+	 */
+	template <typename Task>
+	void ParallelFor(size_t begin, size_t end, size_t threadCount, const Task& task) {
+		const size_t count = end - begin;
+		threadCount = std::min(threadCount, std::max<size_t>(count / PARALLEL_MIN_TRANSFORMS, 1));
+		if (threadCount <= 1) {
+			task(begin, end);
+			return;
+		}
+
+		const size_t rangeSize = ((count + threadCount - 1) / threadCount + 3) & ~static_cast<size_t>(3);
+		std::vector<std::future<void>> futures;
+		futures.reserve(threadCount - 1);
+		for (size_t rangeBegin = begin + rangeSize; rangeBegin < end; rangeBegin += rangeSize) {
+			futures.push_back(std::async(std::launch::async, task, rangeBegin, std::min(rangeBegin + rangeSize, end)));
+		}
+		task(begin, std::min(begin + rangeSize, end));
+		for (auto& future : futures) {
+			future.wait();
+		}
+		for (auto& future : futures) {
+			future.get();
+		}
+	}
+
+	// Builds T * R * S, which is the same as glm::translate(p) * glm::toMat4(q) * glm::scale(s) without the two full
+	// matrix multiplies
+	void ComposeTRS(float px, float py, float pz, float qx, float qy, float qz, float qw, float sx, float sy, float sz, glm::mat4& result) {
+		const float xx = qx * qx, yy = qy * qy, zz = qz * qz;
+		const float xy = qx * qy, xz = qx * qz, yz = qy * qz;
+		const float wx = qw * qx, wy = qw * qy, wz = qw * qz;
+		result[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * sx;
+		result[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * sy;
+		result[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * sz;
+		result[3] = glm::vec4(px, py, pz, 1.0f);
+	}
+
+	#ifdef TRANSFORM_SYSTEM_SSE
+	inline __m128 Cross(__m128 a, __m128 b) {
+		const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+		return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+	#endif
+}
+
+TransformSystem::sptr TransformSystem::Get(entt::registry& registry) {
+	sptr* system = registry.try_ctx<sptr>();
+	return system != nullptr ? *system : registry.set<sptr>(Create());
+}
+
+template <typename Func>
+void TransformSystem::_ForEachArray(const Func& func) {
+	func(_positionsX); func(_positionsY); func(_positionsZ);
+	func(_rotationsX); func(_rotationsY); func(_rotationsZ); func(_rotationsW);
+	func(_scalesX); func(_scalesY); func(_scalesZ);
+	func(_parents);
+	func(_parentSlots);
+	func(_depths);
+	func(_nodes);
+	func(_entities);
+	func(_local);
+	func(_world);
+	func(_worldNormal);
+	func(_dirty);
+	func(_changed);
+}
+
+TransformSystem::NodeId TransformSystem::Add(entt::entity entity) {
+	NodeId node;
+	if (!_freeNodes.empty()) {
+		node = _freeNodes.back();
+		_freeNodes.pop_back();
+	} else {
+		node = static_cast<NodeId>(_slots.size());
+		_slots.push_back(0);
+		_firstChildren.push_back(INVALID_NODE);
+		_nextSiblings.push_back(INVALID_NODE);
+		_previousSiblings.push_back(INVALID_NODE);
+	}
+	_slots[node] = static_cast<uint32_t>(_nodes.size());
+
+	_positionsX.push_back(0.0f); _positionsY.push_back(0.0f); _positionsZ.push_back(0.0f);
+	_rotationsX.push_back(0.0f); _rotationsY.push_back(0.0f); _rotationsZ.push_back(0.0f); _rotationsW.push_back(1.0f);
+	_scalesX.push_back(1.0f); _scalesY.push_back(1.0f); _scalesZ.push_back(1.0f);
+	_parents.push_back(INVALID_NODE);
+	_parentSlots.push_back(INVALID_NODE);
+	_depths.push_back(0);
+	_nodes.push_back(node);
+	_entities.push_back(entity);
+	_local.push_back(glm::mat4(1.0f));
+	_world.push_back(glm::mat4(1.0f));
+	_worldNormal.push_back(glm::mat3(1.0f));
+	_dirty.push_back(0);
+	_changed.push_back(0);
+	_MarkDirty(_slots[node]);
+
+	// Roots need to go before everything else
+	_isOrderDirty = true;
+	return node;
+}
+
+TransformSystem::NodeId TransformSystem::Clone(NodeId source, entt::entity entity) {
+	const NodeId node = Add(entity);
+	const uint32_t from = _slots[source];
+	const uint32_t to = _slots[node];
+	_positionsX[to] = _positionsX[from]; _positionsY[to] = _positionsY[from]; _positionsZ[to] = _positionsZ[from];
+	_rotationsX[to] = _rotationsX[from]; _rotationsY[to] = _rotationsY[from]; _rotationsZ[to] = _rotationsZ[from]; _rotationsW[to] = _rotationsW[from];
+	_scalesX[to] = _scalesX[from]; _scalesY[to] = _scalesY[from]; _scalesZ[to] = _scalesZ[from];
+	_local[to] = _local[from];
+	_world[to] = _world[from];
+	_worldNormal[to] = _worldNormal[from];
+	SetParent(node, _parents[from]);
+	return node;
+}
+
+void TransformSystem::Remove(NodeId node) {
+	_Unlink(node);
+
+	// Orphaned children become roots
+	for (NodeId child = _firstChildren[node]; child != INVALID_NODE; ) {
+		const NodeId next = _nextSiblings[child];
+		_parents[_slots[child]] = INVALID_NODE;
+		_nextSiblings[child] = INVALID_NODE;
+		_previousSiblings[child] = INVALID_NODE;
+		_SetDepth(child, 0);
+		_MarkDirty(_slots[child]);
+		child = next;
+	}
+	_firstChildren[node] = INVALID_NODE;
+
+	// Move the last node into the gap, the sort will put it back where it belongs
+	const uint32_t slot = _slots[node];
+	const uint32_t last = static_cast<uint32_t>(_nodes.size() - 1);
+	_ForEachArray([slot, last](auto& values) {
+		values[slot] = values[last];
+		values.pop_back();
+	});
+	if (slot != last) {
+		_slots[_nodes[slot]] = slot;
+	}
+	_slots[node] = INVALID_NODE;
+	_freeNodes.push_back(node);
+	_isOrderDirty = true;
+}
+
+void TransformSystem::SetParent(NodeId node, NodeId parent) {
+	for (NodeId ancestor = parent; ancestor != INVALID_NODE; ancestor = _parents[_slots[ancestor]]) {
+		LOG_ASSERT(ancestor != node, "A transform cannot be parented to itself or one of its children!");
+	}
+	const uint32_t slot = _slots[node];
+	if (_parents[slot] == parent) {
+		return;
+	}
+	_Unlink(node);
+	_Link(node, parent);
+
+	// If the depth didn't change, the node is still in a valid spot and only needs to know where its new parent is
+	const int depth = _depths[slot];
+	_SetDepth(node, parent == INVALID_NODE ? 0 : _depths[_slots[parent]] + 1);
+	if (_depths[slot] != depth) {
+		_isOrderDirty = true;
+	}
+	_parentSlots[slot] = parent == INVALID_NODE ? INVALID_NODE : _slots[parent];
+	_MarkDirty(slot);
+}
+
+void TransformSystem::_Link(NodeId node, NodeId parent) {
+	_parents[_slots[node]] = parent;
+	if (parent != INVALID_NODE) {
+		const NodeId first = _firstChildren[parent];
+		_nextSiblings[node] = first;
+		if (first != INVALID_NODE) {
+			_previousSiblings[first] = node;
+		}
+		_firstChildren[parent] = node;
+	}
+}
+
+void TransformSystem::_Unlink(NodeId node) {
+	const NodeId parent = _parents[_slots[node]];
+	const NodeId previous = _previousSiblings[node];
+	const NodeId next = _nextSiblings[node];
+	if (previous != INVALID_NODE) {
+		_nextSiblings[previous] = next;
+	} else if (parent != INVALID_NODE) {
+		_firstChildren[parent] = next;
+	}
+	if (next != INVALID_NODE) {
+		_previousSiblings[next] = previous;
+	}
+	_parents[_slots[node]] = INVALID_NODE;
+	_previousSiblings[node] = INVALID_NODE;
+	_nextSiblings[node] = INVALID_NODE;
+}
+
+void TransformSystem::_MarkDirty(uint32_t slot) {
+	_dirty[slot] = 1;
+	// Most of the time the node is no shallower than what's already dirty, so we can skip the write entirely
+	const int depth = _depths[slot];
+	int dirtyDepth = _dirtyDepth.load(std::memory_order_relaxed);
+	while (depth < dirtyDepth && !_dirtyDepth.compare_exchange_weak(dirtyDepth, depth, std::memory_order_relaxed)) { }
+}
+
+void TransformSystem::_SetDepth(NodeId node, int depth) {
+	// The depths below a node are always relative to it, so if this one is right the whole subtree is
+	const uint32_t slot = _slots[node];
+	if (_depths[slot] == depth) {
+		return;
+	}
+	_depths[slot] = depth;
+	for (NodeId child = _firstChildren[node]; child != INVALID_NODE; child = _nextSiblings[child]) {
+		_SetDepth(child, depth + 1);
+	}
+}
+
+glm::vec3 TransformSystem::GetPosition(NodeId node) const {
+	const uint32_t slot = _slots[node];
+	return glm::vec3(_positionsX[slot], _positionsY[slot], _positionsZ[slot]);
+}
+
+void TransformSystem::SetPosition(NodeId node, const glm::vec3& position) {
+	const uint32_t slot = _slots[node];
+	_positionsX[slot] = position.x;
+	_positionsY[slot] = position.y;
+	_positionsZ[slot] = position.z;
+	_MarkDirty(slot);
+}
+
+glm::quat TransformSystem::GetRotation(NodeId node) const {
+	const uint32_t slot = _slots[node];
+	return glm::quat(_rotationsW[slot], _rotationsX[slot], _rotationsY[slot], _rotationsZ[slot]);
+}
+
+void TransformSystem::SetRotation(NodeId node, const glm::quat& rotation) {
+	const uint32_t slot = _slots[node];
+	_rotationsX[slot] = rotation.x;
+	_rotationsY[slot] = rotation.y;
+	_rotationsZ[slot] = rotation.z;
+	_rotationsW[slot] = rotation.w;
+	_MarkDirty(slot);
+}
+
+glm::vec3 TransformSystem::GetScale(NodeId node) const {
+	const uint32_t slot = _slots[node];
+	return glm::vec3(_scalesX[slot], _scalesY[slot], _scalesZ[slot]);
+}
+
+void TransformSystem::SetScale(NodeId node, const glm::vec3& scale) {
+	const uint32_t slot = _slots[node];
+	_scalesX[slot] = scale.x;
+	_scalesY[slot] = scale.y;
+	_scalesZ[slot] = scale.z;
+	_MarkDirty(slot);
+}
+
+const glm::mat4& TransformSystem::UpdateLocal(NodeId node) {
+	const uint32_t slot = _slots[node];
+	ComposeTRS(_positionsX[slot], _positionsY[slot], _positionsZ[slot],
+		_rotationsX[slot], _rotationsY[slot], _rotationsZ[slot], _rotationsW[slot],
+		_scalesX[slot], _scalesY[slot], _scalesZ[slot], _local[slot]);
+	return _local[slot];
+}
+
+void TransformSystem::UpdateWorld(NodeId node) {
+	const uint32_t slot = _slots[node];
+	const glm::mat4& local = UpdateLocal(node);
+	_world[slot] = _parents[slot] != INVALID_NODE ? _world[_slots[_parents[slot]]] * local : local;
+	_worldNormal[slot] = AffineNormalMatrix(_world[slot]);
+}
+
+glm::mat3 TransformSystem::AffineNormalMatrix(const glm::mat4& transform) {
+	// The rows of the inverse are the cross products of the columns divided by the determinant, so those cross products
+	// are the columns of the inverse transpose
+	const glm::vec3 x = transform[0], y = transform[1], z = transform[2];
+	const glm::vec3 yz = glm::cross(y, z);
+	const float inverseDeterminant = 1.0f / glm::dot(x, yz);
+	return glm::mat3(yz * inverseDeterminant, glm::cross(z, x) * inverseDeterminant, glm::cross(x, y) * inverseDeterminant);
+}
+
+void TransformSystem::Update(size_t threadCount) {
+	if (!_changedEntities.empty()) {
+		std::fill(_changed.begin(), _changed.end(), static_cast<uint8_t>(0));
+		_changedEntities.clear();
+	}
+	if (_dirtyDepth == NO_DIRTY_NODES) {
+		return;
+	}
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	if (_isOrderDirty) {
+		_SortByDepth();
+	}
+
+	// Every node in a level only depends on the levels above it, so each level can be split up freely. Removing nodes
+	// can leave the dirty depth below the deepest level, in which case there's nothing left to do
+	const size_t firstLevel = std::min(static_cast<size_t>(_dirtyDepth.load()), _levels.size() - 1);
+	for (size_t level = firstLevel; level + 1 < _levels.size(); level++) {
+		ParallelFor(_levels[level], _levels[level + 1], threadCount, [this](size_t begin, size_t end) {
+			_UpdateRange(static_cast<uint32_t>(begin), static_cast<uint32_t>(end));
+		});
+	}
+
+	for (uint32_t slot = _levels[firstLevel]; slot < _nodes.size(); slot++) {
+		if (_changed[slot]) {
+			_changedEntities.push_back(_entities[slot]);
+		}
+	}
+	_dirtyDepth = NO_DIRTY_NODES;
+}
+
+void TransformSystem::_SortByDepth() {
+	// Counting sort on the depth, which keeps the nodes within each level in the same order as before
+	int maxDepth = 0;
+	for (int depth : _depths) {
+		maxDepth = std::max(maxDepth, depth);
+	}
+	_levels.assign(maxDepth + 2, 0);
+	for (int depth : _depths) {
+		_levels[depth + 1]++;
+	}
+	for (size_t ix = 1; ix < _levels.size(); ix++) {
+		_levels[ix] += _levels[ix - 1];
+	}
+
+	std::vector<uint32_t> next(_levels.begin(), _levels.end() - 1);
+	std::vector<uint32_t> order(_nodes.size());
+	for (uint32_t slot = 0; slot < _nodes.size(); slot++) {
+		order[next[_depths[slot]]++] = slot;
+	}
+	_ForEachArray([&order](auto& values) {
+		std::remove_reference_t<decltype(values)> sorted(values.size());
+		for (size_t ix = 0; ix < order.size(); ix++) {
+			sorted[ix] = values[order[ix]];
+		}
+		values.swap(sorted);
+	});
+
+	for (uint32_t slot = 0; slot < _nodes.size(); slot++) {
+		_slots[_nodes[slot]] = slot;
+	}
+	for (uint32_t slot = 0; slot < _nodes.size(); slot++) {
+		_parentSlots[slot] = _parents[slot] != INVALID_NODE ? _slots[_parents[slot]] : INVALID_NODE;
+	}
+	_isOrderDirty = false;
+}
+
+void TransformSystem::_UpdateRange(uint32_t begin, uint32_t end) {
+	// A node needs a new world matrix if it was changed, or if its parent got a new one. Parents are always in an
+	// earlier level, so their flags are already final
+	for (uint32_t ix = begin; ix < end; ix++) {
+		const uint32_t parent = _parentSlots[ix];
+		_changed[ix] = _dirty[ix] | (parent != INVALID_NODE ? _changed[parent] : 0);
+	}
+
+	// Only the dirty nodes need new local matrices, the rest still have the one from their last update
+	uint32_t ix = begin;
+
+	#ifdef TRANSFORM_SYSTEM_SSE
+	// Compose the local matrices for four nodes at a time, with one node in each lane, then transpose each group of
+	// four rows into the columns of the four matrices
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	for (; ix + 4 <= end; ix += 4) {
+		if ((_dirty[ix] | _dirty[ix + 1] | _dirty[ix + 2] | _dirty[ix + 3]) == 0) {
+			continue;
+		}
+		const __m128 x = _mm_loadu_ps(&_rotationsX[ix]);
+		const __m128 y = _mm_loadu_ps(&_rotationsY[ix]);
+		const __m128 z = _mm_loadu_ps(&_rotationsZ[ix]);
+		const __m128 w = _mm_loadu_ps(&_rotationsW[ix]);
+		const __m128 sx = _mm_loadu_ps(&_scalesX[ix]);
+		const __m128 sy = _mm_loadu_ps(&_scalesY[ix]);
+		const __m128 sz = _mm_loadu_ps(&_scalesZ[ix]);
+		const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+		__m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		__m128 c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		__m128 c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		__m128 c0w = _mm_setzero_ps();
+		__m128 c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		__m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		__m128 c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		__m128 c1w = _mm_setzero_ps();
+		__m128 c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		__m128 c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		__m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		__m128 c2w = _mm_setzero_ps();
+		__m128 c3x = _mm_loadu_ps(&_positionsX[ix]);
+		__m128 c3y = _mm_loadu_ps(&_positionsY[ix]);
+		__m128 c3z = _mm_loadu_ps(&_positionsZ[ix]);
+		__m128 c3w = one;
+		_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+		_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+		_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+		_MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+
+		float* local = &_local[ix][0][0];
+		_mm_storeu_ps(local +  0, c0x); _mm_storeu_ps(local +  4, c1x); _mm_storeu_ps(local +  8, c2x); _mm_storeu_ps(local + 12, c3x);
+		_mm_storeu_ps(local + 16, c0y); _mm_storeu_ps(local + 20, c1y); _mm_storeu_ps(local + 24, c2y); _mm_storeu_ps(local + 28, c3y);
+		_mm_storeu_ps(local + 32, c0z); _mm_storeu_ps(local + 36, c1z); _mm_storeu_ps(local + 40, c2z); _mm_storeu_ps(local + 44, c3z);
+		_mm_storeu_ps(local + 48, c0w); _mm_storeu_ps(local + 52, c1w); _mm_storeu_ps(local + 56, c2w); _mm_storeu_ps(local + 60, c3w);
+	}
+	#endif
+
+	for (; ix < end; ix++) {
+		if (!_dirty[ix]) {
+			continue;
+		}
+		ComposeTRS(_positionsX[ix], _positionsY[ix], _positionsZ[ix], _rotationsX[ix], _rotationsY[ix], _rotationsZ[ix], _rotationsW[ix],
+			_scalesX[ix], _scalesY[ix], _scalesZ[ix], _local[ix]);
+	}
+
+	for (ix = begin; ix < end; ix++) {
+		if (!_changed[ix]) {
+			continue;
+		}
+		_dirty[ix] = 0;
+		const uint32_t parent = _parentSlots[ix];
+
+		#ifdef TRANSFORM_SYSTEM_SSE
+		// Same multiply and add order as glm's mat4 * mat4
+		const float* local = &_local[ix][0][0];
+		float* world = &_world[ix][0][0];
+		if (parent != INVALID_NODE) {
+			const float* parentWorld = &_world[parent][0][0];
+			const __m128 p0 = _mm_loadu_ps(parentWorld + 0);
+			const __m128 p1 = _mm_loadu_ps(parentWorld + 4);
+			const __m128 p2 = _mm_loadu_ps(parentWorld + 8);
+			const __m128 p3 = _mm_loadu_ps(parentWorld + 12);
+			for (int column = 0; column < 16; column += 4) {
+				const __m128 result = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(local[column + 0])), _mm_mul_ps(p1, _mm_set1_ps(local[column + 1]))),
+					_mm_add_ps(_mm_mul_ps(p2, _mm_set1_ps(local[column + 2])), _mm_mul_ps(p3, _mm_set1_ps(local[column + 3]))));
+				_mm_storeu_ps(world + column, result);
+			}
+		} else {
+			memcpy(world, local, sizeof(glm::mat4));
+		}
+
+		// See AffineNormalMatrix, the w components of the first three columns are 0 so they drop out of the cross products
+		const __m128 a0 = _mm_loadu_ps(world + 0);
+		const __m128 a1 = _mm_loadu_ps(world + 4);
+		const __m128 a2 = _mm_loadu_ps(world + 8);
+		const __m128 n0 = Cross(a1, a2);
+		const __m128 dot = _mm_mul_ps(a0, n0);
+		const __m128 determinant = _mm_add_ss(_mm_add_ss(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(dot, dot));
+		const __m128 inverseDeterminant = _mm_div_ps(one, _mm_shuffle_ps(determinant, determinant, _MM_SHUFFLE(0, 0, 0, 0)));
+
+		// Each store spills one float into the next column, which the next store then overwrites. The last column can't
+		// spill past the end of the matrix, so it goes through a temporary
+		float* normal = &_worldNormal[ix][0][0];
+		_mm_storeu_ps(normal + 0, _mm_mul_ps(n0, inverseDeterminant));
+		_mm_storeu_ps(normal + 3, _mm_mul_ps(Cross(a2, a0), inverseDeterminant));
+		float lastColumn[4];
+		_mm_storeu_ps(lastColumn, _mm_mul_ps(Cross(a0, a1), inverseDeterminant));
+		memcpy(normal + 6, lastColumn, sizeof(float) * 3);
+		#else
+		_world[ix] = parent != INVALID_NODE ? _world[parent] * _local[ix] : _local[ix];
+		_worldNormal[ix] = AffineNormalMatrix(_world[ix]);
+		#endif
+	}
+}
+
+namespace {
+	// The layout and update that Transform used before it was backed by the TransformSystem, for comparison
+	struct LegacyTransform {
+		glm::mat4 LocalTransform;
+		glm::mat3 NormalMatrix;
+		glm::mat4 WorldTransform;
+		glm::mat3 WorldNormalMatrix;
+		glm::quat Rotation;
+		glm::vec3 RotationEulerDeg;
+		glm::vec3 Position;
+		glm::vec3 Scale;
+		entt::entity Parent;
+		entt::registry* Registry;
+		entt::entity Entity;
+		int HierarchyDepth;
+		bool IsLocalDirty;
+	};
+
+	void UpdateLegacy(std::vector<LegacyTransform>& transforms) {
+		const glm::mat4 identity = glm::mat4(1.0f);
+		for (LegacyTransform& t : transforms) {
+			if (t.IsLocalDirty) {
+				t.LocalTransform = glm::translate(identity, t.Position) * glm::toMat4(t.Rotation) * glm::scale(identity, t.Scale);
+				t.NormalMatrix = glm::mat3(glm::transpose(glm::inverse(t.LocalTransform)));
+				t.IsLocalDirty = false;
+			}
+			if (t.Parent != entt::null) {
+				t.WorldTransform = transforms[static_cast<size_t>(t.Parent)].WorldTransform * t.LocalTransform;
+				t.WorldNormalMatrix = glm::mat3(glm::transpose(glm::inverse(t.WorldTransform)));
+			} else {
+				t.WorldTransform = t.LocalTransform;
+				t.WorldNormalMatrix = t.NormalMatrix;
+			}
+		}
+	}
+
+	template <typename Func>
+	double TimeUpdate(int iterations, const Func& update) {
+		using Clock = std::chrono::high_resolution_clock;
+		double milliseconds = 0.0;
+		for (int ix = 0; ix < iterations; ix++) {
+			const auto start = Clock::now();
+			update();
+			milliseconds += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+		return milliseconds / iterations;
+	}
+}
+
+void TransformSystem::Benchmark(size_t count, int iterations)
+{
+	// A fixed forest of binary trees, with a thousand roots scattered around and every other node a child of an
+	// earlier node. Parents always come first, so the legacy path can update them in order
+	const size_t rootCount = std::min<size_t>(1000, count);
+	TransformSystem system;
+	std::vector<LegacyTransform> legacy(count);
+	std::vector<NodeId> nodes(count);
+	for (size_t ix = 0; ix < count; ix++) {
+		const float t = static_cast<float>(ix);
+		LegacyTransform& transform = legacy[ix];
+		transform.Position = ix < rootCount ? glm::vec3(fmodf(t, 100.0f), fmodf(t * 0.37f, 50.0f), t * 0.01f) : glm::vec3(1.0f, 0.5f, fmodf(t, 3.0f));
+		transform.RotationEulerDeg = glm::vec3(fmodf(t * 7.0f, 360.0f), fmodf(t * 13.0f, 360.0f), fmodf(t * 29.0f, 360.0f));
+		transform.Rotation = glm::quat(glm::radians(transform.RotationEulerDeg));
+		transform.Scale = glm::vec3(0.9f + fmodf(t, 3.0f) * 0.1f);
+		transform.Parent = ix < rootCount ? entt::null : static_cast<entt::entity>((ix - rootCount) / 2);
+		transform.Entity = static_cast<entt::entity>(ix);
+		transform.IsLocalDirty = true;
+	}
+
+	LOG_INFO("TransformSystem benchmark ({} transforms in {} hierarchies, {} iterations)", count, rootCount, iterations);
+
+	// The first update sorts the nodes by depth, which only happens when the hierarchy changes
+	const double buildTime = TimeUpdate(1, [&]() {
+		for (size_t ix = 0; ix < count; ix++) {
+			const LegacyTransform& transform = legacy[ix];
+			nodes[ix] = system.Add(transform.Entity);
+			system.SetPosition(nodes[ix], transform.Position);
+			system.SetRotation(nodes[ix], transform.Rotation);
+			system.SetScale(nodes[ix], transform.Scale);
+			if (transform.Parent != entt::null) {
+				system.SetParent(nodes[ix], nodes[static_cast<size_t>(transform.Parent)]);
+			}
+		}
+	});
+	const double firstUpdateTime = TimeUpdate(1, [&]() { system.Update(1); });
+	UpdateLegacy(legacy);
+	LOG_INFO("\t{:<18}: {:.2f} ms, then {:.2f} ms for the first update", "Building", buildTime, firstUpdateTime);
+
+	// Every frame, each moving node swaps between its starting position and a nudged one. The moving roots drag their
+	// whole hierarchies along with them
+	std::vector<glm::vec3> positions(count);
+	for (size_t ix = 0; ix < count; ix++) {
+		positions[ix] = legacy[ix].Position;
+	}
+	const glm::vec3 nudge = glm::vec3(0.25f, 0.0f, -0.5f);
+	struct Scenario {
+		const char* Name;
+		size_t Stride;
+	};
+	const Scenario scenarios[] = { { "Everything moving", 1 }, { "1% moving", 100 }, { "Nothing moving", 0 } };
+	float maxError = 0.0f;
+	for (const Scenario& scenario : scenarios) {
+		int frame = 0;
+		const double legacyTime = TimeUpdate(iterations, [&]() {
+			for (size_t ix = 0; scenario.Stride > 0 && ix < count; ix += scenario.Stride) {
+				legacy[ix].Position = positions[ix] + (frame & 1 ? nudge : glm::vec3(0.0f));
+				legacy[ix].IsLocalDirty = true;
+			}
+			UpdateLegacy(legacy);
+			frame++;
+		});
+		double systemTimes[2];
+		for (size_t threads : { 1, 0 }) {
+			frame = 0;
+			systemTimes[threads == 1 ? 0 : 1] = TimeUpdate(iterations, [&]() {
+				for (size_t ix = 0; scenario.Stride > 0 && ix < count; ix += scenario.Stride) {
+					system.SetPosition(nodes[ix], positions[ix] + (frame & 1 ? nudge : glm::vec3(0.0f)));
+				}
+				system.Update(threads);
+				frame++;
+			});
+		}
+		LOG_INFO("\t{:<18}: {:.2f} ms per component, {:.2f} ms SoA on 1 thread, {:.2f} ms SoA on {} threads ({} changed)", scenario.Name,
+			legacyTime, systemTimes[0], systemTimes[1], std::max(std::thread::hardware_concurrency(), 1u), system.GetChanged().size());
+
+		for (size_t ix = 0; ix < count; ix++) {
+			const glm::mat4& world = system.GetWorld(nodes[ix]);
+			const glm::mat3& normal = system.GetWorldNormal(nodes[ix]);
+			for (int column = 0; column < 4; column++) {
+				for (int row = 0; row < 4; row++) {
+					const float expected = legacy[ix].WorldTransform[column][row];
+					maxError = std::max(maxError, fabsf(world[column][row] - expected) / std::max(1.0f, fabsf(expected)));
+				}
+			}
+			for (int column = 0; column < 3; column++) {
+				for (int row = 0; row < 3; row++) {
+					const float expected = legacy[ix].WorldNormalMatrix[column][row];
+					maxError = std::max(maxError, fabsf(normal[column][row] - expected) / std::max(1.0f, fabsf(expected)));
+				}
+			}
+		}
+	}
+	if (maxError > 1e-4f) {
+		LOG_ERROR("\tSoA world matrices do not match the per component world matrices (relative error of {})", maxError);
+	}
+
+	// Moving whole hierarchies around only touches the moved nodes, and the nodes only get sorted once afterwards
+	const NodeId root = system.Add(entt::null);
+	const double parentTime = TimeUpdate(1, [&]() {
+		for (size_t ix = 0; ix < rootCount; ix++) {
+			system.SetParent(nodes[ix], root);
+		}
+	});
+	const double unparentTime = TimeUpdate(1, [&]() {
+		for (size_t ix = 0; ix < rootCount; ix++) {
+			system.SetParent(nodes[ix], INVALID_NODE);
+		}
+	});
+	const double sortTime = TimeUpdate(1, [&]() { system.Update(1); });
+	LOG_INFO("\t{:<18}: {:.2f} ms to parent all {} hierarchies to one node, {:.2f} ms to move them back, {:.2f} ms to re-sort and update",
+		"Re-parenting", parentTime, rootCount, unparentTime, sortTime);
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <entt.hpp>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Utilities/Macros.h"
+
+/// <summary>
+/// Stores the transforms for a single registry as structure of arrays, so that the world matrices for the whole scene
+/// can be calculated in one linear pass instead of one component at a time.
+///
+/// Nodes are kept sorted by their depth in the hierarchy, so every parent comes before its children and each depth level
+/// is a contiguous range. Update composes the local TRS matrices four nodes at a time, multiplies them by their parent's
+/// world matrix, and splits large levels across worker threads, since the nodes within a level never depend on each other.
+///
+/// Only nodes that have changed since the last update get recalculated. The setters mark a node as dirty, and its
+/// descendants are picked up as the update walks down the levels, starting at the shallowest dirty node. A scene where
+/// nothing moved costs next to nothing to update.
+///
+/// The setters for different nodes can be called from multiple threads at once, but anything that changes the
+/// hierarchy (adding, removing or re-parenting nodes) and Update must only happen on one thread at a time.
+///
+/// The Transform component is a thin facade over this, game code should keep using Transform
+/// </summary>
+class TransformSystem final
+{
+	SMART_MEMORY_MANAGED(TransformSystem)
+
+public:
+	typedef uint32_t NodeId;
+	static constexpr NodeId INVALID_NODE = ~0u;
+
+	TransformSystem() = default;
+	~TransformSystem() = default;
+
+	/// <summary>
+	/// Gets the transform system for a registry, creating it if it does not exist yet. The system is shared with every
+	/// Transform in the registry, so that it outlives them when the registry is destroyed
+	/// </summary>
+	static TransformSystem::sptr Get(entt::registry& registry);
+
+	/// <summary>
+	/// Adds a new root node with an identity transform
+	/// </summary>
+	/// <param name="entity">The entity that the node belongs to</param>
+	/// <returns>The ID of the new node, which stays the same until the node is removed</returns>
+	NodeId Add(entt::entity entity);
+	/// <summary>
+	/// Adds a new node with the same local transform and parent as another node
+	/// </summary>
+	NodeId Clone(NodeId source, entt::entity entity);
+	/// <summary>
+	/// Removes a node, any children it had become root nodes
+	/// </summary>
+	void Remove(NodeId node);
+
+	/// <summary>
+	/// Sets the parent of a node, and updates the hierarchy depth of the node and everything below it. This only touches
+	/// the moved subtree, the nodes get put back in depth order at the start of the next update
+	/// </summary>
+	/// <param name="node">The node to move</param>
+	/// <param name="parent">The new parent node, or INVALID_NODE to make the node a root</param>
+	void SetParent(NodeId node, NodeId parent);
+	NodeId GetParent(NodeId node) const { return _parents[_slots[node]]; }
+	int GetDepth(NodeId node) const { return _depths[_slots[node]]; }
+	entt::entity GetEntity(NodeId node) const { return _entities[_slots[node]]; }
+	size_t Size() const { return _nodes.size(); }
+
+	glm::vec3 GetPosition(NodeId node) const;
+	void SetPosition(NodeId node, const glm::vec3& position);
+	glm::quat GetRotation(NodeId node) const;
+	void SetRotation(NodeId node, const glm::quat& rotation);
+	glm::vec3 GetScale(NodeId node) const;
+	void SetScale(NodeId node, const glm::vec3& scale);
+
+	/// <summary>
+	/// Re-calculates and returns the local TRS matrix of a single node
+	/// </summary>
+	const glm::mat4& UpdateLocal(NodeId node);
+	/// <summary>
+	/// Re-calculates the local and world matrices of a single node from the current world matrix of its parent
+	/// </summary>
+	void UpdateWorld(NodeId node);
+
+	/// <summary>
+	/// Gets the world matrix of a node as of the last update. The reference is only valid until the next update
+	/// </summary>
+	const glm::mat4& GetWorld(NodeId node) const { return _world[_slots[node]]; }
+	/// <summary>
+	/// Gets the matrix for transforming the node's normals into world space as of the last update. The reference is only
+	/// valid until the next update
+	/// </summary>
+	const glm::mat3& GetWorldNormal(NodeId node) const { return _worldNormal[_slots[node]]; }
+
+	/// <summary>
+	/// Calculates the world matrices for every node that was changed since the last update, along with everything below
+	/// them in the hierarchy
+	/// </summary>
+	/// <param name="threadCount">The maximum number of threads to split each depth level across, or 0 to use every hardware thread</param>
+	void Update(size_t threadCount = 0);
+
+	/// <summary>
+	/// Gets the entities whose world matrices changed during the last update, in depth order. Anything not in here can be
+	/// treated as static for the frame (ie. culling results, collision shapes or uploaded matrices can be re-used)
+	/// </summary>
+	const std::vector<entt::entity>& GetChanged() const { return _changedEntities; }
+	/// <summary>
+	/// Returns true if the world matrix of a node changed during the last update
+	/// </summary>
+	bool HasChanged(NodeId node) const { return _changed[_slots[node]] != 0; }
+
+	/// <summary>
+	/// Calculates the matrix for transforming normals by an affine transformation (the inverse transpose of its upper 3x3).
+	/// Inverting the 3x3 through its cofactors is much cheaper than calling glm::inverse on the whole 4x4, and the
+	/// translation never affects the normals anyway
+	/// </summary>
+	static glm::mat3 AffineNormalMatrix(const glm::mat4& transform);
+
+	/// <summary>
+	/// Times updating a hierarchy of transforms through the system against the per component path that Transform used to
+	/// take, and logs an error if the two ever disagree
+	/// </summary>
+	/// <param name="count">The number of transforms in the hierarchy</param>
+	/// <param name="iterations">The number of times to run each test</param>
+	static void Benchmark(size_t count = 100000, int iterations = 10);
+
+private:
+	// Everything below is indexed by slot, which is the node's position in depth order
+	std::vector<float> _positionsX, _positionsY, _positionsZ;
+	std::vector<float> _rotationsX, _rotationsY, _rotationsZ, _rotationsW;
+	std::vector<float> _scalesX, _scalesY, _scalesZ;
+	std::vector<NodeId> _parents;
+	std::vector<uint32_t> _parentSlots;
+	std::vector<int> _depths;
+	std::vector<NodeId> _nodes;
+	std::vector<entt::entity> _entities;
+	std::vector<glm::mat4> _local;
+	std::vector<glm::mat4> _world;
+	std::vector<glm::mat3> _worldNormal;
+	// Set when a node's local transform or parent changes, and cleared when the update recalculates it
+	std::vector<uint8_t> _dirty;
+	// Set by the update for every node whose world matrix it recalculated
+	std::vector<uint8_t> _changed;
+
+	// Maps node IDs to slots, and keeps a list of IDs that can be re-used
+	std::vector<uint32_t> _slots;
+	std::vector<NodeId> _freeNodes;
+
+	// The hierarchy links, indexed by node ID so that sorting doesn't need to touch them. The children of each node
+	// form a doubly linked list, so a node can be re-parented or removed without searching for it or its children
+	std::vector<NodeId> _firstChildren;
+	std::vector<NodeId> _nextSiblings;
+	std::vector<NodeId> _previousSiblings;
+
+	// The first slot of each depth level, followed by the total number of nodes
+	std::vector<uint32_t> _levels;
+	// Whether the nodes are out of depth order since they were last sorted. Any number of changes to the hierarchy
+	// between updates only cost one sort, at the start of the next update
+	bool _isOrderDirty = false;
+	// The depth of the shallowest dirty node, the update can skip every level above it. This is atomic so that
+	// behaviours running in parallel (see SystemScheduler) can move different transforms at the same time
+	static constexpr int NO_DIRTY_NODES = INT_MAX;
+	std::atomic<int> _dirtyDepth { NO_DIRTY_NODES };
+	std::vector<entt::entity> _changedEntities;
+
+	// Calls func with every per slot array, so that they can all be re-ordered together
+	template <typename Func>
+	void _ForEachArray(const Func& func);
+
+	void _MarkDirty(uint32_t slot);
+	void _Link(NodeId node, NodeId parent);
+	void _Unlink(NodeId node);
+	void _SetDepth(NodeId node, int depth);
+	void _SortByDepth();
+	void _UpdateRange(uint32_t begin, uint32_t end);
+};
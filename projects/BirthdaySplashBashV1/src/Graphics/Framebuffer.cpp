@@ -1,4 +1,5 @@
 #include "Framebuffer.h"
+#include "VertexArrayObject.h"
 
 GLuint Framebuffer::_fullscreenQuadVBO = 0;
 GLuint Framebuffer::_fullscreenQuadVAO = 0;
@@ -282,7 +283,7 @@ void Framebuffer::InitFullscreenQuad()
 	//Generates vertex array
 	glGenVertexArrays(1, &_fullscreenQuadVAO);
 	//Binds VAO
-	glBindVertexArray(_fullscreenQuadVAO);
+	VertexArrayObject::BindHandle(_fullscreenQuadVAO);
 
 	//Enables 2 vertex attrib array slots
 	glEnableVertexAttribArray(0); //Vertices
@@ -305,14 +306,15 @@ void Framebuffer::InitFullscreenQuad()
 #pragma warning(pop)
 
 	glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-	glBindVertexArray(GL_NONE);
+	VertexArrayObject::UnBind();
 }
 
 void Framebuffer::DrawFullscreenQuad()
 {
-	glBindVertexArray(_fullscreenQuadVAO);
+	VertexArrayObject::BindHandle(_fullscreenQuadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glBindVertexArray(GL_NONE);
+	VertexArrayObject::RecordDrawCall();
+	VertexArrayObject::UnBind();
 }
 
 
@@ -0,0 +1,182 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+#include "Logging.h"
+
+ArenaMesh::ArenaMesh(GeometryArena* arena) :
+	_arena(arena),
+	_baseVertex(0),
+	_vertexCount(0),
+	_firstIndex(0),
+	_indexCount(0)
+{ }
+
+ArenaMesh::~ArenaMesh() {
+	if (_arena != nullptr) {
+		_arena->_Release(this, true);
+	}
+}
+
+GeometryArena::GeometryArena(const std::vector<BufferAttribute>& layout, size_t vertexSize, size_t vertexCapacity, size_t indexCapacity) :
+	_layout(layout),
+	_vertexSize(vertexSize),
+	_vertices(nullptr),
+	_indices(nullptr),
+	_vao(nullptr)
+{
+	_Rebuild(vertexCapacity, indexCapacity, false);
+}
+
+GeometryArena::~GeometryArena() {
+	// Any meshes that outlive us become empty
+	for (ArenaMesh* mesh : _meshes) {
+		mesh->_arena = nullptr;
+	}
+}
+
+ArenaMesh::sptr GeometryArena::CreateMesh() {
+	ArenaMesh::sptr result = std::make_shared<ArenaMesh>(this);
+	_meshes.push_back(result.get());
+	return result;
+}
+
+ArenaMesh::sptr GeometryArena::Allocate(const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+	ArenaMesh::sptr result = CreateMesh();
+	SetData(result, vertices, vertexCount, indices, indexCount);
+	return result;
+}
+
+void GeometryArena::SetData(const ArenaMesh::sptr& mesh, const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+	LOG_ASSERT(mesh->_arena == this, "Mesh does not belong to this arena");
+	_Release(mesh.get(), false);
+	if (vertexCount == 0 || indexCount == 0) {
+		return;
+	}
+
+	// Note that allocating the indices may compact the arena, which moves the vertices we've just allocated
+	mesh->_baseVertex = _AllocateRange(true, vertexCount);
+	mesh->_vertexCount = vertexCount;
+	mesh->_firstIndex = _AllocateRange(false, indexCount);
+	mesh->_indexCount = indexCount;
+
+	_vertices->UpdateData(vertices, mesh->_baseVertex * _vertexSize, vertexCount * _vertexSize);
+	_indices->UpdateData(indices, mesh->_firstIndex * sizeof(uint32_t), indexCount * sizeof(uint32_t));
+}
+
+void GeometryArena::Defragment() {
+	_Rebuild(_vertexRanges.GetCapacity(), _indexRanges.GetCapacity(), true);
+}
+
+void GeometryArena::Render(const ArenaMesh& mesh) const {
+	LOG_ASSERT(mesh._arena == this, "Mesh does not belong to this arena");
+	if (!mesh.IsLoaded()) {
+		return;
+	}
+	_vao->Bind();
+	glDrawElementsBaseVertex(GL_TRIANGLES, mesh.GetIndexCount(), GL_UNSIGNED_INT,
+		(void*)(mesh._firstIndex * sizeof(uint32_t)), mesh.GetBaseVertex());
+	VertexArrayObject::RecordDrawCall();
+	VertexArrayObject::UnBind();
+}
+
+void GeometryArena::_Release(ArenaMesh* mesh, bool destroyed) {
+	if (mesh->_vertexCount > 0) {
+		_vertexRanges.Free(mesh->_baseVertex, mesh->_vertexCount);
+	}
+	if (mesh->_indexCount > 0) {
+		_indexRanges.Free(mesh->_firstIndex, mesh->_indexCount);
+	}
+	mesh->_baseVertex = mesh->_vertexCount = 0;
+	mesh->_firstIndex = mesh->_indexCount = 0;
+
+	if (destroyed) {
+		auto it = std::find(_meshes.begin(), _meshes.end(), mesh);
+		if (it != _meshes.end()) {
+			*it = _meshes.back();
+			_meshes.pop_back();
+		}
+	}
+}
+
+size_t GeometryArena::_AllocateRange(bool vertices, size_t count) {
+	RangeAllocator& ranges = vertices ? _vertexRanges : _indexRanges;
+	size_t offset = ranges.Allocate(count);
+	if (offset != RangeAllocator::INVALID_OFFSET) {
+		return offset;
+	}
+
+	// If there's enough room in total, it's just scattered between the meshes, so we can pack them together instead of growing
+	if (ranges.GetCapacity() - ranges.GetUsed() >= count) {
+		Defragment();
+	}
+	// Otherwise we double the buffer (or more for a really big mesh), so that a series of allocations only needs to grow a few times
+	else {
+		const size_t capacity = std::max(ranges.GetCapacity() * 2, ranges.GetCapacity() + count);
+		_Rebuild(vertices ? capacity : _vertexRanges.GetCapacity(), vertices ? _indexRanges.GetCapacity() : capacity, false);
+	}
+
+	offset = ranges.Allocate(count);
+	LOG_ASSERT(offset != RangeAllocator::INVALID_OFFSET, "Failed to make room in the geometry arena");
+	return offset;
+}
+
+void GeometryArena::_Rebuild(size_t vertexCapacity, size_t indexCapacity, bool compact) {
+	VertexBuffer::sptr vertices = VertexBuffer::Create();
+	vertices->LoadData(nullptr, _vertexSize, vertexCapacity);
+	IndexBuffer::sptr indices = IndexBuffer::Create();
+	indices->LoadData(nullptr, sizeof(uint32_t), indexCapacity, GL_UNSIGNED_INT);
+
+	if (compact) {
+		// Move the meshes down to the start of the new buffers, keeping them in the same order so that meshes that were
+		// loaded together stay together
+		std::vector<ArenaMesh*> order;
+		order.reserve(_meshes.size());
+
+		size_t vertexOffset = 0;
+		for (ArenaMesh* mesh : _meshes) {
+			if (mesh->_vertexCount > 0) order.push_back(mesh);
+		}
+		std::sort(order.begin(), order.end(), [](const ArenaMesh* l, const ArenaMesh* r) { return l->_baseVertex < r->_baseVertex; });
+		for (ArenaMesh* mesh : order) {
+			glCopyNamedBufferSubData(_vertices->GetHandle(), vertices->GetHandle(),
+				mesh->_baseVertex * _vertexSize, vertexOffset * _vertexSize, mesh->_vertexCount * _vertexSize);
+			mesh->_baseVertex = vertexOffset;
+			vertexOffset += mesh->_vertexCount;
+		}
+
+		size_t indexOffset = 0;
+		order.clear();
+		for (ArenaMesh* mesh : _meshes) {
+			if (mesh->_indexCount > 0) order.push_back(mesh);
+		}
+		std::sort(order.begin(), order.end(), [](const ArenaMesh* l, const ArenaMesh* r) { return l->_firstIndex < r->_firstIndex; });
+		for (ArenaMesh* mesh : order) {
+			glCopyNamedBufferSubData(_indices->GetHandle(), indices->GetHandle(),
+				mesh->_firstIndex * sizeof(uint32_t), indexOffset * sizeof(uint32_t), mesh->_indexCount * sizeof(uint32_t));
+			mesh->_firstIndex = indexOffset;
+			indexOffset += mesh->_indexCount;
+		}
+
+		_vertexRanges.Reset(vertexCapacity, vertexOffset);
+		_indexRanges.Reset(indexCapacity, indexOffset);
+	} else {
+		// Growing keeps every mesh where it is, so we can copy the old buffers over as a whole
+		if (_vertices != nullptr && _vertexRanges.GetCapacity() > 0) {
+			glCopyNamedBufferSubData(_vertices->GetHandle(), vertices->GetHandle(), 0, 0, _vertexRanges.GetCapacity() * _vertexSize);
+		}
+		if (_indices != nullptr && _indexRanges.GetCapacity() > 0) {
+			glCopyNamedBufferSubData(_indices->GetHandle(), indices->GetHandle(), 0, 0, _indexRanges.GetCapacity() * sizeof(uint32_t));
+		}
+		_vertexRanges.Grow(vertexCapacity);
+		_indexRanges.Grow(indexCapacity);
+	}
+
+	_vertices = vertices;
+	_indices = indices;
+	_vao = VertexArrayObject::Create();
+	_vao->AddVertexBuffer(_vertices, _layout);
+	_vao->SetIndexBuffer(_indices);
+
+	LOG_TRACE("Geometry arena {}: {}/{} vertices, {}/{} indices, {} meshes", compact ? "compacted" : "resized",
+		_vertexRanges.GetUsed(), vertexCapacity, _indexRanges.GetUsed(), indexCapacity, _meshes.size());
+}
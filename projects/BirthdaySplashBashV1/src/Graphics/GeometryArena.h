@@ -0,0 +1,198 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "VertexArrayObject.h"
+#include "Utilities/RangeAllocator.h"
+
+class GeometryArena;
+
+/// <summary>
+/// A mesh that lives in a GeometryArena, as a range of the arena's vertices and a range of its indices. The indices
+/// are relative to the first vertex of the mesh. The ranges are returned to the arena when the mesh is destroyed
+/// </summary>
+class ArenaMesh final
+{
+public:
+	typedef std::shared_ptr<ArenaMesh> sptr;
+
+	// We'll disallow moving and copying, since the arena keeps track of its meshes by address
+	ArenaMesh(const ArenaMesh& other) = delete;
+	ArenaMesh(ArenaMesh&& other) = delete;
+	ArenaMesh& operator=(const ArenaMesh& other) = delete;
+	ArenaMesh& operator=(ArenaMesh&& other) = delete;
+
+	/// <summary>
+	/// Creates an empty mesh, use GeometryArena::CreateMesh or GeometryArena::Allocate instead
+	/// </summary>
+	ArenaMesh(GeometryArena* arena);
+	~ArenaMesh();
+
+	/// <summary>
+	/// Returns the arena that this mesh lives in, or nullptr if the arena has been destroyed
+	/// </summary>
+	GeometryArena* GetArena() const { return _arena; }
+	/// <summary>
+	/// Returns true if the mesh has any geometry to draw, meshes that are still loading are empty
+	/// </summary>
+	bool IsLoaded() const { return _indexCount > 0 && _arena != nullptr; }
+
+	/// <summary>
+	/// Returns the index of the mesh's first vertex within the arena's vertex buffer
+	/// </summary>
+	uint32_t GetBaseVertex() const { return static_cast<uint32_t>(_baseVertex); }
+	/// <summary>
+	/// Returns the number of vertices in the mesh
+	/// </summary>
+	uint32_t GetVertexCount() const { return static_cast<uint32_t>(_vertexCount); }
+	/// <summary>
+	/// Returns the index of the mesh's first index within the arena's index buffer
+	/// </summary>
+	uint32_t GetFirstIndex() const { return static_cast<uint32_t>(_firstIndex); }
+	/// <summary>
+	/// Returns the number of indices in the mesh
+	/// </summary>
+	uint32_t GetIndexCount() const { return static_cast<uint32_t>(_indexCount); }
+
+private:
+	friend class GeometryArena;
+
+	GeometryArena* _arena;
+	size_t _baseVertex;
+	size_t _vertexCount;
+	size_t _firstIndex;
+	size_t _indexCount;
+};
+
+/// <summary>
+/// Stores many meshes that share a vertex layout in a single large vertex buffer and a single 32 bit index buffer,
+/// so they can all be drawn from one VAO without rebinding, or submitted together with glMultiDrawElementsIndirect
+/// (see IndirectRenderer).
+///
+/// The buffers grow on demand. Growing or defragmenting replaces the buffers and the VAO, so anything that holds on to
+/// them (such as a VAO with extra instance buffers) should check whether GetVertexBuffer has changed and rebuild
+/// </summary>
+class GeometryArena final
+{
+public:
+	typedef std::shared_ptr<GeometryArena> sptr;
+	/// <summary>
+	/// Creates an arena for meshes of the given vertex type
+	/// </summary>
+	/// <typeparam name="VertType">The vertex type to store, must have a V_DECL (see VertexTypes.h)</typeparam>
+	/// <param name="vertexCapacity">The number of vertices to make room for up front</param>
+	/// <param name="indexCapacity">The number of indices to make room for up front</param>
+	template <typename VertType>
+	static inline sptr Create(size_t vertexCapacity = 65536, size_t indexCapacity = 196608) {
+		return std::make_shared<GeometryArena>(VertType::V_DECL, sizeof(VertType), vertexCapacity, indexCapacity);
+	}
+
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	GeometryArena(const GeometryArena& other) = delete;
+	GeometryArena(GeometryArena&& other) = delete;
+	GeometryArena& operator=(const GeometryArena& other) = delete;
+	GeometryArena& operator=(GeometryArena&& other) = delete;
+
+public:
+	/// <summary>
+	/// Creates a new arena, prefer the templated Create
+	/// </summary>
+	/// <param name="layout">The vertex attributes of the vertices stored in the arena</param>
+	/// <param name="vertexSize">The size of a single vertex, in bytes</param>
+	/// <param name="vertexCapacity">The number of vertices to make room for up front</param>
+	/// <param name="indexCapacity">The number of indices to make room for up front</param>
+	GeometryArena(const std::vector<BufferAttribute>& layout, size_t vertexSize, size_t vertexCapacity, size_t indexCapacity);
+	~GeometryArena();
+
+	/// <summary>
+	/// Creates an empty mesh in this arena, which can be filled in later with SetData
+	/// </summary>
+	ArenaMesh::sptr CreateMesh();
+	/// <summary>
+	/// Creates a mesh in this arena and uploads its geometry
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh, must be in the arena's vertex layout</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="indices">The indices of the mesh, relative to its first vertex</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	ArenaMesh::sptr Allocate(const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+	/// <summary>
+	/// Replaces the geometry of a mesh in this arena, growing the arena if there is not enough room
+	/// </summary>
+	/// <param name="mesh">The mesh to update, must belong to this arena</param>
+	/// <param name="vertices">The vertices of the mesh, must be in the arena's vertex layout</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="indices">The indices of the mesh, relative to its first vertex</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	void SetData(const ArenaMesh::sptr& mesh, const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+
+	/// <summary>
+	/// Packs all of the meshes together at the start of the buffers, so that all of the free space is in one range.
+	/// This copies the buffers on the GPU, and changes the ranges of every mesh
+	/// </summary>
+	void Defragment();
+
+	/// <summary>
+	/// Draws a single mesh from this arena with glDrawElementsBaseVertex
+	/// </summary>
+	/// <param name="mesh">The mesh to draw, must belong to this arena</param>
+	void Render(const ArenaMesh& mesh) const;
+
+	/// <summary>
+	/// Returns the VAO that reads from this arena's buffers
+	/// </summary>
+	const VertexArrayObject::sptr& GetVao() const { return _vao; }
+	/// <summary>
+	/// Returns the buffer holding the vertices of every mesh in this arena
+	/// </summary>
+	const VertexBuffer::sptr& GetVertexBuffer() const { return _vertices; }
+	/// <summary>
+	/// Returns the buffer holding the indices of every mesh in this arena, always 32 bit
+	/// </summary>
+	const IndexBuffer::sptr& GetIndexBuffer() const { return _indices; }
+	/// <summary>
+	/// Returns the vertex attributes of the vertices stored in this arena
+	/// </summary>
+	const std::vector<BufferAttribute>& GetLayout() const { return _layout; }
+	/// <summary>
+	/// Returns the size in bytes of a single vertex in this arena
+	/// </summary>
+	size_t GetVertexSize() const { return _vertexSize; }
+
+	/// <summary>
+	/// Returns the number of meshes in this arena
+	/// </summary>
+	size_t GetMeshCount() const { return _meshes.size(); }
+	/// <summary>
+	/// Returns the number of vertices the arena has room for, and the number in use
+	/// </summary>
+	size_t GetVertexCapacity() const { return _vertexRanges.GetCapacity(); }
+	size_t GetVertexUsed() const { return _vertexRanges.GetUsed(); }
+	/// <summary>
+	/// Returns the number of indices the arena has room for, and the number in use
+	/// </summary>
+	size_t GetIndexCapacity() const { return _indexRanges.GetCapacity(); }
+	size_t GetIndexUsed() const { return _indexRanges.GetUsed(); }
+
+private:
+	friend class ArenaMesh;
+
+	// Frees the ranges of a mesh, and stops tracking it if it is being destroyed
+	void _Release(ArenaMesh* mesh, bool destroyed);
+	// Allocates a range from one of the allocators, growing the arena if it is full
+	size_t _AllocateRange(bool vertices, size_t count);
+	// Replaces the buffers with new ones of the given capacities, optionally packing the meshes together
+	void _Rebuild(size_t vertexCapacity, size_t indexCapacity, bool compact);
+
+	std::vector<BufferAttribute> _layout;
+	size_t _vertexSize;
+
+	VertexBuffer::sptr _vertices;
+	IndexBuffer::sptr _indices;
+	VertexArrayObject::sptr _vao;
+	RangeAllocator _vertexRanges;
+	RangeAllocator _indexRanges;
+
+	std::vector<ArenaMesh*> _meshes;
+};
@@ -24,6 +24,14 @@ void IBuffer::LoadData(const void* data, size_t elementSize, size_t elementCount
 	_elementSize = elementSize;
 }
 
+void IBuffer::UpdateData(const void* data, size_t offset, size_t size) {
+	glNamedBufferSubData(_handle, offset, size, data);
+}
+
+void IBuffer::GetData(void* result, size_t offset, size_t size) const {
+	glGetNamedBufferSubData(_handle, offset, size, result);
+}
+
 void IBuffer::Bind() {
 	glBindBuffer(_type, _handle);
 }
@@ -38,6 +38,22 @@ public:
 		IBuffer::LoadData((const void*)(data), sizeof(T), count);
 	}
 
+	/// <summary>
+	/// Overwrites part of this buffer without reallocating it, using glNamedBufferSubData. The buffer must already be
+	/// large enough, see LoadData
+	/// </summary>
+	/// <param name="data">The data to copy into the buffer</param>
+	/// <param name="offset">The offset in bytes from the start of the buffer to start writing at</param>
+	/// <param name="size">The number of bytes to write</param>
+	void UpdateData(const void* data, size_t offset, size_t size);
+	/// <summary>
+	/// Reads the contents of this buffer back from the GPU, using glGetNamedBufferSubData. This stalls until any
+	/// pending draws using the buffer have finished, so it should only be used for baking and tools, not every frame
+	/// </summary>
+	/// <param name="result">The memory to copy the data into, must be at least size bytes</param>
+	/// <param name="offset">The offset in bytes from the start of the buffer to start reading from</param>
+	/// <param name="size">The number of bytes to read</param>
+	void GetData(void* result, size_t offset, size_t size) const;
 	/// <summary>
 	/// Returns the number of elements that are loaded into this buffer
 	/// </summary>
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <stdexcept>
 #include <memory>
+#include <vector>
 
 /// <summary>
 /// The index buffer will store indices for rendering (uint8_t, uint16_t and uint32_t)
@@ -46,6 +47,14 @@ public:
 	/// <param name="count">The number of elements in the array to upload</param>
 	template <typename T>
 	void LoadData(const T* data, size_t count) { throw std::runtime_error("Must be one of uint8_t, uint16_t or uint32_t"); } // Note, see template specializations below
+	/// <summary>
+	/// Loads 32 bit indices into this buffer, narrowing them to 16 bit indices if the mesh is small enough for all of
+	/// them to fit. This halves the size of the buffer for any mesh with 65536 vertices or less
+	/// </summary>
+	/// <param name="data">A pointer to the start of the array</param>
+	/// <param name="count">The number of indices in the array to upload</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	void LoadIndices(const uint32_t* data, size_t count, size_t vertexCount);
 
 	/// <summary>
 	/// Gets the underlying index type for this buffer (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)
@@ -80,3 +89,15 @@ inline void IndexBuffer::LoadData<uint32_t>(const uint32_t* data, size_t count)
 	IBuffer::LoadData<uint32_t>(data, count);
 	_elementType = GL_UNSIGNED_INT;
 }
+
+inline void IndexBuffer::LoadIndices(const uint32_t* data, size_t count, size_t vertexCount) {
+	if (vertexCount <= 65536) {
+		std::vector<uint16_t> narrowed(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			narrowed[ix] = static_cast<uint16_t>(data[ix]);
+		}
+		LoadData<uint16_t>(narrowed.data(), narrowed.size());
+	} else {
+		LoadData<uint32_t>(data, count);
+	}
+}
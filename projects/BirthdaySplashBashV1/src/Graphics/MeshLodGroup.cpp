@@ -0,0 +1,116 @@
+#include "MeshLodGroup.h"
+
+#include <algorithm>
+
+#include "Logging.h"
+
+namespace {
+	// Gets how much of the screen's height a model space sphere covers when drawn with the given transforms
+	float GetSphereScreenSize(const glm::vec3& sphereCenter, float sphereRadius, const glm::mat4& world, const glm::vec3& cameraPosition, const glm::mat4& projection) {
+		// Scale the radius by the largest axis, so that the sphere still encloses the mesh under non-uniform scales
+		const float scale = sqrtf(std::max(glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+			std::max(glm::dot(glm::vec3(world[1]), glm::vec3(world[1])), glm::dot(glm::vec3(world[2]), glm::vec3(world[2])))));
+		const float radius = sphereRadius * scale;
+
+		// projection[1][1] maps view space heights to clip space, where the screen is 2 units tall
+		const bool isOrtho = projection[3][3] == 1.0f;
+		if (isOrtho) {
+			return radius * projection[1][1];
+		}
+		const glm::vec3 center = glm::vec3(world * glm::vec4(sphereCenter, 1.0f));
+		const float distance = glm::length(center - cameraPosition);
+		// Once the camera is inside the sphere the object fills the screen anyways
+		return radius * projection[1][1] / std::max(distance, radius);
+	}
+
+	// Steps from the current level towards the coarsest level whose error stays under the max screen error, where
+	// errorScale converts a level's error into a fraction of the screen's height
+	template <typename ErrorFunc>
+	size_t SelectByError(size_t levelCount, float errorScale, float maxScreenError, float hysteresis, size_t currentLevel, ErrorFunc getError) {
+		size_t level = std::min(currentLevel, levelCount - 1);
+		const float coarsenLimit = maxScreenError * (1.0f - hysteresis);
+		const float refineLimit = maxScreenError * (1.0f + hysteresis);
+
+		while (level + 1 < levelCount && getError(level + 1) * errorScale < coarsenLimit) {
+			level++;
+		}
+		while (level > 0 && getError(level) * errorScale > refineLimit) {
+			level--;
+		}
+		return level;
+	}
+}
+
+void MeshLodGroup::AddLevel(const VertexArrayObject::sptr& mesh, float error) {
+	LOG_ASSERT(_levels.empty() || error >= _levels.back().Error, "Levels of detail must be added from finest to coarsest!");
+	_levels.push_back({ mesh, error });
+}
+
+void MeshLodGroup::AddPart(const glm::vec3& center, float radius, const std::vector<float>& errors) {
+	LOG_ASSERT(errors.size() == _levels.size(), "Parts need an error for every level, add them after the levels!");
+	_parts.push_back({ center, radius, errors });
+}
+
+void MeshLodGroup::SetBounds(const glm::vec3& center, float radius) {
+	_boundsCenter = center;
+	_boundsRadius = radius;
+}
+
+float MeshLodGroup::GetScreenSize(const glm::mat4& world, const glm::vec3& cameraPosition, const glm::mat4& projection) const {
+	return GetSphereScreenSize(_boundsCenter, _boundsRadius, world, cameraPosition, projection);
+}
+
+size_t MeshLodGroup::SelectLevel(float screenSize, size_t currentLevel) const {
+	if (_levels.size() < 2 || _boundsRadius <= 0.0f) {
+		return 0;
+	}
+	// The error is relative to the object's size, so the scale of the object cancels out
+	return SelectByError(_levels.size(), screenSize / (2.0f * _boundsRadius), _maxScreenError, _hysteresis, currentLevel,
+		[&](size_t level) { return _levels[level].Error; });
+}
+
+size_t MeshLodGroup::SelectLevel(const glm::mat4& world, const glm::vec3& cameraPosition, const glm::mat4& projection, size_t currentLevel) const {
+	if (_parts.empty()) {
+		return SelectLevel(GetScreenSize(world, cameraPosition, projection), currentLevel);
+	}
+	if (_levels.size() < 2) {
+		return 0;
+	}
+
+	// Every part has to look as good as it would on its own, so the part that needs the finest level wins
+	size_t result = _levels.size() - 1;
+	for (const Part& part : _parts) {
+		if (part.Radius <= 0.0f) {
+			return 0;
+		}
+		const float errorScale = GetSphereScreenSize(part.Center, part.Radius, world, cameraPosition, projection) / (2.0f * part.Radius);
+		result = std::min(result, SelectByError(_levels.size(), errorScale, _maxScreenError, _hysteresis, currentLevel,
+			[&](size_t level) { return part.Errors[level]; }));
+	}
+	return result;
+}
+
+void MeshLodGroup::ComputeBounds(const glm::vec3* positions, size_t positionStride, size_t vertexCount, glm::vec3& center, float& radius) {
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(positions);
+	center = glm::vec3(0.0f);
+	radius = 0.0f;
+	if (vertexCount == 0) {
+		return;
+	}
+
+	glm::vec3 min = *reinterpret_cast<const glm::vec3*>(data);
+	glm::vec3 max = min;
+	for (size_t ix = 1; ix < vertexCount; ix++) {
+		const glm::vec3& position = *reinterpret_cast<const glm::vec3*>(data + ix * positionStride);
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
+	center = (min + max) * 0.5f;
+
+	float radiusSquared = 0.0f;
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		const glm::vec3 offset = *reinterpret_cast<const glm::vec3*>(data + ix * positionStride) - center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	radius = sqrtf(radiusSquared);
+}
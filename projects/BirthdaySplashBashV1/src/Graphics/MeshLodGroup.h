@@ -0,0 +1,131 @@
+#pragma once
+#include <vector>
+#include <memory>
+
+#include <GLM/glm.hpp>
+
+#include "VertexArrayObject.h"
+
+/// <summary>
+/// A set of meshes representing the same object at decreasing levels of detail, along with the logic to pick which
+/// one to draw based on how large the object appears on screen. Level 0 is always the full detail mesh.
+///
+/// Each level stores how far its surface may be from the original (see MeshSimplifier), and a level is only used once
+/// that distance would cover less than the max screen error. A hysteresis band around each switch point stops
+/// objects sitting right on the threshold from flickering back and forth between levels
+/// </summary>
+class MeshLodGroup final
+{
+public:
+	typedef std::shared_ptr<MeshLodGroup> sptr;
+	static inline sptr Create() {
+		return std::make_shared<MeshLodGroup>();
+	}
+
+	struct Level
+	{
+		VertexArrayObject::sptr Mesh;
+		/// <summary>
+		/// The estimated distance between this level's surface and the full detail mesh, in model space
+		/// </summary>
+		float Error;
+	};
+
+	MeshLodGroup() = default;
+	~MeshLodGroup() = default;
+
+	MeshLodGroup(const MeshLodGroup& other) = delete;
+	MeshLodGroup(MeshLodGroup&& other) = delete;
+	MeshLodGroup& operator=(const MeshLodGroup& other) = delete;
+	MeshLodGroup& operator=(MeshLodGroup&& other) = delete;
+
+	/// <summary>
+	/// Adds the next coarsest level, levels must be added in order of increasing error
+	/// </summary>
+	/// <param name="mesh">The mesh to draw for this level</param>
+	/// <param name="error">The estimated distance between this level's surface and the full detail mesh, in model space</param>
+	void AddLevel(const VertexArrayObject::sptr& mesh, float error);
+
+	size_t GetLevelCount() const { return _levels.size(); }
+	const Level& GetLevel(size_t level) const { return _levels[level]; }
+
+	/// <summary>
+	/// Adds a separate object within the mesh, for meshes that merge several objects together (see StaticBatcher). Once a
+	/// group has parts, each part works out the level it needs from its own size on screen, and the finest of those is
+	/// drawn. Parts must be added after all of the levels
+	/// </summary>
+	/// <param name="center">The center of the part's bounding sphere, in model space</param>
+	/// <param name="radius">The radius of the part's bounding sphere, in model space</param>
+	/// <param name="errors">How far the part's surface is from its full detail in each level, in model space</param>
+	void AddPart(const glm::vec3& center, float radius, const std::vector<float>& errors);
+	size_t GetPartCount() const { return _parts.size(); }
+
+	/// <summary>
+	/// Sets the model space sphere that encloses every level, used to work out how large the object is on screen
+	/// </summary>
+	void SetBounds(const glm::vec3& center, float radius);
+	const glm::vec3& GetBoundsCenter() const { return _boundsCenter; }
+	float GetBoundsRadius() const { return _boundsRadius; }
+
+	/// <summary>
+	/// Sets the largest error a level may have on screen before a finer level is used, as a fraction of the screen's
+	/// height. The default of 0.002 is about 2 pixels at 1080p
+	/// </summary>
+	void SetMaxScreenError(float value) { _maxScreenError = value; }
+	float GetMaxScreenError() const { return _maxScreenError; }
+	/// <summary>
+	/// Sets how far past a switch point (as a fraction of the max screen error) an object must be before it changes level
+	/// </summary>
+	void SetHysteresis(float value) { _hysteresis = value; }
+	float GetHysteresis() const { return _hysteresis; }
+
+	/// <summary>
+	/// Gets how much of the screen's height the bounding sphere covers when drawn with the given transforms
+	/// </summary>
+	/// <param name="world">The model to world transform of the object</param>
+	/// <param name="cameraPosition">The world space position of the camera</param>
+	/// <param name="projection">The camera's projection matrix, either perspective or orthographic</param>
+	float GetScreenSize(const glm::mat4& world, const glm::vec3& cameraPosition, const glm::mat4& projection) const;
+	/// <summary>
+	/// Picks the level to draw for an object of the given size on screen
+	/// </summary>
+	/// <param name="screenSize">The fraction of the screen's height that the object covers, see GetScreenSize</param>
+	/// <param name="currentLevel">The level that was drawn last frame</param>
+	/// <returns>The level to draw this frame</returns>
+	size_t SelectLevel(float screenSize, size_t currentLevel) const;
+	/// <summary>
+	/// Picks the level to draw for an object with the given transforms. Groups with parts draw the finest level that any
+	/// of their parts need, and the rest use the bounding sphere of the whole group
+	/// </summary>
+	/// <param name="world">The model to world transform of the object</param>
+	/// <param name="cameraPosition">The world space position of the camera</param>
+	/// <param name="projection">The camera's projection matrix, either perspective or orthographic</param>
+	/// <param name="currentLevel">The level that was drawn last frame</param>
+	/// <returns>The level to draw this frame</returns>
+	size_t SelectLevel(const glm::mat4& world, const glm::vec3& cameraPosition, const glm::mat4& projection, size_t currentLevel) const;
+
+	/// <summary>
+	/// Calculates a bounding sphere for a set of vertices, centered on the middle of their bounding box
+	/// </summary>
+	/// <param name="positions">A pointer to the position of the first vertex</param>
+	/// <param name="positionStride">The number of bytes between each position</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="center">Receives the center of the sphere</param>
+	/// <param name="radius">Receives the radius of the sphere</param>
+	static void ComputeBounds(const glm::vec3* positions, size_t positionStride, size_t vertexCount, glm::vec3& center, float& radius);
+
+private:
+	struct Part
+	{
+		glm::vec3          Center;
+		float              Radius;
+		std::vector<float> Errors;
+	};
+
+	std::vector<Level> _levels;
+	std::vector<Part>  _parts;
+	glm::vec3 _boundsCenter = glm::vec3(0.0f);
+	float     _boundsRadius = 0.0f;
+	float     _maxScreenError = 0.002f;
+	float     _hysteresis = 0.1f;
+};
@@ -1,5 +1,7 @@
 #include "BlurEffect.h"
 
+#include "Utilities/AssetManager.h"
+
 void BlurEffect::Init(unsigned width, unsigned height)
 {
     int index = int(_buffers.size());
@@ -22,31 +24,16 @@ void BlurEffect::Init(unsigned width, unsigned height)
 
     //Loads the shaders
     index = int(_shaders.size());
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/passthrough_frag.glsl"));
     index++;
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/Post/Bloom_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/Post/Bloom_frag.glsl"));
     index++;
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/Post/BlurH_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/Post/BlurH_frag.glsl"));
     index++;
     index = int(_shaders.size());
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/Post/BlurV_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/Post/BlurV_frag.glsl"));
     index++;
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/Post/Composite_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/Post/Composite_frag.glsl"));
     index++;
 
     direction = glm::vec2(1.0f / width, 1.0f / height);
@@ -1,5 +1,7 @@
 #include "ColorCorrectEffect.h"
 
+#include "Utilities/AssetManager.h"
+
 void ColorCorrectEffect::Init(unsigned width, unsigned height)
 {
 	int index = int(_buffers.size());
@@ -10,10 +12,7 @@ void ColorCorrectEffect::Init(unsigned width, unsigned height)
 
 	//Loads the shaders
 	index = int(_shaders.size());
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/Post/color_correction_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
+	_shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/Post/color_correction_frag.glsl"));
 
 	//Load in cube
 	_Lut.loadFromFile("cubes/BrightenedCorrection.cube");
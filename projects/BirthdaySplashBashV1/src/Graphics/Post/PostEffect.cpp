@@ -1,5 +1,7 @@
 #include "PostEffect.h"
 
+#include "Utilities/AssetManager.h"
+
 void PostEffect::Init(unsigned width, unsigned height)
 {
 	if (!_shaders.size() > 0)
@@ -12,10 +14,7 @@ void PostEffect::Init(unsigned width, unsigned height)
 		_buffers[index]->Init(width, height);
 	}
 
-	_shaders.push_back(Shader::Create());
-	_shaders[_shaders.size() - 1]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[_shaders.size() - 1]->LoadShaderPartFromFile("shaders/passthrough_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[_shaders.size() - 1]->Link();
+	_shaders.push_back(AssetManager::LoadShader("shaders/passthrough_vert.glsl", "shaders/passthrough_frag.glsl"));
 
 }
 
@@ -2,11 +2,16 @@
 #include "IndexBuffer.h"
 #include "Logging.h"
 #include "VertexBuffer.h"
+#include "VertexFormat.h"
+
+GLuint VertexArrayObject::_boundHandle = 0;
+VertexArrayObject::DrawStats VertexArrayObject::_stats;
 
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
-	_vertexCount(0)
+	_vertexCount(0),
+	_format(nullptr)
 {
 	glCreateVertexArrays(1, &_handle);
 }
@@ -14,6 +19,7 @@ VertexArrayObject::VertexArrayObject() :
 VertexArrayObject::~VertexArrayObject()
 {
 	if (_handle != 0) {
+		ForgetHandle(_handle);
 		glDeleteVertexArrays(1, &_handle);
 		_handle = 0;
 	}
@@ -51,22 +57,76 @@ void VertexArrayObject::AddVertexBuffer(const VertexBuffer::sptr& buffer, const
 	}
 	UnBind();
 
+	// Meshes fed by a single buffer can share a VAO with every other mesh in the same layout
+	_format = (_vertexBuffers.size() == 1 && _instanceBuffers.empty()) ? VertexFormat::Get(attributes) : nullptr;
+}
+
+void VertexArrayObject::AddInstanceBuffer(const VertexBuffer::sptr& buffer, const std::vector<BufferAttribute>& attributes, GLuint divisor)
+{
+	VertexBufferBinding binding;
+	binding.Buffer = buffer;
+	binding.Attributes = attributes;
+	_instanceBuffers.push_back(binding);
+	// The shared formats don't know about our instance attributes
+	_format = nullptr;
+
+	Bind();
+	buffer->Bind();
+	for (const BufferAttribute& attrib : attributes) {
+		glEnableVertexArrayAttrib(_handle, attrib.Slot);
+		glVertexAttribPointer(attrib.Slot, attrib.Size, attrib.Type, attrib.Normalized, attrib.Stride, (void*)attrib.Offset);
+		glVertexAttribDivisor(attrib.Slot, divisor);
+	}
+	UnBind();
 }
 
 void VertexArrayObject::Bind() const {
-	glBindVertexArray(_handle);
+	BindHandle(_handle);
 }
 
 void VertexArrayObject::UnBind() {
-	glBindVertexArray(0);
+	BindHandle(0);
+}
+
+void VertexArrayObject::BindHandle(GLuint handle) {
+	if (_boundHandle != handle) {
+		glBindVertexArray(handle);
+		_boundHandle = handle;
+		if (handle != 0) {
+			_stats.VaoBinds++;
+		}
+	}
+}
+
+void VertexArrayObject::ForgetHandle(GLuint handle) {
+	// Deleting the bound VAO reverts the binding back to 0
+	if (_boundHandle == handle) {
+		_boundHandle = 0;
+	}
 }
 
 void VertexArrayObject::Render() const {
-	Bind();
+	// We leave the VAO bound after drawing, so the next mesh in the same format can skip the bind
+	if (_format != nullptr) {
+		_format->Bind(_vertexBuffers[0].Buffer, _indexBuffer);
+	} else {
+		Bind();
+	}
 	if (_indexBuffer != nullptr) {
 		glDrawElements(GL_TRIANGLES, _indexBuffer->GetElementCount(), _indexBuffer->GetElementType(), nullptr);
 	} else {
 		glDrawArrays(GL_TRIANGLES, 0, _vertexCount / 3);
 	}
+	_stats.DrawCalls++;
+}
+
+void VertexArrayObject::RenderInstanced(GLsizei instanceCount) const {
+	Bind();
+	if (_indexBuffer != nullptr) {
+		glDrawElementsInstanced(GL_TRIANGLES, _indexBuffer->GetElementCount(), _indexBuffer->GetElementType(), nullptr, instanceCount);
+	} else {
+		glDrawArraysInstanced(GL_TRIANGLES, 0, _vertexCount, instanceCount);
+	}
+	_stats.DrawCalls++;
 	UnBind();
 }
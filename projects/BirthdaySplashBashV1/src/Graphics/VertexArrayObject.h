@@ -7,6 +7,8 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 
+class VertexFormat;
+
 /// <summary>
 /// We'll use this just to make it more clear what the intended usage of an attribute is in our code!
 /// </summary>
@@ -113,6 +115,14 @@ public:
 	/// <param name="buffer">The buffer to add (note, does not take ownership, you will still need to delete later)</param>
 	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer</param>
 	void AddVertexBuffer(const VertexBuffer::sptr& buffer, const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Adds a buffer of per-instance data to this VAO, the attributes it feeds advance once per instance instead of once per
+	/// vertex. Unlike vertex buffers, instance buffers can be resized freely after being added
+	/// </summary>
+	/// <param name="buffer">The buffer to add (note, does not take ownership, you will still need to delete later)</param>
+	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer</param>
+	/// <param name="divisor">The number of instances that share each element of the buffer, default is 1</param>
+	void AddInstanceBuffer(const VertexBuffer::sptr& buffer, const std::vector<BufferAttribute>& attributes, GLuint divisor = 1);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -122,15 +132,81 @@ public:
 	/// Unbinds the currently bound VAO
 	/// </summary>
 	static void UnBind();
+	/// <summary>
+	/// Binds a raw VAO handle, skipping the bind if it is already bound. Any code that binds VAOs outside of this class
+	/// should go through here, otherwise the tracked binding will be out of date
+	/// </summary>
+	/// <param name="handle">The VAO handle to bind, or 0 to unbind</param>
+	static void BindHandle(GLuint handle);
+	/// <summary>
+	/// Lets the binding tracker know that a VAO handle is being deleted, so a new VAO that re-uses the handle will still
+	/// be bound
+	/// </summary>
+	static void ForgetHandle(GLuint handle);
+
+	/// <summary>
+	/// Counts the draw calls and the state changes needed to issue them, so we can see how well the draws are batched
+	/// </summary>
+	struct DrawStats
+	{
+		// Number of draw commands issued
+		size_t DrawCalls = 0;
+		// Number of times a different VAO was bound
+		size_t VaoBinds = 0;
+		// Number of times a shared vertex format had a new vertex buffer attached
+		size_t VertexBufferSwitches = 0;
+		// Number of times a shared vertex format had a new index buffer attached
+		size_t IndexBufferSwitches = 0;
+	};
+	/// <summary>
+	/// Returns the draw stats collected since the last call to ResetStats
+	/// </summary>
+	static const DrawStats& GetStats() { return _stats; }
+	/// <summary>
+	/// Resets the draw stats, call this at the start of each frame
+	/// </summary>
+	static void ResetStats() { _stats = DrawStats(); }
+	/// <summary>
+	/// Records a draw call that was issued without going through Render, so that it shows up in the stats
+	/// </summary>
+	static void RecordDrawCall(size_t count = 1) { _stats.DrawCalls += count; }
 
 	/// <summary>
 	/// Returns the underlying OpenGL handle that this class is wrapping around
 	/// </summary>
 	GLuint GetHandle() const { return _handle; }
 
+	/// <summary>
+	/// Returns the index buffer bound to this VAO, or nullptr if it is not indexed
+	/// </summary>
+	const IndexBuffer::sptr& GetIndexBuffer() const { return _indexBuffer; }
+	/// <summary>
+	/// Returns the number of vertex buffers that have been added to this VAO
+	/// </summary>
+	size_t GetVertexBufferCount() const { return _vertexBuffers.size(); }
+	/// <summary>
+	/// Returns the vertex buffer at the given index, in the order they were added
+	/// </summary>
+	const VertexBuffer::sptr& GetVertexBuffer(size_t index) const { return _vertexBuffers[index].Buffer; }
+	/// <summary>
+	/// Returns the attributes that the vertex buffer at the given index feeds
+	/// </summary>
+	const std::vector<BufferAttribute>& GetVertexBufferAttributes(size_t index) const { return _vertexBuffers[index].Attributes; }
+
+	/// <summary>
+	/// Draws the mesh. Meshes with a single vertex buffer are drawn through the shared VertexFormat for their layout,
+	/// so drawing many meshes with the same layout in a row does not need to switch VAOs
+	/// </summary>
 	void Render() const;
+	/// <summary>
+	/// Draws the mesh instanceCount times with a single draw call, the instance buffers must hold at least that many instances
+	/// </summary>
+	/// <param name="instanceCount">The number of copies of the mesh to draw</param>
+	void RenderInstanced(GLsizei instanceCount) const;
 	
 protected:
+	friend class VertexFormat;
+
 	// Helper structure to store a buffer and the attributes
 	struct VertexBufferBinding
 	{
@@ -142,8 +218,17 @@ protected:
 	IndexBuffer::sptr _indexBuffer;
 	// The vertex buffers bound to this VAO
 	std::vector<VertexBufferBinding> _vertexBuffers;
+	// The per-instance buffers bound to this VAO
+	std::vector<VertexBufferBinding> _instanceBuffers;
 
 	GLsizei _vertexCount;
+
+	// The shared format used to draw this mesh, or nullptr if the mesh has to be drawn with its own VAO
+	std::shared_ptr<VertexFormat> _format;
+
+	// The VAO that is currently bound, so we can skip redundant binds
+	static GLuint _boundHandle;
+	static DrawStats _stats;
 	
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
@@ -0,0 +1,88 @@
+#include "VertexFormat.h"
+#include "Logging.h"
+
+std::vector<VertexFormat::sptr> VertexFormat::_formats;
+
+VertexFormat::VertexFormat(const std::vector<BufferAttribute>& attributes) :
+	_attributes(attributes),
+	_stride(0),
+	_vertexBuffer(nullptr),
+	_indexBuffer(nullptr),
+	_handle(0)
+{
+	LOG_ASSERT(IsSupported(attributes), "All attributes in a vertex format must share the same non-zero stride!");
+	_stride = attributes.empty() ? 0 : attributes[0].Stride;
+
+	glCreateVertexArrays(1, &_handle);
+	for (const BufferAttribute& attrib : _attributes) {
+		glEnableVertexArrayAttrib(_handle, attrib.Slot);
+		glVertexArrayAttribFormat(_handle, attrib.Slot, attrib.Size, attrib.Type, attrib.Normalized, static_cast<GLuint>(attrib.Offset));
+		glVertexArrayAttribBinding(_handle, attrib.Slot, 0);
+	}
+}
+
+VertexFormat::~VertexFormat()
+{
+	if (_handle != 0) {
+		VertexArrayObject::ForgetHandle(_handle);
+		glDeleteVertexArrays(1, &_handle);
+		_handle = 0;
+	}
+}
+
+void VertexFormat::Bind(const VertexBuffer::sptr& vbo, const IndexBuffer::sptr& ibo) {
+	VertexArrayObject::BindHandle(_handle);
+	if (_vertexBuffer != vbo) {
+		glVertexArrayVertexBuffer(_handle, 0, vbo != nullptr ? vbo->GetHandle() : 0, 0, _stride);
+		_vertexBuffer = vbo;
+		VertexArrayObject::_stats.VertexBufferSwitches++;
+	}
+	if (_indexBuffer != ibo) {
+		glVertexArrayElementBuffer(_handle, ibo != nullptr ? ibo->GetHandle() : 0);
+		_indexBuffer = ibo;
+		VertexArrayObject::_stats.IndexBufferSwitches++;
+	}
+}
+
+VertexFormat::sptr VertexFormat::Get(const std::vector<BufferAttribute>& attributes) {
+	if (!IsSupported(attributes)) {
+		return nullptr;
+	}
+	// There's only ever a handful of formats, so a linear search is plenty
+	for (const sptr& format : _formats) {
+		if (Matches(format->_attributes, attributes)) {
+			return format;
+		}
+	}
+	_formats.push_back(Create(attributes));
+	return _formats.back();
+}
+
+bool VertexFormat::IsSupported(const std::vector<BufferAttribute>& attributes) {
+	if (attributes.empty() || attributes[0].Stride <= 0) {
+		return false;
+	}
+	for (const BufferAttribute& attrib : attributes) {
+		if (attrib.Stride != attributes[0].Stride) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool VertexFormat::Matches(const std::vector<BufferAttribute>& a, const std::vector<BufferAttribute>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t ix = 0; ix < a.size(); ix++) {
+		if (a[ix].Slot != b[ix].Slot || a[ix].Size != b[ix].Size || a[ix].Type != b[ix].Type ||
+			a[ix].Normalized != b[ix].Normalized || a[ix].Stride != b[ix].Stride || a[ix].Offset != b[ix].Offset) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void VertexFormat::ReleaseAll() {
+	_formats.clear();
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <glad/glad.h>
+#include <memory>
+#include <vector>
+
+#include "VertexArrayObject.h"
+
+/// <summary>
+/// A vertex format is a single VAO shared by every mesh that uses the same vertex layout. The attribute layout is set up
+/// once with glVertexArrayAttribFormat, and the mesh's buffers are swapped in with glVertexArrayVertexBuffer and
+/// glVertexArrayElementBuffer, so drawing a run of meshes with the same layout never needs to switch VAOs.
+///
+/// Nothing about the registry is decided at compile time. Formats are created at runtime the first time a layout is
+/// requested through Get(attributes), and later requests with matching attributes get the same format back.
+/// Get<VertType>() is only a shortcut that looks up the V_DECL of one of the vertex structures in VertexTypes.h
+/// </summary>
+class VertexFormat final
+{
+public:
+	typedef std::shared_ptr<VertexFormat> sptr;
+	template <typename ... TArgs>
+	static inline sptr Create(TArgs&&... args) {
+		return std::make_shared<VertexFormat>(std::forward<TArgs>(args)...);
+	}
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	VertexFormat(const VertexFormat& other) = delete;
+	VertexFormat(VertexFormat&& other) = delete;
+	VertexFormat& operator=(const VertexFormat& other) = delete;
+	VertexFormat& operator=(VertexFormat&& other) = delete;
+
+public:
+	/// <summary>
+	/// Creates a new VAO with the given layout. All of the attributes are read from binding point 0, so they must all
+	/// share the same stride. Prefer Get over creating formats directly, so that meshes can share them
+	/// </summary>
+	/// <param name="attributes">The attributes of the vertex layout</param>
+	VertexFormat(const std::vector<BufferAttribute>& attributes);
+	~VertexFormat();
+
+	/// <summary>
+	/// Binds this format's VAO and attaches the given buffers to it, skipping any state that is already set
+	/// </summary>
+	/// <param name="vbo">The vertex buffer to read the vertices from</param>
+	/// <param name="ibo">The index buffer to read the indices from, or nullptr if the mesh is not indexed</param>
+	void Bind(const VertexBuffer::sptr& vbo, const IndexBuffer::sptr& ibo);
+
+	/// <summary>
+	/// Returns the underlying OpenGL handle that this class is wrapping around
+	/// </summary>
+	GLuint GetHandle() const { return _handle; }
+	/// <summary>
+	/// Returns the size of a single vertex in this format, in bytes
+	/// </summary>
+	GLsizei GetStride() const { return _stride; }
+	/// <summary>
+	/// Returns the attributes that make up this format
+	/// </summary>
+	const std::vector<BufferAttribute>& GetAttributes() const { return _attributes; }
+
+	/// <summary>
+	/// Returns the shared format for a vertex structure, creating it the first time it is requested
+	/// </summary>
+	/// <typeparam name="VertType">The vertex structure, must have a static V_DECL</typeparam>
+	template <typename VertType>
+	static sptr Get() {
+		return Get(VertType::V_DECL);
+	}
+	/// <summary>
+	/// Returns the shared format for a vertex layout, creating it the first time it is requested
+	/// </summary>
+	/// <param name="attributes">The attributes of the vertex layout</param>
+	/// <returns>The shared format, or nullptr if the layout cannot be described by a single binding</returns>
+	static sptr Get(const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Checks whether a vertex layout can be drawn through a shared format, all of its attributes need to share a
+	/// non-zero stride
+	/// </summary>
+	static bool IsSupported(const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Returns true if two vertex layouts are identical
+	/// </summary>
+	static bool Matches(const std::vector<BufferAttribute>& a, const std::vector<BufferAttribute>& b);
+	/// <summary>
+	/// Returns the number of formats that have been created so far
+	/// </summary>
+	static size_t GetFormatCount() { return _formats.size(); }
+	/// <summary>
+	/// Deletes all of the shared formats, this should be called before the OpenGL context is destroyed
+	/// </summary>
+	static void ReleaseAll();
+
+private:
+	std::vector<BufferAttribute> _attributes;
+	GLsizei _stride;
+
+	// We hold on to the attached buffers so that their handles can't be re-used by a new buffer while we still think
+	// they are attached
+	VertexBuffer::sptr _vertexBuffer;
+	IndexBuffer::sptr _indexBuffer;
+
+	// The underlying OpenGL handle that this class is wrapping around
+	GLuint _handle;
+
+	static std::vector<sptr> _formats;
+};
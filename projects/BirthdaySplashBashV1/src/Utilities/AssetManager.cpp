@@ -0,0 +1,78 @@
+#include "AssetManager.h"
+
+#include <filesystem>
+
+#include "Logging.h"
+
+AssetCache<VertexArrayObject> AssetManager::Meshes;
+AssetCache<MeshLodGroup> AssetManager::MeshLods;
+AssetCache<Texture2D> AssetManager::Textures;
+AssetCache<Shader> AssetManager::Shaders;
+
+namespace {
+	template <typename T>
+	void LogCacheStats(const char* name, const AssetCache<T>& cache) {
+		const size_t requests = cache.GetHits() + cache.GetMisses();
+		LOG_INFO("{:<8} {:>4} loaded, {:>4} hits, {:>4} misses ({:.1f}% hit rate)", name, cache.GetCount(), cache.GetHits(), cache.GetMisses(),
+			requests > 0 ? 100.0 * cache.GetHits() / requests : 0.0);
+	}
+}
+
+Shader::sptr AssetManager::LoadShader(const std::string& vertexPath, const std::string& fragmentPath) {
+	return Shaders.GetOrLoad(MakeShaderKey(vertexPath, fragmentPath), [&]() {
+		Shader::sptr result = Shader::Create();
+		result->LoadShaderPartFromFile(vertexPath.c_str(), GL_VERTEX_SHADER);
+		result->LoadShaderPartFromFile(fragmentPath.c_str(), GL_FRAGMENT_SHADER);
+		result->Link();
+		return result;
+	});
+}
+
+std::string AssetManager::MakeMeshKey(const std::string& path, const glm::vec4& inColor) {
+	// The color is baked into the vertices, so the same file with a different color is a different mesh
+	return GetCanonicalPath(path) + "|" + std::to_string(inColor.r) + "," + std::to_string(inColor.g) + "," +
+		std::to_string(inColor.b) + "," + std::to_string(inColor.a);
+}
+
+std::string AssetManager::MakeMeshLodKey(const std::string& path, const glm::vec4& inColor, const std::vector<float>& triangleRatios) {
+	std::string result = MakeMeshKey(path, inColor) + "|lod";
+	for (float ratio : triangleRatios) {
+		result += "," + std::to_string(ratio);
+	}
+	return result;
+}
+
+std::string AssetManager::MakeTextureKey(const std::string& path) {
+	return GetCanonicalPath(path);
+}
+
+std::string AssetManager::MakeShaderKey(const std::string& vertexPath, const std::string& fragmentPath) {
+	return GetCanonicalPath(vertexPath) + "|" + GetCanonicalPath(fragmentPath);
+}
+
+std::string AssetManager::GetCanonicalPath(const std::string& path) {
+	std::error_code error;
+	std::filesystem::path result = std::filesystem::weakly_canonical(path, error);
+	if (error) {
+		result = std::filesystem::absolute(path, error).lexically_normal();
+	}
+	return result.generic_string();
+}
+
+size_t AssetManager::ReleaseUnused() {
+	return Meshes.ReleaseUnused() + MeshLods.ReleaseUnused() + Textures.ReleaseUnused() + Shaders.ReleaseUnused();
+}
+
+void AssetManager::Clear() {
+	Meshes.Clear();
+	MeshLods.Clear();
+	Textures.Clear();
+	Shaders.Clear();
+}
+
+void AssetManager::LogStats() {
+	LogCacheStats("Meshes", Meshes);
+	LogCacheStats("LODs", MeshLods);
+	LogCacheStats("Textures", Textures);
+	LogCacheStats("Shaders", Shaders);
+}
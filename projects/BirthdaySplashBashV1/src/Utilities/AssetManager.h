@@ -0,0 +1,167 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+#include <GLM/glm.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/MeshLodGroup.h"
+#include "Graphics/Texture2D.h"
+#include "Graphics/Shader.h"
+
+/// <summary>
+/// A cache of loaded assets of a single type, keyed by a string built from the asset's path and load options.
+/// The cache holds a strong reference to every asset, so the use count of the shared pointer doubles as the
+/// reference count; an asset with a use count of one is only being kept alive by the cache
+/// </summary>
+template <typename T>
+class AssetCache final
+{
+public:
+	typedef std::shared_ptr<T> sptr;
+
+	/// <summary>
+	/// Gets the asset stored under the given key, invoking the loader and storing the result if it is not already loaded.
+	/// Assets that fail to load (the loader returns nullptr or throws) are not stored. The AsyncLoader stores an empty
+	/// asset right away and only finds out about failures later, so it takes the entry back out with Remove
+	/// </summary>
+	/// <param name="key">The key to look up, see AssetManager::MakeKey</param>
+	/// <param name="load">The function to call to load the asset if it is not in the cache</param>
+	sptr GetOrLoad(const std::string& key, const std::function<sptr()>& load) {
+		auto it = _assets.find(key);
+		if (it != _assets.end()) {
+			_hits++;
+			return it->second;
+		}
+		_misses++;
+		sptr result = load();
+		if (result != nullptr) {
+			_assets[key] = result;
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Removes the entry for the given key, as long as it still holds the given asset. Anyone already holding the asset
+	/// keeps it, but the next request for the key will load it again
+	/// </summary>
+	/// <returns>True if the entry was removed</returns>
+	bool Remove(const std::string& key, const sptr& asset) {
+		auto it = _assets.find(key);
+		if (it == _assets.end() || it->second != asset) {
+			return false;
+		}
+		_assets.erase(it);
+		return true;
+	}
+
+	/// <summary>
+	/// Removes every asset that is no longer referenced outside of the cache
+	/// </summary>
+	/// <returns>The number of assets that were released</returns>
+	size_t ReleaseUnused() {
+		size_t released = 0;
+		for (auto it = _assets.begin(); it != _assets.end(); ) {
+			if (it->second.use_count() == 1) {
+				it = _assets.erase(it);
+				released++;
+			} else {
+				++it;
+			}
+		}
+		return released;
+	}
+
+	/// <summary>
+	/// Drops the cache's reference to every asset and resets the statistics. Assets that are still in use elsewhere
+	/// will stay alive, but will be loaded again the next time they are requested
+	/// </summary>
+	void Clear() {
+		_assets.clear();
+		_hits = 0;
+		_misses = 0;
+	}
+
+	/// <summary>
+	/// Gets the number of references to the asset with the given key, not counting the cache itself
+	/// </summary>
+	size_t GetReferenceCount(const std::string& key) const {
+		auto it = _assets.find(key);
+		return it == _assets.end() ? 0 : static_cast<size_t>(it->second.use_count() - 1);
+	}
+
+	size_t GetCount() const { return _assets.size(); }
+	size_t GetHits() const { return _hits; }
+	size_t GetMisses() const { return _misses; }
+
+private:
+	std::unordered_map<std::string, sptr> _assets;
+	size_t _hits = 0;
+	size_t _misses = 0;
+};
+
+/// <summary>
+/// Keeps track of every mesh, texture and shader that has been loaded, so that an asset that is requested more than once
+/// is only read from disk and uploaded to the GPU a single time. Paths are canonicalized before lookup, so different
+/// spellings of the same file (ex: "images//a.png" and "images/a.png") share an entry.
+///
+/// ObjLoader::LoadFromFile and the AsyncLoader go through these caches automatically. Note that every caller gets the same
+/// object back, so a shared shader program also shares its uniform state, and a mesh that was first requested through
+/// the AsyncLoader may still be empty when it is handed out.
+///
+/// The caches are not thread safe, and should only be used from the main thread
+/// </summary>
+class AssetManager abstract
+{
+public:
+	static AssetCache<VertexArrayObject> Meshes;
+	static AssetCache<MeshLodGroup> MeshLods;
+	static AssetCache<Texture2D> Textures;
+	static AssetCache<Shader> Shaders;
+
+	/// <summary>
+	/// Loads a shader program from a vertex and fragment shader file, or returns the existing program if this pair
+	/// has already been loaded
+	/// </summary>
+	/// <param name="vertexPath">The path of the vertex shader source</param>
+	/// <param name="fragmentPath">The path of the fragment shader source</param>
+	static Shader::sptr LoadShader(const std::string& vertexPath, const std::string& fragmentPath);
+
+	/// <summary>
+	/// Gets the key that a mesh is stored under in the mesh cache
+	/// </summary>
+	static std::string MakeMeshKey(const std::string& path, const glm::vec4& inColor);
+	/// <summary>
+	/// Gets the key that a mesh's levels of detail are stored under in the LOD cache
+	/// </summary>
+	static std::string MakeMeshLodKey(const std::string& path, const glm::vec4& inColor, const std::vector<float>& triangleRatios);
+	/// <summary>
+	/// Gets the key that a texture is stored under in the texture cache
+	/// </summary>
+	static std::string MakeTextureKey(const std::string& path);
+	/// <summary>
+	/// Gets the key that a shader program is stored under in the shader cache
+	/// </summary>
+	static std::string MakeShaderKey(const std::string& vertexPath, const std::string& fragmentPath);
+
+	/// <summary>
+	/// Converts a path to an absolute, normalized form so that it can be used as a cache key
+	/// </summary>
+	static std::string GetCanonicalPath(const std::string& path);
+
+	/// <summary>
+	/// Releases every asset that is only being kept alive by the caches
+	/// </summary>
+	/// <returns>The total number of assets that were released</returns>
+	static size_t ReleaseUnused();
+	/// <summary>
+	/// Drops every cached asset and resets the statistics
+	/// </summary>
+	static void Clear();
+	/// <summary>
+	/// Logs the number of assets and the hit and miss counts for each cache
+	/// </summary>
+	static void LogStats();
+};
@@ -0,0 +1,361 @@
+#include "AsyncLoader.h"
+
+#include <chrono>
+#include <memory>
+
+#include "Logging.h"
+#include "ObjLoader.h"
+#include "MeshCache.h"
+#include "MemoryMappedFile.h"
+#include "MeshSimplifier.h"
+#include "AssetManager.h"
+
+std::vector<std::thread> AsyncLoader::_workers;
+bool AsyncLoader::_isRunning = false;
+
+std::mutex AsyncLoader::_jobMutex;
+std::condition_variable AsyncLoader::_jobReady;
+std::deque<AsyncLoader::PendingJob> AsyncLoader::_jobs;
+
+std::mutex AsyncLoader::_uploadMutex;
+std::condition_variable AsyncLoader::_uploadReady;
+std::deque<AsyncLoader::PendingUpload> AsyncLoader::_uploads;
+
+std::atomic<size_t> AsyncLoader::_pendingCount(0);
+
+// By default we'll allow 16 MB or 4ms of uploads per frame
+size_t AsyncLoader::_budgetBytes = 16 * 1024 * 1024;
+double AsyncLoader::_budgetMilliseconds = 4.0;
+
+namespace {
+	// The largest error to allow in a mesh's levels of detail, relative to the size of the mesh
+	constexpr float LOD_MAX_ERROR = 0.05f;
+	// Bump this whenever the simplifier's output changes, so that the levels of detail stored in mesh caches get rebuilt
+	constexpr uint64_t LOD_CACHE_VERSION = 2;
+
+	// Gets the key that a mesh's levels of detail are stored under in its mesh cache
+	uint64_t GetLodCacheKey(const std::vector<float>& triangleRatios) {
+		const uint64_t seed = MeshCache::Hash(&LOD_MAX_ERROR, sizeof(float), LOD_CACHE_VERSION);
+		return MeshCache::Hash(triangleRatios.data(), triangleRatios.size() * sizeof(float), seed);
+	}
+
+	// Gets the mesh cache variant for a mesh loaded with levels of detail, these are cached separately from the plain
+	// mesh so that loading a file both with and without levels doesn't keep replacing its cache
+	uint64_t GetLodCacheVariant(const glm::vec4& inColor, uint64_t lodKey) {
+		return MeshCache::Hash(&lodKey, sizeof(uint64_t), ObjLoader::GetCacheVariant(inColor));
+	}
+
+	// The vertex and index data of a mesh on a worker thread, either mapped straight from the mesh cache or parsed from the source file
+	struct PackedMeshData {
+		MemoryMappedFile File;
+		MeshBuilder<VertexPosNormTexColPacked> Builder;
+		const VertexPosNormTexColPacked* Vertices = nullptr;
+		size_t VertexCount = 0;
+		const uint32_t* Indices = nullptr;
+		size_t IndexCount = 0;
+		// The levels of detail that were stored in the mesh cache, if any
+		uint64_t LodKey = 0;
+		std::vector<MeshCacheLodView> Lods;
+
+		size_t GetByteSize() const { return VertexCount * sizeof(VertexPosNormTexColPacked) + IndexCount * sizeof(uint32_t); }
+	};
+
+	// Loads a mesh on a worker thread, if lodKey is non-zero the cache holding levels of detail simplified with that key is tried first
+	std::shared_ptr<PackedMeshData> LoadPackedMesh(const std::string& filename, const glm::vec4& inColor, uint64_t lodKey = 0) {
+		std::shared_ptr<PackedMeshData> result = std::make_shared<PackedMeshData>();
+		const uint64_t variant = ObjLoader::GetCacheVariant(inColor);
+
+		// If we have a valid cache for the mesh, we can hand the mapped file straight to the main thread
+		MeshCacheView view;
+		if ((lodKey != 0 && MeshCache::Open(filename, GetLodCacheVariant(inColor, lodKey), VertexPosNormTexColPacked::V_DECL, result->File, view)) ||
+			MeshCache::Open(filename, variant, VertexPosNormTexColPacked::V_DECL, result->File, view)) {
+			result->Vertices = static_cast<const VertexPosNormTexColPacked*>(view.Vertices);
+			result->VertexCount = view.VertexCount;
+			result->Indices = view.Indices;
+			result->IndexCount = view.IndexCount;
+			result->LodKey = view.LodKey;
+			result->Lods = std::move(view.Lods);
+		}
+		// Otherwise we parse the source file on this thread (the other workers are busy with their own files), and update the cache while we're at it
+		else {
+			ObjLoader::BuildCachedMesh(filename, result->Builder, inColor, 1);
+			result->Vertices = result->Builder.GetVertexDataPtr();
+			result->VertexCount = result->Builder.GetVertexCount();
+			result->Indices = result->Builder.GetIndexDataPtr();
+			result->IndexCount = result->Builder.GetIndexCount();
+		}
+		return result;
+	}
+
+	// Fills in an existing VAO with vertex and index data, returning the vertex buffer so that other VAOs can share it
+	VertexBuffer::sptr UploadMesh(const VertexArrayObject::sptr& vao, const std::vector<BufferAttribute>& layout,
+		const void* vertices, size_t vertexSize, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+	{
+		VertexBuffer::sptr vbo = VertexBuffer::Create();
+		vbo->LoadData(vertices, vertexSize, vertexCount);
+
+		IndexBuffer::sptr ebo = IndexBuffer::Create();
+		ebo->LoadIndices(indices, indexCount, vertexCount);
+
+		vao->AddVertexBuffer(vbo, layout);
+		vao->SetIndexBuffer(ebo);
+		return vbo;
+	}
+}
+
+void AsyncLoader::Init(size_t threadCount) {
+	LOG_ASSERT(!_isRunning, "AsyncLoader has already been initialized!");
+
+	if (threadCount == 0) {
+		// Leave a hardware thread for the main thread, since it still needs to render while we're loading
+		const size_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	_isRunning = true;
+	for (size_t ix = 0; ix < threadCount; ix++) {
+		_workers.emplace_back(&AsyncLoader::_WorkerMain);
+	}
+}
+
+void AsyncLoader::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_isRunning = false;
+		_jobs.clear();
+	}
+	_jobReady.notify_all();
+	for (std::thread& worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+
+	std::lock_guard<std::mutex> lock(_uploadMutex);
+	_uploads.clear();
+	_pendingCount = 0;
+}
+
+VertexArrayObject::sptr AsyncLoader::LoadMesh(const std::string& filename, const glm::vec4& inColor) {
+	// Only the first request for a mesh queues a load, the rest share its VAO
+	return AssetManager::Meshes.GetOrLoad(AssetManager::MakeMeshKey(filename, inColor), [&]() {
+		return _QueueMesh(filename, inColor);
+	});
+}
+
+MeshLodGroup::sptr AsyncLoader::LoadMeshLods(const std::string& filename, const std::vector<float>& triangleRatios, const glm::vec4& inColor) {
+	return AssetManager::MeshLods.GetOrLoad(AssetManager::MakeMeshLodKey(filename, inColor, triangleRatios), [&]() {
+		return _QueueMeshLods(filename, triangleRatios, inColor);
+	});
+}
+
+ArenaMesh::sptr AsyncLoader::LoadArenaMesh(const std::string& filename, const GeometryArena::sptr& arena, const glm::vec4& inColor) {
+	LOG_ASSERT(arena->GetVertexSize() == sizeof(VertexPosNormTexColPacked), "Geometry arena was created for a different vertex type");
+	ArenaMesh::sptr result = arena->CreateMesh();
+
+	_QueueJob(filename, [result, arena, filename, inColor]() {
+		std::shared_ptr<PackedMeshData> mesh = LoadPackedMesh(filename, inColor);
+		_QueueUpload(mesh->GetByteSize(), [result, arena, mesh]() {
+			arena->SetData(result, mesh->Vertices, mesh->VertexCount, mesh->Indices, mesh->IndexCount);
+		});
+	});
+
+	return result;
+}
+
+Texture2D::sptr AsyncLoader::LoadTexture(const std::string& filename) {
+	return AssetManager::Textures.GetOrLoad(AssetManager::MakeTextureKey(filename), [&]() {
+		return _QueueTexture(filename);
+	});
+}
+
+VertexArrayObject::sptr AsyncLoader::_QueueMesh(const std::string& filename, const glm::vec4& inColor) {
+	VertexArrayObject::sptr result = VertexArrayObject::Create();
+	const std::string key = AssetManager::MakeMeshKey(filename, inColor);
+
+	_QueueJob(filename, [result, filename, inColor]() {
+		std::shared_ptr<PackedMeshData> mesh = LoadPackedMesh(filename, inColor);
+		_QueueUpload(mesh->GetByteSize(), [result, mesh]() {
+			UploadMesh(result, VertexPosNormTexColPacked::V_DECL, mesh->Vertices, sizeof(VertexPosNormTexColPacked), mesh->VertexCount,
+				mesh->Indices, mesh->IndexCount);
+		});
+	}, [result, key]() {
+		// Take the empty mesh back out of the cache, so that the next request tries again
+		AssetManager::Meshes.Remove(key, result);
+	});
+
+	return result;
+}
+
+MeshLodGroup::sptr AsyncLoader::_QueueMeshLods(const std::string& filename, const std::vector<float>& triangleRatios, const glm::vec4& inColor) {
+	// The full detail level is handed out right away, so that renderers have something to draw while we're loading
+	MeshLodGroup::sptr result = MeshLodGroup::Create();
+	VertexArrayObject::sptr fullDetail = VertexArrayObject::Create();
+	result->AddLevel(fullDetail, 0.0f);
+	const std::string key = AssetManager::MakeMeshLodKey(filename, inColor, triangleRatios);
+
+	_QueueJob(filename, [result, fullDetail, filename, triangleRatios, inColor]() {
+		const uint64_t lodKey = GetLodCacheKey(triangleRatios);
+		std::shared_ptr<PackedMeshData> mesh = LoadPackedMesh(filename, inColor, lodKey);
+
+		// If the mesh cache already has levels that were simplified with the same settings we use those, otherwise we
+		// simplify the mesh now and save the levels into their own cache for next time
+		std::shared_ptr<std::vector<MeshLodData>> levels = std::make_shared<std::vector<MeshLodData>>();
+		if (mesh->LodKey == lodKey) {
+			for (const MeshCacheLodView& lod : mesh->Lods) {
+				levels->push_back({ std::vector<uint32_t>(lod.Indices, lod.Indices + lod.IndexCount), lod.Error });
+			}
+		} else if (mesh->VertexCount > 0) {
+			MeshSimplifier::GenerateLods(mesh->Indices, mesh->IndexCount, &mesh->Vertices[0].Position, sizeof(VertexPosNormTexColPacked), mesh->VertexCount,
+				triangleRatios, LOD_MAX_ERROR, *levels);
+			MeshCache::Save(filename, GetLodCacheVariant(inColor, lodKey), VertexPosNormTexColPacked::V_DECL, mesh->Vertices, sizeof(VertexPosNormTexColPacked),
+				mesh->VertexCount, mesh->Indices, mesh->IndexCount, lodKey, *levels);
+		}
+
+		size_t bytes = mesh->GetByteSize();
+		glm::vec3 center(0.0f);
+		float radius = 0.0f;
+		if (mesh->VertexCount > 0) {
+			MeshLodGroup::ComputeBounds(&mesh->Vertices[0].Position, sizeof(VertexPosNormTexColPacked), mesh->VertexCount, center, radius);
+		}
+		for (const MeshLodData& level : *levels) {
+			bytes += level.Indices.size() * sizeof(uint32_t);
+		}
+
+		_QueueUpload(bytes, [result, fullDetail, mesh, levels, center, radius]() {
+			VertexBuffer::sptr vbo = UploadMesh(fullDetail, VertexPosNormTexColPacked::V_DECL, mesh->Vertices, sizeof(VertexPosNormTexColPacked), mesh->VertexCount,
+				mesh->Indices, mesh->IndexCount);
+			for (const MeshLodData& level : *levels) {
+				IndexBuffer::sptr ebo = IndexBuffer::Create();
+				ebo->LoadIndices(level.Indices.data(), level.Indices.size(), mesh->VertexCount);
+
+				VertexArrayObject::sptr vao = VertexArrayObject::Create();
+				vao->AddVertexBuffer(vbo, VertexPosNormTexColPacked::V_DECL);
+				vao->SetIndexBuffer(ebo);
+				result->AddLevel(vao, level.Error);
+			}
+			result->SetBounds(center, radius);
+		});
+	}, [result, key]() {
+		AssetManager::MeshLods.Remove(key, result);
+	});
+
+	return result;
+}
+
+Texture2D::sptr AsyncLoader::_QueueTexture(const std::string& filename) {
+	Texture2D::sptr result = Texture2D::Create();
+
+	_QueueJob(filename, [result, filename]() {
+		Texture2DData::sptr data = Texture2DData::LoadFromFile(filename);
+		if (data == nullptr) {
+			throw std::runtime_error("Failed to load image");
+		}
+		_QueueUpload(data->GetDataSize(), [result, data]() {
+			result->LoadData(data);
+		});
+	}, [result, filename]() {
+		AssetManager::Textures.Remove(AssetManager::MakeTextureKey(filename), result);
+	});
+
+	return result;
+}
+
+void AsyncLoader::Update() {
+	using Clock = std::chrono::high_resolution_clock;
+	const auto start = Clock::now();
+	size_t bytesUploaded = 0;
+
+	while (true) {
+		PendingUpload upload;
+		{
+			std::lock_guard<std::mutex> lock(_uploadMutex);
+			if (_uploads.empty()) {
+				return;
+			}
+			// Always allow the first upload of the frame, even if it's larger than the budget
+			if (bytesUploaded > 0 && bytesUploaded + _uploads.front().Bytes > _budgetBytes) {
+				return;
+			}
+			upload = std::move(_uploads.front());
+			_uploads.pop_front();
+		}
+
+		_CompleteUpload(upload);
+		bytesUploaded += upload.Bytes;
+
+		if (std::chrono::duration<double, std::milli>(Clock::now() - start).count() >= _budgetMilliseconds) {
+			return;
+		}
+	}
+}
+
+void AsyncLoader::Flush() {
+	while (_pendingCount > 0) {
+		PendingUpload upload;
+		{
+			std::unique_lock<std::mutex> lock(_uploadMutex);
+			_uploadReady.wait(lock, []() { return !_uploads.empty() || _pendingCount == 0; });
+			if (_uploads.empty()) {
+				return;
+			}
+			upload = std::move(_uploads.front());
+			_uploads.pop_front();
+		}
+		_CompleteUpload(upload);
+	}
+}
+
+void AsyncLoader::SetUploadBudget(size_t bytesPerFrame, double millisecondsPerFrame) {
+	_budgetBytes = bytesPerFrame;
+	_budgetMilliseconds = millisecondsPerFrame;
+}
+
+void AsyncLoader::_QueueJob(const std::string& filename, std::function<void()>&& load, std::function<void()>&& onFailed) {
+	LOG_ASSERT(_isRunning, "AsyncLoader must be initialized before loading assets!");
+	_pendingCount++;
+	{
+		std::lock_guard<std::mutex> lock(_jobMutex);
+		_jobs.push_back({ filename, std::move(load), std::move(onFailed) });
+	}
+	_jobReady.notify_one();
+}
+
+void AsyncLoader::_QueueUpload(size_t bytes, std::function<void()>&& apply) {
+	{
+		std::lock_guard<std::mutex> lock(_uploadMutex);
+		_uploads.push_back({ bytes, std::move(apply) });
+	}
+	_uploadReady.notify_all();
+}
+
+void AsyncLoader::_CompleteUpload(PendingUpload& upload) {
+	// Failed loads are queued with their failure handler (if any) in place of the upload, so that they still get
+	// counted as complete on the main thread
+	if (upload.Apply) {
+		upload.Apply();
+	}
+	_pendingCount--;
+}
+
+void AsyncLoader::_WorkerMain() {
+	while (true) {
+		PendingJob job;
+		{
+			std::unique_lock<std::mutex> lock(_jobMutex);
+			_jobReady.wait(lock, []() { return !_isRunning || !_jobs.empty(); });
+			if (!_isRunning) {
+				return;
+			}
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		try {
+			job.Load();
+		}
+		catch (const std::exception& e) {
+			LOG_WARN("Failed to load \"{}\" in the background: {}", job.Filename, e.what());
+			_QueueUpload(0, std::move(job.OnFailed));
+		}
+	}
+}
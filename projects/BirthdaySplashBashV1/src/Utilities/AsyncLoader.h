@@ -0,0 +1,141 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include <GLM/glm.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/MeshLodGroup.h"
+#include "Graphics/GeometryArena.h"
+#include "Graphics/Texture2D.h"
+
+/// <summary>
+/// Loads meshes and textures in the background. Worker threads handle the file IO and decoding, and hand the
+/// results back to the main thread, which uploads them to the GPU in Update() while staying under a per-frame budget.
+///
+/// The load functions return an empty VAO or texture right away, which will be filled in once the upload happens.
+/// These can be handed to materials and renderers immediately, they simply draw nothing (or sample black) until
+/// they have finished loading
+/// </summary>
+class AsyncLoader abstract
+{
+public:
+	/// <summary>
+	/// Starts up the worker threads, must be called from the thread that owns the OpenGL context
+	/// </summary>
+	/// <param name="threadCount">The number of worker threads, or 0 to use all but one of the hardware threads</param>
+	static void Init(size_t threadCount = 0);
+	/// <summary>
+	/// Stops the worker threads, discarding any loads that have not completed yet
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Queues an OBJ file to be loaded in the background. If the mesh has already been requested, the existing VAO
+	/// is returned instead (see AssetManager)
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	/// <returns>An empty VAO that will receive the mesh data once it has been uploaded</returns>
+	static VertexArrayObject::sptr LoadMesh(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Queues an OBJ file to be loaded in the background, along with a set of simplified versions of it to use as levels
+	/// of detail (see MeshSimplifier). If the same LODs have already been requested, the existing group is returned instead.
+	/// The levels are saved in the mesh's cache along with the ratios, so the mesh is only simplified again when the
+	/// source file or the ratios change
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="triangleRatios">The fraction of the triangles to keep in each level, in decreasing order</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	/// <returns>A group with a single empty level, the rest of the levels are added once the mesh has been uploaded</returns>
+	static MeshLodGroup::sptr LoadMeshLods(const std::string& filename, const std::vector<float>& triangleRatios = { 0.5f, 0.25f, 0.1f },
+		const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Queues an OBJ file to be loaded in the background into a geometry arena, for drawing with an IndirectRenderer.
+	/// Unlike LoadMesh, arena meshes are not shared through the AssetManager, so each call loads its own copy
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="arena">The arena to load the mesh into, must have been created for VertexPosNormTexColPacked</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	/// <returns>An empty mesh that will receive its geometry once it has been uploaded</returns>
+	static ArenaMesh::sptr LoadArenaMesh(const std::string& filename, const GeometryArena::sptr& arena, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Queues an image to be loaded in the background. If the image has already been requested, the existing texture
+	/// is returned instead (see AssetManager)
+	/// </summary>
+	/// <param name="filename">The path of the image to load</param>
+	/// <returns>An empty texture that will receive the image once it has been uploaded</returns>
+	static Texture2D::sptr LoadTexture(const std::string& filename);
+
+	/// <summary>
+	/// Uploads finished loads to the GPU, call once per frame from the main thread. At least one upload is
+	/// always performed if one is ready, so that a single large asset can never stall the queue
+	/// </summary>
+	static void Update();
+	/// <summary>
+	/// Blocks until every load that has been queued so far has been uploaded, ignoring the upload budget
+	/// </summary>
+	static void Flush();
+
+	/// <summary>
+	/// Sets how much work Update() is allowed to do in a single frame
+	/// </summary>
+	/// <param name="bytesPerFrame">The maximum number of bytes to upload per frame</param>
+	/// <param name="millisecondsPerFrame">The maximum time to spend uploading per frame</param>
+	static void SetUploadBudget(size_t bytesPerFrame, double millisecondsPerFrame);
+
+	/// <summary>
+	/// Gets the number of loads that have been queued, but not yet uploaded
+	/// </summary>
+	static size_t GetPendingCount() { return _pendingCount; }
+	/// <summary>
+	/// Returns true if there are no loads in progress
+	/// </summary>
+	static bool IsIdle() { return _pendingCount == 0; }
+
+private:
+	// A file that is waiting to be loaded on a worker thread
+	struct PendingJob
+	{
+		std::string Filename;
+		std::function<void()> Load;
+		// Runs on the main thread if Load throws
+		std::function<void()> OnFailed;
+	};
+	// A decoded asset that is waiting to be uploaded on the main thread
+	struct PendingUpload
+	{
+		size_t Bytes;
+		std::function<void()> Apply;
+	};
+
+	static VertexArrayObject::sptr _QueueMesh(const std::string& filename, const glm::vec4& inColor);
+	static MeshLodGroup::sptr _QueueMeshLods(const std::string& filename, const std::vector<float>& triangleRatios, const glm::vec4& inColor);
+	static Texture2D::sptr _QueueTexture(const std::string& filename);
+	static void _QueueJob(const std::string& filename, std::function<void()>&& load, std::function<void()>&& onFailed = nullptr);
+	static void _QueueUpload(size_t bytes, std::function<void()>&& apply);
+	static void _CompleteUpload(PendingUpload& upload);
+	static void _WorkerMain();
+
+	static std::vector<std::thread> _workers;
+	static bool _isRunning;
+
+	static std::mutex _jobMutex;
+	static std::condition_variable _jobReady;
+	static std::deque<PendingJob> _jobs;
+
+	static std::mutex _uploadMutex;
+	static std::condition_variable _uploadReady;
+	static std::deque<PendingUpload> _uploads;
+
+	static std::atomic<size_t> _pendingCount;
+
+	static size_t _budgetBytes;
+	static double _budgetMilliseconds;
+};
@@ -46,6 +46,8 @@ void EnvironmentGenerator::GenerateEnvironment()
 			{
 				temp.push_back(Application::Instance().ActiveScene->CreateEntity(_objectsToSpawn[i] + (std::to_string(j + 1))));
 				temp[j].emplace<RendererComponent>().SetMesh(_vaosToSpawn[i]).SetMaterial(_materialsForSpawning[i]);
+				//Every copy shares a mesh and material, so they can all be drawn with one instanced draw call
+				temp[j].emplace<InstancedTag>();
 				//Randomly places
 				temp[j].get<Transform>().SetLocalPosition(glm::vec3(Util::GetRandomNumberBetween(_spawnFromAll[i],
 					_spawnToAll[i], _avoidFromAll[i], _avoidToAll[i]), 0.0f));
@@ -4,6 +4,7 @@
 #include <Utilities/ObjLoader.h>
 #include <Gameplay/RendererComponent.h>
 #include <Gameplay/Transform.h>
+#include <Gameplay/InstancedTag.h>
 #include <vector>
 
 #include "Utilities/Util.h"
@@ -14,7 +15,7 @@ public:
 	
 	//Regenerates environment with your settings
 	static void RegenerateEnvironment();
-	//Generates an environment with your settings
+	//Generates an environment with your settings, the spawned objects are drawn through an InstancedRenderer
 	static void GenerateEnvironment();
 	//Cleans up the environment using your settings
 	static void CleanEnvironment();
@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+/// <summary>
+/// Scrambles the bits of a 64 bit value, so that keys which only differ in a few low bits still end up spread
+/// across the whole table (this is the finalizer from splitmix64)
+/// </summary>
+inline uint64_t FlatHashMix(uint64_t value) {
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ull;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebull;
+	value ^= value >> 31;
+	return value;
+}
+
+/// <summary>
+/// The default hash for FlatHashMap, works for any key that can be converted to a 64 bit integer
+/// </summary>
+template <typename KeyType>
+struct FlatHash
+{
+	uint64_t operator()(const KeyType& key) const {
+		return FlatHashMix(static_cast<uint64_t>(key));
+	}
+};
+
+/// <summary>
+/// An open addressing hash map using linear probing. All of the entries live in a single contiguous array, so lookups
+/// touch one or two cache lines rather than chasing a node per entry like std::unordered_map. Meant for the hot
+/// insert-or-find loops in our mesh loaders, so entries cannot be removed individually, only cleared all at once.
+///
+/// Note that pointers to values are invalidated whenever the map grows
+/// </summary>
+/// <typeparam name="KeyType">The key type, must be default constructible and comparable with ==</typeparam>
+/// <typeparam name="ValueType">The value type, must be default constructible</typeparam>
+/// <typeparam name="Hash">A functor returning a 64 bit hash for a key, the low bits are used to pick the slot</typeparam>
+template <typename KeyType, typename ValueType, typename Hash = FlatHash<KeyType>>
+class FlatHashMap final
+{
+public:
+	FlatHashMap() = default;
+	/// <summary>
+	/// Creates a new map with enough room for the given number of entries
+	/// </summary>
+	explicit FlatHashMap(size_t expectedCount) { Reserve(expectedCount); }
+
+	/// <summary>
+	/// Makes sure that the given number of entries can be stored without the map having to grow
+	/// </summary>
+	void Reserve(size_t count) {
+		size_t capacity = MIN_CAPACITY;
+		while (capacity * MAX_LOAD_NUMERATOR < count * MAX_LOAD_DENOMINATOR) {
+			capacity <<= 1;
+		}
+		if (capacity > _slots.size()) {
+			_Rehash(capacity);
+		}
+	}
+
+	/// <summary>
+	/// Inserts a value for the given key if the key is not already in the map
+	/// </summary>
+	/// <returns>A pointer to the value stored for the key, and true if the value was inserted</returns>
+	std::pair<ValueType*, bool> TryEmplace(const KeyType& key, const ValueType& value) {
+		if ((_size + 1) * MAX_LOAD_DENOMINATOR > _slots.size() * MAX_LOAD_NUMERATOR) {
+			_Rehash(std::max(_slots.size() * 2, MIN_CAPACITY));
+		}
+		size_t ix = _hash(key) & _mask;
+		while (true) {
+			Slot& slot = _slots[ix];
+			if (!slot.Occupied) {
+				slot.Key = key;
+				slot.Value = value;
+				slot.Occupied = true;
+				_size++;
+				return std::make_pair(&slot.Value, true);
+			}
+			if (slot.Key == key) {
+				return std::make_pair(&slot.Value, false);
+			}
+			ix = (ix + 1) & _mask;
+		}
+	}
+
+	/// <summary>
+	/// Gets the value stored for the key, inserting a default constructed value if the key is not in the map
+	/// </summary>
+	ValueType& operator[](const KeyType& key) {
+		return *TryEmplace(key, ValueType()).first;
+	}
+
+	/// <summary>
+	/// Looks up the value stored for the given key
+	/// </summary>
+	/// <returns>A pointer to the value, or nullptr if the key is not in the map</returns>
+	ValueType* Find(const KeyType& key) {
+		return const_cast<ValueType*>(static_cast<const FlatHashMap*>(this)->Find(key));
+	}
+	const ValueType* Find(const KeyType& key) const {
+		if (_size == 0) {
+			return nullptr;
+		}
+		size_t ix = _hash(key) & _mask;
+		while (true) {
+			const Slot& slot = _slots[ix];
+			if (!slot.Occupied) {
+				return nullptr;
+			}
+			if (slot.Key == key) {
+				return &slot.Value;
+			}
+			ix = (ix + 1) & _mask;
+		}
+	}
+
+	bool Contains(const KeyType& key) const { return Find(key) != nullptr; }
+
+	/// <summary>
+	/// Removes every entry from the map, keeping the allocated storage
+	/// </summary>
+	void Clear() {
+		for (Slot& slot : _slots) {
+			slot.Occupied = false;
+		}
+		_size = 0;
+	}
+
+	size_t Size() const { return _size; }
+	bool Empty() const { return _size == 0; }
+	size_t Capacity() const { return _slots.size(); }
+
+private:
+	// The table is kept at most 3/4 full, past that the probe sequences start getting long
+	static constexpr size_t MAX_LOAD_NUMERATOR = 3;
+	static constexpr size_t MAX_LOAD_DENOMINATOR = 4;
+	static constexpr size_t MIN_CAPACITY = 16;
+
+	struct Slot {
+		KeyType   Key = KeyType();
+		ValueType Value = ValueType();
+		bool      Occupied = false;
+	};
+
+	// Re-inserts every entry into a new table, capacity must be a power of two
+	void _Rehash(size_t capacity) {
+		std::vector<Slot> old(capacity);
+		old.swap(_slots);
+		_mask = capacity - 1;
+		for (Slot& slot : old) {
+			if (slot.Occupied) {
+				size_t ix = _hash(slot.Key) & _mask;
+				while (_slots[ix].Occupied) {
+					ix = (ix + 1) & _mask;
+				}
+				_slots[ix] = std::move(slot);
+			}
+		}
+	}
+
+	std::vector<Slot> _slots;
+	size_t _size = 0;
+	size_t _mask = 0;
+	Hash   _hash;
+};
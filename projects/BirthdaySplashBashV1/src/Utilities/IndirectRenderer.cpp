@@ -0,0 +1,140 @@
+#include "IndirectRenderer.h"
+
+#include <algorithm>
+
+#include "Logging.h"
+#include "Gameplay/Transform.h"
+#include "Utilities/BackendHandler.h"
+
+IndirectRenderer::IndirectRenderer() :
+	_commandBuffer(IndirectBuffer::Create()),
+	_instanceBuffer(VertexBuffer::Create(GL_DYNAMIC_DRAW))
+{ }
+
+void IndirectRenderer::SetShaderVariant(const Shader::sptr& shader, const Shader::sptr& instanced) {
+	LOG_ASSERT(shader != nullptr && instanced != nullptr, "Both shaders must be set when registering an instanced variant");
+	_variants[shader.get()] = instanced;
+}
+
+void IndirectRenderer::Update(entt::registry& registry) {
+	_draws.clear();
+	_commands.clear();
+	_instances.clear();
+	_submissions.clear();
+
+	registry.view<ArenaRendererComponent, Transform>().each([&](entt::entity, ArenaRendererComponent& renderer, Transform& transform) {
+		if (renderer.Mesh == nullptr || renderer.Material == nullptr || !renderer.Mesh->IsLoaded()) {
+			return;
+		}
+		_draws.push_back({ renderer.Material->RenderLayer, renderer.Material->Shader.get(), &renderer.Material, renderer.Mesh->GetArena(),
+			renderer.Mesh.get(), { transform.WorldTransform(), transform.WorldNormalMatrix() } });
+	});
+
+	// Same ordering as the regular render groups, then by arena so each material only needs one submission, and by
+	// mesh so that entities sharing a mesh can share a command
+	std::sort(_draws.begin(), _draws.end(), [](const Draw& l, const Draw& r) {
+		if (l.RenderLayer != r.RenderLayer) return l.RenderLayer < r.RenderLayer;
+		if (l.Shader != r.Shader) return l.Shader < r.Shader;
+		if (*l.Material != *r.Material) return *l.Material < *r.Material;
+		if (l.Arena != r.Arena) return l.Arena < r.Arena;
+		return l.Mesh < r.Mesh;
+	});
+
+	const ArenaMesh* lastMesh = nullptr;
+	for (const Draw& draw : _draws) {
+		if (_submissions.empty() || _submissions.back().Material != *draw.Material || _submissions.back().Arena != draw.Arena) {
+			_submissions.push_back({ *draw.Material, draw.Arena, _commands.size(), 0 });
+			lastMesh = nullptr;
+		}
+		if (draw.Mesh == lastMesh) {
+			_commands.back().InstanceCount++;
+		} else {
+			DrawElementsIndirectCommand command;
+			command.Count = draw.Mesh->GetIndexCount();
+			command.InstanceCount = 1;
+			command.FirstIndex = draw.Mesh->GetFirstIndex();
+			command.BaseVertex = static_cast<int32_t>(draw.Mesh->GetBaseVertex());
+			command.BaseInstance = static_cast<uint32_t>(_instances.size());
+			_commands.push_back(command);
+			_submissions.back().CommandCount++;
+			lastMesh = draw.Mesh;
+		}
+		_instances.push_back(draw.Instance);
+	}
+
+	_commandBuffer->LoadData(_commands.data(), _commands.size());
+	_instanceBuffer->LoadData(_instances.data(), _instances.size());
+
+	// Make sure we have a VAO for every arena we're drawing from, arenas replace their buffers when they grow or compact
+	for (auto it = _bindings.begin(); it != _bindings.end(); ) {
+		const bool used = std::any_of(_submissions.begin(), _submissions.end(), [&](const Submission& s) { return s.Arena == it->first; });
+		it = used ? std::next(it) : _bindings.erase(it);
+	}
+	for (const Submission& submission : _submissions) {
+		ArenaBinding& binding = _bindings[submission.Arena];
+		if (binding.Vertices != submission.Arena->GetVertexBuffer() || binding.Indices != submission.Arena->GetIndexBuffer()) {
+			binding.Vertices = submission.Arena->GetVertexBuffer();
+			binding.Indices = submission.Arena->GetIndexBuffer();
+			binding.Vao = VertexArrayObject::Create();
+			binding.Vao->AddVertexBuffer(binding.Vertices, submission.Arena->GetLayout());
+			binding.Vao->SetIndexBuffer(binding.Indices);
+			binding.Vao->AddInstanceBuffer(_instanceBuffer, InstancedRenderer::InstanceData::V_DECL);
+		}
+	}
+}
+
+size_t IndirectRenderer::Render(const glm::mat4& view, const glm::mat4& projection) {
+	size_t drawCalls = 0;
+	Shader::sptr current = nullptr;
+	ShaderMaterial* currentMat = nullptr;
+	const glm::mat4 viewProjection = projection * view;
+
+	_commandBuffer->Bind();
+	for (const Submission& submission : _submissions) {
+		auto variant = _variants.find(submission.Material->Shader.get());
+		const bool instanced = variant != _variants.end();
+		const Shader::sptr& shader = instanced ? variant->second : submission.Material->Shader;
+
+		// If the shader has changed, set up it's uniforms
+		if (current != shader) {
+			current = shader;
+			BackendHandler::SetupShaderForFrame(current, view, projection);
+			currentMat = nullptr;
+		}
+		// If the material has changed, apply it
+		if (currentMat != submission.Material.get()) {
+			currentMat = submission.Material.get();
+			if (instanced) {
+				currentMat->Apply(current);
+			} else {
+				currentMat->Apply();
+			}
+		}
+
+		const ArenaBinding& binding = _bindings[submission.Arena];
+		binding.Vao->Bind();
+		if (instanced) {
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(submission.FirstCommand * sizeof(DrawElementsIndirectCommand)),
+				static_cast<GLsizei>(submission.CommandCount), 0);
+			VertexArrayObject::RecordDrawCall();
+			drawCalls++;
+		} else {
+			for (size_t ix = submission.FirstCommand; ix < submission.FirstCommand + submission.CommandCount; ix++) {
+				const DrawElementsIndirectCommand& command = _commands[ix];
+				for (uint32_t instance = 0; instance < command.InstanceCount; instance++) {
+					const InstancedRenderer::InstanceData& data = _instances[command.BaseInstance + instance];
+					current->SetUniformMatrix("u_ModelViewProjection", viewProjection * data.Model);
+					current->SetUniformMatrix("u_Model", data.Model);
+					current->SetUniformMatrix("u_NormalMatrix", data.NormalMatrix);
+					glDrawElementsBaseVertex(GL_TRIANGLES, command.Count, GL_UNSIGNED_INT, (void*)(command.FirstIndex * sizeof(uint32_t)), command.BaseVertex);
+					VertexArrayObject::RecordDrawCall();
+					drawCalls++;
+				}
+			}
+		}
+	}
+	VertexArrayObject::UnBind();
+	IndirectBuffer::UnBind();
+
+	return drawCalls;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Shader.h"
+#include "Graphics/GeometryArena.h"
+#include "Graphics/IndirectBuffer.h"
+#include "Gameplay/ShaderMaterial.h"
+#include "Gameplay/ArenaRendererComponent.h"
+#include "Utilities/InstancedRenderer.h"
+
+/// <summary>
+/// Draws the entities with an ArenaRendererComponent using glMultiDrawElementsIndirect. Every frame the entities are
+/// sorted by render layer, shader and material, and a draw command is written for each mesh (entities sharing a mesh
+/// become instances of one command). Each run of entities that share a material and arena is then submitted with a
+/// single call, no matter how many different meshes it contains.
+///
+/// The per-draw transforms are fed through the same per-instance attributes as the InstancedRenderer, with each
+/// command's base instance pointing at its transforms, so it uses the same instanced shader variants (see
+/// InstancedRenderer::SetShaderVariant). Materials whose shader has no variant are drawn one entity at a time
+/// </summary>
+class IndirectRenderer final
+{
+public:
+	typedef std::shared_ptr<IndirectRenderer> sptr;
+	static inline sptr Create() {
+		return std::make_shared<IndirectRenderer>();
+	}
+
+public:
+	IndirectRenderer();
+	IndirectRenderer(const IndirectRenderer& other) = delete;
+	IndirectRenderer& operator=(const IndirectRenderer& other) = delete;
+
+	/// <summary>
+	/// Registers the instanced version of a shader, materials using shader will be drawn with instanced instead. Only the
+	/// per-frame camera uniforms and the material are applied to the variant here, any scene level uniforms (such as the
+	/// lighting) must be kept in sync with shader by the caller
+	/// </summary>
+	/// <param name="shader">The shader that the materials use</param>
+	/// <param name="instanced">A shader with the same fragment stage, that takes its transforms per instance</param>
+	void SetShaderVariant(const Shader::sptr& shader, const Shader::sptr& instanced);
+
+	/// <summary>
+	/// Builds the draw commands for the entities in a registry, and uploads them along with their transforms
+	/// </summary>
+	/// <param name="registry">The registry to collect the entities from, world matrices must be up to date</param>
+	void Update(entt::registry& registry);
+
+	/// <summary>
+	/// Submits the commands built by the last Update. This will change the bound shader and material
+	/// </summary>
+	/// <param name="view">The camera's view matrix</param>
+	/// <param name="projection">The camera's projection matrix</param>
+	/// <returns>The number of draw calls that were made</returns>
+	size_t Render(const glm::mat4& view, const glm::mat4& projection);
+
+	/// <summary>
+	/// Returns the number of draw commands built by the last Update
+	/// </summary>
+	size_t GetCommandCount() const { return _commands.size(); }
+	/// <summary>
+	/// Returns the number of multi-draw calls that the last Update's commands are split into
+	/// </summary>
+	size_t GetSubmissionCount() const { return _submissions.size(); }
+
+private:
+	// An entity to draw this frame
+	struct Draw
+	{
+		int                                RenderLayer;
+		const Shader*                      Shader;
+		// Points at the entity's component, only valid during Update
+		const ShaderMaterial::sptr*        Material;
+		GeometryArena*                     Arena;
+		const ArenaMesh*                   Mesh;
+		InstancedRenderer::InstanceData    Instance;
+	};
+	// A run of commands that share a material and arena, submitted with one call
+	struct Submission
+	{
+		ShaderMaterial::sptr Material;
+		GeometryArena*       Arena;
+		size_t               FirstCommand;
+		size_t               CommandCount;
+	};
+	// A VAO that reads from an arena's buffers, plus our instance buffer
+	struct ArenaBinding
+	{
+		VertexArrayObject::sptr Vao;
+		VertexBuffer::sptr      Vertices;
+		IndexBuffer::sptr       Indices;
+	};
+
+	std::vector<Draw> _draws;
+	std::vector<DrawElementsIndirectCommand> _commands;
+	std::vector<InstancedRenderer::InstanceData> _instances;
+	std::vector<Submission> _submissions;
+
+	IndirectBuffer::sptr _commandBuffer;
+	VertexBuffer::sptr _instanceBuffer;
+	std::unordered_map<GeometryArena*, ArenaBinding> _bindings;
+	std::unordered_map<const Shader*, Shader::sptr> _variants;
+};
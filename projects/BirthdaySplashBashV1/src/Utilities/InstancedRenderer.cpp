@@ -0,0 +1,161 @@
+#include "InstancedRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Logging.h"
+#include "Gameplay/RendererComponent.h"
+#include "Gameplay/Transform.h"
+#include "Utilities/BackendHandler.h"
+
+InstancedRenderer::InstanceData* IRID = nullptr;
+
+const std::vector<BufferAttribute> InstancedRenderer::InstanceData::V_DECL = {
+	// A mat4 attribute is passed as 4 vec4 columns, in consecutive slots
+	BufferAttribute(4, 4, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->Model[0], AttribUsage::User0),
+	BufferAttribute(5, 4, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->Model[1], AttribUsage::User0),
+	BufferAttribute(6, 4, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->Model[2], AttribUsage::User0),
+	BufferAttribute(7, 4, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->Model[3], AttribUsage::User0),
+	// And a mat3 as 3 vec3 columns
+	BufferAttribute(8, 3, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->NormalMatrix[0], AttribUsage::User1),
+	BufferAttribute(9, 3, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->NormalMatrix[1], AttribUsage::User1),
+	BufferAttribute(10, 3, GL_FLOAT, false, sizeof(InstanceData), (size_t)&IRID->NormalMatrix[2], AttribUsage::User1),
+};
+
+void InstancedRenderer::SetShaderVariant(const Shader::sptr& shader, const Shader::sptr& instanced) {
+	LOG_ASSERT(shader != nullptr && instanced != nullptr, "Both shaders must be set when registering an instanced variant");
+	_variants[shader.get()] = instanced;
+}
+
+void InstancedRenderer::Update(entt::registry& registry, const glm::vec3& cameraPosition, const glm::mat4& projection) {
+	_instanceCount = 0;
+	for (auto& kvp : _batches) {
+		kvp.second.Instances.clear();
+	}
+
+	// Instances spawned together usually share a batch, so we remember the last one to skip most of the lookups
+	Batch* last = nullptr;
+	BatchKey lastKey = { nullptr, nullptr };
+	registry.view<InstancedTag, RendererComponent, Transform>().each([&](entt::entity, RendererComponent& renderer, Transform& transform) {
+		if (renderer.Mesh == nullptr || renderer.Material == nullptr) {
+			return;
+		}
+		renderer.UpdateLod(transform, cameraPosition, projection);
+
+		const BatchKey key = { renderer.Mesh.get(), renderer.Material.get() };
+		if (last == nullptr || !(key == lastKey)) {
+			auto it = _batches.find(key);
+			if (it == _batches.end()) {
+				it = _batches.emplace(key, Batch()).first;
+				it->second.Mesh = renderer.Mesh;
+				it->second.Material = renderer.Material;
+				if (_variants.find(renderer.Material->Shader.get()) == _variants.end()) {
+					LOG_WARN("Material \"{}\" has no instanced shader variant, its instances will be drawn one at a time", renderer.Material->DebugName);
+				}
+			}
+			last = &it->second;
+			lastKey = key;
+		}
+		last->Instances.push_back({ transform.WorldTransform(), transform.WorldNormalMatrix() });
+		_instanceCount++;
+	});
+
+	// Release the batches that have no instances left, and upload the rest
+	_sorted.clear();
+	for (auto it = _batches.begin(); it != _batches.end(); ) {
+		if (it->second.Instances.empty()) {
+			it = _batches.erase(it);
+			continue;
+		}
+		_PrepareBatch(it->second);
+		if (it->second.Vao != nullptr) {
+			_sorted.push_back(&it->second);
+		}
+		++it;
+	}
+
+	// Same ordering as the regular render groups, so that layers still draw in order
+	std::sort(_sorted.begin(), _sorted.end(), [](const Batch* l, const Batch* r) {
+		if (l->Material->RenderLayer != r->Material->RenderLayer) return l->Material->RenderLayer < r->Material->RenderLayer;
+		if (l->Material->Shader != r->Material->Shader) return l->Material->Shader < r->Material->Shader;
+		return l->Material < r->Material;
+	});
+}
+
+size_t InstancedRenderer::Render(const glm::mat4& view, const glm::mat4& projection) {
+	size_t drawCalls = 0;
+	Shader::sptr current = nullptr;
+	ShaderMaterial* currentMat = nullptr;
+	const glm::mat4 viewProjection = projection * view;
+
+	for (Batch* batch : _sorted) {
+		auto variant = _variants.find(batch->Material->Shader.get());
+		const bool instanced = variant != _variants.end();
+		const Shader::sptr& shader = instanced ? variant->second : batch->Material->Shader;
+
+		// If the shader has changed, set up it's uniforms
+		if (current != shader) {
+			current = shader;
+			BackendHandler::SetupShaderForFrame(current, view, projection);
+			currentMat = nullptr;
+		}
+		// If the material has changed, apply it
+		if (currentMat != batch->Material.get()) {
+			currentMat = batch->Material.get();
+			if (instanced) {
+				currentMat->Apply(current);
+			} else {
+				currentMat->Apply();
+			}
+		}
+
+		if (instanced) {
+			batch->Vao->RenderInstanced(static_cast<GLsizei>(batch->Instances.size()));
+			drawCalls++;
+		} else {
+			for (const InstanceData& instance : batch->Instances) {
+				current->SetUniformMatrix("u_ModelViewProjection", viewProjection * instance.Model);
+				current->SetUniformMatrix("u_Model", instance.Model);
+				current->SetUniformMatrix("u_NormalMatrix", instance.NormalMatrix);
+				batch->Mesh->Render();
+				drawCalls++;
+			}
+		}
+	}
+
+	return drawCalls;
+}
+
+void InstancedRenderer::Clear() {
+	_sorted.clear();
+	_batches.clear();
+	_instanceCount = 0;
+}
+
+void InstancedRenderer::_PrepareBatch(Batch& batch) {
+	// Meshes that are still streaming in have no buffers yet, we'll pick them up once they've loaded
+	const size_t meshBufferCount = batch.Mesh->GetVertexBufferCount();
+	if (meshBufferCount == 0) {
+		return;
+	}
+
+	// Make a VAO that reads the same vertex and index buffers as the mesh, plus our instance buffer
+	if (batch.Vao == nullptr || batch.MeshBufferCount != meshBufferCount) {
+		batch.InstanceBuffer = VertexBuffer::Create(GL_DYNAMIC_DRAW);
+		batch.Vao = VertexArrayObject::Create();
+		for (size_t ix = 0; ix < meshBufferCount; ix++) {
+			batch.Vao->AddVertexBuffer(batch.Mesh->GetVertexBuffer(ix), batch.Mesh->GetVertexBufferAttributes(ix));
+		}
+		batch.Vao->SetIndexBuffer(batch.Mesh->GetIndexBuffer());
+		batch.Vao->AddInstanceBuffer(batch.InstanceBuffer, InstanceData::V_DECL);
+		batch.MeshBufferCount = meshBufferCount;
+		batch.Uploaded.clear();
+	}
+
+	// Most instanced props never move, so we only upload when something has actually changed since last frame
+	if (batch.Instances.size() != batch.Uploaded.size() ||
+		std::memcmp(batch.Instances.data(), batch.Uploaded.data(), batch.Instances.size() * sizeof(InstanceData)) != 0) {
+		batch.InstanceBuffer->LoadData(batch.Instances.data(), batch.Instances.size());
+		batch.Uploaded = batch.Instances;
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Shader.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Gameplay/ShaderMaterial.h"
+#include "Gameplay/InstancedTag.h"
+
+/// <summary>
+/// Draws the entities tagged with InstancedTag using hardware instancing. Every frame the instanced entities are
+/// collected into batches by mesh and material, their world transforms are uploaded into a per-instance buffer, and
+/// each batch is drawn with a single glDrawElementsInstanced call.
+///
+/// Instancing needs a vertex shader that reads its model matrix from the instance attributes instead of uniforms (see
+/// shaders/vertex_shader_instanced.glsl). Register the instanced variant of each shader with SetShaderVariant, batches
+/// whose shader has no variant are still drawn, but with one draw call per instance
+/// </summary>
+class InstancedRenderer final
+{
+public:
+	typedef std::shared_ptr<InstancedRenderer> sptr;
+	static inline sptr Create() {
+		return std::make_shared<InstancedRenderer>();
+	}
+
+	/// <summary>
+	/// The data uploaded for each instance, fed to the vertex shader through slots 4-10
+	/// </summary>
+	struct InstanceData
+	{
+		glm::mat4 Model;
+		glm::mat3 NormalMatrix;
+
+		static const std::vector<BufferAttribute> V_DECL;
+	};
+
+public:
+	InstancedRenderer() = default;
+	InstancedRenderer(const InstancedRenderer& other) = delete;
+	InstancedRenderer& operator=(const InstancedRenderer& other) = delete;
+
+	/// <summary>
+	/// Registers the instanced version of a shader, materials using shader will be drawn with instanced instead
+	/// </summary>
+	/// <param name="shader">The shader that the materials use</param>
+	/// <param name="instanced">A shader with the same fragment stage, that takes its transforms per instance</param>
+	void SetShaderVariant(const Shader::sptr& shader, const Shader::sptr& instanced);
+
+	/// <summary>
+	/// Collects the instanced entities in a registry into batches, and uploads their transforms. Entities with levels
+	/// of detail pick their level here, so each level gets its own batch
+	/// </summary>
+	/// <param name="registry">The registry to collect the entities from, world matrices must be up to date</param>
+	/// <param name="cameraPosition">The world space position of the camera, used to pick levels of detail</param>
+	/// <param name="projection">The camera's projection matrix, used to pick levels of detail</param>
+	void Update(entt::registry& registry, const glm::vec3& cameraPosition, const glm::mat4& projection);
+
+	/// <summary>
+	/// Draws all of the batches collected by the last Update. This will change the bound shader and material
+	/// </summary>
+	/// <param name="view">The camera's view matrix</param>
+	/// <param name="projection">The camera's projection matrix</param>
+	/// <returns>The number of draw calls that were made</returns>
+	size_t Render(const glm::mat4& view, const glm::mat4& projection);
+
+	/// <summary>
+	/// Returns the number of batches collected by the last Update
+	/// </summary>
+	size_t GetBatchCount() const { return _sorted.size(); }
+	/// <summary>
+	/// Returns the number of instances collected by the last Update
+	/// </summary>
+	size_t GetInstanceCount() const { return _instanceCount; }
+
+	/// <summary>
+	/// Releases all of the batches, and their GPU resources
+	/// </summary>
+	void Clear();
+
+protected:
+	// All of the instances of one mesh using one material
+	struct Batch
+	{
+		VertexArrayObject::sptr   Mesh;
+		ShaderMaterial::sptr      Material;
+		// A copy of the mesh's VAO, with the instance buffer added
+		VertexArrayObject::sptr   Vao;
+		VertexBuffer::sptr        InstanceBuffer;
+		// The number of vertex buffers the mesh had when Vao was made, meshes that are still loading have none
+		size_t                    MeshBufferCount = 0;
+		// The instances collected this frame, and the ones that were last uploaded
+		std::vector<InstanceData> Instances;
+		std::vector<InstanceData> Uploaded;
+	};
+
+	struct BatchKey
+	{
+		const VertexArrayObject* Mesh;
+		const ShaderMaterial*    Material;
+
+		bool operator ==(const BatchKey& other) const { return Mesh == other.Mesh && Material == other.Material; }
+	};
+
+	struct BatchKeyHash
+	{
+		size_t operator()(const BatchKey& key) const noexcept {
+			return std::hash<const void*>()(key.Mesh) ^ (std::hash<const void*>()(key.Material) * 31);
+		}
+	};
+
+	void _PrepareBatch(Batch& batch);
+
+	std::unordered_map<BatchKey, Batch, BatchKeyHash> _batches;
+	// The batches with instances this frame, in draw order
+	std::vector<Batch*> _sorted;
+	std::unordered_map<Shader*, Shader::sptr> _variants;
+	size_t _instanceCount = 0;
+};
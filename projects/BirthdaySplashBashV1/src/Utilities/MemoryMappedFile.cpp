@@ -0,0 +1,117 @@
+#include "MemoryMappedFile.h"
+
+#ifdef WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile() :
+	_data(nullptr),
+	_size(0),
+	_isOpen(false),
+	_fileHandle(nullptr),
+	_mappingHandle(nullptr)
+{ }
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) :
+	MemoryMappedFile()
+{
+	Open(path);
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+	Close();
+}
+
+bool MemoryMappedFile::Open(const std::string& path) {
+	Close();
+
+	#ifdef WINDOWS
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+	_fileHandle = file;
+	_size = static_cast<size_t>(size.QuadPart);
+
+	// Windows will refuse to create a mapping for an empty file, but an empty file is still a valid file
+	if (_size > 0) {
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			Close();
+			return false;
+		}
+		_mappingHandle = mapping;
+
+		_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (_data == nullptr) {
+			Close();
+			return false;
+		}
+	}
+	#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+	// We store the descriptor offset by one so that a null handle always means "no file"
+	_fileHandle = reinterpret_cast<void*>(static_cast<intptr_t>(fd) + 1);
+	_size = static_cast<size_t>(info.st_size);
+
+	if (_size > 0) {
+		void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			Close();
+			return false;
+		}
+		madvise(data, _size, MADV_SEQUENTIAL);
+		_data = static_cast<const char*>(data);
+	}
+	#endif
+
+	_isOpen = true;
+	return true;
+}
+
+void MemoryMappedFile::Close() {
+	#ifdef WINDOWS
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(_mappingHandle));
+	}
+	if (_fileHandle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(_fileHandle));
+	}
+	#else
+	if (_data != nullptr) {
+		munmap(const_cast<char*>(_data), _size);
+	}
+	if (_fileHandle != nullptr) {
+		close(static_cast<int>(reinterpret_cast<intptr_t>(_fileHandle) - 1));
+	}
+	#endif
+
+	_data = nullptr;
+	_size = 0;
+	_isOpen = false;
+	_fileHandle = nullptr;
+	_mappingHandle = nullptr;
+}
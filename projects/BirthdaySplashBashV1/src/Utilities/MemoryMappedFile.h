@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+/// <summary>
+/// Wraps a read-only memory mapping of a file on disk, allowing loaders to parse the file contents
+/// in place without copying them into intermediate strings or streams
+/// </summary>
+class MemoryMappedFile final
+{
+public:
+	// We'll disallow moving and copying, since the mapping is tied to the lifetime of this object
+	MemoryMappedFile(const MemoryMappedFile& other) = delete;
+	MemoryMappedFile(MemoryMappedFile&& other) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+	MemoryMappedFile& operator=(MemoryMappedFile&& other) = delete;
+
+	/// <summary>
+	/// Creates a new memory mapped file that is not yet attached to any file
+	/// </summary>
+	MemoryMappedFile();
+	/// <summary>
+	/// Creates a new memory mapped file and attempts to map the given path, see IsOpen()
+	/// </summary>
+	/// <param name="path">The path of the file to map</param>
+	explicit MemoryMappedFile(const std::string& path);
+	~MemoryMappedFile();
+
+	/// <summary>
+	/// Maps the given file into memory for reading, closing any previously mapped file
+	/// </summary>
+	/// <param name="path">The path of the file to map</param>
+	/// <returns>True if the file was mapped, false if it could not be opened</returns>
+	bool Open(const std::string& path);
+	/// <summary>
+	/// Unmaps the file and releases all handles associated with it
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// Returns true if a file is currently mapped (note that an empty file is open, but has no data)
+	/// </summary>
+	bool IsOpen() const { return _isOpen; }
+	/// <summary>
+	/// Gets a pointer to the first byte of the mapped file, or nullptr if the file is empty
+	/// </summary>
+	const char* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the mapped file, in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+
+private:
+	const char* _data;
+	size_t      _size;
+	bool        _isOpen;
+
+	// Platform specific handles (HANDLEs on windows, a file descriptor otherwise)
+	void* _fileHandle;
+	void* _mappingHandle;
+};
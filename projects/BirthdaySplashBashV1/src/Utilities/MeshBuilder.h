@@ -1,6 +1,12 @@
 #pragma once
 #include <vector>
+#include <algorithm>
+#include "Logging.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/MeshLodGroup.h"
+#include "Graphics/GeometryArena.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 
 template <typename VertType>
 class MeshBuilder
@@ -43,7 +49,6 @@ public:
 	/// <param name="c">The index of the third vertex</param>
 	void AddIndexTri(uint32_t a, uint32_t b, uint32_t c)
 	{
-		ReserveIndexSpace(3);
 		_indices.push_back(a);
 		_indices.push_back(b);
 		_indices.push_back(c);
@@ -55,7 +60,7 @@ public:
 	/// </summary>
 	/// <param name="extendAmount">The number of vertices to reserve space for</param>
 	void ReserveVertexSpace(size_t extendAmount) {
-		_vertices.reserve(_vertices.size() + extendAmount);
+		_ReserveGrowth(_vertices, extendAmount);
 	}
 	/// <summary>
 	/// Resizes the internal vector to allocate space for new indices, can improve
@@ -63,7 +68,7 @@ public:
 	/// </summary>
 	/// <param name="extendAmount">The number of indices to reserve space for</param>
 	void ReserveIndexSpace(size_t extendAmount) {
-		_indices.reserve(_indices.size() + extendAmount);
+		_ReserveGrowth(_indices, extendAmount);
 	}
 
 	/// <summary>
@@ -81,12 +86,105 @@ public:
 	/// </summary>
 	size_t GetTriangleCount() const { return _indices.size() > 0 ? _indices.size() / 3 : _vertices.size() / 3; }
 
+	/// <summary>
+	/// Reorders the triangles and vertices in this mesh so that it makes better use of the GPU's vertex cache, see
+	/// MeshOptimizer. This is pure CPU work with a deterministic result, and only applies to indexed meshes
+	/// </summary>
+	/// <param name="reduceOverdraw">True to also sort clusters of triangles so that the outside of the mesh is drawn first</param>
+	/// <returns>The vertex cache statistics of the mesh before and after optimizing</returns>
+	MeshOptimizationStats Optimize(bool reduceOverdraw = false) {
+		MeshOptimizationStats result;
+		if (_indices.empty()) {
+			return result;
+		}
+		result.Before = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+
+		MeshOptimizer::OptimizeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		if (reduceOverdraw) {
+			MeshOptimizer::OptimizeOverdraw(_indices.data(), _indices.size(), &_vertices[0].Position, sizeof(VertType), _vertices.size());
+		}
+
+		std::vector<uint32_t> remap;
+		MeshOptimizer::OptimizeVertexFetch(_indices.data(), _indices.size(), _vertices.size(), remap);
+		std::vector<VertType> vertices(_vertices.size());
+		for (size_t ix = 0; ix < _vertices.size(); ix++) {
+			vertices[remap[ix]] = _vertices[ix];
+		}
+		_vertices.swap(vertices);
+
+		result.After = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		return result;
+	}
+
+	/// <summary>
+	/// Creates a copy of this mesh using a different vertex format, such as one of the packed vertex types
+	/// </summary>
+	/// <typeparam name="OutType">The vertex type to convert to, must be constructible from VertType</typeparam>
+	template <typename OutType>
+	MeshBuilder<OutType> ConvertTo() const {
+		MeshBuilder<OutType> result;
+		result._vertices.reserve(_vertices.size());
+		for (const VertType& vertex : _vertices) {
+			result._vertices.emplace_back(vertex);
+		}
+		result._indices = _indices;
+		return result;
+	}
+
+	/// <summary>
+	/// Generates simplified versions of this mesh for use as levels of detail, see MeshSimplifier::GenerateLods. Only
+	/// applies to indexed meshes
+	/// </summary>
+	/// <param name="triangleRatios">The fraction of the triangles to keep in each level, in decreasing order</param>
+	/// <param name="maxError">The largest error to allow in any level, relative to the size of the mesh</param>
+	/// <returns>The index buffers for each level, which refer to this mesh's vertices</returns>
+	std::vector<MeshLodData> GenerateLods(const std::vector<float>& triangleRatios, float maxError = 0.05f) const {
+		std::vector<MeshLodData> result;
+		if (!_indices.empty()) {
+			MeshSimplifier::GenerateLods(_indices.data(), _indices.size(), &_vertices[0].Position, sizeof(VertType), _vertices.size(),
+				triangleRatios, maxError, result);
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Bakes this mesh along with a set of simplified versions of it, all of the levels share a single vertex buffer
+	/// </summary>
+	/// <param name="triangleRatios">The fraction of the triangles to keep in each level, in decreasing order</param>
+	/// <param name="maxError">The largest error to allow in any level, relative to the size of the mesh</param>
+	MeshLodGroup::sptr BakeLods(const std::vector<float>& triangleRatios, float maxError = 0.05f) {
+		VertexBuffer::sptr vbo = VertexBuffer::Create();
+		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
+
+		std::vector<MeshLodData> levels = GenerateLods(triangleRatios, maxError);
+		levels.insert(levels.begin(), MeshLodData{ _indices, 0.0f });
+
+		MeshLodGroup::sptr result = MeshLodGroup::Create();
+		for (const MeshLodData& level : levels) {
+			IndexBuffer::sptr ebo = IndexBuffer::Create();
+			ebo->LoadIndices(level.Indices.data(), level.Indices.size(), _vertices.size());
+
+			VertexArrayObject::sptr vao = VertexArrayObject::Create();
+			vao->AddVertexBuffer(vbo, VertType::V_DECL);
+			vao->SetIndexBuffer(ebo);
+			result->AddLevel(vao, level.Error);
+		}
+
+		if (!_vertices.empty()) {
+			glm::vec3 center;
+			float radius;
+			MeshLodGroup::ComputeBounds(&_vertices[0].Position, sizeof(VertType), _vertices.size(), center, radius);
+			result->SetBounds(center, radius);
+		}
+		return result;
+	}
+
 	VertexArrayObject::sptr Bake() {
 		VertexBuffer::sptr vbo = VertexBuffer::Create();
 		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
 
 		IndexBuffer::sptr ebo = IndexBuffer::Create();
-		ebo->LoadData(GetIndexDataPtr(), _indices.size());
+		ebo->LoadIndices(GetIndexDataPtr(), _indices.size(), _vertices.size());
 
 		VertexArrayObject::sptr result = VertexArrayObject::Create();
 		result->AddVertexBuffer(vbo, VertType::V_DECL);
@@ -94,6 +192,16 @@ public:
 
 		return result;
 	}
+
+	/// <summary>
+	/// Uploads this mesh into a geometry arena instead of its own buffers, so that it can be drawn by an IndirectRenderer.
+	/// Only applies to indexed meshes
+	/// </summary>
+	/// <param name="arena">The arena to upload to, must have been created for VertType</param>
+	ArenaMesh::sptr BakeToArena(const GeometryArena::sptr& arena) const {
+		LOG_ASSERT(arena->GetVertexSize() == sizeof(VertType), "Geometry arena was created for a different vertex type");
+		return arena->Allocate(GetVertexDataPtr(), _vertices.size(), GetIndexDataPtr(), _indices.size());
+	}
 	
 	/// <summary>
 	/// Gets a pointer to the underlying vertex data in the mesh, valid only
@@ -111,7 +219,19 @@ public:
 	}
 	
 protected:
+	// Reserving exactly the requested space would re-allocate on every call when appending many small meshes, so we
+	// grow by at least double the current capacity like push_back would
+	template <typename T>
+	static void _ReserveGrowth(std::vector<T>& vector, size_t extendAmount) {
+		const size_t required = vector.size() + extendAmount;
+		if (required > vector.capacity()) {
+			vector.reserve(std::max(required, vector.capacity() * 2));
+		}
+	}
+
 	friend class MeshFactory;
+	friend class ObjLoader;
+	template <typename OtherType> friend class MeshBuilder;
 	
 	std::vector<VertType> _vertices;
 	std::vector<uint32_t> _indices;
@@ -0,0 +1,331 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Logging.h"
+
+namespace {
+	// Bump this whenever the layout of the file changes, so that old caches get rebuilt
+	constexpr uint32_t MESH_CACHE_VERSION = 2;
+	constexpr char     MESH_CACHE_MAGIC[4] = { 'O', 'T', 'M', 'S' };
+	// Vertex and index data are aligned to this many bytes within the file
+	constexpr size_t   MESH_CACHE_ALIGNMENT = 16;
+
+	/*
+	 * The layout of an .otmesh file is:
+	 *    MeshCacheHeader
+	 *    MeshCacheAttribute[AttributeCount]
+	 *    (padding to MESH_CACHE_ALIGNMENT)
+	 *    Vertex data [VertexCount * VertexSize]
+	 *    (padding to MESH_CACHE_ALIGNMENT)
+	 *    Index data [IndexCount * sizeof(uint32_t)]
+	 *    (padding to MESH_CACHE_ALIGNMENT)
+	 *    MeshCacheLod[LodCount]
+	 *    Index data for each level of detail, in order [MeshCacheLod::IndexCount * sizeof(uint32_t)]
+	 */
+	struct MeshCacheHeader {
+		char     Magic[4];
+		uint32_t Version;
+		// The key identifying the source this cache was built from
+		uint64_t PathHash;
+		uint64_t SourceSize;
+		int64_t  SourceTime;
+		uint64_t SourceHash;
+		uint64_t Variant;
+		// The description of the data stored in the file
+		uint32_t AttributeCount;
+		uint32_t VertexSize;
+		uint64_t VertexCount;
+		uint64_t IndexCount;
+		uint64_t VertexOffset;
+		uint64_t IndexOffset;
+		// The levels of detail stored after the mesh, and the key they were simplified with
+		uint64_t LodKey;
+		uint64_t LodCount;
+		uint64_t LodOffset;
+		// A hash of everything after the header, used to detect truncated or corrupted files
+		uint64_t PayloadHash;
+	};
+
+	struct MeshCacheAttribute {
+		uint32_t Slot;
+		uint32_t Size;
+		uint32_t Type;
+		uint32_t Normalized;
+		uint32_t Stride;
+		uint32_t Offset;
+		uint32_t Usage;
+		uint32_t Padding;
+	};
+
+	struct MeshCacheLod {
+		uint64_t IndexOffset;
+		uint64_t IndexCount;
+		float    Error;
+		uint32_t Padding;
+	};
+
+	inline size_t AlignUp(size_t value) {
+		return (value + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1);
+	}
+
+	MeshCacheAttribute ToCacheAttribute(const BufferAttribute& attrib) {
+		MeshCacheAttribute result;
+		memset(&result, 0, sizeof(MeshCacheAttribute));
+		result.Slot = attrib.Slot;
+		result.Size = static_cast<uint32_t>(attrib.Size);
+		result.Type = attrib.Type;
+		result.Normalized = attrib.Normalized ? 1 : 0;
+		result.Stride = static_cast<uint32_t>(attrib.Stride);
+		result.Offset = static_cast<uint32_t>(attrib.Offset);
+		result.Usage = static_cast<uint32_t>(attrib.Usage);
+		return result;
+	}
+
+	// Fills in the part of the header that identifies the source file, returns false if the source could not be read
+	bool GetSourceKey(const std::string& sourcePath, MeshCacheHeader& header) {
+		std::error_code error;
+		auto time = std::filesystem::last_write_time(sourcePath, error);
+		if (error) {
+			return false;
+		}
+
+		MemoryMappedFile source(sourcePath);
+		if (!source.IsOpen()) {
+			return false;
+		}
+
+		header.PathHash = MeshCache::Hash(sourcePath.data(), sourcePath.size());
+		header.SourceSize = source.GetSize();
+		header.SourceTime = static_cast<int64_t>(time.time_since_epoch().count());
+		header.SourceHash = MeshCache::Hash(source.GetData(), source.GetSize());
+		return true;
+	}
+
+	// Gets a temporary file name that no other save will use, since two loader threads (or two copies of the game) may
+	// be writing the same cache at once
+	std::string GetTempPath(const std::string& cachePath) {
+		static std::atomic<uint64_t> counter(0);
+		const uint64_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+		const uint64_t time = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+		const uint64_t unique = MeshCache::Hash(&thread, sizeof(uint64_t), time ^ counter.fetch_add(1));
+		return fmt::format("{}.{:016x}.tmp", cachePath, unique);
+	}
+}
+
+std::string MeshCache::GetCachePath(const std::string& sourcePath, uint64_t variant) {
+	return fmt::format("{}.{:016x}.otmesh", sourcePath, variant);
+}
+
+bool MeshCache::Open(const std::string& sourcePath, uint64_t variant, const std::vector<BufferAttribute>& layout, MemoryMappedFile& file, MeshCacheView& view)
+{
+	if (!file.Open(GetCachePath(sourcePath, variant))) {
+		return false;
+	}
+
+	// Make sure the header is intact and for this version of the format
+	if (file.GetSize() < sizeof(MeshCacheHeader)) {
+		file.Close();
+		return false;
+	}
+	MeshCacheHeader header;
+	memcpy(&header, file.GetData(), sizeof(MeshCacheHeader));
+	if (memcmp(header.Magic, MESH_CACHE_MAGIC, 4) != 0 || header.Version != MESH_CACHE_VERSION || header.Variant != variant) {
+		file.Close();
+		return false;
+	}
+
+	// Make sure the cache was built from the file as it is now
+	MeshCacheHeader source;
+	if (!GetSourceKey(sourcePath, source) ||
+		header.PathHash != source.PathHash ||
+		header.SourceSize != source.SourceSize ||
+		header.SourceTime != source.SourceTime ||
+		header.SourceHash != source.SourceHash) {
+		file.Close();
+		return false;
+	}
+
+	// Make sure all the data the header describes is actually in the file
+	if (header.AttributeCount > file.GetSize() || header.VertexCount > file.GetSize() || header.IndexCount > file.GetSize() || header.LodCount > file.GetSize()) {
+		LOG_WARN("Mesh cache \"{}\" is corrupt, it will be rebuilt", GetCachePath(sourcePath, variant));
+		file.Close();
+		return false;
+	}
+	const size_t attribEnd = sizeof(MeshCacheHeader) + header.AttributeCount * sizeof(MeshCacheAttribute);
+	const size_t vertexEnd = header.VertexOffset + header.VertexCount * header.VertexSize;
+	const size_t indexEnd  = header.IndexOffset + header.IndexCount * sizeof(uint32_t);
+	const size_t lodEnd    = header.LodOffset + header.LodCount * sizeof(MeshCacheLod);
+	bool isValid = attribEnd <= file.GetSize() && header.VertexOffset >= attribEnd && vertexEnd <= header.IndexOffset &&
+		indexEnd <= header.LodOffset && lodEnd <= file.GetSize();
+	// Each level's indices follow straight on from the level before it, and the last one ends the file
+	size_t levelEnd = lodEnd;
+	for (size_t ix = 0; isValid && ix < header.LodCount; ix++) {
+		MeshCacheLod lod;
+		memcpy(&lod, file.GetData() + header.LodOffset + ix * sizeof(MeshCacheLod), sizeof(MeshCacheLod));
+		isValid = lod.IndexOffset == levelEnd && lod.IndexCount <= file.GetSize();
+		levelEnd = lod.IndexOffset + lod.IndexCount * sizeof(uint32_t);
+	}
+	if (!isValid || levelEnd != file.GetSize() ||
+		header.PayloadHash != Hash(file.GetData() + sizeof(MeshCacheHeader), file.GetSize() - sizeof(MeshCacheHeader))) {
+		LOG_WARN("Mesh cache \"{}\" is corrupt, it will be rebuilt", GetCachePath(sourcePath, variant));
+		file.Close();
+		return false;
+	}
+
+	// Make sure that the vertices are in the format the caller is expecting
+	bool layoutMatches = header.AttributeCount == layout.size() && (layout.empty() || header.VertexSize == static_cast<uint32_t>(layout[0].Stride));
+	for (size_t ix = 0; layoutMatches && ix < layout.size(); ix++) {
+		MeshCacheAttribute expected = ToCacheAttribute(layout[ix]);
+		layoutMatches = memcmp(&expected, file.GetData() + sizeof(MeshCacheHeader) + ix * sizeof(MeshCacheAttribute), sizeof(MeshCacheAttribute)) == 0;
+	}
+	if (!layoutMatches) {
+		file.Close();
+		return false;
+	}
+
+	view.Vertices = file.GetData() + header.VertexOffset;
+	view.VertexCount = header.VertexCount;
+	view.VertexSize = header.VertexSize;
+	view.Indices = reinterpret_cast<const uint32_t*>(file.GetData() + header.IndexOffset);
+	view.IndexCount = header.IndexCount;
+	view.LodKey = header.LodKey;
+	view.Lods.resize(header.LodCount);
+	for (size_t ix = 0; ix < header.LodCount; ix++) {
+		MeshCacheLod lod;
+		memcpy(&lod, file.GetData() + header.LodOffset + ix * sizeof(MeshCacheLod), sizeof(MeshCacheLod));
+		view.Lods[ix].Indices = reinterpret_cast<const uint32_t*>(file.GetData() + lod.IndexOffset);
+		view.Lods[ix].IndexCount = lod.IndexCount;
+		view.Lods[ix].Error = lod.Error;
+	}
+	return true;
+}
+
+VertexArrayObject::sptr MeshCache::TryLoad(const std::string& sourcePath, uint64_t variant, const std::vector<BufferAttribute>& layout)
+{
+	MemoryMappedFile file;
+	MeshCacheView view;
+	if (!Open(sourcePath, variant, layout, file, view)) {
+		return nullptr;
+	}
+
+	// The mapped data is already in the exact format OpenGL wants, so we can upload it without any copies on our end
+	VertexBuffer::sptr vbo = VertexBuffer::Create();
+	vbo->LoadData(view.Vertices, view.VertexSize, view.VertexCount);
+
+	IndexBuffer::sptr ebo = IndexBuffer::Create();
+	ebo->LoadIndices(view.Indices, view.IndexCount, view.VertexCount);
+
+	VertexArrayObject::sptr result = VertexArrayObject::Create();
+	result->AddVertexBuffer(vbo, layout);
+	result->SetIndexBuffer(ebo);
+
+	return result;
+}
+
+bool MeshCache::Save(const std::string& sourcePath, uint64_t variant, const std::vector<BufferAttribute>& layout,
+	const void* vertices, size_t vertexSize, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+	uint64_t lodKey, const std::vector<MeshLodData>& lods)
+{
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(MeshCacheHeader));
+	if (!GetSourceKey(sourcePath, header)) {
+		return false;
+	}
+	memcpy(header.Magic, MESH_CACHE_MAGIC, 4);
+	header.Version = MESH_CACHE_VERSION;
+	header.Variant = variant;
+	header.AttributeCount = static_cast<uint32_t>(layout.size());
+	header.VertexSize = static_cast<uint32_t>(vertexSize);
+	header.VertexCount = vertexCount;
+	header.IndexCount = indexCount;
+	header.VertexOffset = AlignUp(sizeof(MeshCacheHeader) + layout.size() * sizeof(MeshCacheAttribute));
+	header.IndexOffset = AlignUp(header.VertexOffset + vertexCount * vertexSize);
+	header.LodKey = lodKey;
+	header.LodCount = lods.size();
+	header.LodOffset = AlignUp(header.IndexOffset + indexCount * sizeof(uint32_t));
+
+	// The levels' indices are packed one after another, straight after the table describing them
+	std::vector<MeshCacheLod> lodTable(lods.size());
+	size_t fileSize = header.LodOffset + lods.size() * sizeof(MeshCacheLod);
+	for (size_t ix = 0; ix < lods.size(); ix++) {
+		memset(&lodTable[ix], 0, sizeof(MeshCacheLod));
+		lodTable[ix].IndexOffset = fileSize;
+		lodTable[ix].IndexCount = lods[ix].Indices.size();
+		lodTable[ix].Error = lods[ix].Error;
+		fileSize += lods[ix].Indices.size() * sizeof(uint32_t);
+	}
+
+	// Build the payload in memory first so that we can hash it
+	std::vector<char> payload(fileSize - sizeof(MeshCacheHeader), 0);
+	for (size_t ix = 0; ix < layout.size(); ix++) {
+		MeshCacheAttribute attrib = ToCacheAttribute(layout[ix]);
+		memcpy(payload.data() + ix * sizeof(MeshCacheAttribute), &attrib, sizeof(MeshCacheAttribute));
+	}
+	if (vertexCount > 0) {
+		memcpy(payload.data() + header.VertexOffset - sizeof(MeshCacheHeader), vertices, vertexCount * vertexSize);
+	}
+	if (indexCount > 0) {
+		memcpy(payload.data() + header.IndexOffset - sizeof(MeshCacheHeader), indices, indexCount * sizeof(uint32_t));
+	}
+	for (size_t ix = 0; ix < lods.size(); ix++) {
+		memcpy(payload.data() + header.LodOffset + ix * sizeof(MeshCacheLod) - sizeof(MeshCacheHeader), &lodTable[ix], sizeof(MeshCacheLod));
+		if (!lods[ix].Indices.empty()) {
+			memcpy(payload.data() + lodTable[ix].IndexOffset - sizeof(MeshCacheHeader), lods[ix].Indices.data(), lods[ix].Indices.size() * sizeof(uint32_t));
+		}
+	}
+	header.PayloadHash = Hash(payload.data(), payload.size());
+
+	// We write to a temporary file and then move it over the cache, so that we never leave a half written cache behind
+	const std::string cachePath = GetCachePath(sourcePath, variant);
+	const std::string tempPath = GetTempPath(cachePath);
+	std::error_code error;
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			LOG_WARN("Failed to write mesh cache \"{}\"", cachePath);
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+		file.write(payload.data(), payload.size());
+		if (!file) {
+			LOG_WARN("Failed to write mesh cache \"{}\"", cachePath);
+			file.close();
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error) {
+		LOG_WARN("Failed to write mesh cache \"{}\": {}", cachePath, error.message());
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+uint64_t MeshCache::Hash(const void* data, size_t size, uint64_t seed)
+{
+	// This is FNV-1a, but consuming 8 bytes at a time with an extra shift to mix the high bits back down
+	const uint64_t prime = 0x100000001b3ull;
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = seed ^ (size * prime);
+
+	size_t ix = 0;
+	for (; ix + 8 <= size; ix += 8) {
+		uint64_t word;
+		memcpy(&word, bytes + ix, 8);
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 32;
+	}
+	for (; ix < size; ix++) {
+		hash = (hash ^ bytes[ix]) * prime;
+	}
+	return hash;
+}
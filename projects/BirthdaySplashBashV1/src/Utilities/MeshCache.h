@@ -0,0 +1,104 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Graphics/VertexArrayObject.h"
+#include "MeshBuilder.h"
+#include "MemoryMappedFile.h"
+#include "MeshSimplifier.h"
+
+/// <summary>
+/// A read-only view of a level of detail stored in a memory mapped .otmesh file, the indices refer to the vertices of
+/// the full detail mesh
+/// </summary>
+struct MeshCacheLodView
+{
+	const uint32_t* Indices    = nullptr;
+	size_t          IndexCount = 0;
+	float           Error      = 0.0f;
+};
+
+/// <summary>
+/// A read-only view of the mesh data stored in a memory mapped .otmesh file, the pointers are valid for as long
+/// as the mapped file stays open
+/// </summary>
+struct MeshCacheView
+{
+	const void*     Vertices    = nullptr;
+	size_t          VertexCount = 0;
+	size_t          VertexSize  = 0;
+	const uint32_t* Indices     = nullptr;
+	size_t          IndexCount  = 0;
+	// The key that the levels of detail were saved with, or 0 if the cache does not have any
+	uint64_t        LodKey      = 0;
+	std::vector<MeshCacheLodView> Lods;
+};
+
+/// <summary>
+/// Stores already de-duplicated vertex and index data in a binary .otmesh file next to the source asset, so that
+/// later loads can skip parsing entirely. Caches are keyed by the source path, size, modified time and contents,
+/// as well as a variant key for any loader options that change the output (such as the vertex color). Each variant
+/// gets its own file, so loading the same asset with different options does not keep replacing the cache.
+///
+/// A cache can also hold a set of levels of detail for the mesh, under their own key for the options that were used to
+/// simplify them (such as the triangle ratios). Loaders should fold that key into the variant as well, so that the
+/// levels don't replace the plain mesh's cache
+/// </summary>
+class MeshCache
+{
+public:
+	/// <summary>
+	/// Gets the path of the cache file that would be used for the given source file and loader variant
+	/// </summary>
+	static std::string GetCachePath(const std::string& sourcePath, uint64_t variant);
+
+	/// <summary>
+	/// Maps the cache for a source file and validates it against the source. The view is only valid while the
+	/// mapped file is open
+	/// </summary>
+	/// <param name="sourcePath">The path of the source asset the cache was built from</param>
+	/// <param name="variant">The loader specific key that the cache was saved with</param>
+	/// <param name="layout">The vertex declaration that the cached vertices must match</param>
+	/// <param name="file">The file to map the cache into</param>
+	/// <param name="view">Will receive pointers into the mapped data</param>
+	/// <returns>True if a valid cache was found, false if it is missing, stale or corrupt</returns>
+	static bool Open(const std::string& sourcePath, uint64_t variant, const std::vector<BufferAttribute>& layout, MemoryMappedFile& file, MeshCacheView& view);
+
+	/// <summary>
+	/// Attempts to load a mesh from the cache for the given source file, uploading the mapped data directly to the GPU
+	/// </summary>
+	/// <param name="sourcePath">The path of the source asset the cache was built from</param>
+	/// <param name="variant">The loader specific key that the cache was saved with</param>
+	/// <param name="layout">The vertex declaration that the cached vertices must match</param>
+	/// <returns>The loaded mesh, or nullptr if the cache is missing, stale or corrupt</returns>
+	static VertexArrayObject::sptr TryLoad(const std::string& sourcePath, uint64_t variant, const std::vector<BufferAttribute>& layout);
+
+	/// <summary>
+	/// Writes a cache file for the given source file. Failing to write the cache is not an error, the next load will
+	/// simply fall back to the source file again
+	/// </summary>
+	/// <param name="lodKey">The key to store the levels of detail under, should be non-zero if there are any levels</param>
+	/// <param name="lods">The levels of detail to store alongside the mesh, their indices refer to the given vertices</param>
+	/// <returns>True if the cache was written</returns>
+	static bool Save(const std::string& sourcePath, uint64_t variant, const std::vector<BufferAttribute>& layout,
+		const void* vertices, size_t vertexSize, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+		uint64_t lodKey = 0, const std::vector<MeshLodData>& lods = {});
+	template <typename VertType>
+	static bool Save(const std::string& sourcePath, uint64_t variant, const MeshBuilder<VertType>& mesh) {
+		return Save(sourcePath, variant, VertType::V_DECL, mesh.GetVertexDataPtr(), sizeof(VertType), mesh.GetVertexCount(),
+			mesh.GetIndexDataPtr(), mesh.GetIndexCount());
+	}
+
+	/// <summary>
+	/// Computes a fast 64 bit (non-cryptographic) hash of a block of memory
+	/// </summary>
+	/// <param name="data">The data to hash</param>
+	/// <param name="size">The size of the data, in bytes</param>
+	/// <param name="seed">A seed to combine into the hash, can be used to chain hashes together</param>
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+protected:
+	MeshCache() = default;
+	~MeshCache() = default;
+};
@@ -1,15 +1,164 @@
 #include "MeshFactory.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <GLM/gtx/euler_angles.hpp>
-#include <unordered_map>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
 
 #include "Logging.h"
+#include "FlatHashMap.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define MESH_FACTORY_SSE
+#endif
 
+#ifndef M_PI
 #define M_PI 3.14159265359f
+#endif
 
 typedef VertexPosNormTexCol Vertex;
 
-int AddMiddlePoint(uint32_t offset, glm::vec3 scale, glm::vec3 center, int a, int b, std::vector<Vertex>& vertices, std::unordered_map<uint64_t, uint32_t>& midpointCache)
+namespace {
+	// Batches that generate fewer vertices than this (per thread) will not be split up, since the overhead of spinning
+	// up threads would outweigh the gains
+	constexpr size_t PARALLEL_MIN_VERTICES = 64 * 1024;
+
+	const glm::vec4 WHITE = glm::vec4(1.0f);
+
+	/*
+	 * Appends count items with a fixed number of vertices and indices to a mesh, the caller should reserve the space
+	 * for them beforehand. Small batches are appended on the calling thread through a scratch buffer, so the mesh's
+	 * memory is only written once. Large batches are split into even ranges across threads, each writing straight into
+	 * its own slice of the resized buffers. Re-throws the first exception once all ranges have finished. The writer
+	 * must look like:
+	 *    void(size_t item, Vertex* vertices, uint32_t* indices, uint32_t baseVertex)
+	 */
+	template <typename Writer>
+	void AppendItems(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, size_t count, size_t verticesPerItem,
+		size_t indicesPerItem, size_t threadCount, const Writer& writer) {
+		if (threadCount == 0) {
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		threadCount = std::min(threadCount, std::max<size_t>(count * verticesPerItem / PARALLEL_MIN_VERTICES, 1));
+
+		const size_t firstVertex = vertices.size();
+		const size_t firstIndex = indices.size();
+		if (threadCount <= 1) {
+			std::vector<Vertex> scratchVertices(verticesPerItem);
+			std::vector<uint32_t> scratchIndices(indicesPerItem);
+			for (size_t ix = 0; ix < count; ix++) {
+				writer(ix, scratchVertices.data(), scratchIndices.data(), static_cast<uint32_t>(vertices.size()));
+				vertices.insert(vertices.end(), scratchVertices.begin(), scratchVertices.end());
+				indices.insert(indices.end(), scratchIndices.begin(), scratchIndices.end());
+			}
+			return;
+		}
+
+		vertices.resize(firstVertex + count * verticesPerItem);
+		indices.resize(firstIndex + count * indicesPerItem);
+		auto task = [&](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				writer(ix, &vertices[firstVertex + ix * verticesPerItem], &indices[firstIndex + ix * indicesPerItem],
+					static_cast<uint32_t>(firstVertex + ix * verticesPerItem));
+			}
+		};
+
+		const size_t rangeSize = (count + threadCount - 1) / threadCount;
+		std::vector<std::future<void>> futures;
+		futures.reserve(threadCount - 1);
+		for (size_t begin = rangeSize; begin < count; begin += rangeSize) {
+			futures.push_back(std::async(std::launch::async, task, begin, std::min(begin + rangeSize, count)));
+		}
+		task(0, rangeSize);
+		for (auto& future : futures) {
+			future.wait();
+		}
+		for (auto& future : futures) {
+			future.get();
+		}
+	}
+
+	// The corners, normals and UVs of each of the 24 vertices that AddCube emits, in the order it emits them
+	struct CubeVertex {
+		uint8_t Corner, Normal, UV;
+	};
+	constexpr CubeVertex CUBE_VERTICES[24] = {
+		{ 0, 4, 3 }, { 2, 4, 2 }, { 3, 4, 1 }, { 1, 4, 0 }, // Bottom
+		{ 6, 5, 0 }, { 4, 5, 1 }, { 5, 5, 2 }, { 7, 5, 3 }, // Top
+		{ 0, 0, 0 }, { 4, 0, 1 }, { 6, 0, 2 }, { 2, 0, 3 }, // Left
+		{ 3, 1, 0 }, { 7, 1, 1 }, { 5, 1, 2 }, { 1, 1, 3 }, // Right
+		{ 2, 3, 0 }, { 6, 3, 1 }, { 7, 3, 2 }, { 3, 3, 3 }, // Front
+		{ 1, 2, 0 }, { 5, 2, 1 }, { 4, 2, 2 }, { 0, 2, 3 }  // Back
+	};
+	const glm::vec3 CUBE_CORNERS[8] = {
+		glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(-0.5f,  0.5f, -0.5f), glm::vec3(0.5f,  0.5f, -0.5f),
+		glm::vec3(-0.5f, -0.5f,  0.5f), glm::vec3(0.5f, -0.5f,  0.5f), glm::vec3(-0.5f,  0.5f,  0.5f), glm::vec3(0.5f,  0.5f,  0.5f)
+	};
+	const glm::vec3 CUBE_NORMALS[6] = {
+		glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f)
+	};
+	const glm::vec2 CUBE_UVS[4] = {
+		glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f), glm::vec2(0.0f, 1.0f), glm::vec2(0.0f, 0.0f)
+	};
+
+	/*
+	 * Transforms the corners and face normals of a unit cube. The SIMD path does its multiplies and adds in the same
+	 * order as glm's mat4 * vec4 and mat3 * vec3, so that it gives bit for bit the same results as AddCube
+	 */
+	inline void TransformCube(const glm::mat4& transform, glm::vec3 corners[8], glm::vec3 normals[6]) {
+		#ifdef MESH_FACTORY_SSE
+		const __m128 c0 = _mm_loadu_ps(&transform[0][0]);
+		const __m128 c1 = _mm_loadu_ps(&transform[1][0]);
+		const __m128 c2 = _mm_loadu_ps(&transform[2][0]);
+		const __m128 c3 = _mm_loadu_ps(&transform[3][0]);
+		float result[4];
+		for (int ix = 0; ix < 8; ix++) {
+			const glm::vec3& p = CUBE_CORNERS[ix];
+			// (c0 * x + c1 * y) + (c2 * z + c3 * 1)
+			const __m128 a0 = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p.x)), _mm_mul_ps(c1, _mm_set1_ps(p.y)));
+			const __m128 a1 = _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p.z)), _mm_mul_ps(c3, _mm_set1_ps(1.0f)));
+			_mm_storeu_ps(result, _mm_add_ps(a0, a1));
+			corners[ix] = glm::vec3(result[0], result[1], result[2]);
+		}
+		for (int ix = 0; ix < 6; ix++) {
+			const glm::vec3& n = CUBE_NORMALS[ix];
+			// (c0 * x + c1 * y) + c2 * z, the w lane is ignored
+			const __m128 a0 = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(n.x)), _mm_mul_ps(c1, _mm_set1_ps(n.y)));
+			_mm_storeu_ps(result, _mm_add_ps(a0, _mm_mul_ps(c2, _mm_set1_ps(n.z))));
+			normals[ix] = glm::vec3(result[0], result[1], result[2]);
+		}
+		#else
+		for (int ix = 0; ix < 8; ix++) {
+			corners[ix] = transform * glm::vec4(CUBE_CORNERS[ix], 1.0f);
+		}
+		const glm::mat3 rotation = transform;
+		for (int ix = 0; ix < 6; ix++) {
+			normals[ix] = rotation * CUBE_NORMALS[ix];
+		}
+		#endif
+	}
+
+	// Writes center + normal * radii into a vertex's position, matching the scalar sphere functions exactly
+	inline void PlaceSphereVertex(Vertex& vertex, const glm::vec3& center, const glm::vec3& radii) {
+		#ifdef MESH_FACTORY_SSE
+		// The normal is followed by the UVs in the vertex, so loading 4 floats from it is safe, the last lane is ignored
+		const __m128 normal = _mm_loadu_ps(&vertex.Normal.x);
+		const __m128 result = _mm_add_ps(_mm_set_ps(0.0f, center.z, center.y, center.x), _mm_mul_ps(normal, _mm_set_ps(0.0f, radii.z, radii.y, radii.x)));
+		float out[4];
+		_mm_storeu_ps(out, result);
+		vertex.Position = glm::vec3(out[0], out[1], out[2]);
+		#else
+		vertex.Position = center + (vertex.Normal * radii);
+		#endif
+	}
+}
+
+int AddMiddlePoint(uint32_t offset, glm::vec3 scale, glm::vec3 center, int a, int b, std::vector<Vertex>& vertices, FlatHashMap<uint64_t, uint32_t>& midpointCache)
 {
 	uint64_t key = 0;
 	if (a < b) {
@@ -18,9 +167,9 @@ int AddMiddlePoint(uint32_t offset, glm::vec3 scale, glm::vec3 center, int a, in
 	else {
 		key = (static_cast<uint64_t>(b) << 32ul) | static_cast<uint64_t>(a);
 	}
-	auto it = midpointCache.find(key);
-	if (it != midpointCache.end())
-		return it->second;
+	const uint32_t* cached = midpointCache.Find(key);
+	if (cached != nullptr)
+		return *cached;
 	else {
 		Vertex p1 = vertices[a];
 		Vertex p2 = vertices[b];
@@ -34,7 +183,7 @@ int AddMiddlePoint(uint32_t offset, glm::vec3 scale, glm::vec3 center, int a, in
 		interpolated.UV = glm::vec2(u, v);
 
 		int ix = vertices.size();
-		midpointCache[key] = ix;
+		midpointCache.TryEmplace(key, ix);
 		vertices.push_back(interpolated);
 		return ix;
 	}
@@ -99,9 +248,11 @@ void MeshFactory::AddIcoSphere(MeshBuilder<VertexPosNormTexCol>& data, const glm
 
 	uint32_t indexOffset = data.GetVertexCount();
 	uint32_t initialIndex = data.GetIndexCount();
-	std::vector<glm::ivec3> faces;
 
-	uint32_t estimatedFaces = 12 + pow(tessellation + 1, 3);
+	// Each level of tessellation splits every face into 4, so we know exactly how many faces we'll end up with
+	const size_t finalFaces = static_cast<size_t>(20) << (2 * std::max(tessellation, 0));
+	std::vector<glm::ivec3> faces;
+	faces.reserve(finalFaces);
 
 	float t = (1.0f + sqrtf(5.0f)) / 2.0f;
 
@@ -150,12 +301,23 @@ void MeshFactory::AddIcoSphere(MeshBuilder<VertexPosNormTexCol>& data, const glm
 	faces.emplace_back(iOff + glm::ivec3(8, 6, 7));
 	faces.emplace_back(iOff + glm::ivec3(9, 8, 1));
 
-	// Cache used to index our midpoints
-	std::unordered_map<uint64_t, uint32_t> midPointCache;
+	// Cache used to index our midpoints. Each level of tessellation adds a midpoint to every edge, and the number
+	// of edges quadruples with each level, so we can size the cache up front
+	FlatHashMap<uint64_t, uint32_t> midPointCache;
+	size_t midPointCount = 0;
+	for (size_t ix = 0, edges = 30; ix < static_cast<size_t>(std::max(tessellation, 0)); ix++, edges *= 4) {
+		midPointCount += edges;
+	}
+	midPointCache.Reserve(midPointCount);
+	data.ReserveVertexSpace(12 + midPointCount);
+	data.ReserveIndexSpace(finalFaces * 3);
 
+	// We swap between two face lists rather than building a new one for every level
+	std::vector<glm::ivec3> tempFaces;
+	tempFaces.reserve(finalFaces);
 	for (int ix = 0; ix < tessellation; ix++)
 	{
-		std::vector<glm::ivec3> tempFaces;
+		tempFaces.clear();
 		for (auto& indices : faces)
 		{
 			uint32_t a = AddMiddlePoint(indexOffset, radii, center, indices[0], indices[1], data._vertices, midPointCache);
@@ -167,7 +329,7 @@ void MeshFactory::AddIcoSphere(MeshBuilder<VertexPosNormTexCol>& data, const glm
 			tempFaces.emplace_back(glm::ivec3(indices[2], c, b));
 			tempFaces.emplace_back(glm::ivec3(a, b, c));
 		}
-		faces = tempFaces;
+		faces.swap(tempFaces);
 	}
 
 	for (auto& face : faces) {
@@ -200,7 +362,7 @@ void MeshFactory::AddUvSphere(MeshBuilder<VertexPosNormTexCol>& data, const glm:
 
 	uint32_t offset = verts.size();
 	uint32_t initialIndex = data._indices.size();
-	verts.reserve(verts.size() + numverts);
+	data.ReserveVertexSpace(numverts);
 
 	float stackAngle, sliceAngle;
 	float x, y, z, xy;
@@ -239,7 +401,7 @@ void MeshFactory::AddUvSphere(MeshBuilder<VertexPosNormTexCol>& data, const glm:
 	}
 	
 	int numIndices = (slices - 1) * slices * 6;
-	data._indices.reserve(data._indices.size() + numIndices);
+	data.ReserveIndexSpace(numIndices);
 
 	// Body loop
 	int k1, k2;
@@ -406,3 +568,159 @@ void MeshFactory::AddCube(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::mat
 
 	#pragma endregion
 }
+
+void MeshFactory::AddCubes(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::mat4* transforms, const glm::vec4* colors, size_t count, size_t threadCount) {
+	mesh.ReserveVertexSpace(count * 24);
+	mesh.ReserveIndexSpace(count * 36);
+	AppendItems(mesh._vertices, mesh._indices, count, 24, 36, threadCount, [&](size_t ix, Vertex* vertices, uint32_t* indices, uint32_t base) {
+		glm::vec3 corners[8];
+		glm::vec3 normals[6];
+		TransformCube(transforms[ix], corners, normals);
+		const glm::vec4& col = colors != nullptr ? colors[ix] : WHITE;
+
+		for (int v = 0; v < 24; v++) {
+			const CubeVertex& cube = CUBE_VERTICES[v];
+			vertices[v] = Vertex(corners[cube.Corner], normals[cube.Normal], CUBE_UVS[cube.UV], col);
+		}
+		for (uint32_t face = 0; face < 6; face++) {
+			const uint32_t o = base + face * 4;
+			indices[face * 6 + 0] = o + 0;
+			indices[face * 6 + 1] = o + 1;
+			indices[face * 6 + 2] = o + 2;
+			indices[face * 6 + 3] = o + 0;
+			indices[face * 6 + 4] = o + 2;
+			indices[face * 6 + 5] = o + 3;
+		}
+	});
+}
+
+void MeshFactory::AddIcoSpheres(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec3* centers, const glm::vec3* radii, const glm::vec4* colors,
+	size_t count, int tessellation, size_t threadCount) {
+	if (count == 0) {
+		return;
+	}
+	// The sphere's layout doesn't depend on where it is, so we only need to tessellate it once
+	MeshBuilder<VertexPosNormTexCol> unitSphere;
+	AddIcoSphere(unitSphere, glm::vec3(0.0f), glm::vec3(1.0f), tessellation);
+	_AddSphereInstances(mesh, unitSphere, centers, radii, colors, count, threadCount);
+}
+
+void MeshFactory::AddUvSpheres(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec3* centers, const glm::vec3* radii, const glm::vec4* colors,
+	size_t count, int tessellation, size_t threadCount) {
+	if (count == 0) {
+		return;
+	}
+	MeshBuilder<VertexPosNormTexCol> unitSphere;
+	AddUvSphere(unitSphere, glm::vec3(0.0f), glm::vec3(1.0f), tessellation);
+	_AddSphereInstances(mesh, unitSphere, centers, radii, colors, count, threadCount);
+}
+
+void MeshFactory::_AddSphereInstances(MeshBuilder<VertexPosNormTexCol>& mesh, const MeshBuilder<VertexPosNormTexCol>& unitSphere,
+	const glm::vec3* centers, const glm::vec3* radii, const glm::vec4* colors, size_t count, size_t threadCount) {
+	// Both sphere functions place every vertex at center + normal * radii, and give every vertex the same color, so
+	// the normals, UVs and indices of the unit sphere can be copied as is
+	const size_t vertexCount = unitSphere._vertices.size();
+	const size_t indexCount = unitSphere._indices.size();
+	mesh.ReserveVertexSpace(count * vertexCount);
+	mesh.ReserveIndexSpace(count * indexCount);
+	AppendItems(mesh._vertices, mesh._indices, count, vertexCount, indexCount, threadCount, [&](size_t ix, Vertex* vertices, uint32_t* indices, uint32_t base) {
+		const glm::vec4& col = colors != nullptr ? colors[ix] : WHITE;
+		memcpy(vertices, unitSphere._vertices.data(), vertexCount * sizeof(Vertex));
+		for (size_t v = 0; v < vertexCount; v++) {
+			PlaceSphereVertex(vertices[v], centers[ix], radii[ix]);
+			vertices[v].Color = col;
+		}
+		for (size_t i = 0; i < indexCount; i++) {
+			indices[i] = unitSphere._indices[i] + base;
+		}
+	});
+}
+
+namespace {
+	// Returns true if the two meshes have byte for byte identical vertex and index buffers
+	bool MeshesMatch(const MeshBuilder<VertexPosNormTexCol>& a, const MeshBuilder<VertexPosNormTexCol>& b) {
+		return
+			a.GetVertexCount() == b.GetVertexCount() &&
+			a.GetIndexCount() == b.GetIndexCount() &&
+			memcmp(a.GetVertexDataPtr(), b.GetVertexDataPtr(), a.GetVertexCount() * sizeof(VertexPosNormTexCol)) == 0 &&
+			memcmp(a.GetIndexDataPtr(), b.GetIndexDataPtr(), a.GetIndexCount() * sizeof(uint32_t)) == 0;
+	}
+
+	// Runs a generator the given number of times, returning the average time in milliseconds and the last result
+	template <typename Generator>
+	double TimeGenerator(int iterations, MeshBuilder<VertexPosNormTexCol>& result, const Generator& generator) {
+		using Clock = std::chrono::high_resolution_clock;
+		double milliseconds = 0.0;
+		for (int i = 0; i < iterations; i++) {
+			result = MeshBuilder<VertexPosNormTexCol>();
+			auto start = Clock::now();
+			generator(result);
+			milliseconds += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+		return milliseconds / iterations;
+	}
+}
+
+void MeshFactory::Benchmark(size_t cubeCount, int tessellation, size_t sphereCount, int iterations)
+{
+	// A fixed pattern of transforms and colors, so every run generates the same meshes
+	std::vector<glm::mat4> transforms(cubeCount);
+	std::vector<glm::vec4> cubeColors(cubeCount);
+	for (size_t ix = 0; ix < cubeCount; ix++) {
+		const float t = static_cast<float>(ix);
+		transforms[ix] = glm::translate(MAT4_IDENTITY, glm::vec3(fmodf(t, 100.0f), fmodf(t * 0.37f, 50.0f), t * 0.01f)) *
+			glm::mat4(glm::quat(glm::vec3(t * 0.1f, t * 0.2f, t * 0.3f))) * glm::scale(MAT4_IDENTITY, glm::vec3(1.0f + fmodf(t, 3.0f)));
+		cubeColors[ix] = glm::vec4(fmodf(t * 0.01f, 1.0f), 0.5f, 1.0f, 1.0f);
+	}
+	std::vector<glm::vec3> centers(sphereCount);
+	std::vector<glm::vec3> radii(sphereCount);
+	std::vector<glm::vec4> sphereColors(sphereCount);
+	for (size_t ix = 0; ix < sphereCount; ix++) {
+		const float t = static_cast<float>(ix);
+		centers[ix] = glm::vec3(t * 3.0f, -t, t * 0.5f);
+		radii[ix] = glm::vec3(1.0f + t * 0.1f, 1.0f, 2.0f - t * 0.01f);
+		sphereColors[ix] = glm::vec4(0.25f, fmodf(t * 0.1f, 1.0f), 0.75f, 1.0f);
+	}
+
+	LOG_INFO("MeshFactory benchmark ({} cubes, {} spheres at tessellation {}, {} iterations)", cubeCount, sphereCount, tessellation, iterations);
+
+	MeshBuilder<VertexPosNormTexCol> scalar, batch;
+	double scalarTime = TimeGenerator(iterations, scalar, [&](MeshBuilder<VertexPosNormTexCol>& mesh) {
+		for (size_t ix = 0; ix < cubeCount; ix++) {
+			AddCube(mesh, transforms[ix], cubeColors[ix]);
+		}
+	});
+	double batchTime = TimeGenerator(iterations, batch, [&](MeshBuilder<VertexPosNormTexCol>& mesh) {
+		AddCubes(mesh, transforms.data(), cubeColors.data(), cubeCount);
+	});
+	LOG_INFO("\t{:<10}: {:.2f} ms scalar, {:.2f} ms batched ({} vertices)", "Cubes", scalarTime, batchTime, batch.GetVertexCount());
+	if (!MeshesMatch(scalar, batch)) {
+		LOG_ERROR("\tBatched cubes do not match the scalar cubes");
+	}
+
+	scalarTime = TimeGenerator(iterations, scalar, [&](MeshBuilder<VertexPosNormTexCol>& mesh) {
+		for (size_t ix = 0; ix < sphereCount; ix++) {
+			AddIcoSphere(mesh, centers[ix], radii[ix], tessellation, sphereColors[ix]);
+		}
+	});
+	batchTime = TimeGenerator(iterations, batch, [&](MeshBuilder<VertexPosNormTexCol>& mesh) {
+		AddIcoSpheres(mesh, centers.data(), radii.data(), sphereColors.data(), sphereCount, tessellation);
+	});
+	LOG_INFO("\t{:<10}: {:.2f} ms scalar, {:.2f} ms batched ({} vertices)", "IcoSpheres", scalarTime, batchTime, batch.GetVertexCount());
+	if (!MeshesMatch(scalar, batch)) {
+		LOG_ERROR("\tBatched icospheres do not match the scalar icospheres");
+	}
+
+	scalarTime = TimeGenerator(iterations, scalar, [&](MeshBuilder<VertexPosNormTexCol>& mesh) {
+		for (size_t ix = 0; ix < sphereCount; ix++) {
+			AddUvSphere(mesh, centers[ix], radii[ix], tessellation, sphereColors[ix]);
+		}
+	});
+	batchTime = TimeGenerator(iterations, batch, [&](MeshBuilder<VertexPosNormTexCol>& mesh) {
+		AddUvSpheres(mesh, centers.data(), radii.data(), sphereColors.data(), sphereCount, tessellation);
+	});
+	LOG_INFO("\t{:<10}: {:.2f} ms scalar, {:.2f} ms batched ({} vertices)", "UvSpheres", scalarTime, batchTime, batch.GetVertexCount());
+	if (!MeshesMatch(scalar, batch)) {
+		LOG_ERROR("\tBatched UV spheres do not match the scalar UV spheres");
+	}
+}
@@ -20,10 +20,55 @@ public:
 	static void AddPlane(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec3& pos, const glm::vec3& normal, const glm::vec3& tangent, const glm::vec2& scale, const glm::vec4& col = glm::vec4(1.0f));
 
 	static void InvertFaces(MeshBuilder<VertexPosNormTexCol>& mesh);
+
+	/// <summary>
+	/// Adds a cube for every transform in a single call. The output is identical to calling AddCube for each transform
+	/// in order, but the space is reserved once, the corners are transformed with SIMD, and large batches are split
+	/// across threads
+	/// </summary>
+	/// <param name="mesh">The mesh to append the cubes to</param>
+	/// <param name="transforms">The transform of each cube, applied to a unit cube centered on the origin</param>
+	/// <param name="colors">The color of each cube, or nullptr to make them all white</param>
+	/// <param name="count">The number of cubes to add</param>
+	/// <param name="threadCount">The maximum number of threads to use, or 0 to use one per hardware thread</param>
+	static void AddCubes(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::mat4* transforms, const glm::vec4* colors, size_t count, size_t threadCount = 0);
+	/// <summary>
+	/// Adds an icosphere for every center in a single call, the output is identical to calling AddIcoSphere for each
+	/// sphere in order. The sphere is only tessellated once, then copied into place for each center
+	/// </summary>
+	/// <param name="mesh">The mesh to append the spheres to</param>
+	/// <param name="centers">The center of each sphere</param>
+	/// <param name="radii">The radii of each sphere along each axis</param>
+	/// <param name="colors">The color of each sphere, or nullptr to make them all white</param>
+	/// <param name="count">The number of spheres to add</param>
+	/// <param name="tessellation">The number of times to subdivide the spheres, shared by every sphere</param>
+	/// <param name="threadCount">The maximum number of threads to use, or 0 to use one per hardware thread</param>
+	static void AddIcoSpheres(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec3* centers, const glm::vec3* radii, const glm::vec4* colors,
+		size_t count, int tessellation = 0, size_t threadCount = 0);
+	/// <summary>
+	/// Adds a UV sphere for every center in a single call, the output is identical to calling AddUvSphere for each
+	/// sphere in order. See AddIcoSpheres
+	/// </summary>
+	static void AddUvSpheres(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec3* centers, const glm::vec3* radii, const glm::vec4* colors,
+		size_t count, int tessellation = 0, size_t threadCount = 0);
+
+	/// <summary>
+	/// Times the batch functions against calling the single primitive functions in a loop, and logs an error if the
+	/// two ever produce different meshes
+	/// </summary>
+	/// <param name="cubeCount">The number of cubes to generate</param>
+	/// <param name="tessellation">The tessellation level to generate the spheres at</param>
+	/// <param name="sphereCount">The number of spheres of each kind to generate</param>
+	/// <param name="iterations">The number of times to run each test</param>
+	static void Benchmark(size_t cubeCount = 100000, int tessellation = 6, size_t sphereCount = 32, int iterations = 5);
 	
 protected:	
 	MeshFactory() = default;
 	~MeshFactory() = default;
 
+	// Copies a sphere generated around the origin with a radius of 1 into place for each center
+	static void _AddSphereInstances(MeshBuilder<VertexPosNormTexCol>& mesh, const MeshBuilder<VertexPosNormTexCol>& unitSphere,
+		const glm::vec3* centers, const glm::vec3* radii, const glm::vec4* colors, size_t count, size_t threadCount);
+
 	inline static const glm::mat4 MAT4_IDENTITY = glm::mat4(1.0f);
 };
\ No newline at end of file
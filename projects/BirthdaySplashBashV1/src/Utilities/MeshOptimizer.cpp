@@ -0,0 +1,334 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "Logging.h"
+
+namespace {
+	// Tuning values for the vertex cache optimizer, these are the values from Forsyth's original write up
+	constexpr size_t FORSYTH_CACHE_SIZE = 32;
+	constexpr size_t FORSYTH_MAX_VALENCE = 32;
+	constexpr float  CACHE_DECAY_POWER = 1.5f;
+	constexpr float  LAST_TRIANGLE_SCORE = 0.75f;
+	constexpr float  VALENCE_BOOST_SCALE = 2.0f;
+	constexpr float  VALENCE_BOOST_POWER = 0.5f;
+
+	// The cache simulated when splitting meshes into clusters for overdraw sorting
+	constexpr size_t OVERDRAW_CACHE_SIZE = 16;
+
+	// For every vertex, the list of triangles that use it
+	struct TriangleAdjacency {
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Triangles;
+	};
+
+	void BuildAdjacency(const uint32_t* indices, size_t indexCount, size_t vertexCount, TriangleAdjacency& result) {
+		result.Counts.assign(vertexCount, 0);
+		result.Offsets.resize(vertexCount);
+		result.Triangles.resize(indexCount);
+
+		for (size_t ix = 0; ix < indexCount; ix++) {
+			result.Counts[indices[ix]]++;
+		}
+		uint32_t offset = 0;
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			result.Offsets[ix] = offset;
+			offset += result.Counts[ix];
+		}
+
+		// Fill in the lists, using the counts as a cursor and then restoring them afterwards
+		std::fill(result.Counts.begin(), result.Counts.end(), 0);
+		for (size_t ix = 0; ix < indexCount; ix++) {
+			const uint32_t vertex = indices[ix];
+			result.Triangles[result.Offsets[vertex] + result.Counts[vertex]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	// Pre-computes the scores for vertices based on their position in the cache and the number of triangles still using them
+	struct ForsythScoreTable {
+		float Cache[FORSYTH_CACHE_SIZE + 1];
+		float Valence[FORSYTH_MAX_VALENCE + 1];
+
+		ForsythScoreTable() {
+			// The last slot is used for vertices that are not in the cache
+			for (size_t ix = 0; ix < FORSYTH_CACHE_SIZE; ix++) {
+				// The vertices of the last triangle get a fixed score, since we don't want to prefer any of them over the others
+				if (ix < 3) {
+					Cache[ix] = LAST_TRIANGLE_SCORE;
+				} else {
+					const float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+					Cache[ix] = powf(1.0f - (ix - 3) * scale, CACHE_DECAY_POWER);
+				}
+			}
+			Cache[FORSYTH_CACHE_SIZE] = 0.0f;
+
+			// Vertices with only a few triangles left get a boost, so that we finish them off rather than leaving lone triangles behind
+			Valence[0] = 0.0f;
+			for (size_t ix = 1; ix <= FORSYTH_MAX_VALENCE; ix++) {
+				Valence[ix] = VALENCE_BOOST_SCALE * powf(static_cast<float>(ix), -VALENCE_BOOST_POWER);
+			}
+		}
+
+		float Score(size_t cachePosition, uint32_t activeTriangles) const {
+			// A vertex with no triangles left can't help us, so it should never be picked
+			if (activeTriangles == 0) {
+				return -1.0f;
+			}
+			return Cache[std::min(cachePosition, FORSYTH_CACHE_SIZE)] + Valence[std::min<size_t>(activeTriangles, FORSYTH_MAX_VALENCE)];
+		}
+	};
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+	VertexCacheStats result;
+	if (indexCount < 3 || vertexCount == 0) {
+		return result;
+	}
+
+	// We track the time every vertex was last put into the cache, measured in cache misses. With a FIFO cache, a
+	// vertex is still cached if fewer than cacheSize misses have happened since then
+	std::vector<size_t> cachedAt(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	size_t misses = 0;
+	size_t usedVertices = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		const uint32_t vertex = indices[ix];
+		if (!used[vertex]) {
+			used[vertex] = true;
+			usedVertices++;
+		}
+		if (cachedAt[vertex] == 0 || misses + 1 - cachedAt[vertex] > cacheSize) {
+			misses++;
+			cachedAt[vertex] = misses;
+		}
+	}
+
+	result.ACMR = static_cast<float>(misses) / (indexCount / 3);
+	result.ATVR = static_cast<float>(misses) / usedVertices;
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	LOG_ASSERT(indexCount % 3 == 0, "Index count must be a multiple of 3!");
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	static const ForsythScoreTable scores;
+
+	TriangleAdjacency adjacency;
+	BuildAdjacency(indices, indexCount, vertexCount, adjacency);
+
+	// The number of triangles still to be emitted for each vertex, these are always the first entries in the vertex's adjacency list
+	std::vector<uint32_t> activeTriangles = adjacency.Counts;
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScores[ix] = scores.Score(FORSYTH_CACHE_SIZE, activeTriangles[ix]);
+	}
+
+	// We start off with the best scoring triangle in the whole mesh
+	std::vector<bool> emitted(triangleCount, false);
+	uint32_t bestTriangle = 0;
+	float bestScore = -1.0f;
+	for (size_t ix = 0; ix < triangleCount; ix++) {
+		const uint32_t* tri = indices + ix * 3;
+		const float score = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+		if (score > bestScore) {
+			bestScore = score;
+			bestTriangle = static_cast<uint32_t>(ix);
+		}
+	}
+
+	// The cache holds an extra 3 vertices while we're updating it, any that get pushed past the end are evicted
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t nextCache[FORSYTH_CACHE_SIZE + 3];
+	size_t cacheCount = 0;
+
+	std::vector<uint32_t> result(indexCount);
+	size_t nextInputTriangle = 0;
+
+	for (size_t output = 0; output < triangleCount; output++) {
+		// If none of the triangles around the cache could be used, we take the next triangle we haven't emitted yet
+		if (bestTriangle == UINT32_MAX) {
+			while (emitted[nextInputTriangle]) {
+				nextInputTriangle++;
+			}
+			bestTriangle = static_cast<uint32_t>(nextInputTriangle);
+		}
+
+		const uint32_t* tri = indices + bestTriangle * 3;
+		result[output * 3 + 0] = tri[0];
+		result[output * 3 + 1] = tri[1];
+		result[output * 3 + 2] = tri[2];
+		emitted[bestTriangle] = true;
+
+		// Remove the triangle from the active lists of its vertices
+		for (int ix = 0; ix < 3; ix++) {
+			const uint32_t vertex = tri[ix];
+			uint32_t* list = adjacency.Triangles.data() + adjacency.Offsets[vertex];
+			uint32_t& count = activeTriangles[vertex];
+			for (uint32_t i = 0; i < count; i++) {
+				if (list[i] == bestTriangle) {
+					std::swap(list[i], list[count - 1]);
+					break;
+				}
+			}
+			count--;
+		}
+
+		// The new triangle's vertices move to the front of the cache, and everything else gets pushed back
+		size_t nextCount = 0;
+		nextCache[nextCount++] = tri[0];
+		nextCache[nextCount++] = tri[1];
+		nextCache[nextCount++] = tri[2];
+		for (size_t ix = 0; ix < cacheCount; ix++) {
+			const uint32_t vertex = cache[ix];
+			if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2]) {
+				nextCache[nextCount++] = vertex;
+			}
+		}
+
+		// Update the scores of everything that moved, including the vertices that just got evicted
+		for (size_t ix = 0; ix < nextCount; ix++) {
+			const uint32_t vertex = nextCache[ix];
+			vertexScores[vertex] = scores.Score(ix, activeTriangles[vertex]);
+		}
+
+		// Re-score the triangles around the cache, and pick the best one to emit next
+		bestTriangle = UINT32_MAX;
+		bestScore = 0.0f;
+		for (size_t ix = 0; ix < nextCount; ix++) {
+			const uint32_t vertex = nextCache[ix];
+			const uint32_t* list = adjacency.Triangles.data() + adjacency.Offsets[vertex];
+			for (uint32_t i = 0; i < activeTriangles[vertex]; i++) {
+				const uint32_t triangle = list[i];
+				const uint32_t* other = indices + triangle * 3;
+				const float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = triangle;
+				}
+			}
+		}
+
+		cacheCount = std::min(nextCount, FORSYTH_CACHE_SIZE);
+		std::copy(nextCache, nextCache + cacheCount, cache);
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount)
+{
+	LOG_ASSERT(indexCount % 3 == 0, "Index count must be a multiple of 3!");
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	auto position = [&](uint32_t vertex) -> const glm::vec3& {
+		return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+	};
+
+	// Start a new cluster at every triangle where all 3 vertices miss the cache. The cache is effectively empty at
+	// these points anyways, so moving the clusters around afterwards won't cost us any vertex re-use
+	std::vector<uint32_t> clusterStarts;
+	std::vector<size_t> cachedAt(vertexCount, 0);
+	size_t misses = 0;
+	for (size_t ix = 0; ix < triangleCount; ix++) {
+		int triangleMisses = 0;
+		for (int i = 0; i < 3; i++) {
+			const uint32_t vertex = indices[ix * 3 + i];
+			if (cachedAt[vertex] == 0 || misses + 1 - cachedAt[vertex] > OVERDRAW_CACHE_SIZE) {
+				misses++;
+				cachedAt[vertex] = misses;
+				triangleMisses++;
+			}
+		}
+		if (ix == 0 || triangleMisses == 3) {
+			clusterStarts.push_back(static_cast<uint32_t>(ix));
+		}
+	}
+	if (clusterStarts.size() < 2) {
+		return;
+	}
+	clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+	// Find the area weighted center of the whole mesh
+	glm::vec3 meshCenter = glm::vec3(0.0f);
+	float meshArea = 0.0f;
+	for (size_t ix = 0; ix < triangleCount; ix++) {
+		const glm::vec3& a = position(indices[ix * 3 + 0]);
+		const glm::vec3& b = position(indices[ix * 3 + 1]);
+		const glm::vec3& c = position(indices[ix * 3 + 2]);
+		const float area = glm::length(glm::cross(b - a, c - a));
+		meshCenter += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : meshCenter;
+
+	// Score each cluster by how far it faces away from the center, clusters on the outside of the mesh tend to cover
+	// the ones further in, so they should be drawn first
+	const size_t clusterCount = clusterStarts.size() - 1;
+	std::vector<float> clusterScores(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float area = 0.0f;
+		for (uint32_t ix = clusterStarts[cluster]; ix < clusterStarts[cluster + 1]; ix++) {
+			const glm::vec3& a = position(indices[ix * 3 + 0]);
+			const glm::vec3& b = position(indices[ix * 3 + 1]);
+			const glm::vec3& c = position(indices[ix * 3 + 2]);
+			const glm::vec3 cross = glm::cross(b - a, c - a);
+			const float triangleArea = glm::length(cross);
+			center += (a + b + c) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+		const float normalLength = glm::length(normal);
+		if (area <= 0.0f || normalLength <= 0.0f) {
+			clusterScores[cluster] = 0.0f;
+			continue;
+		}
+		clusterScores[cluster] = glm::dot(center / area - meshCenter, normal / normalLength);
+	}
+
+	// Stable sort so that clusters with the same score keep their order, and the output is always the same
+	std::vector<uint32_t> order(clusterCount);
+	for (size_t ix = 0; ix < clusterCount; ix++) {
+		order[ix] = static_cast<uint32_t>(ix);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return clusterScores[a] > clusterScores[b];
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(indexCount);
+	for (uint32_t cluster : order) {
+		result.insert(result.end(), indices + clusterStarts[cluster] * 3, indices + clusterStarts[cluster + 1] * 3);
+	}
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap)
+{
+	remap.assign(vertexCount, UINT32_MAX);
+	uint32_t nextVertex = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& mapped = remap[indices[ix]];
+		if (mapped == UINT32_MAX) {
+			mapped = nextVertex++;
+		}
+		indices[ix] = mapped;
+	}
+	for (uint32_t& mapped : remap) {
+		if (mapped == UINT32_MAX) {
+			mapped = nextVertex++;
+		}
+	}
+}
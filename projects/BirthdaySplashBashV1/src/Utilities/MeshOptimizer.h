@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// How well an index buffer makes use of the GPU's post-transform vertex cache
+/// </summary>
+struct VertexCacheStats
+{
+	/// <summary>
+	/// Average cache miss ratio, the number of vertices transformed per triangle. Ranges from 0.5 for an ideal
+	/// grid to 3 when no vertices are ever re-used
+	/// </summary>
+	float ACMR = 0.0f;
+	/// <summary>
+	/// Average transform to vertex ratio, the number of times each vertex is transformed. 1 is ideal
+	/// </summary>
+	float ATVR = 0.0f;
+};
+
+/// <summary>
+/// The vertex cache statistics of a mesh before and after optimizing it
+/// </summary>
+struct MeshOptimizationStats
+{
+	VertexCacheStats Before;
+	VertexCacheStats After;
+};
+
+/// <summary>
+/// CPU side passes for reordering indexed triangle lists so that they render faster. None of these touch OpenGL, and
+/// all of them are deterministic, so they can safely be run while building mesh caches.
+///
+/// The usual order is OptimizeVertexCache, then OptimizeOverdraw (optional), then OptimizeVertexFetch. See
+/// MeshBuilder::Optimize, which does all of this for you
+/// </summary>
+class MeshOptimizer abstract
+{
+public:
+	/// <summary>
+	/// Simulates a FIFO post-transform cache to measure how well the index buffer re-uses vertices
+	/// </summary>
+	/// <param name="indices">The triangle list to analyze</param>
+	/// <param name="indexCount">The number of indices, must be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="cacheSize">The number of vertices the simulated cache holds</param>
+	static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = 16);
+
+	/// <summary>
+	/// Reorders the triangles so that vertices are re-used while they are still in the post-transform cache, using
+	/// Tom Forsyth's linear-speed vertex cache optimization
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place</param>
+	/// <param name="indexCount">The number of indices, must be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Splits a cache optimized triangle list into clusters wherever the vertex cache starts over, and sorts the
+	/// clusters so that the ones facing out from the center of the mesh are drawn first. This lets the depth test
+	/// reject more of the hidden triangles, without costing any extra vertex cache misses
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place, should already be cache optimized</param>
+	/// <param name="indexCount">The number of indices, must be a multiple of 3</param>
+	/// <param name="positions">A pointer to the position of the first vertex</param>
+	/// <param name="positionStride">The number of bytes between each position</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount);
+
+	/// <summary>
+	/// Renumbers the vertices in the order they are first used by the index buffer, so that vertex fetches walk the
+	/// vertex buffer mostly in order. Vertices that are never used are moved to the end
+	/// </summary>
+	/// <param name="indices">The triangle list to renumber in place</param>
+	/// <param name="indexCount">The number of indices</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="remap">Receives the new index of every vertex, the vertex buffer must be reordered to match</param>
+	static void OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+};
@@ -0,0 +1,810 @@
+#include "MeshSimplifier.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#include "FlatHashMap.h"
+#include "MeshOptimizer.h"
+
+namespace {
+	// How much more it costs to move a vertex away from an open border than away from a surface of the same size
+	constexpr double BORDER_WEIGHT = 10.0;
+	// A pass will not perform collapses that cost more than this many times the cost of the last collapse it needs
+	// to reach the target, so that each pass still prefers the cheapest collapses across the whole mesh
+	constexpr float PASS_ERROR_SLACK = 1.5f;
+	// Levels of detail that keep more than this fraction of the previous level's triangles are dropped
+	constexpr float LOD_MIN_REDUCTION = 0.9f;
+	// How many times a level of detail is simplified with a tighter error limit before it is dropped for moving the
+	// surface too far, and how far under the limit each retry aims
+	constexpr int LOD_MAX_ATTEMPTS = 4;
+	constexpr float LOD_RETRY_MARGIN = 0.8f;
+	// The number of random points sampled on each surface when measuring a level of detail (see MeasureDeviation)
+	constexpr size_t LOD_DEVIATION_SAMPLES = 20000;
+
+	constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+	enum class VertexKind : uint8_t {
+		// The vertex is surrounded by triangles, and can collapse onto any of its neighbours
+		Manifold,
+		// The vertex is on an open edge, and can only collapse along that edge
+		Border,
+		// The vertex is on a non-manifold edge, or is where several borders meet, and cannot be moved
+		Locked
+	};
+
+	// The sum of the squared distances to a set of planes, weighted by the area of the triangles they came from
+	struct Quadric {
+		double A00 = 0.0, A11 = 0.0, A22 = 0.0, A01 = 0.0, A02 = 0.0, A12 = 0.0;
+		double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+		double C = 0.0;
+		double Weight = 0.0;
+
+		// Adds the plane dot(normal, p) + distance = 0, normal must be unit length
+		void AddPlane(const glm::dvec3& normal, double distance, double weight) {
+			A00 += weight * normal.x * normal.x;
+			A11 += weight * normal.y * normal.y;
+			A22 += weight * normal.z * normal.z;
+			A01 += weight * normal.x * normal.y;
+			A02 += weight * normal.x * normal.z;
+			A12 += weight * normal.y * normal.z;
+			B0 += weight * normal.x * distance;
+			B1 += weight * normal.y * distance;
+			B2 += weight * normal.z * distance;
+			C += weight * distance * distance;
+		}
+
+		Quadric& operator+=(const Quadric& other) {
+			A00 += other.A00; A11 += other.A11; A22 += other.A22;
+			A01 += other.A01; A02 += other.A02; A12 += other.A12;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			Weight += other.Weight;
+			return *this;
+		}
+
+		// Gets the weighted sum of squared distances from the point to every plane
+		double Evaluate(const glm::dvec3& p) const {
+			const double result =
+				A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z +
+				2.0 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z) +
+				2.0 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+			return result > 0.0 ? result : 0.0;
+		}
+	};
+
+	// Hashes the bits of a position, used to find the vertices that only differ by their other attributes
+	struct PositionHash {
+		uint64_t operator()(const glm::vec3& position) const {
+			uint32_t bits[3];
+			memcpy(bits, &position, sizeof(bits));
+			return FlatHashMix(bits[0] ^ (static_cast<uint64_t>(bits[1]) << 21) ^ (static_cast<uint64_t>(bits[2]) << 42));
+		}
+	};
+
+	inline uint64_t EdgeKey(uint32_t from, uint32_t to) {
+		return (static_cast<uint64_t>(from) << 32) | to;
+	}
+
+	inline const glm::vec3& GetPosition(const glm::vec3* positions, size_t positionStride, size_t index) {
+		return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+	}
+
+	// An edge collapse, moving the From vertex onto the To vertex
+	struct Collapse {
+		uint32_t From;
+		uint32_t To;
+		float    Cost;
+	};
+
+	// For every vertex, the list of triangles that use it
+	struct TriangleAdjacency {
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Triangles;
+	};
+
+	void BuildAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount, TriangleAdjacency& result) {
+		result.Counts.assign(vertexCount, 0);
+		result.Offsets.resize(vertexCount);
+		result.Triangles.resize(indices.size());
+
+		for (uint32_t vertex : indices) {
+			result.Counts[vertex]++;
+		}
+		uint32_t offset = 0;
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			result.Offsets[ix] = offset;
+			offset += result.Counts[ix];
+		}
+		std::fill(result.Counts.begin(), result.Counts.end(), 0);
+		for (size_t ix = 0; ix < indices.size(); ix++) {
+			const uint32_t vertex = indices[ix];
+			result.Triangles[result.Offsets[vertex] + result.Counts[vertex]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	// The working state of a single call to Simplify
+	class Simplifier {
+	public:
+		Simplifier(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount) :
+			_vertexCount(vertexCount),
+			_indices(indices, indices + indexCount)
+		{
+			_WeldPositions(positions, positionStride);
+			_ClassifyVertices();
+			_ComputeQuadrics();
+			_ComputeWedgeNormals();
+		}
+
+		float Run(size_t targetIndexCount, float targetError, std::vector<uint32_t>& result) {
+			const float errorLimit = targetError * targetError;
+			float maxCost = 0.0f;
+
+			while (_indices.size() > targetIndexCount) {
+				BuildAdjacency(_canonical, _vertexCount, _adjacency);
+				_FindBorderEdges();
+
+				std::vector<Collapse> collapses;
+				_PickCollapses(collapses);
+				if (collapses.empty()) {
+					break;
+				}
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+					return a.Cost < b.Cost || (a.Cost == b.Cost && a.From < b.From);
+				});
+
+				// Most collapses remove 2 triangles, so this is roughly how many we need to hit the target
+				const size_t triangleGoal = (_indices.size() - targetIndexCount) / 3;
+				const size_t collapseGoal = std::min(collapses.size(), std::max<size_t>(triangleGoal / 2, 1));
+				const float passLimit = std::min(errorLimit, collapses[collapseGoal - 1].Cost * PASS_ERROR_SLACK);
+
+				const size_t removed = _PerformCollapses(collapses, passLimit, triangleGoal, maxCost);
+				if (removed == 0) {
+					break;
+				}
+				_RemapIndices();
+			}
+
+			result = _indices;
+			return sqrtf(maxCost);
+		}
+
+	private:
+		// Finds the vertices that share a position, and scales the positions to fit in a unit cube so that the
+		// error values don't depend on the size of the mesh
+		void _WeldPositions(const glm::vec3* positions, size_t positionStride) {
+			_remap.resize(_vertexCount);
+			_positions.resize(_vertexCount);
+
+			FlatHashMap<glm::vec3, uint32_t, PositionHash> firstVertex(_vertexCount);
+			glm::vec3 min(std::numeric_limits<float>::max());
+			glm::vec3 max(-std::numeric_limits<float>::max());
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				const glm::vec3& position = GetPosition(positions, positionStride, ix);
+				_remap[ix] = *firstVertex.TryEmplace(position, static_cast<uint32_t>(ix)).first;
+				min = glm::min(min, position);
+				max = glm::max(max, position);
+			}
+
+			const glm::vec3 size = max - min;
+			const float extent = std::max(size.x, std::max(size.y, size.z));
+			const float scale = extent > 0.0f ? 1.0f / extent : 0.0f;
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				_positions[ix] = (GetPosition(positions, positionStride, ix) - min) * scale;
+			}
+
+			// Group the vertices that share a position, so that we can move all of them at once
+			_wedgeOffsets.assign(_vertexCount + 1, 0);
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				_wedgeOffsets[_remap[ix] + 1]++;
+			}
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				_wedgeOffsets[ix + 1] += _wedgeOffsets[ix];
+			}
+			std::vector<uint32_t> cursor(_wedgeOffsets.begin(), _wedgeOffsets.end() - 1);
+			_wedges.resize(_vertexCount);
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				_wedges[cursor[_remap[ix]]++] = static_cast<uint32_t>(ix);
+			}
+
+			_canonical.resize(_indices.size());
+			for (size_t ix = 0; ix < _indices.size(); ix++) {
+				_canonical[ix] = _remap[_indices[ix]];
+			}
+		}
+
+		void _ClassifyVertices() {
+			FlatHashMap<uint64_t, uint32_t> edgeUses(_canonical.size());
+			for (size_t ix = 0; ix < _canonical.size(); ix += 3) {
+				for (int edge = 0; edge < 3; edge++) {
+					edgeUses[EdgeKey(_canonical[ix + edge], _canonical[ix + (edge + 1) % 3])]++;
+				}
+			}
+
+			_kinds.assign(_vertexCount, VertexKind::Manifold);
+			std::vector<uint8_t> borderEdges(_vertexCount, 0);
+			for (size_t ix = 0; ix < _canonical.size(); ix += 3) {
+				for (int edge = 0; edge < 3; edge++) {
+					const uint32_t from = _canonical[ix + edge];
+					const uint32_t to = _canonical[ix + (edge + 1) % 3];
+					// An edge used twice in the same direction means the surface is folded over on itself
+					if (*edgeUses.Find(EdgeKey(from, to)) > 1) {
+						_kinds[from] = _kinds[to] = VertexKind::Locked;
+					}
+					else if (!edgeUses.Contains(EdgeKey(to, from))) {
+						borderEdges[from] = std::min(borderEdges[from] + 1, 255);
+						borderEdges[to] = std::min(borderEdges[to] + 1, 255);
+					}
+				}
+			}
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				if (borderEdges[ix] > 0 && _kinds[ix] != VertexKind::Locked) {
+					// A simple border vertex has exactly one edge going in, and one going out
+					_kinds[ix] = borderEdges[ix] == 2 ? VertexKind::Border : VertexKind::Locked;
+				}
+			}
+		}
+
+		void _ComputeQuadrics() {
+			_quadrics.assign(_vertexCount, Quadric());
+			for (size_t ix = 0; ix < _canonical.size(); ix += 3) {
+				const uint32_t corners[3] = { _canonical[ix], _canonical[ix + 1], _canonical[ix + 2] };
+				const glm::dvec3 p0 = _positions[corners[0]];
+				const glm::dvec3 p1 = _positions[corners[1]];
+				const glm::dvec3 p2 = _positions[corners[2]];
+
+				const glm::dvec3 cross = glm::cross(p1 - p0, p2 - p0);
+				const double length = glm::length(cross);
+				if (length == 0.0) {
+					continue;
+				}
+				const glm::dvec3 normal = cross / length;
+				const double area = length * 0.5;
+
+				Quadric plane;
+				plane.AddPlane(normal, -glm::dot(normal, p0), area);
+				plane.Weight = area;
+				for (uint32_t corner : corners) {
+					_quadrics[corner] += plane;
+				}
+
+				// Open edges get an extra plane running along them, perpendicular to the triangle, so that moving
+				// a vertex off of the border is penalized even when the surface is flat
+				for (int edge = 0; edge < 3; edge++) {
+					const uint32_t from = corners[edge];
+					const uint32_t to = corners[(edge + 1) % 3];
+					if (_kinds[from] == VertexKind::Manifold || _kinds[to] == VertexKind::Manifold) {
+						continue;
+					}
+					const glm::dvec3 direction = _positions[to] - _positions[from];
+					const double edgeLength = glm::length(direction);
+					if (edgeLength == 0.0) {
+						continue;
+					}
+					const glm::dvec3 borderNormal = glm::normalize(glm::cross(direction, normal));
+					Quadric border;
+					border.AddPlane(borderNormal, -glm::dot(borderNormal, glm::dvec3(_positions[from])), edgeLength * edgeLength * BORDER_WEIGHT);
+					_quadrics[from] += border;
+					_quadrics[to] += border;
+				}
+			}
+		}
+
+		// Averages the normals of the faces around each vertex. When a vertex moves onto a position with several
+		// vertices, we use these to pick the one whose attributes will look the most like the one it replaces
+		void _ComputeWedgeNormals() {
+			_wedgeNormals.assign(_vertexCount, glm::vec3(0.0f));
+			for (size_t ix = 0; ix < _indices.size(); ix += 3) {
+				const glm::vec3& p0 = _positions[_canonical[ix]];
+				const glm::vec3 normal = glm::cross(_positions[_canonical[ix + 1]] - p0, _positions[_canonical[ix + 2]] - p0);
+				for (int corner = 0; corner < 3; corner++) {
+					_wedgeNormals[_indices[ix + corner]] += normal;
+				}
+			}
+			for (glm::vec3& normal : _wedgeNormals) {
+				const float length = glm::length(normal);
+				normal = length > 0.0f ? normal / length : glm::vec3(0.0f);
+			}
+		}
+
+		// Collects the edges along open borders in the current mesh
+		void _FindBorderEdges() {
+			FlatHashMap<uint64_t, uint8_t> edges(_canonical.size());
+			for (size_t ix = 0; ix < _canonical.size(); ix += 3) {
+				for (int edge = 0; edge < 3; edge++) {
+					edges[EdgeKey(_canonical[ix + edge], _canonical[ix + (edge + 1) % 3])] = 1;
+				}
+			}
+			_borderEdges.Clear();
+			for (size_t ix = 0; ix < _canonical.size(); ix += 3) {
+				for (int edge = 0; edge < 3; edge++) {
+					const uint32_t from = _canonical[ix + edge];
+					const uint32_t to = _canonical[ix + (edge + 1) % 3];
+					if (!edges.Contains(EdgeKey(to, from))) {
+						_borderEdges[EdgeKey(from, to)] = 1;
+						_borderEdges[EdgeKey(to, from)] = 1;
+					}
+				}
+			}
+		}
+
+		bool _CanCollapse(uint32_t from, uint32_t to) const {
+			switch (_kinds[from]) {
+				case VertexKind::Manifold:
+					return true;
+				case VertexKind::Border:
+					return _kinds[to] != VertexKind::Manifold && _borderEdges.Contains(EdgeKey(from, to));
+				default:
+					return false;
+			}
+		}
+
+		float _GetCost(uint32_t from, uint32_t to) const {
+			Quadric combined = _quadrics[from];
+			combined += _quadrics[to];
+			const double error = combined.Evaluate(_positions[to]);
+			return static_cast<float>(combined.Weight > 0.0 ? error / combined.Weight : error);
+		}
+
+		// Finds the cheapest collapse for every vertex that can be moved
+		void _PickCollapses(std::vector<Collapse>& result) {
+			std::vector<Collapse> best(_vertexCount, { INVALID_INDEX, INVALID_INDEX, std::numeric_limits<float>::max() });
+			for (size_t ix = 0; ix < _canonical.size(); ix += 3) {
+				for (int edge = 0; edge < 3; edge++) {
+					const uint32_t a = _canonical[ix + edge];
+					const uint32_t b = _canonical[ix + (edge + 1) % 3];
+					const uint32_t directions[2][2] = { { a, b }, { b, a } };
+					for (const auto& direction : directions) {
+						const uint32_t from = direction[0];
+						const uint32_t to = direction[1];
+						if (!_CanCollapse(from, to)) {
+							continue;
+						}
+						const float cost = _GetCost(from, to);
+						if (cost < best[from].Cost || (cost == best[from].Cost && to < best[from].To)) {
+							best[from] = { from, to, cost };
+						}
+					}
+				}
+			}
+			for (const Collapse& collapse : best) {
+				if (collapse.From != INVALID_INDEX) {
+					result.push_back(collapse);
+				}
+			}
+		}
+
+		// Checks whether moving a vertex would flip any of the triangles around it, and counts the triangles that
+		// would be removed
+		bool _CheckCollapse(uint32_t from, uint32_t to, size_t& removed) const {
+			removed = 0;
+			const uint32_t* triangles = &_adjacency.Triangles[_adjacency.Offsets[from]];
+			for (uint32_t ix = 0; ix < _adjacency.Counts[from]; ix++) {
+				const uint32_t* corners = &_canonical[triangles[ix] * 3];
+				if (corners[0] == to || corners[1] == to || corners[2] == to) {
+					removed++;
+					continue;
+				}
+				const glm::vec3 p[3] = { _positions[corners[0]], _positions[corners[1]], _positions[corners[2]] };
+				glm::vec3 moved[3] = { p[0], p[1], p[2] };
+				for (int corner = 0; corner < 3; corner++) {
+					if (corners[corner] == from) {
+						moved[corner] = _positions[to];
+					}
+				}
+				const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				if (glm::dot(before, after) <= 0.0f) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Picks the vertex at the destination position that each vertex at the source position should become
+		void _RemapWedges(uint32_t from, uint32_t to) {
+			const uint32_t* triangles = &_adjacency.Triangles[_adjacency.Offsets[from]];
+			for (uint32_t wedge = _wedgeOffsets[from]; wedge < _wedgeOffsets[from + 1]; wedge++) {
+				const uint32_t vertex = _wedges[wedge];
+				uint32_t target = INVALID_INDEX;
+
+				// Prefer a vertex that this one shares a triangle with, since they will have matching UVs
+				for (uint32_t ix = 0; ix < _adjacency.Counts[from] && target == INVALID_INDEX; ix++) {
+					const uint32_t* corners = &_indices[triangles[ix] * 3];
+					if (corners[0] != vertex && corners[1] != vertex && corners[2] != vertex) {
+						continue;
+					}
+					for (int corner = 0; corner < 3; corner++) {
+						if (_remap[corners[corner]] == to) {
+							target = corners[corner];
+						}
+					}
+				}
+				// Otherwise, go with the one whose surrounding faces point the same way (this matters on flat shaded meshes)
+				if (target == INVALID_INDEX) {
+					float bestDot = -std::numeric_limits<float>::max();
+					for (uint32_t candidate = _wedgeOffsets[to]; candidate < _wedgeOffsets[to + 1]; candidate++) {
+						const float dot = glm::dot(_wedgeNormals[vertex], _wedgeNormals[_wedges[candidate]]);
+						if (dot > bestDot) {
+							bestDot = dot;
+							target = _wedges[candidate];
+						}
+					}
+				}
+				_vertexRemap[vertex] = target;
+			}
+		}
+
+		// Performs the cheapest collapses that don't touch each other, returning the number of triangles removed
+		size_t _PerformCollapses(const std::vector<Collapse>& collapses, float passLimit, size_t triangleGoal, float& maxCost) {
+			std::vector<uint8_t> touched(_vertexCount, 0);
+			_vertexRemap.resize(_vertexCount);
+			for (size_t ix = 0; ix < _vertexCount; ix++) {
+				_vertexRemap[ix] = static_cast<uint32_t>(ix);
+			}
+
+			size_t removedTotal = 0;
+			for (const Collapse& collapse : collapses) {
+				if (collapse.Cost > passLimit || removedTotal >= triangleGoal) {
+					break;
+				}
+				if (touched[collapse.From] || touched[collapse.To]) {
+					continue;
+				}
+				size_t removed;
+				if (!_CheckCollapse(collapse.From, collapse.To, removed)) {
+					continue;
+				}
+
+				_RemapWedges(collapse.From, collapse.To);
+				_quadrics[collapse.To] += _quadrics[collapse.From];
+				maxCost = std::max(maxCost, collapse.Cost);
+				removedTotal += removed;
+
+				// The triangles around the moved vertex have changed, so none of their vertices can be used again
+				// until the next pass
+				const uint32_t* triangles = &_adjacency.Triangles[_adjacency.Offsets[collapse.From]];
+				for (uint32_t ix = 0; ix < _adjacency.Counts[collapse.From]; ix++) {
+					for (int corner = 0; corner < 3; corner++) {
+						touched[_canonical[triangles[ix] * 3 + corner]] = 1;
+					}
+				}
+			}
+			return removedTotal;
+		}
+
+		// Applies the collapses to the index buffer, dropping the triangles that have become degenerate
+		void _RemapIndices() {
+			size_t write = 0;
+			for (size_t ix = 0; ix < _indices.size(); ix += 3) {
+				const uint32_t a = _vertexRemap[_indices[ix]];
+				const uint32_t b = _vertexRemap[_indices[ix + 1]];
+				const uint32_t c = _vertexRemap[_indices[ix + 2]];
+				if (_remap[a] == _remap[b] || _remap[b] == _remap[c] || _remap[a] == _remap[c]) {
+					continue;
+				}
+				_indices[write] = a;
+				_indices[write + 1] = b;
+				_indices[write + 2] = c;
+				_canonical[write] = _remap[a];
+				_canonical[write + 1] = _remap[b];
+				_canonical[write + 2] = _remap[c];
+				write += 3;
+			}
+			_indices.resize(write);
+			_canonical.resize(write);
+		}
+
+		size_t _vertexCount;
+		// The current triangle list, and the same list using the first vertex at each position
+		std::vector<uint32_t> _indices;
+		std::vector<uint32_t> _canonical;
+		// The first vertex with the same position as each vertex
+		std::vector<uint32_t> _remap;
+		// The vertices at each position, indexed by the first vertex at that position
+		std::vector<uint32_t> _wedgeOffsets;
+		std::vector<uint32_t> _wedges;
+		std::vector<glm::vec3> _wedgeNormals;
+
+		std::vector<glm::vec3> _positions;
+		std::vector<VertexKind> _kinds;
+		std::vector<Quadric> _quadrics;
+
+		TriangleAdjacency _adjacency;
+		FlatHashMap<uint64_t, uint8_t> _borderEdges;
+		std::vector<uint32_t> _vertexRemap;
+	};
+}
+
+namespace {
+	// The closest point to p on the triangle abc, from Ericson's Real-Time Collision Detection (5.1.5)
+	glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+		const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+		const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) {
+			return a;
+		}
+		const glm::vec3 bp = p - b;
+		const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3) {
+			return b;
+		}
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+			return a + ab * (d1 / (d1 - d3));
+		}
+		const glm::vec3 cp = p - c;
+		const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6) {
+			return c;
+		}
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+			return a + ac * (d2 / (d2 - d6));
+		}
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+		const float denominator = va + vb + vc;
+		// Degenerate triangles fall back to their first corner
+		if (denominator <= 0.0f) {
+			return a;
+		}
+		const float v = vb / denominator, w = vc / denominator;
+		return a + ab * v + ac * w;
+	}
+
+	// A bounding volume hierarchy over the triangles in a mesh, for finding the closest point on the surface to a point.
+	// Meshes like the flower patch are mostly empty space with dense clusters, which a uniform grid handles badly
+	class TriangleTree {
+	public:
+		TriangleTree(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride) :
+			_indices(indices), _positions(positions), _positionStride(positionStride)
+		{
+			const size_t triangleCount = indexCount / 3;
+			_triangles.resize(triangleCount);
+			_centers.resize(triangleCount);
+			for (size_t ix = 0; ix < triangleCount; ix++) {
+				_triangles[ix] = static_cast<uint32_t>(ix);
+				_centers[ix] = (_Corner(ix, 0) + _Corner(ix, 1) + _Corner(ix, 2)) / 3.0f;
+			}
+			if (triangleCount > 0) {
+				_nodes.reserve(triangleCount * 2);
+				_nodes.emplace_back();
+				_Build(0, 0, triangleCount);
+			}
+		}
+
+		// Gets the distance from a point to the closest point on the mesh
+		float GetDistance(const glm::vec3& point) const {
+			float bestSquared = std::numeric_limits<float>::max();
+			if (_nodes.empty()) {
+				return bestSquared;
+			}
+
+			uint32_t stack[64];
+			size_t stackSize = 0;
+			stack[stackSize++] = 0;
+			while (stackSize > 0) {
+				const Node& node = _nodes[stack[--stackSize]];
+				if (_BoxDistanceSquared(node, point) >= bestSquared) {
+					continue;
+				}
+				if (node.Count > 0) {
+					for (uint32_t ix = node.First; ix < node.First + node.Count; ix++) {
+						const uint32_t triangle = _triangles[ix];
+						const glm::vec3 offset = ClosestPointOnTriangle(point, _Corner(triangle, 0), _Corner(triangle, 1), _Corner(triangle, 2)) - point;
+						bestSquared = std::min(bestSquared, glm::dot(offset, offset));
+					}
+					continue;
+				}
+				// Visit the closer child first, so the further one is more likely to be skipped
+				uint32_t near = node.First, far = node.First + 1;
+				if (_BoxDistanceSquared(_nodes[far], point) < _BoxDistanceSquared(_nodes[near], point)) {
+					std::swap(near, far);
+				}
+				stack[stackSize++] = far;
+				stack[stackSize++] = near;
+			}
+			return sqrtf(bestSquared);
+		}
+
+	private:
+		static constexpr size_t LEAF_SIZE = 4;
+
+		struct Node {
+			glm::vec3 Min;
+			glm::vec3 Max;
+			// For leaves, the first triangle in _triangles. Otherwise the index of the first of the two child nodes
+			uint32_t  First;
+			// The number of triangles in a leaf, or 0 for inner nodes
+			uint32_t  Count;
+		};
+
+		const glm::vec3& _Corner(size_t triangle, int corner) const {
+			return GetPosition(_positions, _positionStride, _indices[triangle * 3 + corner]);
+		}
+
+		static float _BoxDistanceSquared(const Node& node, const glm::vec3& point) {
+			const glm::vec3 offset = glm::max(glm::max(node.Min - point, point - node.Max), glm::vec3(0.0f));
+			return glm::dot(offset, offset);
+		}
+
+		// Fills in the node for the triangles from begin to end, splitting them at the median along the longest axis of
+		// their centers
+		void _Build(uint32_t nodeIndex, size_t begin, size_t end) {
+			glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+			glm::vec3 centerMin = min, centerMax = max;
+			for (size_t ix = begin; ix < end; ix++) {
+				const uint32_t triangle = _triangles[ix];
+				for (int corner = 0; corner < 3; corner++) {
+					min = glm::min(min, _Corner(triangle, corner));
+					max = glm::max(max, _Corner(triangle, corner));
+				}
+				centerMin = glm::min(centerMin, _centers[triangle]);
+				centerMax = glm::max(centerMax, _centers[triangle]);
+			}
+			_nodes[nodeIndex].Min = min;
+			_nodes[nodeIndex].Max = max;
+
+			if (end - begin <= LEAF_SIZE) {
+				_nodes[nodeIndex].First = static_cast<uint32_t>(begin);
+				_nodes[nodeIndex].Count = static_cast<uint32_t>(end - begin);
+				return;
+			}
+
+			const glm::vec3 extents = centerMax - centerMin;
+			const int axis = extents.x > extents.y ? (extents.x > extents.z ? 0 : 2) : (extents.y > extents.z ? 1 : 2);
+			const size_t middle = begin + (end - begin) / 2;
+			std::nth_element(_triangles.begin() + begin, _triangles.begin() + middle, _triangles.begin() + end, [&](uint32_t a, uint32_t b) {
+				return _centers[a][axis] < _centers[b][axis];
+			});
+
+			const uint32_t first = static_cast<uint32_t>(_nodes.size());
+			_nodes.emplace_back();
+			_nodes.emplace_back();
+			_nodes[nodeIndex].First = first;
+			_nodes[nodeIndex].Count = 0;
+			_Build(first, begin, middle);
+			_Build(first + 1, middle, end);
+		}
+
+		const uint32_t*        _indices;
+		const glm::vec3*       _positions;
+		size_t                 _positionStride;
+		std::vector<uint32_t>  _triangles;
+		std::vector<glm::vec3> _centers;
+		std::vector<Node>      _nodes;
+	};
+
+	// Gets the furthest that any of the sampled points on the surface are from the target mesh. The surface is sampled
+	// at each of its vertices, the center of each triangle, and then at random points spread out by triangle area
+	float GetOneSidedDeviation(const uint32_t* surface, size_t surfaceCount, const TriangleTree& target, const glm::vec3* positions,
+		size_t positionStride, size_t vertexCount, size_t sampleCount)
+	{
+		float result = 0.0f;
+		std::vector<uint8_t> sampled(vertexCount, 0);
+		std::vector<float> cumulativeArea(surfaceCount / 3);
+		float totalArea = 0.0f;
+		for (size_t ix = 0; ix + 2 < surfaceCount; ix += 3) {
+			const glm::vec3& a = GetPosition(positions, positionStride, surface[ix]);
+			const glm::vec3& b = GetPosition(positions, positionStride, surface[ix + 1]);
+			const glm::vec3& c = GetPosition(positions, positionStride, surface[ix + 2]);
+			for (int corner = 0; corner < 3; corner++) {
+				if (!sampled[surface[ix + corner]]) {
+					sampled[surface[ix + corner]] = 1;
+					result = std::max(result, target.GetDistance(GetPosition(positions, positionStride, surface[ix + corner])));
+				}
+			}
+			result = std::max(result, target.GetDistance((a + b + c) / 3.0f));
+			totalArea += glm::length(glm::cross(b - a, c - a)) * 0.5f;
+			cumulativeArea[ix / 3] = totalArea;
+		}
+		if (totalArea <= 0.0f) {
+			return result;
+		}
+
+		// A fixed seed keeps the result the same from run to run
+		uint32_t state = 0x9E3779B9u;
+		auto random = [&]() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return (state >> 8) * (1.0f / 16777216.0f);
+		};
+		for (size_t sample = 0; sample < sampleCount; sample++) {
+			const size_t triangle = std::min<size_t>(std::lower_bound(cumulativeArea.begin(), cumulativeArea.end(), random() * totalArea) - cumulativeArea.begin(),
+				cumulativeArea.size() - 1);
+			float u = random(), v = random();
+			if (u + v > 1.0f) {
+				u = 1.0f - u;
+				v = 1.0f - v;
+			}
+			const glm::vec3& a = GetPosition(positions, positionStride, surface[triangle * 3]);
+			const glm::vec3& b = GetPosition(positions, positionStride, surface[triangle * 3 + 1]);
+			const glm::vec3& c = GetPosition(positions, positionStride, surface[triangle * 3 + 2]);
+			result = std::max(result, target.GetDistance(a + (b - a) * u + (c - a) * v));
+		}
+		return result;
+	}
+}
+
+float MeshSimplifier::GetScale(const glm::vec3* positions, size_t positionStride, size_t vertexCount) {
+	if (vertexCount == 0) {
+		return 0.0f;
+	}
+	glm::vec3 min = GetPosition(positions, positionStride, 0);
+	glm::vec3 max = min;
+	for (size_t ix = 1; ix < vertexCount; ix++) {
+		min = glm::min(min, GetPosition(positions, positionStride, ix));
+		max = glm::max(max, GetPosition(positions, positionStride, ix));
+	}
+	const glm::vec3 size = max - min;
+	return std::max(size.x, std::max(size.y, size.z));
+}
+
+float MeshSimplifier::Simplify(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount,
+	size_t targetIndexCount, float targetError, std::vector<uint32_t>& result)
+{
+	if (indexCount <= targetIndexCount || vertexCount == 0) {
+		result.assign(indices, indices + indexCount);
+		return 0.0f;
+	}
+	Simplifier simplifier(indices, indexCount, positions, positionStride, vertexCount);
+	return simplifier.Run(targetIndexCount, targetError, result);
+}
+
+void MeshSimplifier::GenerateLods(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount,
+	const std::vector<float>& triangleRatios, float maxError, std::vector<MeshLodData>& result)
+{
+	result.clear();
+	const float scale = GetScale(positions, positionStride, vertexCount);
+
+	size_t previousCount = indexCount;
+	for (float ratio : triangleRatios) {
+		const size_t targetIndexCount = static_cast<size_t>(indexCount / 3 * ratio) * 3;
+
+		// The quadric error underestimates how far the surface really moves, so we measure each level and simplify it
+		// again with a tighter limit until it fits. The measured distance is what gets stored, so that MeshLodGroup
+		// switches levels based on how far the surface really is from the original
+		MeshLodData level;
+		float targetError = maxError;
+		bool withinLimit = false;
+		for (int attempt = 0; attempt < LOD_MAX_ATTEMPTS && !withinLimit; attempt++) {
+			const float estimate = Simplify(indices, indexCount, positions, positionStride, vertexCount, targetIndexCount, targetError, level.Indices);
+			if (level.Indices.empty() || level.Indices.size() > previousCount * LOD_MIN_REDUCTION) {
+				break;
+			}
+			level.Error = MeasureDeviation(indices, indexCount, level.Indices.data(), level.Indices.size(), positions, positionStride, vertexCount,
+				LOD_DEVIATION_SAMPLES);
+			withinLimit = level.Error <= maxError * scale;
+			if (!withinLimit) {
+				targetError = estimate * maxError * scale / level.Error * LOD_RETRY_MARGIN;
+			}
+		}
+		if (!withinLimit) {
+			continue;
+		}
+		MeshOptimizer::OptimizeVertexCache(level.Indices.data(), level.Indices.size(), vertexCount);
+		previousCount = level.Indices.size();
+		result.push_back(std::move(level));
+	}
+}
+
+float MeshSimplifier::MeasureDeviation(const uint32_t* indicesA, size_t indexCountA, const uint32_t* indicesB, size_t indexCountB,
+	const glm::vec3* positions, size_t positionStride, size_t vertexCount, size_t sampleCount)
+{
+	// An empty surface is infinitely far from anything that isn't also empty
+	if (indexCountA < 3 || indexCountB < 3 || vertexCount == 0) {
+		return indexCountA < 3 && indexCountB < 3 ? 0.0f : std::numeric_limits<float>::infinity();
+	}
+
+	const TriangleTree treeA(indicesA, indexCountA, positions, positionStride);
+	const TriangleTree treeB(indicesB, indexCountB, positions, positionStride);
+	return std::max(
+		GetOneSidedDeviation(indicesA, indexCountA, treeB, positions, positionStride, vertexCount, sampleCount),
+		GetOneSidedDeviation(indicesB, indexCountB, treeA, positions, positionStride, vertexCount, sampleCount));
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A reduced version of a mesh, as generated by MeshSimplifier::GenerateLods. The indices refer to the vertices
+/// of the original mesh, so every level of detail can share a single vertex buffer
+/// </summary>
+struct MeshLodData
+{
+	std::vector<uint32_t> Indices;
+	/// <summary>
+	/// The distance between the simplified surface and the original as measured by MeshSimplifier::MeasureDeviation, in
+	/// the same units as the mesh
+	/// </summary>
+	float Error = 0.0f;
+};
+
+/// <summary>
+/// Reduces the number of triangles in a mesh by collapsing edges, picking the collapses that move the surface the
+/// least according to Garland and Heckbert's quadric error metric.
+///
+/// Vertices are only ever moved onto other existing vertices, so the simplified index buffer can be drawn with the
+/// original vertex buffer. Vertices that share a position (ex: along UV seams, or everywhere on a flat shaded mesh)
+/// are collapsed together, and open borders can only collapse along themselves so that holes don't grow.
+///
+/// Like the MeshOptimizer, this is pure CPU work with a deterministic result
+/// </summary>
+class MeshSimplifier abstract
+{
+public:
+	/// <summary>
+	/// Gets the size of the largest side of the mesh's bounding box, errors passed to and returned from Simplify are
+	/// relative to this
+	/// </summary>
+	static float GetScale(const glm::vec3* positions, size_t positionStride, size_t vertexCount);
+
+	/// <summary>
+	/// Simplifies a triangle list until it reaches the target size, or until any further collapse would move the
+	/// surface by more than the target error
+	/// </summary>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="indexCount">The number of indices, must be a multiple of 3</param>
+	/// <param name="positions">A pointer to the position of the first vertex</param>
+	/// <param name="positionStride">The number of bytes between each position</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="targetIndexCount">The number of indices to try and reduce the mesh to</param>
+	/// <param name="targetError">The largest error to allow, relative to the size of the mesh (see GetScale)</param>
+	/// <param name="result">Receives the simplified triangle list</param>
+	/// <returns>The estimated error of the simplified mesh, relative to the size of the mesh</returns>
+	static float Simplify(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount,
+		size_t targetIndexCount, float targetError, std::vector<uint32_t>& result);
+
+	/// <summary>
+	/// Generates a chain of simplified meshes, one for each of the given triangle ratios. Each level is simplified
+	/// from the original mesh and cache optimized. Every level is measured against the original (see MeasureDeviation),
+	/// and simplified again with a tighter limit if it moved the surface further than the max error. Levels that would
+	/// not remove at least 10% of the triangles of the level before them (because the error limit was reached) are left
+	/// out, so the result may be shorter than the list of ratios
+	/// </summary>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="indexCount">The number of indices, must be a multiple of 3</param>
+	/// <param name="positions">A pointer to the position of the first vertex</param>
+	/// <param name="positionStride">The number of bytes between each position</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="triangleRatios">The fraction of the triangles to keep in each level, in decreasing order (ex: 0.5, 0.25, 0.1)</param>
+	/// <param name="maxError">The largest error to allow in any level, relative to the size of the mesh (see GetScale)</param>
+	/// <param name="result">Receives the simplified levels, not including the original mesh</param>
+	static void GenerateLods(const uint32_t* indices, size_t indexCount, const glm::vec3* positions, size_t positionStride, size_t vertexCount,
+		const std::vector<float>& triangleRatios, float maxError, std::vector<MeshLodData>& result);
+
+	/// <summary>
+	/// Measures how far apart two triangle lists over the same vertices are, as the largest distance from a point on
+	/// either surface to the closest point on the other (a sampled, two sided Hausdorff distance). Each surface is
+	/// sampled at its vertices, the center of each triangle, and a fixed number of random points, so the result is a
+	/// lower bound on the true distance that gets tighter with more samples
+	/// </summary>
+	/// <param name="indicesA">The first triangle list, usually the original mesh</param>
+	/// <param name="indexCountA">The number of indices in the first list, must be a multiple of 3</param>
+	/// <param name="indicesB">The second triangle list, usually a simplified level</param>
+	/// <param name="indexCountB">The number of indices in the second list, must be a multiple of 3</param>
+	/// <param name="positions">A pointer to the position of the first vertex</param>
+	/// <param name="positionStride">The number of bytes between each position</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="sampleCount">The number of random points to sample on each surface</param>
+	/// <returns>The largest distance found, in the same units as the mesh</returns>
+	static float MeasureDeviation(const uint32_t* indicesA, size_t indexCountA, const uint32_t* indicesB, size_t indexCountB,
+		const glm::vec3* positions, size_t positionStride, size_t vertexCount, size_t sampleCount = 100000);
+};
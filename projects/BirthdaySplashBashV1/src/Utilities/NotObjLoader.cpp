@@ -1,112 +1,166 @@
 #include "NotObjLoader.h"
 
 #include <string>
-#include <sstream>
-#include <fstream>
-#include <iostream>
+#include <string_view>
+#include <charconv>
 
-#include "StringUtils.h"
+#include "Logging.h"
+#include "MemoryMappedFile.h"
+#include "MeshCache.h"
+
+namespace {
+	// Bump this whenever the loader or MeshFactory start producing different meshes from the same file, so that old
+	// mesh caches get rebuilt
+	constexpr uint64_t NOTOBJ_LOADER_VERSION = 1;
+
+	inline bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// Pops the next whitespace separated token off the front of a line, returns an empty view once the line runs out
+	inline std::string_view NextToken(std::string_view& line) {
+		size_t start = 0;
+		while (start < line.size() && IsSpace(line[start])) { start++; }
+		size_t end = start;
+		while (end < line.size() && !IsSpace(line[end])) { end++; }
+		const std::string_view token = line.substr(start, end - start);
+		line.remove_prefix(end);
+		return token;
+	}
+
+	inline bool ParseToken(std::string_view token, float& result) {
+		// from_chars does not accept a leading plus sign
+		if (!token.empty() && token[0] == '+') { token.remove_prefix(1); }
+		const char* end = token.data() + token.size();
+		auto res = std::from_chars(token.data(), end, result);
+		return res.ec == std::errc() && res.ptr == end;
+	}
+
+	inline bool ParseToken(std::string_view token, int& result) {
+		if (!token.empty() && token[0] == '+') { token.remove_prefix(1); }
+		const char* end = token.data() + token.size();
+		auto res = std::from_chars(token.data(), end, result);
+		return res.ec == std::errc() && res.ptr == end;
+	}
+
+	// Reads up to count floats off the front of a line, returning the number that were read
+	inline size_t ParseFloats(std::string_view& line, float* result, size_t count) {
+		for (size_t ix = 0; ix < count; ix++) {
+			if (!ParseToken(NextToken(line), result[ix])) {
+				return ix;
+			}
+		}
+		return count;
+	}
+
+	// Reads the optional r g b [a] color at the end of a primitive, any missing channels are left at 1
+	inline glm::vec4 ParseColor(std::string_view& line) {
+		glm::vec4 color = glm::vec4(1.0f);
+		ParseFloats(line, &color.r, 4);
+		return color;
+	}
+}
 
 VertexArrayObject::sptr NotObjLoader::LoadFromFile(const std::string& filename)
 {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+	// If we've already compiled this file, we can upload the cached data directly
+	VertexArrayObject::sptr result = MeshCache::TryLoad(filename, GetCacheVariant(), VertexPosNormTexCol::V_DECL);
+	if (result != nullptr) {
+		return result;
+	}
+
+	MeshBuilder<VertexPosNormTexCol> mesh;
+	BuildCachedMesh(filename, mesh);
+	return mesh.Bake();
+}
+
+void NotObjLoader::LoadMeshFromFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh)
+{
+	// Map the entire file into memory, rather than streaming it in
+	MemoryMappedFile file(filename);
 
 	// If our file fails to open, we will throw an error
-	if (!file) {
+	if (!file.IsOpen()) {
 		throw std::runtime_error("Failed to open file");
 	}
 
-	MeshBuilder<VertexPosNormTexCol> mesh;
-	std::string line;
-	
-	// Iterate as long as there is content to read
-	while (std::getline(file, line)) {
-		trim(line);
-		if (line.substr(0, 1) == "#")
+	const std::string_view contents(file.GetData(), file.GetSize());
+	size_t lineNumber = 0;
+	size_t lineStart = 0;
+	while (lineStart < contents.size()) {
+		size_t lineEnd = contents.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos) {
+			lineEnd = contents.size();
+		}
+		std::string_view line = contents.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		lineNumber++;
+
+		const std::string_view command = NextToken(line);
+		if (command.empty() || command[0] == '#')
 		{
-			// Comment, no-op
+			// Blank line or comment, no-op
 		}
-		else if (line.substr(0, 5) == "cube ") // We can do equality check this way since the left side is a string and not a char*
+		else if (command == "cube")
 		{
-			std::istringstream ss = std::istringstream(line.substr(5));
-			glm::vec3 pos;
-			ss >> pos.x >> pos.y >> pos.z;
-			
-			glm::vec3 scale;
-			ss >> scale.x >> scale.y >> scale.z;
-			
-			glm::vec3 eulerDeg;
-			ss >> eulerDeg.x >> eulerDeg.y >> eulerDeg.z;
-			
-			glm::vec4 color = glm::vec4(1.0f);
-			if (ss.rdbuf()->in_avail() > 0) {
-				ss >> color.r >> color.g >> color.b;
+			// x y z  sx sy sz  rx ry rz  [r g b [a]]
+			float values[9];
+			if (ParseFloats(line, values, 9) != 9) {
+				LOG_WARN("Malformed cube on line {} of \"{}\"", lineNumber, filename);
+				continue;
 			}
-			if (ss.rdbuf()->in_avail() > 0) {
-				ss >> color.a;
-			}
-
-			MeshFactory::AddCube(mesh, pos, scale, eulerDeg, color);
-			
+			const glm::vec4 color = ParseColor(line);
+			MeshFactory::AddCube(mesh, glm::vec3(values[0], values[1], values[2]), glm::vec3(values[3], values[4], values[5]),
+				glm::vec3(values[6], values[7], values[8]), color);
 		}
-		else if (line.substr(0, 6) == "plane ")
+		else if (command == "plane")
 		{
-			std::istringstream ss = std::istringstream(line.substr(6));
-			glm::vec3 pos;
-			ss >> pos.x >> pos.y >> pos.z;
-			glm::vec3 normal;
-			ss >> normal.x >> normal.y >> normal.z;
-			glm::vec3 tangent;
-			ss >> tangent.x >> tangent.y >> tangent.z;
-			glm::vec2 size;
-			ss >> size.x >> size.y;
-			glm::vec4 color = glm::vec4(1.0f);
-			if (ss.rdbuf()->in_avail() > 0) {
-				ss >> color.r >> color.g >> color.b;
-			}
-			if (ss.rdbuf()->in_avail() > 0) {
-				ss >> color.a;
+			// x y z  nx ny nz  tx ty tz  sx sy  [r g b [a]]
+			float values[11];
+			if (ParseFloats(line, values, 11) != 11) {
+				LOG_WARN("Malformed plane on line {} of \"{}\"", lineNumber, filename);
+				continue;
 			}
-			
-			MeshFactory::AddPlane(mesh, pos, normal, tangent, size, color);
+			const glm::vec4 color = ParseColor(line);
+			MeshFactory::AddPlane(mesh, glm::vec3(values[0], values[1], values[2]), glm::vec3(values[3], values[4], values[5]),
+				glm::vec3(values[6], values[7], values[8]), glm::vec2(values[9], values[10]), color);
 		}
-		else if (line.substr(0, 7) == "sphere ")
+		else if (command == "sphere")
 		{
-			std::istringstream ss = std::istringstream(line.substr(7));
-
-			std::string mode;
-			ss >> mode;
-
-			int tesselation = 0;
-			ss >> tesselation;
-
-			glm::vec3 pos;
-			ss >> pos.x >> pos.y >> pos.z;
-
-			glm::vec3 radii;
-			ss >> radii.x >> radii.y >> radii.z;
-			
-			glm::vec4 color = glm::vec4(1.0f);
-			if (ss.rdbuf()->in_avail() > 0) {
-				ss >> color.r >> color.g >> color.b;
-			}
-			if (ss.rdbuf()->in_avail() > 0) {
-				ss >> color.a;
+			// ico|uv  tessellation  x y z  sx sy sz  [r g b [a]]
+			const std::string_view mode = NextToken(line);
+			int tessellation = 0;
+			float values[6];
+			if ((mode != "ico" && mode != "uv") || !ParseToken(NextToken(line), tessellation) || ParseFloats(line, values, 6) != 6) {
+				LOG_WARN("Malformed sphere on line {} of \"{}\"", lineNumber, filename);
+				continue;
 			}
-						
+			const glm::vec4 color = ParseColor(line);
+			const glm::vec3 pos = glm::vec3(values[0], values[1], values[2]);
+			const glm::vec3 radii = glm::vec3(values[3], values[4], values[5]);
 			if (mode == "ico") {
-				MeshFactory::AddIcoSphere(mesh, pos, radii, tesselation, color);
-			} else if (mode == "uv") {
-				MeshFactory::AddUvSphere(mesh, pos, radii, tesselation, color);
+				MeshFactory::AddIcoSphere(mesh, pos, radii, tessellation, color);
+			} else {
+				MeshFactory::AddUvSphere(mesh, pos, radii, tessellation, color);
 			}
 		}
 	}
+}
+
+bool NotObjLoader::BuildCachedMesh(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh)
+{
+	mesh = MeshBuilder<VertexPosNormTexCol>();
+	LoadMeshFromFile(filename, mesh);
 
-	// Note: with actual OBJ files you're going to run into the issue where faces are composited of different indices
-	// You'll need to keep track of these and create vertex entries for each vertex in the face
-	// If you want to get fancy, you can track which vertices you've already added
+	// Since the result gets cached, we can afford to spend some extra time making the mesh faster to draw
+	MeshOptimizationStats stats = mesh.Optimize();
+	LOG_TRACE("Compiled \"{}\", {} vertices, {} triangles, ACMR {:.3f} -> {:.3f}", filename, mesh.GetVertexCount(),
+		mesh.GetTriangleCount(), stats.Before.ACMR, stats.After.ACMR);
 
-	return mesh.Bake();
+	return MeshCache::Save(filename, GetCacheVariant(), mesh);
+}
+
+uint64_t NotObjLoader::GetCacheVariant()
+{
+	return MeshCache::Hash(&NOTOBJ_LOADER_VERSION, sizeof(uint64_t));
 }
@@ -1,12 +1,41 @@
 #pragma once
 #include "MeshFactory.h"
 
+#include <string>
+
 class NotObjLoader
 {
 public:
+	/// <summary>
+	/// Loads a NotObj file into a VAO. The generated geometry is compiled into the mesh cache the first time a file is
+	/// loaded, so later loads can upload the cached vertices directly instead of re-running MeshFactory
+	/// </summary>
+	/// <param name="filename">The path of the NotObj file to load</param>
 	static VertexArrayObject::sptr LoadFromFile(const std::string& filename);
 
+	/// <summary>
+	/// Parses a NotObj file and generates its primitives into a mesh builder, without touching OpenGL. The file is
+	/// memory mapped and tokenized in place, so no strings or streams are allocated while reading it
+	/// </summary>
+	/// <param name="filename">The path of the NotObj file to load</param>
+	/// <param name="mesh">The mesh builder to append the primitives to</param>
+	static void LoadMeshFromFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh);
+
+	/// <summary>
+	/// Parses a NotObj file, optimizes the result for the GPU's vertex cache, and writes it to the mesh cache. Can be
+	/// called ahead of time to compile large level files, so that they never need to be parsed at runtime
+	/// </summary>
+	/// <param name="filename">The path of the NotObj file to compile</param>
+	/// <param name="mesh">The mesh builder to store the mesh in, any existing contents are replaced</param>
+	/// <returns>True if the cache was written</returns>
+	static bool BuildCachedMesh(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh);
+
+	/// <summary>
+	/// Gets the key that NotObj meshes are stored under in the mesh cache
+	/// </summary>
+	static uint64_t GetCacheVariant();
+
 protected:
 	NotObjLoader() = default;
 	~NotObjLoader() = default;
-};
\ No newline at end of file
+};
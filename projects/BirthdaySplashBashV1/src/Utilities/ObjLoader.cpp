@@ -5,10 +5,519 @@
 #include <fstream>
 #include <iostream>
 #include <unordered_map>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
 
+#include "Logging.h"
 #include "StringUtils.h"
+#include "MemoryMappedFile.h"
+#include "MeshCache.h"
+#include "AssetManager.h"
+#include "FlatHashMap.h"
+
+namespace {
+	// Bump this whenever the loader starts producing different meshes from the same file, so that old mesh caches get rebuilt
+	constexpr uint64_t OBJ_LOADER_VERSION = 3;
+
+	// Files smaller than this (per thread) will not be split up when loading in parallel, since the overhead of
+	// spinning up threads would outweigh the gains
+	constexpr size_t PARALLEL_CHUNK_MIN_SIZE = 256 * 1024;
+
+	// Helpers for walking over a memory mapped OBJ file. All of these take the current read position and the end
+	// of the buffer, and never read past the end
+
+	inline bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipSpaces(const char* it, const char* end) {
+		while (it < end && IsSpace(*it)) { it++; }
+		return it;
+	}
+
+	inline const char* SkipLine(const char* it, const char* end) {
+		const char* newLine = static_cast<const char*>(memchr(it, '\n', end - it));
+		return newLine != nullptr ? newLine + 1 : end;
+	}
+
+	inline const char* ParseFloat(const char* it, const char* end, float& result) {
+		it = SkipSpaces(it, end);
+		// from_chars does not accept a leading plus sign, but OBJ exporters will sometimes emit one
+		if (it < end && *it == '+') { it++; }
+		auto res = std::from_chars(it, end, result);
+		if (res.ec != std::errc()) {
+			result = 0.0f;
+		}
+		return res.ptr;
+	}
+
+	inline const char* ParseInt(const char* it, const char* end, int& result) {
+		if (it < end && *it == '+') { it++; }
+		auto res = std::from_chars(it, end, result);
+		if (res.ec != std::errc()) {
+			result = 0;
+		}
+		return res.ptr;
+	}
+
+	// The kinds of lines we care about in an OBJ file
+	enum class ObjCommand {
+		Unknown,
+		Position,
+		Normal,
+		TextureCoord,
+		Face
+	};
+
+	// Reads the command token at the start of a line, leaving the iterator just past it
+	inline ObjCommand ParseCommand(const char*& it, const char* end) {
+		const char* command = it;
+		while (it < end && !IsSpace(*it) && *it != '\n') { it++; }
+		const size_t length = it - command;
+
+		if (length == 1) {
+			return command[0] == 'v' ? ObjCommand::Position : command[0] == 'f' ? ObjCommand::Face : ObjCommand::Unknown;
+		}
+		if (length == 2 && command[0] == 'v') {
+			return command[1] == 'n' ? ObjCommand::Normal : command[1] == 't' ? ObjCommand::TextureCoord : ObjCommand::Unknown;
+		}
+		return ObjCommand::Unknown;
+	}
+
+	/*
+	 * Walks over every line in the given range, handing the attributes and faces to the visitor. The visitor must provide:
+	 *    void OnPosition(const glm::vec3&), void OnNormal(const glm::vec3&), void OnTextureCoord(const glm::vec2&)
+	 *    void OnFace(const std::vector<glm::ivec3>&), where the face vertices are the raw OBJ indices, and may be negative
+	 */
+	template <typename Visitor>
+	void ParseObjRange(const char* it, const char* end, Visitor& visitor) {
+		// Faces can have any number of vertices, we re-use this between faces so we only allocate for the largest one
+		std::vector<glm::ivec3> face;
+
+		while (it < end) {
+			it = SkipSpaces(it, end);
+			if (it >= end) {
+				break;
+			}
+
+			switch (ParseCommand(it, end)) {
+				case ObjCommand::Position:
+				{
+					glm::vec3 temp;
+					it = ParseFloat(it, end, temp.x);
+					it = ParseFloat(it, end, temp.y);
+					it = ParseFloat(it, end, temp.z);
+					visitor.OnPosition(temp);
+					break;
+				}
+				case ObjCommand::Normal:
+				{
+					glm::vec3 temp;
+					it = ParseFloat(it, end, temp.x);
+					it = ParseFloat(it, end, temp.y);
+					it = ParseFloat(it, end, temp.z);
+					visitor.OnNormal(temp);
+					break;
+				}
+				case ObjCommand::TextureCoord:
+				{
+					glm::vec2 temp;
+					it = ParseFloat(it, end, temp.x);
+					it = ParseFloat(it, end, temp.y);
+					visitor.OnTextureCoord(temp);
+					break;
+				}
+				case ObjCommand::Face:
+				{
+					face.clear();
+					// Faces are a list of position/uv/normal triplets, where the uv and normal may be omitted (ex: 1, 1/2, 1//3 or 1/2/3)
+					while (true) {
+						it = SkipSpaces(it, end);
+						if (it >= end || *it == '\n' || *it == '#') {
+							break;
+						}
+
+						glm::ivec3 vertexIndices = glm::ivec3(0);
+						it = ParseInt(it, end, vertexIndices.x);
+						if (it < end && *it == '/') {
+							it++;
+							if (it < end && *it != '/') {
+								it = ParseInt(it, end, vertexIndices.y);
+							}
+							if (it < end && *it == '/') {
+								it++;
+								it = ParseInt(it, end, vertexIndices.z);
+							}
+						}
+						// Skip anything we could not make sense of so that we can't get stuck on a malformed face
+						while (it < end && !IsSpace(*it) && *it != '\n') { it++; }
+
+						face.push_back(vertexIndices);
+					}
+					visitor.OnFace(face);
+					break;
+				}
+				default:
+					break;
+			}
+
+			// Anything else (comments, groups, materials, etc...) is ignored, and we move on to the next line
+			it = SkipLine(it, end);
+		}
+	}
+
+	// Counts the number of each attribute and face in the given range, without parsing any of their values
+	void CountObjAttributes(const char* it, const char* end, size_t& positions, size_t& normals, size_t& textureCoords, size_t& faces) {
+		positions = normals = textureCoords = faces = 0;
+		while (it < end) {
+			it = SkipSpaces(it, end);
+			if (it >= end) {
+				break;
+			}
+			switch (ParseCommand(it, end)) {
+				case ObjCommand::Position:     positions++;     break;
+				case ObjCommand::Normal:       normals++;       break;
+				case ObjCommand::TextureCoord: textureCoords++; break;
+				case ObjCommand::Face:         faces++;         break;
+				default: break;
+			}
+			it = SkipLine(it, end);
+		}
+	}
+
+	// Converts an OBJ face vertex into 1-based absolute indices, with 0 meaning that the uv or normal was not specified.
+	// The counts are the number of each attribute that had been declared before the face
+	inline glm::ivec3 ResolveIndices(glm::ivec3 indices, size_t positionCount, size_t textureCount, size_t normalCount) {
+		// The OBJ format can have negative values, which are a reference from the last added attributes
+		if (indices.x < 0) { indices.x = static_cast<int>(positionCount) + 1 + indices.x; }
+		if (indices.y < 0) { indices.y = static_cast<int>(textureCount) + 1 + indices.y; }
+		if (indices.z < 0) { indices.z = static_cast<int>(normalCount) + 1 + indices.z; }
+		if (indices.x <= 0 || indices.x > static_cast<int>(positionCount) ||
+			indices.y < 0 || indices.y > static_cast<int>(textureCount) ||
+			indices.z < 0 || indices.z > static_cast<int>(normalCount)) {
+			throw std::runtime_error("Face references an attribute that does not exist");
+		}
+		return indices;
+	}
+
+	// Hashes the full position/uv/normal index triplet, so unlike packing the indices into a single 64 bit key there
+	// is no limit on the number of attributes. The position index goes in the high bits and the uv and normal are folded
+	// in below it before the whole key gets mixed, so every vertex lands in its own random slot no matter how many other
+	// vertices share its position. Keeping the position index as the slot number would walk the table in order, but a
+	// position with lots of vertices (like the centre of a triangle fan) would then spill into its neighbours' slots
+	// and turn every lookup around it into a long probe
+	struct VertexKeyHash {
+		uint64_t operator()(const glm::ivec3& indices) const {
+			const uint32_t variant = static_cast<uint32_t>(indices.y) * 0x9e3779b1u ^ static_cast<uint32_t>(indices.z);
+			return FlatHashMix((static_cast<uint64_t>(static_cast<uint32_t>(indices.x)) << 32) | variant);
+		}
+	};
+
+	// Maps a combination of attributes to the index of the vertex that was created for it
+	typedef FlatHashMap<glm::ivec3, uint32_t, VertexKeyHash> VertexIndexMap;
+
+	// A closed triangle mesh has about half as many vertices as faces, with uv seams and hard edges adding more on top.
+	// If we guess too low the map just has to grow once, which is cheaper than clearing a table that's twice as big
+	inline size_t EstimateUniqueVertices(size_t faceCount) {
+		return faceCount * 3 / 4;
+	}
+
+	inline VertexPosNormTexCol MakeVertex(const glm::ivec3& indices, const std::vector<glm::vec3>& positions,
+		const std::vector<glm::vec2>& textureCoords, const std::vector<glm::vec3>& normals, const glm::vec4& color)
+	{
+		VertexPosNormTexCol vertex;
+		vertex.Position = positions[indices.x - 1];
+		vertex.UV = indices.y != 0 ? textureCoords[indices.y - 1] : glm::vec2(0.0f);
+		vertex.Normal = indices.z != 0 ? normals[indices.z - 1] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.Color = color;
+		return vertex;
+	}
+
+	// Builds the mesh directly while parsing, used when loading on a single thread
+	struct SerialObjVisitor {
+		MeshBuilder<VertexPosNormTexCol>& Mesh;
+		glm::vec4 Color;
+
+		SerialObjVisitor(MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& color) :
+			Mesh(mesh), Color(color) { }
+
+		std::vector<glm::vec3> Positions;
+		std::vector<glm::vec3> Normals;
+		std::vector<glm::vec2> TextureCoords;
+
+		// We'll use a map of attribute indices to avoid duplicate vertices
+		VertexIndexMap IndexMap;
+		std::vector<uint32_t> Edges;
+
+		void OnPosition(const glm::vec3& value) { Positions.push_back(value); }
+		void OnNormal(const glm::vec3& value) { Normals.push_back(value); }
+		void OnTextureCoord(const glm::vec2& value) { TextureCoords.push_back(value); }
+
+		void OnFace(const std::vector<glm::ivec3>& face) {
+			Edges.clear();
+			for (const glm::ivec3& raw : face) {
+				glm::ivec3 indices = ResolveIndices(raw, Positions.size(), TextureCoords.size(), Normals.size());
+
+				// Find the index associated with the combination of attributes, or add a new vertex if this is a new combination
+				auto result = IndexMap.TryEmplace(indices, 0);
+				if (result.second) {
+					*result.first = Mesh.AddVertex(MakeVertex(indices, Positions, TextureCoords, Normals, Color));
+				}
+				Edges.push_back(*result.first);
+			}
+
+			// Triangulate the face as a fan, which handles triangles and quads the same way the streamed loader does
+			for (size_t ix = 2; ix < Edges.size(); ix++) {
+				Mesh.AddIndexTri(Edges[0], Edges[ix - 1], Edges[ix]);
+			}
+		}
+	};
+
+	/*
+	 * A line aligned slice of an OBJ file that is parsed on a worker thread. Every chunk writes its attributes
+	 * directly into the shared attribute arrays at its offsets, and de-duplicates its own vertices. The chunks
+	 * are then merged in file order, so that the final vertex and index order matches the serial loader exactly
+	 */
+	struct ObjChunk {
+		const char* Begin;
+		const char* End;
+
+		// The number of each attribute declared in this chunk, and in all chunks before it
+		size_t PositionCount, NormalCount, TextureCount, FaceCount;
+		size_t PositionOffset, NormalOffset, TextureOffset;
+
+		// Pointers to the shared attribute arrays
+		glm::vec3* Positions;
+		glm::vec3* Normals;
+		glm::vec2* TextureCoords;
+		size_t PositionsParsed, NormalsParsed, TexturesParsed;
+
+		// The unique vertices in this chunk, in the order they were first referenced
+		VertexIndexMap IndexMap;
+		std::vector<glm::ivec3> UniqueVertices;
+		// Triangle indices into UniqueVertices, later re-mapped into the final mesh
+		std::vector<uint32_t> Indices;
+		std::vector<uint32_t> Remap;
+		size_t IndexOffset;
+
+		std::vector<uint32_t> Edges;
+
+		void OnPosition(const glm::vec3& value) { Positions[PositionOffset + PositionsParsed++] = value; }
+		void OnNormal(const glm::vec3& value) { Normals[NormalOffset + NormalsParsed++] = value; }
+		void OnTextureCoord(const glm::vec2& value) { TextureCoords[TextureOffset + TexturesParsed++] = value; }
+
+		void OnFace(const std::vector<glm::ivec3>& face) {
+			Edges.clear();
+			for (const glm::ivec3& raw : face) {
+				glm::ivec3 indices = ResolveIndices(raw,
+					PositionOffset + PositionsParsed, TextureOffset + TexturesParsed, NormalOffset + NormalsParsed);
+
+				auto result = IndexMap.TryEmplace(indices, static_cast<uint32_t>(UniqueVertices.size()));
+				if (result.second) {
+					UniqueVertices.push_back(indices);
+				}
+				Edges.push_back(*result.first);
+			}
+			for (size_t ix = 2; ix < Edges.size(); ix++) {
+				Indices.push_back(Edges[0]);
+				Indices.push_back(Edges[ix - 1]);
+				Indices.push_back(Edges[ix]);
+			}
+		}
+	};
+
+	// Runs the task for every index in [0, count) on its own thread, re-throwing the first exception once all tasks have finished
+	template <typename Task>
+	void RunParallel(size_t count, const Task& task) {
+		std::vector<std::future<void>> futures;
+		futures.reserve(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			futures.push_back(std::async(std::launch::async, task, ix));
+		}
+		for (auto& future : futures) {
+			future.wait();
+		}
+		for (auto& future : futures) {
+			future.get();
+		}
+	}
+}
+
+void ObjLoader::LoadMeshFromFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor)
+{
+	// Map the entire file into memory, rather than streaming it in
+	MemoryMappedFile file(filename);
+
+	// If our file fails to open, we will throw an error
+	if (!file.IsOpen()) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	SerialObjVisitor visitor { mesh, inColor };
+
+	// Counting the lines up front is cheap compared to parsing them, and lets us size everything exactly once
+	size_t positionCount, normalCount, textureCount, faceCount;
+	CountObjAttributes(file.GetData(), file.GetData() + file.GetSize(), positionCount, normalCount, textureCount, faceCount);
+	visitor.Positions.reserve(positionCount);
+	visitor.Normals.reserve(normalCount);
+	visitor.TextureCoords.reserve(textureCount);
+	visitor.IndexMap.Reserve(EstimateUniqueVertices(faceCount));
+	mesh.ReserveIndexSpace(faceCount * 3);
+
+	ParseObjRange(file.GetData(), file.GetData() + file.GetSize(), visitor);
+}
+
+void ObjLoader::LoadMeshFromFileParallel(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor, size_t threadCount)
+{
+	// Map the entire file into memory, rather than streaming it in
+	MemoryMappedFile file(filename);
+
+	// If our file fails to open, we will throw an error
+	if (!file.IsOpen()) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	const size_t chunkCount = std::min(threadCount, std::max<size_t>(file.GetSize() / PARALLEL_CHUNK_MIN_SIZE, 1));
+	if (chunkCount == 1) {
+		LoadMeshFromFile(filename, mesh, inColor);
+		return;
+	}
+
+	const char* data = file.GetData();
+	const char* end  = data + file.GetSize();
+
+	// Split the file into roughly equal chunks, moving each split point forward to the start of the next line
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* chunkStart = data;
+	for (size_t ix = 0; ix < chunkCount; ix++) {
+		ObjChunk& chunk = chunks[ix];
+		chunk.Begin = chunkStart;
+		chunk.End = ix == chunkCount - 1 ? end : std::max(chunkStart, SkipLine(data + file.GetSize() * (ix + 1) / chunkCount, end));
+		chunkStart = chunk.End;
+	}
+
+	// Count up the attributes in each chunk, so that we know where each chunk will write to in the shared attribute arrays
+	RunParallel(chunkCount, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		CountObjAttributes(chunk.Begin, chunk.End, chunk.PositionCount, chunk.NormalCount, chunk.TextureCount, chunk.FaceCount);
+	});
+
+	size_t positionCount = 0, normalCount = 0, textureCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.PositionOffset = positionCount;
+		chunk.NormalOffset = normalCount;
+		chunk.TextureOffset = textureCount;
+		positionCount += chunk.PositionCount;
+		normalCount += chunk.NormalCount;
+		textureCount += chunk.TextureCount;
+	}
+
+	std::vector<glm::vec3> positions(positionCount);
+	std::vector<glm::vec3> normals(normalCount);
+	std::vector<glm::vec2> textureCoords(textureCount);
+
+	// Parse the attributes and faces of each chunk, de-duplicating the vertices within the chunk
+	RunParallel(chunkCount, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		chunk.Positions = positions.data();
+		chunk.Normals = normals.data();
+		chunk.TextureCoords = textureCoords.data();
+		chunk.PositionsParsed = chunk.NormalsParsed = chunk.TexturesParsed = 0;
+		chunk.IndexMap.Reserve(EstimateUniqueVertices(chunk.FaceCount));
+		ParseObjRange(chunk.Begin, chunk.End, chunk);
+	});
+
+	// Merge the unique vertices from each chunk in file order, this gives us the same vertex order as the serial loader
+	VertexIndexMap indexMap;
+	size_t uniqueCount = 0;
+	for (const ObjChunk& chunk : chunks) {
+		uniqueCount += chunk.UniqueVertices.size();
+	}
+	indexMap.Reserve(uniqueCount);
+	mesh.ReserveVertexSpace(uniqueCount);
+
+	size_t indexCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.Remap.resize(chunk.UniqueVertices.size());
+		for (size_t ix = 0; ix < chunk.UniqueVertices.size(); ix++) {
+			const glm::ivec3& indices = chunk.UniqueVertices[ix];
+			auto result = indexMap.TryEmplace(indices, 0);
+			if (result.second) {
+				*result.first = mesh.AddVertex(MakeVertex(indices, positions, textureCoords, normals, inColor));
+			}
+			chunk.Remap[ix] = *result.first;
+		}
+		chunk.IndexOffset = indexCount;
+		indexCount += chunk.Indices.size();
+	}
+
+	// Finally we can translate each chunk's local indices into the final mesh's index buffer
+	const size_t baseIndex = mesh._indices.size();
+	mesh._indices.resize(baseIndex + indexCount);
+	uint32_t* outIndices = mesh._indices.data() + baseIndex;
+	RunParallel(chunkCount, [&](size_t ix) {
+		const ObjChunk& chunk = chunks[ix];
+		for (size_t i = 0; i < chunk.Indices.size(); i++) {
+			outIndices[chunk.IndexOffset + i] = chunk.Remap[chunk.Indices[i]];
+		}
+	});
+}
+
+uint64_t ObjLoader::GetCacheVariant(const glm::vec4& inColor)
+{
+	// The color is baked into the vertices, so it needs to be part of the cache key
+	return MeshCache::Hash(&inColor, sizeof(glm::vec4), OBJ_LOADER_VERSION);
+}
 
 VertexArrayObject::sptr ObjLoader::LoadFromFile(const std::string& filename, const glm::vec4& inColor)
+{
+	// If this mesh is already loaded, we can simply share the existing VAO
+	return AssetManager::Meshes.GetOrLoad(AssetManager::MakeMeshKey(filename, inColor), [&]() {
+		return LoadFromFileUncached(filename, inColor);
+	});
+}
+
+VertexArrayObject::sptr ObjLoader::LoadFromFileUncached(const std::string& filename, const glm::vec4& inColor)
+{
+	const uint64_t cacheVariant = GetCacheVariant(inColor);
+
+	// If we've already parsed this file before, we can upload the cached data directly
+	VertexArrayObject::sptr result = MeshCache::TryLoad(filename, cacheVariant, VertexPosNormTexColPacked::V_DECL);
+	if (result != nullptr) {
+		return result;
+	}
+
+	// We'll leverage the mesh builder class
+	MeshBuilder<VertexPosNormTexColPacked> mesh;
+	BuildCachedMesh(filename, mesh, inColor);
+	return mesh.Bake();
+}
+
+void ObjLoader::BuildCachedMesh(const std::string& filename, MeshBuilder<VertexPosNormTexColPacked>& mesh, const glm::vec4& inColor, size_t threadCount)
+{
+	MeshBuilder<VertexPosNormTexCol> source;
+	LoadMeshFromFileParallel(filename, source, inColor, threadCount);
+
+	// Since the result gets cached, we can afford to spend some extra time making the mesh faster to draw
+	MeshOptimizationStats stats = source.Optimize();
+	LOG_TRACE("Optimized \"{}\", ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", filename,
+		stats.Before.ACMR, stats.After.ACMR, stats.Before.ATVR, stats.After.ATVR);
+
+	// Packing the vertices halves the size of the mesh, both on disk and on the GPU
+	mesh = source.ConvertTo<VertexPosNormTexColPacked>();
+	MeshCache::Save(filename, GetCacheVariant(inColor), mesh);
+}
+
+
+void ObjLoader::LoadMeshFromFileStreamed(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor)
 {	
 	// Open our file in binary mode
 	std::ifstream file;
@@ -27,9 +536,6 @@ VertexArrayObject::sptr ObjLoader::LoadFromFile(const std::string& filename, con
 	// We'll use bitmask keys and a map to avoid duplicate vertices
 	std::unordered_map<uint64_t, uint32_t> indexMap;
 
-	// We'll leverage the mesh builder class
-	MeshBuilder<VertexPosNormTexCol> mesh;
-
 	// Temporaries for loading data
 	glm::vec3 temp;
 	glm::ivec3 vertexIndices;
@@ -120,10 +626,218 @@ VertexArrayObject::sptr ObjLoader::LoadFromFile(const std::string& filename, con
 			}
 		}
 	}
+}
+
+namespace {
+	// Returns true if the two meshes have byte for byte identical vertex and index buffers
+	bool MeshesMatch(const MeshBuilder<VertexPosNormTexCol>& a, const MeshBuilder<VertexPosNormTexCol>& b) {
+		return
+			a.GetVertexCount() == b.GetVertexCount() &&
+			a.GetIndexCount() == b.GetIndexCount() &&
+			memcmp(a.GetVertexDataPtr(), b.GetVertexDataPtr(), a.GetVertexCount() * sizeof(VertexPosNormTexCol)) == 0 &&
+			memcmp(a.GetIndexDataPtr(), b.GetIndexDataPtr(), a.GetIndexCount() * sizeof(uint32_t)) == 0;
+	}
+}
+
+void ObjLoader::Benchmark(const std::vector<std::string>& files, int iterations)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	typedef void(*LoadFunc)(const std::string&, MeshBuilder<VertexPosNormTexCol>&, const glm::vec4&);
+
+	const char* names[3] = { "Streamed", "Mapped", "Parallel" };
+	const LoadFunc loaders[3] = {
+		&ObjLoader::LoadMeshFromFileStreamed,
+		&ObjLoader::LoadMeshFromFile,
+		[](const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& color) {
+			ObjLoader::LoadMeshFromFileParallel(filename, mesh, color);
+		}
+	};
+
+	for (const std::string& filename : files) {
+		MemoryMappedFile file(filename);
+		if (!file.IsOpen()) {
+			LOG_WARN("Skipping benchmark for \"{}\", file could not be opened", filename);
+			continue;
+		}
+		const double megabytes = file.GetSize() / (1024.0 * 1024.0);
+		file.Close();
+
+		LOG_INFO("OBJ benchmark \"{}\" ({:.2f} MB, {} iterations)", filename, megabytes, iterations);
+
+		// We load the file once with each loader before timing, so that every run starts with the file in the OS cache
+		MeshBuilder<VertexPosNormTexCol> results[3];
+		for (int ix = 0; ix < 3; ix++) {
+			loaders[ix](filename, results[ix], glm::vec4(1.0f));
+		}
+
+		for (int ix = 0; ix < 3; ix++) {
+			double seconds = 0.0;
+			for (int i = 0; i < iterations; i++) {
+				MeshBuilder<VertexPosNormTexCol> mesh;
+				auto start = Clock::now();
+				loaders[ix](filename, mesh, glm::vec4(1.0f));
+				seconds += std::chrono::duration<double>(Clock::now() - start).count();
+			}
+			LOG_INFO("\t{:<8}: {:.2f} ms ({:.2f} MB/s)", names[ix], seconds * 1000.0 / iterations, megabytes * iterations / seconds);
+		}
+
+		// The streamed loader truncates polygons with more than 4 sides, so it may legitimately differ from the mapped loader
+		if (!MeshesMatch(results[0], results[1])) {
+			LOG_WARN("\t{} and {} loaders produced different meshes ({} / {} vertices, {} / {} indices)", names[0], names[1],
+				results[0].GetVertexCount(), results[1].GetVertexCount(), results[0].GetIndexCount(), results[1].GetIndexCount());
+		}
+		// The parallel loader must always match the serial mapped loader exactly
+		if (!MeshesMatch(results[1], results[2])) {
+			LOG_ERROR("\t{} and {} loaders produced different meshes", names[1], names[2]);
+		}
+
+		// Report how much the vertex cache optimization that runs before caching helps this mesh
+		auto start = Clock::now();
+		MeshOptimizationStats stats = results[1].Optimize();
+		LOG_INFO("\t{:<8}: {:.2f} ms (ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f})", "Optimize",
+			std::chrono::duration<double, std::milli>(Clock::now() - start).count(),
+			stats.Before.ACMR, stats.After.ACMR, stats.Before.ATVR, stats.After.ATVR);
+
+		// Time the same LOD chain the AsyncLoader would generate, see ValidateLods for checking the levels it produces
+		start = Clock::now();
+		std::vector<MeshLodData> lods = results[1].GenerateLods({ 0.5f, 0.25f, 0.1f });
+		const double lodMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		std::string summary = std::to_string(results[1].GetTriangleCount());
+		for (const MeshLodData& lod : lods) {
+			summary += fmt::format(" -> {}", lod.Indices.size() / 3);
+		}
+		LOG_INFO("\t{:<8}: {:.2f} ms (triangles {})", "LODs", lodMilliseconds, summary);
+	}
+}
 
-	// Note: with actual OBJ files you're going to run into the issue where faces are composited of different indices
-	// You'll need to keep track of these and create vertex entries for each vertex in the face
-	// If you want to get fancy, you can track which vertices you've already added
+bool ObjLoader::ValidateLods(const std::vector<std::string>& files, const std::vector<float>& triangleRatios, float maxError)
+{
+	bool result = true;
+	for (const std::string& filename : files) {
+		MeshBuilder<VertexPosNormTexCol> mesh;
+		LoadMeshFromFile(filename, mesh);
+		if (mesh.GetIndexCount() == 0) {
+			LOG_WARN("Skipping LOD validation for \"{}\", it has no triangles", filename);
+			continue;
+		}
 
-	return mesh.Bake();
+		const glm::vec3* positions = &mesh.GetVertexDataPtr()->Position;
+		const float scale = MeshSimplifier::GetScale(positions, sizeof(VertexPosNormTexCol), mesh.GetVertexCount());
+		std::vector<MeshLodData> lods = mesh.GenerateLods(triangleRatios, maxError);
+		LOG_INFO("LOD validation \"{}\" ({} triangles, {} levels)", filename, mesh.GetTriangleCount(), lods.size());
+
+		// Errors are logged relative to the size of the mesh, the same way the limit is given
+		size_t previousCount = mesh.GetIndexCount();
+		for (size_t level = 0; level < lods.size(); level++) {
+			const MeshLodData& lod = lods[level];
+			const float deviation = MeshSimplifier::MeasureDeviation(mesh.GetIndexDataPtr(), mesh.GetIndexCount(), lod.Indices.data(), lod.Indices.size(),
+				positions, sizeof(VertexPosNormTexCol), mesh.GetVertexCount());
+			const float relativeDeviation = scale > 0.0f ? deviation / scale : 0.0f;
+			const float relativeStored = scale > 0.0f ? lod.Error / scale : 0.0f;
+			const bool reduced = lod.Indices.size() < previousCount;
+			const bool withinLimit = relativeDeviation <= maxError;
+
+			if (reduced && withinLimit) {
+				LOG_INFO("\tLevel {}: {} triangles, stored error {:.4f}, measured {:.4f}", level + 1, lod.Indices.size() / 3, relativeStored, relativeDeviation);
+			} else {
+				LOG_ERROR("\tLevel {}: {} triangles, stored error {:.4f}, measured {:.4f} ({})", level + 1, lod.Indices.size() / 3, relativeStored,
+					relativeDeviation, reduced ? fmt::format("over the limit of {:.4f}", maxError) : "does not reduce the level before it");
+				result = false;
+			}
+			previousCount = lod.Indices.size();
+		}
+	}
+	return result;
+}
+
+void ObjLoader::BenchmarkVertexDedup(size_t faceCount, int iterations)
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	// Build the face vertices for a grid of quads split into triangles, the same way an exported height map or
+	// subdivided plane would reference its attributes. The smooth grid shares one uv and normal per position. The flat
+	// shaded grid gives every triangle its own normal, so the positions inside the grid end up with 6 vertices each.
+	// The fan is a disc where every triangle shares a centre position but has its own normal, which piles hundreds of
+	// vertices onto a single position
+	const size_t gridSize = std::max<size_t>(static_cast<size_t>(sqrt(faceCount / 2.0)), 1);
+	std::vector<glm::ivec3> smooth, flat, fan;
+	smooth.reserve(gridSize * gridSize * 6);
+	flat.reserve(gridSize * gridSize * 6);
+	fan.reserve(gridSize * gridSize * 6);
+	int normal = 1;
+	for (size_t y = 0; y < gridSize; y++) {
+		for (size_t x = 0; x < gridSize; x++) {
+			const int corners[4] = {
+				static_cast<int>(y * (gridSize + 1) + x + 1),
+				static_cast<int>(y * (gridSize + 1) + x + 2),
+				static_cast<int>((y + 1) * (gridSize + 1) + x + 1),
+				static_cast<int>((y + 1) * (gridSize + 1) + x + 2)
+			};
+			const int triangles[6] = { corners[0], corners[1], corners[2], corners[2], corners[1], corners[3] };
+			for (int ix = 0; ix < 6; ix++) {
+				smooth.push_back(glm::ivec3(triangles[ix]));
+				flat.push_back(glm::ivec3(triangles[ix], triangles[ix], normal + ix / 3));
+			}
+			normal += 2;
+		}
+	}
+	// Fans of 512 triangles, each with a centre position (every 513th index) and its own normal per triangle
+	for (size_t ix = 0; fan.size() < smooth.size(); ix++) {
+		const int centre = static_cast<int>(ix / 512 * 513 + 1);
+		const int rim = centre + 1 + static_cast<int>(ix % 512);
+		fan.push_back(glm::ivec3(centre, 0, static_cast<int>(ix + 1)));
+		fan.push_back(glm::ivec3(rim, 0, static_cast<int>(ix + 1)));
+		fan.push_back(glm::ivec3(ix % 512 == 511 ? centre + 1 : rim + 1, 0, static_cast<int>(ix + 1)));
+	}
+
+	struct Case {
+		const char* Name;
+		const std::vector<glm::ivec3>& FaceVertices;
+	};
+	const Case cases[] = { { "Smooth", smooth }, { "Flat shaded", flat }, { "Fans", fan } };
+	for (const Case& test : cases) {
+		const std::vector<glm::ivec3>& faceVertices = test.FaceVertices;
+		const size_t triangles = faceVertices.size() / 3;
+
+		LOG_INFO("Vertex de-duplication benchmark, {} ({} triangles, {} lookups, {} iterations)", test.Name, triangles, faceVertices.size(), iterations);
+
+		// Both maps get reserved from the face count, just like the loaders do, so we're only measuring the lookups
+		double seconds[2] = { 0.0, 0.0 };
+		size_t uniqueCounts[2] = { 0, 0 };
+		for (int i = 0; i < iterations; i++) {
+			{
+				auto start = Clock::now();
+				std::unordered_map<uint64_t, uint32_t> indexMap;
+				indexMap.reserve(EstimateUniqueVertices(triangles));
+				const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
+				for (const glm::ivec3& indices : faceVertices) {
+					const uint64_t key = ((indices.x & mask) << 42) | ((indices.y & mask) << 21) | (indices.z & mask);
+					indexMap.try_emplace(key, static_cast<uint32_t>(indexMap.size()));
+				}
+				seconds[0] += std::chrono::duration<double>(Clock::now() - start).count();
+				uniqueCounts[0] = indexMap.size();
+			}
+			{
+				auto start = Clock::now();
+				VertexIndexMap indexMap;
+				indexMap.Reserve(EstimateUniqueVertices(triangles));
+				for (const glm::ivec3& indices : faceVertices) {
+					indexMap.TryEmplace(indices, static_cast<uint32_t>(indexMap.Size()));
+				}
+				seconds[1] += std::chrono::duration<double>(Clock::now() - start).count();
+				uniqueCounts[1] = indexMap.Size();
+			}
+		}
+
+		const char* names[2] = { "unordered_map", "FlatHashMap" };
+		for (int ix = 0; ix < 2; ix++) {
+			LOG_INFO("\t{:<13}: {:.2f} ms ({:.1f} M lookups/s, {} unique)", names[ix], seconds[ix] * 1000.0 / iterations,
+				faceVertices.size() * iterations / seconds[ix] / 1000000.0, uniqueCounts[ix]);
+		}
+		LOG_INFO("\tSpeedup      : {:.2f}x", seconds[0] / seconds[1]);
+		if (uniqueCounts[0] != uniqueCounts[1]) {
+			LOG_ERROR("\tThe maps found a different number of unique vertices");
+		}
+	}
 }
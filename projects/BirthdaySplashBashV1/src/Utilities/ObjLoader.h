@@ -1,12 +1,96 @@
 #pragma once
 #include "MeshFactory.h"
 
+#include <string>
+#include <vector>
+
 class ObjLoader
 {
 public:
+	/// <summary>
+	/// Loads an OBJ file into a VAO, sharing the result with any earlier loads of the same file and color (see AssetManager)
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
 	static VertexArrayObject::sptr LoadFromFile(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Loads an OBJ file into a new VAO, bypassing the AssetManager. Use this if the mesh will be modified after loading
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	static VertexArrayObject::sptr LoadFromFileUncached(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f));
+
+	/// <summary>
+	/// Parses an OBJ file into a mesh builder without touching OpenGL. The file is memory mapped and tokenized
+	/// in place, so no strings or streams are allocated while reading it
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to append the vertices and indices to</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	static void LoadMeshFromFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Parses an OBJ file into a mesh builder, splitting the file into line aligned chunks that are parsed on worker
+	/// threads. The chunks are merged in file order, so the result is identical to LoadMeshFromFile. Small files are
+	/// parsed on the calling thread
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to append the vertices and indices to</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	/// <param name="threadCount">The maximum number of threads to use, or 0 to use one per hardware thread</param>
+	static void LoadMeshFromFileParallel(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor = glm::vec4(1.0f), size_t threadCount = 0);
+	/// <summary>
+	/// Parses an OBJ file into a mesh builder using the original iostream based loader. This is much slower than
+	/// LoadMeshFromFile, and is kept around as a reference for validating and benchmarking the mapped loader
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to append the vertices and indices to</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	static void LoadMeshFromFileStreamed(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor = glm::vec4(1.0f));
+
+	/// <summary>
+	/// Parses an OBJ file, optimizes it for the GPU's vertex cache, packs the vertices, and writes the result to the
+	/// mesh cache so that later loads can skip all of this work
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to store the mesh in, any existing contents are replaced</param>
+	/// <param name="inColor">The color to assign to every vertex in the mesh</param>
+	/// <param name="threadCount">The maximum number of threads to parse with, see LoadMeshFromFileParallel</param>
+	static void BuildCachedMesh(const std::string& filename, MeshBuilder<VertexPosNormTexColPacked>& mesh, const glm::vec4& inColor = glm::vec4(1.0f), size_t threadCount = 0);
+
+	/// <summary>
+	/// Gets the key that meshes loaded with the given color are stored under in the mesh cache
+	/// </summary>
+	static uint64_t GetCacheVariant(const glm::vec4& inColor = glm::vec4(1.0f));
+
+	/// <summary>
+	/// Loads each of the given files with the streamed, memory mapped and parallel loaders, logging the throughput of
+	/// each in MB/s and warning if the loaders disagree on the output. Also reports the vertex cache optimization and
+	/// the time it takes to generate the LOD chain for each mesh
+	/// </summary>
+	/// <param name="files">The OBJ files to load</param>
+	/// <param name="iterations">The number of times to load every file with each loader</param>
+	static void Benchmark(const std::vector<std::string>& files, int iterations = 5);
+	/// <summary>
+	/// Generates the LOD chain for each of the given files, and checks that every level has fewer triangles than the one
+	/// before it, and that its surface stays within maxError of the original. The distance is measured by sampling both
+	/// surfaces (see MeshSimplifier::MeasureDeviation) rather than trusting the simplifier's own estimate. Every level
+	/// is logged, with the ones that fail logged as errors
+	/// </summary>
+	/// <param name="files">The OBJ files to check</param>
+	/// <param name="triangleRatios">The fraction of the triangles to keep in each level, see MeshSimplifier::GenerateLods</param>
+	/// <param name="maxError">The largest distance allowed between a level and the original, relative to the size of the mesh</param>
+	/// <returns>True if every level of every file passed</returns>
+	static bool ValidateLods(const std::vector<std::string>& files, const std::vector<float>& triangleRatios = { 0.5f, 0.25f, 0.1f }, float maxError = 0.05f);
+	/// <summary>
+	/// Times the vertex de-duplication step on its own for generated smooth, flat shaded and triangle fan meshes, comparing
+	/// the flat hash map the loaders use against std::unordered_map with the old packed keys, and logs the lookups per
+	/// second of each
+	/// </summary>
+	/// <param name="faceCount">The number of triangles in the generated mesh</param>
+	/// <param name="iterations">The number of times to run the de-duplication with each map</param>
+	static void BenchmarkVertexDedup(size_t faceCount = 1000000, int iterations = 5);
 
 protected:
 	ObjLoader() = default;
 	~ObjLoader() = default;
-};
\ No newline at end of file
+};
@@ -0,0 +1,82 @@
+#include "RangeAllocator.h"
+
+#include <algorithm>
+#include "Logging.h"
+
+RangeAllocator::RangeAllocator(size_t capacity) :
+	_capacity(0),
+	_used(0)
+{
+	Reset(capacity);
+}
+
+size_t RangeAllocator::Allocate(size_t size) {
+	LOG_ASSERT(size > 0, "Cannot allocate an empty range");
+	for (auto it = _free.begin(); it != _free.end(); ++it) {
+		if (it->second >= size) {
+			const size_t offset = it->first;
+			const size_t remaining = it->second - size;
+			_free.erase(it);
+			if (remaining > 0) {
+				_free.emplace(offset + size, remaining);
+			}
+			_used += size;
+			return offset;
+		}
+	}
+	return INVALID_OFFSET;
+}
+
+void RangeAllocator::Free(size_t offset, size_t size) {
+	LOG_ASSERT(offset + size <= _capacity && size <= _used, "Freeing a range that was not allocated");
+	_used -= size;
+
+	// Merge with the free range that starts right where this one ends
+	auto next = _free.lower_bound(offset);
+	LOG_ASSERT(next == _free.end() || next->first >= offset + size, "Freeing a range that overlaps a free range");
+	if (next != _free.end() && next->first == offset + size) {
+		size += next->second;
+		next = _free.erase(next);
+	}
+	// And with the free range that ends right where this one starts
+	if (next != _free.begin()) {
+		auto prev = std::prev(next);
+		LOG_ASSERT(prev->first + prev->second <= offset, "Freeing a range that overlaps a free range");
+		if (prev->first + prev->second == offset) {
+			prev->second += size;
+			return;
+		}
+	}
+	_free.emplace_hint(next, offset, size);
+}
+
+void RangeAllocator::Grow(size_t capacity) {
+	LOG_ASSERT(capacity >= _capacity, "Cannot shrink a range allocator");
+	if (capacity == _capacity) {
+		return;
+	}
+	const size_t added = capacity - _capacity;
+	const size_t start = _capacity;
+	_capacity = capacity;
+	// Temporarily count the new space as used, so that freeing it merges it with any free range at the old end
+	_used += added;
+	Free(start, added);
+}
+
+void RangeAllocator::Reset(size_t capacity, size_t used) {
+	LOG_ASSERT(used <= capacity, "Cannot use more than the capacity");
+	_free.clear();
+	_capacity = capacity;
+	_used = used;
+	if (capacity > used) {
+		_free.emplace(used, capacity - used);
+	}
+}
+
+size_t RangeAllocator::GetLargestFree() const {
+	size_t result = 0;
+	for (const auto& kvp : _free) {
+		result = std::max(result, kvp.second);
+	}
+	return result;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <map>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Hands out ranges of a fixed size address space, such as the elements of a GPU buffer. Free ranges are kept sorted by
+/// offset, so neighbouring ranges are merged back together when they are freed. Allocation is first fit
+/// </summary>
+class RangeAllocator final
+{
+public:
+	/// <summary>
+	/// Returned by Allocate when there is no free range large enough
+	/// </summary>
+	static constexpr size_t INVALID_OFFSET = SIZE_MAX;
+
+	/// <summary>
+	/// Creates a new allocator with the entire capacity free
+	/// </summary>
+	/// <param name="capacity">The size of the address space to allocate from</param>
+	RangeAllocator(size_t capacity = 0);
+
+	/// <summary>
+	/// Allocates a range of the given size
+	/// </summary>
+	/// <param name="size">The size of the range to allocate, must be greater than 0</param>
+	/// <returns>The offset of the new range, or INVALID_OFFSET if there is no free range large enough</returns>
+	size_t Allocate(size_t size);
+	/// <summary>
+	/// Returns a range to the allocator, the range must have come from Allocate (or be part of the used range set by Reset)
+	/// </summary>
+	/// <param name="offset">The offset of the range to free</param>
+	/// <param name="size">The size of the range to free</param>
+	void Free(size_t offset, size_t size);
+	/// <summary>
+	/// Increases the size of the address space, the new space is added to the end and is free
+	/// </summary>
+	/// <param name="capacity">The new capacity, must be at least the current capacity</param>
+	void Grow(size_t capacity);
+	/// <summary>
+	/// Marks everything below used as allocated and everything above it as free, used after compacting the allocations
+	/// </summary>
+	/// <param name="capacity">The new capacity</param>
+	/// <param name="used">The size of the allocated range at the start of the address space</param>
+	void Reset(size_t capacity, size_t used = 0);
+
+	/// <summary>
+	/// Returns the total size of the address space
+	/// </summary>
+	size_t GetCapacity() const { return _capacity; }
+	/// <summary>
+	/// Returns the total size of all of the allocated ranges
+	/// </summary>
+	size_t GetUsed() const { return _used; }
+	/// <summary>
+	/// Returns the number of separate free ranges, a high count relative to the number of allocations means the space is fragmented
+	/// </summary>
+	size_t GetFreeRangeCount() const { return _free.size(); }
+	/// <summary>
+	/// Returns the size of the largest range that could currently be allocated
+	/// </summary>
+	size_t GetLargestFree() const;
+
+private:
+	// The free ranges, offset -> size
+	std::map<size_t, size_t> _free;
+	size_t _capacity;
+	size_t _used;
+};
@@ -0,0 +1,563 @@
+#include "StaticBatcher.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "Logging.h"
+#include "VertexTypes.h"
+#include "Graphics/Texture2D.h"
+#include "Graphics/VertexFormat.h"
+#include "Gameplay/GameObjectTag.h"
+#include "Gameplay/RendererComponent.h"
+#include "Gameplay/Transform.h"
+
+namespace {
+	constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+	// Materials that only differ by this texture can share a batch, by packing their textures into an atlas
+	const ShaderParamName ATLAS_TEXTURE("s_Diffuse");
+	// The number of texels that each texture's edges are stretched out by in an atlas, so that linear filtering does not
+	// pick up the neighbouring textures. Our textures only have a single mip level, so this does not need to grow for
+	// the smaller levels
+	constexpr int ATLAS_PADDING = 2;
+	// How far outside of [0, 1] a UV can be and still be treated as the edge of the texture
+	constexpr float UV_TOLERANCE = 0.001f;
+
+	typedef VertexPosNormTexColPacked SourceVertex;
+	// The half float UVs of the packed layout are not precise enough to address a texture within an atlas, so batches
+	// are written out with full precision vertices instead
+	typedef VertexPosNormTexCol BatchVertex;
+
+	// One level of detail of a static entity's mesh
+	struct SourceLevel {
+		std::vector<uint32_t> Indices;
+		// How far this level's surface may be from the full detail mesh, in world space
+		float                 Error;
+	};
+
+	// A static entity's mesh, read back from the GPU
+	struct BatchSource {
+		entt::entity              Entity;
+		std::string               Name;
+		ShaderMaterial::sptr      Material;
+		std::vector<SourceVertex> Vertices;
+		// The indices of each level of detail, finest first. Entities without levels of detail only have the one level
+		std::vector<SourceLevel>  Levels;
+		// The level of detail settings, copied from the entity's MeshLodGroup if it has one
+		float                     MaxScreenError;
+		float                     Hysteresis;
+		// The texture that would be packed into an atlas, or nullptr if the entity can only batch with its own material
+		Texture2D::sptr           AtlasTexture;
+	};
+
+	// The static entities that can be drawn with a single material
+	struct MaterialGroup {
+		ShaderMaterial::sptr Material;
+		// Whether every source has a texture that could be packed into an atlas
+		bool                 CanAtlas;
+		// Whether the sources have different atlas textures, and need to be merged by packing their textures together
+		bool                 UsesAtlas;
+		std::vector<size_t>  Sources;
+	};
+
+	// Where a texture ended up in an atlas, in UV space
+	struct AtlasRegion {
+		glm::vec2 Offset;
+		glm::vec2 Scale;
+	};
+
+	// Reads a mesh's indices back from the GPU, meshes without an index buffer get one index per vertex
+	bool ReadIndices(const VertexArrayObject::sptr& vao, size_t vertexCount, std::vector<uint32_t>& indices) {
+		const IndexBuffer::sptr& ebo = vao->GetIndexBuffer();
+		if (ebo == nullptr) {
+			indices.resize(vertexCount);
+			for (size_t ix = 0; ix < indices.size(); ix++) {
+				indices[ix] = static_cast<uint32_t>(ix);
+			}
+			return true;
+		}
+
+		indices.resize(ebo->GetElementCount());
+		switch (ebo->GetElementType()) {
+			case GL_UNSIGNED_INT:
+				ebo->GetData(indices.data(), 0, indices.size() * sizeof(uint32_t));
+				break;
+			case GL_UNSIGNED_SHORT: {
+				std::vector<uint16_t> narrow(indices.size());
+				ebo->GetData(narrow.data(), 0, narrow.size() * sizeof(uint16_t));
+				std::copy(narrow.begin(), narrow.end(), indices.begin());
+				break;
+			}
+			case GL_UNSIGNED_BYTE: {
+				std::vector<uint8_t> narrow(indices.size());
+				ebo->GetData(narrow.data(), 0, narrow.size() * sizeof(uint8_t));
+				std::copy(narrow.begin(), narrow.end(), indices.begin());
+				break;
+			}
+			default:
+				return false;
+		}
+		return true;
+	}
+
+	// Reads a mesh's vertices and indices back from the GPU, returning false if it is not in the packed vertex layout
+	bool ReadMesh(const VertexArrayObject::sptr& vao, std::vector<SourceVertex>& vertices, std::vector<uint32_t>& indices) {
+		if (vao == nullptr || vao->GetVertexBufferCount() != 1 || !VertexFormat::Matches(vao->GetVertexBufferAttributes(0), SourceVertex::V_DECL)) {
+			return false;
+		}
+		const VertexBuffer::sptr& vbo = vao->GetVertexBuffer(0);
+		if (vbo->GetElementCount() == 0) {
+			return false;
+		}
+		vertices.resize(vbo->GetElementCount());
+		vbo->GetData(vertices.data(), 0, vertices.size() * sizeof(SourceVertex));
+		return ReadIndices(vao, vertices.size(), indices);
+	}
+
+	// Reads every level of detail that a renderer can draw into a source. Levels of detail normally share the full detail
+	// level's vertex buffer, so those only need their indices read back
+	bool ReadSource(const RendererComponent& renderer, const glm::mat4& world, BatchSource& source) {
+		if (renderer.Lods == nullptr) {
+			source.Levels.resize(1);
+			source.Levels[0].Error = 0.0f;
+			source.MaxScreenError = 0.0f;
+			source.Hysteresis = 0.0f;
+			return ReadMesh(renderer.Mesh, source.Vertices, source.Levels[0].Indices);
+		}
+
+		// Level errors are in model space, scale them by the largest axis in the same way as MeshLodGroup::GetScreenSize
+		const float scale = sqrtf(std::max(glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+			std::max(glm::dot(glm::vec3(world[1]), glm::vec3(world[1])), glm::dot(glm::vec3(world[2]), glm::vec3(world[2])))));
+		const MeshLodGroup& lods = *renderer.Lods;
+		source.MaxScreenError = lods.GetMaxScreenError();
+		source.Hysteresis = lods.GetHysteresis();
+		source.Levels.resize(lods.GetLevelCount());
+
+		const VertexBuffer* sharedVbo = nullptr;
+		std::vector<SourceVertex> vertices;
+		for (size_t level = 0; level < lods.GetLevelCount(); level++) {
+			const VertexArrayObject::sptr& vao = lods.GetLevel(level).Mesh;
+			SourceLevel& result = source.Levels[level];
+			result.Error = lods.GetLevel(level).Error * scale;
+
+			if (sharedVbo != nullptr && vao != nullptr && vao->GetVertexBufferCount() == 1 && vao->GetVertexBuffer(0).get() == sharedVbo) {
+				if (!ReadIndices(vao, sharedVbo->GetElementCount(), result.Indices)) {
+					return false;
+				}
+				continue;
+			}
+
+			// Anything with its own vertices gets them appended after the levels we already have
+			if (!ReadMesh(vao, vertices, result.Indices)) {
+				return false;
+			}
+			const uint32_t offset = static_cast<uint32_t>(source.Vertices.size());
+			for (uint32_t& index : result.Indices) {
+				index += offset;
+			}
+			source.Vertices.insert(source.Vertices.end(), vertices.begin(), vertices.end());
+			sharedVbo = level == 0 ? vao->GetVertexBuffer(0).get() : sharedVbo;
+		}
+		return true;
+	}
+
+	// Gets the texture that a source would pack into an atlas, or nullptr if its material has none or the mesh samples
+	// outside of [0, 1] (which relies on the texture repeating, and would read the neighbouring textures in an atlas)
+	Texture2D::sptr GetAtlasTexture(const ShaderMaterial& material, const BatchSource& source) {
+		auto it = material.Textures.find(ATLAS_TEXTURE);
+		if (it == material.Textures.end()) {
+			return nullptr;
+		}
+		Texture2D::sptr texture = std::dynamic_pointer_cast<Texture2D>(it->second);
+		if (texture == nullptr || texture->GetWidth() == 0 || texture->GetHeight() == 0) {
+			return nullptr;
+		}
+		for (const SourceLevel& level : source.Levels) {
+			for (uint32_t index : level.Indices) {
+				const glm::vec2 uv = glm::unpackHalf2x16(source.Vertices[index].UV);
+				if (glm::any(glm::lessThan(uv, glm::vec2(-UV_TOLERANCE))) || glm::any(glm::greaterThan(uv, glm::vec2(1.0f + UV_TOLERANCE)))) {
+					return nullptr;
+				}
+			}
+		}
+		return texture;
+	}
+
+	// Checks whether two materials are the same in everything but their atlas textures
+	bool MatchesOutsideAtlas(const ShaderMaterial& a, const ShaderMaterial& b) {
+		if (a.Shader != b.Shader || a.RenderLayer != b.RenderLayer ||
+			a.FloatParams != b.FloatParams || a.Vec2Params != b.Vec2Params || a.Vec3Params != b.Vec3Params ||
+			a.Vec4Params != b.Vec4Params || a.Mat4Params != b.Mat4Params || a.Mat3Params != b.Mat3Params ||
+			a.Textures.size() != b.Textures.size()) {
+			return false;
+		}
+		for (const auto& [name, texture] : a.Textures) {
+			auto it = b.Textures.find(name);
+			if (it == b.Textures.end() || (name != ATLAS_TEXTURE && it->second != texture)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Makes a copy of a material that samples the atlas instead of its own texture
+	ShaderMaterial::sptr CreateAtlasMaterial(const ShaderMaterial& source, const Texture2D::sptr& atlas, size_t batchIndex) {
+		ShaderMaterial::sptr result = ShaderMaterial::Create();
+		result->Shader      = source.Shader;
+		result->Textures    = source.Textures;
+		result->FloatParams = source.FloatParams;
+		result->Vec2Params  = source.Vec2Params;
+		result->Vec3Params  = source.Vec3Params;
+		result->Vec4Params  = source.Vec4Params;
+		result->Mat4Params  = source.Mat4Params;
+		result->Mat3Params  = source.Mat3Params;
+		result->RenderLayer = source.RenderLayer;
+		result->DebugName   = "Static Batch Atlas " + std::to_string(batchIndex);
+		result->Set(ATLAS_TEXTURE.Name, atlas);
+		return result;
+	}
+
+	// Packs the textures into rows, tallest first, and copies them into a new texture on the GPU. Returns nullptr if the
+	// atlas would be larger than the GPU supports
+	Texture2D::sptr BuildAtlas(const std::vector<Texture2D::sptr>& textures, std::vector<AtlasRegion>& regions) {
+		std::vector<size_t> order(textures.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return textures[a]->GetHeight() > textures[b]->GetHeight(); });
+
+		// Start from the smallest square that could fit everything, and let the rows grow it taller if they need to
+		const int maxSize = ITexture::GetLimits().MAX_TEXTURE_SIZE;
+		size_t area = 0;
+		int width = 1;
+		int widest = 0;
+		for (const Texture2D::sptr& texture : textures) {
+			const int paddedWidth = static_cast<int>(texture->GetWidth()) + ATLAS_PADDING * 2;
+			area += static_cast<size_t>(paddedWidth) * (texture->GetHeight() + ATLAS_PADDING * 2);
+			widest = std::max(widest, paddedWidth);
+		}
+		while ((static_cast<size_t>(width) * width < area || width < widest) && width <= maxSize) {
+			width *= 2;
+		}
+
+		std::vector<glm::ivec2> positions(textures.size());
+		int x = 0, y = 0, rowHeight = 0;
+		for (size_t ix : order) {
+			const int paddedWidth = static_cast<int>(textures[ix]->GetWidth()) + ATLAS_PADDING * 2;
+			const int paddedHeight = static_cast<int>(textures[ix]->GetHeight()) + ATLAS_PADDING * 2;
+			if (x + paddedWidth > width) {
+				x = 0;
+				y += rowHeight;
+				rowHeight = 0;
+			}
+			positions[ix] = glm::ivec2(x + ATLAS_PADDING, y + ATLAS_PADDING);
+			x += paddedWidth;
+			rowHeight = std::max(rowHeight, paddedHeight);
+		}
+		int height = 1;
+		while (height < y + rowHeight && height <= maxSize) {
+			height *= 2;
+		}
+
+		if (width > maxSize || height > maxSize) {
+			return nullptr;
+		}
+
+		Texture2DDescription desc = textures[0]->GetDescription();
+		desc.Width = width;
+		desc.Height = height;
+		desc.Format = InternalFormat::RGBA8;
+		desc.HorizontalWrap = WrapMode::ClampToEdge;
+		desc.VerticalWrap = WrapMode::ClampToEdge;
+		Texture2D::sptr atlas = Texture2D::Create(desc);
+
+		// Blitting converts between formats for us, so the textures can be copied without ever leaving the GPU
+		GLuint framebuffers[2];
+		glCreateFramebuffers(2, framebuffers);
+		glNamedFramebufferTexture(framebuffers[1], GL_COLOR_ATTACHMENT0, atlas->GetHandle(), 0);
+		auto blit = [&](int srcX0, int srcY0, int srcX1, int srcY1, int dstX0, int dstY0, int dstX1, int dstY1) {
+			glBlitNamedFramebuffer(framebuffers[0], framebuffers[1], srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		};
+
+		regions.resize(textures.size());
+		for (size_t ix = 0; ix < textures.size(); ix++) {
+			glNamedFramebufferTexture(framebuffers[0], GL_COLOR_ATTACHMENT0, textures[ix]->GetHandle(), 0);
+			const int w = static_cast<int>(textures[ix]->GetWidth());
+			const int h = static_cast<int>(textures[ix]->GetHeight());
+			const int x0 = positions[ix].x, y0 = positions[ix].y;
+			const int p = ATLAS_PADDING;
+
+			blit(0, 0, w, h, x0, y0, x0 + w, y0 + h);
+			// Stretch the edges and corners out over the padding
+			blit(0, 0, 1, h, x0 - p, y0, x0, y0 + h);
+			blit(w - 1, 0, w, h, x0 + w, y0, x0 + w + p, y0 + h);
+			blit(0, 0, w, 1, x0, y0 - p, x0 + w, y0);
+			blit(0, h - 1, w, h, x0, y0 + h, x0 + w, y0 + h + p);
+			blit(0, 0, 1, 1, x0 - p, y0 - p, x0, y0);
+			blit(w - 1, 0, w, 1, x0 + w, y0 - p, x0 + w + p, y0);
+			blit(0, h - 1, 1, h, x0 - p, y0 + h, x0, y0 + h + p);
+			blit(w - 1, h - 1, w, h, x0 + w, y0 + h, x0 + w + p, y0 + h + p);
+
+			regions[ix].Offset = glm::vec2(x0, y0) / glm::vec2(width, height);
+			regions[ix].Scale = glm::vec2(w, h) / glm::vec2(width, height);
+		}
+
+		glDeleteFramebuffers(2, framebuffers);
+		return atlas;
+	}
+
+	// Counts the draw calls that the static entities in a scene take, including any batches they have been merged into
+	size_t CountStaticDrawCalls(entt::registry& registry) {
+		size_t result = registry.view<StaticBatch>().size();
+		registry.view<StaticTag, RendererComponent>(entt::exclude<StaticBatched>).each([&](entt::entity, RendererComponent&) {
+			result++;
+		});
+		return result;
+	}
+}
+
+size_t StaticBatcher::Bake(const GameScene::sptr& scene) {
+	entt::registry& registry = scene->Registry();
+	const size_t drawCallsBefore = CountStaticDrawCalls(registry);
+	Clear(scene);
+
+	// Read back every static mesh that could be batched, in registry order
+	std::vector<BatchSource> sources;
+	// StaticTag is empty, so the view does not pass it to us
+	registry.view<StaticTag, RendererComponent, Transform>().each([&](entt::entity entity, RendererComponent& renderer, Transform& transform) {
+		if (renderer.Mesh == nullptr || renderer.Material == nullptr) {
+			return;
+		}
+
+		const GameObjectTag* tag = registry.try_get<GameObjectTag>(entity);
+		BatchSource source;
+		source.Entity = entity;
+		source.Name = tag != nullptr ? tag->Name : "Entity " + std::to_string(entt::to_integral(entity));
+		source.Material = renderer.Material;
+		transform.UpdateWorldMatrix();
+		if (!ReadSource(renderer, transform.WorldTransform(), source)) {
+			LOG_WARN("Static entity \"{}\" could not be batched, its mesh is not loaded or is not in the packed vertex layout", source.Name);
+			return;
+		}
+		source.AtlasTexture = GetAtlasTexture(*source.Material, source);
+		sources.push_back(std::move(source));
+	});
+
+	// Sources share a group if they use the same material, or if their materials only differ by a texture that can be
+	// packed into an atlas
+	std::vector<MaterialGroup> groups;
+	for (size_t ix = 0; ix < sources.size(); ix++) {
+		const BatchSource& source = sources[ix];
+		auto it = std::find_if(groups.begin(), groups.end(), [&](const MaterialGroup& group) {
+			if (source.AtlasTexture == nullptr) {
+				return !group.CanAtlas && group.Material == source.Material;
+			}
+			return group.CanAtlas && MatchesOutsideAtlas(*group.Material, *source.Material);
+		});
+		if (it == groups.end()) {
+			groups.push_back({ source.Material, source.AtlasTexture != nullptr, false, { ix } });
+		} else {
+			it->UsesAtlas |= sources[it->Sources[0]].AtlasTexture != source.AtlasTexture;
+			it->Sources.push_back(ix);
+		}
+	}
+
+	size_t batchCount = 0;
+	size_t atlasCount = 0;
+	std::vector<uint32_t> remap;
+	// Groups can be split up while we go, so this can't use iterators
+	for (size_t groupIx = 0; groupIx < groups.size(); groupIx++) {
+		// Batching a single entity wouldn't save us anything
+		if (groups[groupIx].Sources.size() < 2) {
+			continue;
+		}
+		const MaterialGroup group = groups[groupIx];
+
+		ShaderMaterial::sptr material = group.Material;
+		std::vector<AtlasRegion> sourceRegions(group.Sources.size(), { glm::vec2(0.0f), glm::vec2(1.0f) });
+		if (group.UsesAtlas) {
+			std::vector<Texture2D::sptr> textures;
+			std::vector<size_t> textureIndices;
+			for (size_t sourceIx : group.Sources) {
+				const Texture2D::sptr& texture = sources[sourceIx].AtlasTexture;
+				auto it = std::find(textures.begin(), textures.end(), texture);
+				textureIndices.push_back(static_cast<size_t>(it - textures.begin()));
+				if (it == textures.end()) {
+					textures.push_back(texture);
+				}
+			}
+
+			std::vector<AtlasRegion> regions;
+			Texture2D::sptr atlas = BuildAtlas(textures, regions);
+			if (atlas == nullptr) {
+				// Fall back to batching each material on its own
+				LOG_WARN("The textures of {} static entities are too large to fit in one atlas, they will be batched by material instead", group.Sources.size());
+				for (size_t sourceIx : group.Sources) {
+					const BatchSource& source = sources[sourceIx];
+					auto it = std::find_if(groups.begin() + groupIx + 1, groups.end(), [&](const MaterialGroup& other) {
+						return !other.CanAtlas && other.Material == source.Material;
+					});
+					if (it == groups.end()) {
+						groups.push_back({ source.Material, false, false, { sourceIx } });
+					} else {
+						it->Sources.push_back(sourceIx);
+					}
+				}
+				continue;
+			}
+
+			for (size_t ix = 0; ix < group.Sources.size(); ix++) {
+				sourceRegions[ix] = regions[textureIndices[ix]];
+			}
+			material = CreateAtlasMaterial(*group.Material, atlas, batchCount);
+			atlasCount++;
+		}
+
+		// Entities without levels of detail (or with fewer levels than the rest) draw their coarsest level in every level
+		size_t levelCount = 1;
+		float maxScreenError = 0.0f;
+		float hysteresis = 0.0f;
+		for (size_t sourceIx : group.Sources) {
+			const BatchSource& source = sources[sourceIx];
+			levelCount = std::max(levelCount, source.Levels.size());
+			if (source.Levels.size() > 1) {
+				// Use the strictest settings, so no entity gets coarser than it would have on its own
+				maxScreenError = maxScreenError > 0.0f ? std::min(maxScreenError, source.MaxScreenError) : source.MaxScreenError;
+				hysteresis = std::max(hysteresis, source.Hysteresis);
+			}
+		}
+
+		// The levels share one vertex buffer, and each get their own indices
+		std::vector<BatchVertex> vertices;
+		std::vector<std::vector<uint32_t>> levelIndices(levelCount);
+		std::vector<float> levelErrors(levelCount, 0.0f);
+		// The sources with levels of detail, each becomes a part of the batch's MeshLodGroup
+		std::vector<size_t> lodRanges;
+		StaticBatch batch;
+
+		for (size_t ix = 0; ix < group.Sources.size(); ix++) {
+			const BatchSource& source = sources[group.Sources[ix]];
+			const AtlasRegion& region = sourceRegions[ix];
+			const Transform& transform = registry.get<Transform>(source.Entity);
+
+			const glm::mat4& world = transform.WorldTransform();
+			const glm::mat3& normalMatrix = transform.WorldNormalMatrix();
+			// A mirroring transform turns the triangles inside out, so we need to flip the winding to keep them front facing
+			const bool flipWinding = glm::determinant(glm::mat3(world)) < 0.0f;
+
+			StaticBatch::Range range;
+			range.Source = source.Entity;
+			range.Name = source.Name;
+			range.FirstIndex = static_cast<uint32_t>(levelIndices[0].size());
+			range.FirstVertex = static_cast<uint32_t>(vertices.size());
+
+			// Only copy the vertices that the levels actually use, since a mesh may share its vertex buffer. Vertices that
+			// several levels use are only copied once
+			remap.assign(source.Vertices.size(), INVALID_INDEX);
+			for (size_t level = 0; level < levelCount; level++) {
+				const SourceLevel& sourceLevel = source.Levels[std::min(level, source.Levels.size() - 1)];
+				std::vector<uint32_t>& indices = levelIndices[level];
+				levelErrors[level] = std::max(levelErrors[level], sourceLevel.Error);
+
+				for (size_t index = 0; index + 2 < sourceLevel.Indices.size(); index += 3) {
+					uint32_t triangle[3] = { sourceLevel.Indices[index], sourceLevel.Indices[index + 1], sourceLevel.Indices[index + 2] };
+					if (flipWinding) {
+						std::swap(triangle[1], triangle[2]);
+					}
+					for (uint32_t sourceIndex : triangle) {
+						if (remap[sourceIndex] == INVALID_INDEX) {
+							remap[sourceIndex] = static_cast<uint32_t>(vertices.size());
+
+							const SourceVertex& sourceVertex = source.Vertices[sourceIndex];
+							BatchVertex vertex;
+							vertex.Position = glm::vec3(world * glm::vec4(sourceVertex.Position, 1.0f));
+							const glm::vec3 normal = normalMatrix * glm::vec3(glm::unpackSnorm3x10_1x2(sourceVertex.Normal));
+							const float length = glm::length(normal);
+							vertex.Normal = length > 0.0f ? normal / length : normal;
+							glm::vec2 uv = glm::unpackHalf2x16(sourceVertex.UV);
+							if (group.UsesAtlas) {
+								uv = region.Offset + glm::clamp(uv, 0.0f, 1.0f) * region.Scale;
+							}
+							vertex.UV = uv;
+							vertex.Color = glm::unpackUnorm4x8(sourceVertex.Color);
+							vertices.push_back(vertex);
+						}
+						indices.push_back(remap[sourceIndex]);
+					}
+				}
+			}
+
+			range.IndexCount = static_cast<uint32_t>(levelIndices[0].size()) - range.FirstIndex;
+			range.VertexCount = static_cast<uint32_t>(vertices.size()) - range.FirstVertex;
+			if (source.Levels.size() > 1) {
+				lodRanges.push_back(ix);
+			}
+			batch.Ranges.push_back(range);
+		}
+
+		const std::string name = "Static Batch " + std::to_string(batchCount);
+		VertexBuffer::sptr vbo = VertexBuffer::Create();
+		vbo->LoadData(vertices.data(), vertices.size());
+		std::vector<VertexArrayObject::sptr> levelMeshes(levelCount);
+		for (size_t level = 0; level < levelCount; level++) {
+			IndexBuffer::sptr ebo = IndexBuffer::Create();
+			ebo->LoadIndices(levelIndices[level].data(), levelIndices[level].size(), vertices.size());
+			levelMeshes[level] = VertexArrayObject::Create();
+			levelMeshes[level]->AddVertexBuffer(vbo, BatchVertex::V_DECL);
+			levelMeshes[level]->SetIndexBuffer(ebo);
+			levelMeshes[level]->SetDebugName(levelCount > 1 ? name + " LOD " + std::to_string(level) : name);
+		}
+
+		GameObject batchObject = scene->CreateEntity(name);
+		RendererComponent& renderer = batchObject.emplace<RendererComponent>();
+		if (levelCount > 1) {
+			// The batch is already in world space, so each entity with levels of detail becomes a part with its own world
+			// space bounds. The batch draws the finest level any of them need, so none end up coarser than on their own
+			MeshLodGroup::sptr lods = MeshLodGroup::Create();
+			for (size_t level = 0; level < levelCount; level++) {
+				lods->AddLevel(levelMeshes[level], levelErrors[level]);
+			}
+			glm::vec3 center;
+			float radius;
+			MeshLodGroup::ComputeBounds(&vertices[0].Position, sizeof(BatchVertex), vertices.size(), center, radius);
+			lods->SetBounds(center, radius);
+			std::vector<float> partErrors(levelCount);
+			for (size_t ix : lodRanges) {
+				const BatchSource& source = sources[group.Sources[ix]];
+				const StaticBatch::Range& range = batch.Ranges[ix];
+				for (size_t level = 0; level < levelCount; level++) {
+					partErrors[level] = source.Levels[std::min(level, source.Levels.size() - 1)].Error;
+				}
+				MeshLodGroup::ComputeBounds(&vertices[range.FirstVertex].Position, sizeof(BatchVertex), range.VertexCount, center, radius);
+				lods->AddPart(center, radius, partErrors);
+			}
+			lods->SetMaxScreenError(maxScreenError);
+			lods->SetHysteresis(hysteresis);
+			renderer.SetLods(lods);
+		} else {
+			renderer.SetMesh(levelMeshes[0]);
+		}
+		renderer.SetMaterial(material);
+		for (size_t sourceIx : group.Sources) {
+			registry.emplace<StaticBatched>(sources[sourceIx].Entity, batchObject.entity());
+		}
+
+		LOG_TRACE("{}: merged {} entities ({} vertices, {} triangles, {} levels of detail{})", name, group.Sources.size(), vertices.size(),
+			levelIndices[0].size() / 3, levelCount, group.UsesAtlas ? ", textures packed into an atlas" : "");
+		batchObject.emplace<StaticBatch>(std::move(batch));
+		batchCount++;
+	}
+
+	LOG_INFO("Baked the static entities in \"{}\" into {} batches ({} with texture atlases), static draw calls went from {} to {}",
+		scene->Name, batchCount, atlasCount, drawCallsBefore, CountStaticDrawCalls(registry));
+	return batchCount;
+}
+
+void StaticBatcher::Clear(const GameScene::sptr& scene) {
+	entt::registry& registry = scene->Registry();
+
+	std::vector<entt::entity> batches;
+	registry.view<StaticBatch>().each([&](entt::entity entity, StaticBatch&) {
+		batches.push_back(entity);
+	});
+	registry.destroy(batches.begin(), batches.end());
+	registry.clear<StaticBatched>();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Gameplay/Scene.h"
+#include "Gameplay/StaticBatch.h"
+
+/// <summary>
+/// Merges the meshes of static entities (see StaticTag) that share a material into a single VAO per material, with
+/// the vertices pre-transformed into world space. This takes a whole scene of props down to one draw call and one set
+/// of per-object uniforms per material.
+///
+/// Materials that are identical other than their s_Diffuse texture are merged as well, by packing their textures into
+/// an atlas and giving the batch a copy of the material that samples it. This only applies to meshes whose UVs stay
+/// within [0, 1], since anything that relies on its texture repeating would sample its neighbours in the atlas.
+///
+/// Meshes are read back from the GPU, so every mesh must have finished loading before baking (see AsyncLoader::IsIdle).
+/// Only meshes in the packed VertexPosNormTexColPacked layout can be merged, anything else is left to draw on its own.
+///
+/// Entities with levels of detail are merged level by level, and the batch gets a MeshLodGroup of its own. Entities with
+/// fewer levels (or none at all) use their coarsest level in the levels past their own. Each entity with levels of detail
+/// is a part of the batch's MeshLodGroup, and the batch draws the finest level that any of those need, so no entity is
+/// drawn coarser than it would be on its own
+/// </summary>
+class StaticBatcher abstract
+{
+public:
+	/// <summary>
+	/// Removes any existing batches from the scene, then merges every static entity that shares a material (or an atlas)
+	/// with at least one other static entity. Can be called again at any time to rebuild the batches after the scene changes
+	/// </summary>
+	/// <param name="scene">The scene to bake</param>
+	/// <returns>The number of batches that were created</returns>
+	static size_t Bake(const GameScene::sptr& scene);
+	/// <summary>
+	/// Destroys all of the batches in a scene, and returns the source entities to drawing on their own
+	/// </summary>
+	/// <param name="scene">The scene to remove the batches from</param>
+	static void Clear(const GameScene::sptr& scene);
+};
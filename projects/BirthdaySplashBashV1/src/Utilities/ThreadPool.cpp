@@ -0,0 +1,128 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+	// Lets Submit and TryRunOne know which queue belongs to the calling thread, if it is one of our workers
+	thread_local ThreadPool* currentPool = nullptr;
+	thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(int workerCount) :
+	_queuedCount(0),
+	_nextQueue(0),
+	_isStopping(false)
+{
+	if (workerCount < 0) {
+		workerCount = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+	}
+
+	// The extra queue at the end is for threads outside of the pool
+	for (int ix = 0; ix <= workerCount; ix++) {
+		_queues.push_back(std::make_unique<Queue>());
+	}
+	_threads.reserve(workerCount);
+	for (int ix = 0; ix < workerCount; ix++) {
+		_threads.emplace_back(&ThreadPool::_WorkerLoop, this, static_cast<size_t>(ix));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_isStopping = true;
+	}
+	_wake.notify_all();
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+}
+
+ThreadPool& ThreadPool::Instance() {
+	static ThreadPool instance;
+	return instance;
+}
+
+void ThreadPool::Submit(Task task) {
+	size_t index;
+	if (currentPool == this) {
+		index = currentWorker;
+	} else if (_threads.empty()) {
+		index = _queues.size() - 1;
+	} else {
+		// Spread tasks from outside the pool across the workers, so they can get started without having to steal
+		index = _nextQueue.fetch_add(1, std::memory_order_relaxed) % _threads.size();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_queues[index]->Mutex);
+		_queues[index]->Tasks.push_back(std::move(task));
+	}
+	_queuedCount.fetch_add(1);
+
+	// Taking the lock makes sure a worker that just found the queues empty is actually waiting before we notify it
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+	}
+	_wake.notify_one();
+}
+
+bool ThreadPool::TryRunOne() {
+	Task task;
+	if (_Pop(currentPool == this ? currentWorker : _queues.size() - 1, task)) {
+		task();
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::_WorkerLoop(size_t index) {
+	currentPool = this;
+	currentWorker = index;
+
+	Task task;
+	while (true) {
+		if (_Pop(index, task)) {
+			task();
+			task = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wake.wait(lock, [this]() { return _isStopping || _queuedCount.load() > 0; });
+		if (_isStopping) {
+			return;
+		}
+	}
+}
+
+bool ThreadPool::_Pop(size_t index, Task& result) {
+	if (_queuedCount.load() == 0) {
+		return false;
+	}
+
+	// Our own queue first, newest task first
+	{
+		Queue& queue = *_queues[index];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Tasks.empty()) {
+			result = std::move(queue.Tasks.back());
+			queue.Tasks.pop_back();
+			_queuedCount.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Otherwise steal the oldest task from someone else
+	for (size_t offset = 1; offset < _queues.size(); offset++) {
+		Queue& queue = *_queues[(index + offset) % _queues.size()];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Tasks.empty()) {
+			result = std::move(queue.Tasks.front());
+			queue.Tasks.pop_front();
+			_queuedCount.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Utilities/Macros.h"
+
+/// <summary>
+/// A pool of worker threads for running lots of small tasks, such as chunks of entities in the SystemScheduler.
+///
+/// Every worker has its own queue. Workers take their newest task first (which is the most likely to still be in
+/// cache), and when they run out they steal the oldest task from another worker's queue, so that one long chunk does
+/// not leave the rest of the pool sitting idle. Threads that are waiting on the pool can help out with TryRunOne
+/// instead of blocking, so a pool with no workers still makes progress on the calling thread
+/// </summary>
+class ThreadPool final
+{
+	SMART_MEMORY_MANAGED(ThreadPool)
+
+public:
+	typedef std::function<void()> Task;
+
+	/// <summary>
+	/// Starts up the worker threads
+	/// </summary>
+	/// <param name="workerCount">The number of worker threads, or -1 to use all but one of the hardware threads (the
+	/// thread waiting on the pool makes up the last one)</param>
+	explicit ThreadPool(int workerCount = -1);
+	/// <summary>
+	/// Stops the worker threads, discarding any tasks that have not started yet
+	/// </summary>
+	~ThreadPool();
+
+	/// <summary>
+	/// Gets the pool shared by the whole game, which is started the first time it is used
+	/// </summary>
+	static ThreadPool& Instance();
+
+	/// <summary>
+	/// Gets the number of threads that can run tasks at once, including the thread that is waiting on the pool
+	/// </summary>
+	size_t ThreadCount() const { return _threads.size() + 1; }
+
+	/// <summary>
+	/// Queues a task to run on the pool. When called from a worker, the task goes on that worker's own queue
+	/// </summary>
+	void Submit(Task task);
+	/// <summary>
+	/// Runs a single queued task on the calling thread, if there are any
+	/// </summary>
+	/// <returns>True if a task was run, false if every queue was empty</returns>
+	bool TryRunOne();
+
+private:
+	struct Queue {
+		std::mutex      Mutex;
+		std::deque<Task> Tasks;
+	};
+
+	// One queue per worker, plus one at the end for tasks submitted by threads outside of the pool when there are no workers
+	std::vector<std::unique_ptr<Queue>> _queues;
+	std::vector<std::thread> _threads;
+
+	// The number of tasks sitting in the queues, so that sleeping workers know when to wake up
+	std::atomic<size_t> _queuedCount;
+	std::atomic<size_t> _nextQueue;
+	std::mutex _sleepMutex;
+	std::condition_variable _wake;
+	bool _isStopping;
+
+	void _WorkerLoop(size_t index);
+	// Pops the newest task from the given queue, or steals the oldest task from any other queue
+	bool _Pop(size_t index, Task& result);
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <GLM/glm.hpp>
+#include <GLM/gtc/packing.hpp>
 #include "Graphics/VertexArrayObject.h"
 
 struct VertexPosCol {
@@ -57,4 +58,48 @@ struct VertexPosNormTexCol {
 		Position({ x, y, z }), Normal({ nX, nY, nZ }), UV({ u, v }), Color({r, g, b, a}) {}
 
 	static const std::vector<BufferAttribute> V_DECL;
-};
\ No newline at end of file
+};
+
+/*
+ * The packed vertex types below store everything except the position in 32 bit words that OpenGL unpacks for us
+ * when fetching the vertex, so they can be used with the same shaders as their full float counterparts:
+ *    Normals are signed normalized 10-10-10-2 (GL_INT_2_10_10_10_REV), about 0.2% error per component
+ *    UVs are a pair of half floats, accurate to about 1/2048 in the 0-1 range (less for UVs that tile past that)
+ *    Colors are 8 bits per channel (GL_UNSIGNED_BYTE, normalized)
+ */
+
+struct VertexPosNormTexPacked {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	uint32_t  UV;
+
+	VertexPosNormTexPacked() : Position(glm::vec3(0.0f)), Normal(PackNormal(glm::vec3(0.0f))), UV(PackUV(glm::vec2(0.0f))) {}
+	VertexPosNormTexPacked(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& uv) :
+		Position(pos), Normal(PackNormal(norm)), UV(PackUV(uv)) {}
+	VertexPosNormTexPacked(const VertexPosNormTex& vertex) :
+		VertexPosNormTexPacked(vertex.Position, vertex.Normal, vertex.UV) {}
+
+	static uint32_t PackNormal(const glm::vec3& normal) { return glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f)); }
+	static uint32_t PackUV(const glm::vec2& uv) { return glm::packHalf2x16(uv); }
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
+
+struct VertexPosNormTexColPacked {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	uint32_t  UV;
+	uint32_t  Color;
+
+	VertexPosNormTexColPacked() : Position(glm::vec3(0.0f)), Normal(PackNormal(glm::vec3(0.0f))), UV(PackUV(glm::vec2(0.0f))), Color(PackColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))) {}
+	VertexPosNormTexColPacked(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& uv, const glm::vec4& col) :
+		Position(pos), Normal(PackNormal(norm)), UV(PackUV(uv)), Color(PackColor(col)) {}
+	VertexPosNormTexColPacked(const VertexPosNormTexCol& vertex) :
+		VertexPosNormTexColPacked(vertex.Position, vertex.Normal, vertex.UV, vertex.Color) {}
+
+	static uint32_t PackNormal(const glm::vec3& normal) { return glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f)); }
+	static uint32_t PackUV(const glm::vec2& uv) { return glm::packHalf2x16(uv); }
+	static uint32_t PackColor(const glm::vec4& color) { return glm::packUnorm4x8(color); }
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
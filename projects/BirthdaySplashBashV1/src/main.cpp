@@ -31,6 +31,7 @@ We have been using Parsec, a screen sharing program, to play online "locally" wi
 #include "Graphics/IndexBuffer.h"
 #include "Graphics/VertexBuffer.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexFormat.h"
 #include "Graphics/Shader.h"
 #include "Gameplay/Camera.h"
 #include "imgui.h"
@@ -53,7 +54,13 @@ We have been using Parsec, a screen sharing program, to play online "locally" wi
 #include "Utilities/ObjLoader.h"
 #include "Utilities/VertexTypes.h"
 #include "Utilities/BackendHandler.h"
+#include "Utilities/AsyncLoader.h"
+#include "Utilities/AssetManager.h"
+#include "Utilities/StaticBatcher.h"
+#include "Utilities/InstancedRenderer.h"
+#include "Utilities/IndirectRenderer.h"
 #include "Gameplay/Scene.h"
+#include "Gameplay/SystemScheduler.h"
 #include "Gameplay/ShaderMaterial.h"
 #include "Gameplay/RendererComponent.h"
 #include "Gameplay/Timing.h"
@@ -70,6 +77,21 @@ We have been using Parsec, a screen sharing program, to play online "locally" wi
 #define NUM_HITBOXES_TEST 2
 #define NUM_HITBOXES 20
 #define NUM_BOTTLES_ARENA 6
+// Uncomment to benchmark the OBJ loaders on the Arena1 models on startup. This logs the load times of the streamed,
+// memory mapped and parallel loaders (with an error if the parallel loader ever disagrees with the mapped one), the
+// vertex cache optimization's before and after stats, how long the LOD chains take to generate, and the vertex
+// de-duplication map lookups on generated meshes
+//#define BENCHMARK_OBJ_LOADER
+// Uncomment to measure how far every level of detail generated for the Arena1 models is from the original surface on
+// startup, stopping with an error if any level goes over its error limit
+//#define VALIDATE_LODS
+// Uncomment to log how long the batched MeshFactory functions take to build 100k cubes and 32 of each kind of sphere
+// compared to adding them one at a time on startup, logging an error if the two ever build different meshes
+//#define BENCHMARK_MESH_FACTORY
+// Uncomment to log how long it takes to update the world matrices for 100k transforms on startup
+//#define BENCHMARK_TRANSFORMS
+// Uncomment to log how long it takes to update 100k behaviours one at a time vs through the SystemScheduler on startup
+//#define BENCHMARK_SCHEDULER
 
 // Borrowed collision from https://learnopengl.com/In-Practice/2D-Game/Collisions/Collision-detection AABB collision
 bool Collision(Transform& hitbox1, Transform& hitbox2)
@@ -99,6 +121,46 @@ int main() {
 	// Enable texturing
 	glEnable(GL_TEXTURE_2D);
 
+	// Start up the background loader, everything but the menu will stream in while the menu is up
+	AsyncLoader::Init();
+
+	#ifdef BENCHMARK_OBJ_LOADER
+	{
+		std::vector<std::string> benchmarkFiles;
+		for (const auto& entry : std::filesystem::directory_iterator("models/Arena1")) {
+			if (entry.path().extension() == ".obj") {
+				benchmarkFiles.push_back(entry.path().string());
+			}
+		}
+		ObjLoader::Benchmark(benchmarkFiles);
+		ObjLoader::BenchmarkVertexDedup();
+	}
+	#endif
+
+	#ifdef VALIDATE_LODS
+	{
+		std::vector<std::string> lodFiles;
+		for (const auto& entry : std::filesystem::directory_iterator("models/Arena1")) {
+			if (entry.path().extension() == ".obj") {
+				lodFiles.push_back(entry.path().string());
+			}
+		}
+		LOG_ASSERT(ObjLoader::ValidateLods(lodFiles), "Some levels of detail moved the surface too far, see the errors above");
+	}
+	#endif
+
+	#ifdef BENCHMARK_MESH_FACTORY
+	MeshFactory::Benchmark();
+	#endif
+
+	#ifdef BENCHMARK_TRANSFORMS
+	TransformSystem::Benchmark();
+	#endif
+
+	#ifdef BENCHMARK_SCHEDULER
+	SystemScheduler::Benchmark();
+	#endif
+
 	// Push another scope so most memory should be freed *before* we exit the app
 	{
 		#pragma region Shader and ImGui
@@ -120,6 +182,19 @@ int main() {
 		reflective->LoadShaderPartFromFile("shaders/frag_blinn_phong_reflection.glsl", GL_FRAGMENT_SHADER);
 		reflective->Link();
 
+		// The same lighting as shader, but taking its transforms per instance, for props drawn by an InstancedRenderer
+		Shader::sptr instancedShader = Shader::Create();
+		instancedShader->LoadShaderPartFromFile("shaders/vertex_shader_instanced.glsl", GL_VERTEX_SHADER);
+		instancedShader->LoadShaderPartFromFile("shaders/frag_blinn_phong_textured.glsl", GL_FRAGMENT_SHADER);
+		instancedShader->Link();
+
+		// The instanced variant shares the fragment stage, so it needs every scene level uniform that shader gets, or the
+		// props drawn through the instanced and indirect renderers come out unlit
+		auto setSceneUniform = [&](const std::string& name, const auto& value) {
+			shader->SetUniform(name, value);
+			instancedShader->SetUniform(name, value);
+		};
+
 		glm::vec3 lightPos = glm::vec3(0.0f, 0.0f, 10.0f);
 		glm::vec3 lightCol = glm::vec3(0.9f, 0.85f, 0.5f);
 		float     lightAmbientPow = 2.1f;
@@ -139,21 +214,21 @@ int main() {
 
 		// These are our application / scene level uniforms that don't necessarily update
 		// every frame
-		shader->SetUniform("u_LightPos", lightPos);
-		shader->SetUniform("u_LightCol", lightCol);
-		shader->SetUniform("u_AmbientLightStrength", lightAmbientPow);
-		shader->SetUniform("u_SpecularLightStrength", lightSpecularPow);
-		shader->SetUniform("u_AmbientCol", ambientCol);
-		shader->SetUniform("u_AmbientStrength", ambientPow);
-		shader->SetUniform("u_LightAttenuationConstant", 1.0f);
-		shader->SetUniform("u_LightAttenuationLinear", lightLinearFalloff);
-		shader->SetUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
-		shader->SetUniform("u_lightoff", lightoff);
-		shader->SetUniform("u_ambient", ambientonly);
-		shader->SetUniform("u_specular", specularonly);
-		shader->SetUniform("u_ambientspecular", ambientandspecular);
-		shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon);
-		shader->SetUniform("u_Textures", Textures);
+		setSceneUniform("u_LightPos", lightPos);
+		setSceneUniform("u_LightCol", lightCol);
+		setSceneUniform("u_AmbientLightStrength", lightAmbientPow);
+		setSceneUniform("u_SpecularLightStrength", lightSpecularPow);
+		setSceneUniform("u_AmbientCol", ambientCol);
+		setSceneUniform("u_AmbientStrength", ambientPow);
+		setSceneUniform("u_LightAttenuationConstant", 1.0f);
+		setSceneUniform("u_LightAttenuationLinear", lightLinearFalloff);
+		setSceneUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
+		setSceneUniform("u_lightoff", lightoff);
+		setSceneUniform("u_ambient", ambientonly);
+		setSceneUniform("u_specular", specularonly);
+		setSceneUniform("u_ambientspecular", ambientandspecular);
+		setSceneUniform("u_ambientspeculartoon", ambientspeculartoon);
+		setSceneUniform("u_Textures", Textures);
 
 		PostEffect* basicEffect;
 
@@ -168,31 +243,31 @@ int main() {
 			if (ImGui::CollapsingHeader("Scene Level Lighting Settings"))
 			{
 				if (ImGui::ColorPicker3("Ambient Color", glm::value_ptr(ambientCol))) {
-					shader->SetUniform("u_AmbientCol", ambientCol);
+					setSceneUniform("u_AmbientCol", ambientCol);
 				}
 				if (ImGui::SliderFloat("Fixed Ambient Power", &ambientPow, 0.01f, 1.0f)) {
-					shader->SetUniform("u_AmbientStrength", ambientPow);
+					setSceneUniform("u_AmbientStrength", ambientPow);
 				}
 			}
 			if (ImGui::CollapsingHeader("Light Level Lighting Settings"))
 			{
 				if (ImGui::DragFloat3("Light Pos", glm::value_ptr(lightPos), 0.01f, -10.0f, 10.0f)) {
-					shader->SetUniform("u_LightPos", lightPos);
+					setSceneUniform("u_LightPos", lightPos);
 				}
 				if (ImGui::ColorPicker3("Light Col", glm::value_ptr(lightCol))) {
-					shader->SetUniform("u_LightCol", lightCol);
+					setSceneUniform("u_LightCol", lightCol);
 				}
 				if (ImGui::SliderFloat("Light Ambient Power", &lightAmbientPow, 0.0f, 1.0f)) {
-					shader->SetUniform("u_AmbientLightStrength", lightAmbientPow);
+					setSceneUniform("u_AmbientLightStrength", lightAmbientPow);
 				}
 				if (ImGui::SliderFloat("Light Specular Power", &lightSpecularPow, 0.0f, 1.0f)) {
-					shader->SetUniform("u_SpecularLightStrength", lightSpecularPow);
+					setSceneUniform("u_SpecularLightStrength", lightSpecularPow);
 				}
 				if (ImGui::DragFloat("Light Linear Falloff", &lightLinearFalloff, 0.01f, 0.0f, 1.0f)) {
-					shader->SetUniform("u_LightAttenuationLinear", lightLinearFalloff);
+					setSceneUniform("u_LightAttenuationLinear", lightLinearFalloff);
 				}
 				if (ImGui::DragFloat("Light Quadratic Falloff", &lightQuadraticFalloff, 0.01f, 0.0f, 1.0f)) {
-					shader->SetUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
+					setSceneUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
 				}
 			}
 
@@ -240,61 +315,61 @@ int main() {
 	
 			if (ImGui::CollapsingHeader("Toggle buttons")) {
 				if (ImGui::Button("No Lighting")) {
-					shader->SetUniform("u_lightoff", lightoff = 1);
-					shader->SetUniform("u_ambient", ambientonly = 0);
-					shader->SetUniform("u_specular", specularonly = 0);
-					shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-					shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
-					shader->SetUniform("u_Textures", Textures = 2);
+					setSceneUniform("u_lightoff", lightoff = 1);
+					setSceneUniform("u_ambient", ambientonly = 0);
+					setSceneUniform("u_specular", specularonly = 0);
+					setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+					setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
+					setSceneUniform("u_Textures", Textures = 2);
 				}
 
 				if (ImGui::Button("Ambient only")) {
-					shader->SetUniform("u_lightoff", lightoff = 0);
-					shader->SetUniform("u_ambient", ambientonly = 1);
-					shader->SetUniform("u_specular", specularonly = 0);
-					shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-					shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
-					shader->SetUniform("u_Textures", Textures = 2);
+					setSceneUniform("u_lightoff", lightoff = 0);
+					setSceneUniform("u_ambient", ambientonly = 1);
+					setSceneUniform("u_specular", specularonly = 0);
+					setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+					setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
+					setSceneUniform("u_Textures", Textures = 2);
 				}
 
 				if (ImGui::Button("specular only")) {
-					shader->SetUniform("u_lightoff", lightoff = 0);
-					shader->SetUniform("u_ambient", ambientonly = 0);
-					shader->SetUniform("u_specular", specularonly = 1);
-					shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-					shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
-					shader->SetUniform("u_Textures", Textures = 2);
+					setSceneUniform("u_lightoff", lightoff = 0);
+					setSceneUniform("u_ambient", ambientonly = 0);
+					setSceneUniform("u_specular", specularonly = 1);
+					setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+					setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
+					setSceneUniform("u_Textures", Textures = 2);
 				}
 
 				if (ImGui::Button("Ambient and Specular")) {
-					shader->SetUniform("u_lightoff", lightoff = 0);
-					shader->SetUniform("u_ambient", ambientonly = 0);
-					shader->SetUniform("u_specular", specularonly = 0);
-					shader->SetUniform("u_ambientspecular", ambientandspecular = 1);
-					shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
-					shader->SetUniform("u_Textures", Textures = 2);
+					setSceneUniform("u_lightoff", lightoff = 0);
+					setSceneUniform("u_ambient", ambientonly = 0);
+					setSceneUniform("u_specular", specularonly = 0);
+					setSceneUniform("u_ambientspecular", ambientandspecular = 1);
+					setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
+					setSceneUniform("u_Textures", Textures = 2);
 				}
 
 				if (ImGui::Button("Ambient, Specular, and Toon Shading")) {
-					shader->SetUniform("u_lightoff", lightoff = 0);
-					shader->SetUniform("u_ambient", ambientonly = 0);
-					shader->SetUniform("u_specular", specularonly = 0);
-					shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-					shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 1);
-					shader->SetUniform("u_Textures", Textures = 2);
+					setSceneUniform("u_lightoff", lightoff = 0);
+					setSceneUniform("u_ambient", ambientonly = 0);
+					setSceneUniform("u_specular", specularonly = 0);
+					setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+					setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 1);
+					setSceneUniform("u_Textures", Textures = 2);
 				}
 
 				if (OnOff) {
 					if (ImGui::Button("Textures Off"))
 					{
-						shader->SetUniform("u_Textures", Textures = 0);
+						setSceneUniform("u_Textures", Textures = 0);
 						OnOff = false;
 					}
 				}
 				else {
 					if (ImGui::Button("Textures On"))
 					{
-						shader->SetUniform("u_Textures", Textures = 1);
+						setSceneUniform("u_Textures", Textures = 1);
 						OnOff = true;
 					}
 				}
@@ -317,6 +392,10 @@ int main() {
 			}
 			ImGui::PlotLines("FPS", fpsBuffer, 128);
 			ImGui::Text("MIN: %f MAX: %f AVG: %f", minFps, maxFps, avgFps / 128.0f);
+
+			const VertexArrayObject::DrawStats& drawStats = VertexArrayObject::GetStats();
+			ImGui::Text("Draw calls: %zu VAO binds: %zu (%zu formats)", drawStats.DrawCalls, drawStats.VaoBinds, VertexFormat::GetFormatCount());
+			ImGui::Text("Vertex buffer switches: %zu Index buffer switches: %zu", drawStats.VertexBufferSwitches, drawStats.IndexBufferSwitches);
 			});
 
 		#pragma endregion Shader and ImGui
@@ -343,41 +422,41 @@ int main() {
 
 		#pragma region testing scene difuses
 		// Load some textures from files
-		Texture2D::sptr diffuse = Texture2D::LoadFromFile("images/TestScene/Stone_001_Diffuse.png");
-		Texture2D::sptr diffuseGround = Texture2D::LoadFromFile("images/TestScene/grass.jpg");
-		Texture2D::sptr diffuseDunce = Texture2D::LoadFromFile("images/TestScene/SkinPNG.png");
-		Texture2D::sptr diffuseDuncet = Texture2D::LoadFromFile("images/TestScene/Duncet.png");
-		Texture2D::sptr diffuseSlide = Texture2D::LoadFromFile("images/TestScene/Slide.png");
-		Texture2D::sptr diffuseSwing = Texture2D::LoadFromFile("images/TestScene/Swing.png");
-		Texture2D::sptr diffuseTable = Texture2D::LoadFromFile("images//TestScene/Table.png");
-		Texture2D::sptr diffuseTreeBig = Texture2D::LoadFromFile("images/TestScene/TreeBig.png");
-		Texture2D::sptr diffuseRedBalloon = Texture2D::LoadFromFile("images/TestScene/BalloonRed.png");
-		Texture2D::sptr diffuseYellowBalloon = Texture2D::LoadFromFile("images/TestScene/BalloonYellow.png");
-		Texture2D::sptr diffuse2 = Texture2D::LoadFromFile("images/TestScene/box.bmp");
-		Texture2D::sptr specular = Texture2D::LoadFromFile("images/TestScene/Stone_001_Specular.png");
-		Texture2D::sptr reflectivity = Texture2D::LoadFromFile("images/TestScene/box-reflections.bmp");
+		Texture2D::sptr diffuse = AsyncLoader::LoadTexture("images/TestScene/Stone_001_Diffuse.png");
+		Texture2D::sptr diffuseGround = AsyncLoader::LoadTexture("images/TestScene/grass.jpg");
+		Texture2D::sptr diffuseDunce = AsyncLoader::LoadTexture("images/TestScene/SkinPNG.png");
+		Texture2D::sptr diffuseDuncet = AsyncLoader::LoadTexture("images/TestScene/Duncet.png");
+		Texture2D::sptr diffuseSlide = AsyncLoader::LoadTexture("images/TestScene/Slide.png");
+		Texture2D::sptr diffuseSwing = AsyncLoader::LoadTexture("images/TestScene/Swing.png");
+		Texture2D::sptr diffuseTable = AsyncLoader::LoadTexture("images//TestScene/Table.png");
+		Texture2D::sptr diffuseTreeBig = AsyncLoader::LoadTexture("images/TestScene/TreeBig.png");
+		Texture2D::sptr diffuseRedBalloon = AsyncLoader::LoadTexture("images/TestScene/BalloonRed.png");
+		Texture2D::sptr diffuseYellowBalloon = AsyncLoader::LoadTexture("images/TestScene/BalloonYellow.png");
+		Texture2D::sptr diffuse2 = AsyncLoader::LoadTexture("images/TestScene/box.bmp");
+		Texture2D::sptr specular = AsyncLoader::LoadTexture("images/TestScene/Stone_001_Specular.png");
+		Texture2D::sptr reflectivity = AsyncLoader::LoadTexture("images/TestScene/box-reflections.bmp");
 		#pragma endregion testing scene difuses
 
 		#pragma region Arena1 diffuses
-		Texture2D::sptr diffuseTrees = Texture2D::LoadFromFile("images/Arena1/Trees.png");
-		Texture2D::sptr diffuseFlowers = Texture2D::LoadFromFile("images/Arena1/Flower.png");
-		Texture2D::sptr diffuseGroundArena = Texture2D::LoadFromFile("images/Arena1/Ground.png");
-		Texture2D::sptr diffuseHedge = Texture2D::LoadFromFile("images/Arena1/Hedge.png");
-		Texture2D::sptr diffuseBalloons = Texture2D::LoadFromFile("images/Arena1/Ballons.png");
-		Texture2D::sptr diffuseDunceArena = Texture2D::LoadFromFile("images/Arena1/SkinPNG.png");
-		Texture2D::sptr diffuseDuncetArena = Texture2D::LoadFromFile("images/Arena1/Duncet.png");
-		Texture2D::sptr diffusered = Texture2D::LoadFromFile("images/Arena1/red.png");
-		Texture2D::sptr diffuseyellow = Texture2D::LoadFromFile("images/Arena1/yellow.png");
-		Texture2D::sptr diffusepink = Texture2D::LoadFromFile("images/Arena1/pink.png");
-		Texture2D::sptr diffusemonkeybar = Texture2D::LoadFromFile("images/Arena1/MonkeyBar.png");
-		Texture2D::sptr diffusecake = Texture2D::LoadFromFile("images/Arena1/SliceOfCake.png");
-		Texture2D::sptr diffusesandbox = Texture2D::LoadFromFile("images/Arena1/SandBox.png");
-		Texture2D::sptr diffuseroundabout = Texture2D::LoadFromFile("images/Arena1/RoundAbout.png");
-		Texture2D::sptr diffusepinwheel = Texture2D::LoadFromFile("images/Arena1/Pinwheel.png");
-		Texture2D::sptr diffuseBench = Texture2D::LoadFromFile("images/Arena1/Bench.png");
-		Texture2D::sptr diffuseBottle = Texture2D::LoadFromFile("images/Arena1/Bottle.png");
-		Texture2D::sptr diffuseBottleEmpty = Texture2D::LoadFromFile("images/Arena1/Blue.png");
-		Texture2D::sptr diffuseWaterBeam = Texture2D::LoadFromFile("images/Arena1/waterBeamTex.png");
+		Texture2D::sptr diffuseTrees = AsyncLoader::LoadTexture("images/Arena1/Trees.png");
+		Texture2D::sptr diffuseFlowers = AsyncLoader::LoadTexture("images/Arena1/Flower.png");
+		Texture2D::sptr diffuseGroundArena = AsyncLoader::LoadTexture("images/Arena1/Ground.png");
+		Texture2D::sptr diffuseHedge = AsyncLoader::LoadTexture("images/Arena1/Hedge.png");
+		Texture2D::sptr diffuseBalloons = AsyncLoader::LoadTexture("images/Arena1/Ballons.png");
+		Texture2D::sptr diffuseDunceArena = AsyncLoader::LoadTexture("images/Arena1/SkinPNG.png");
+		Texture2D::sptr diffuseDuncetArena = AsyncLoader::LoadTexture("images/Arena1/Duncet.png");
+		Texture2D::sptr diffusered = AsyncLoader::LoadTexture("images/Arena1/red.png");
+		Texture2D::sptr diffuseyellow = AsyncLoader::LoadTexture("images/Arena1/yellow.png");
+		Texture2D::sptr diffusepink = AsyncLoader::LoadTexture("images/Arena1/pink.png");
+		Texture2D::sptr diffusemonkeybar = AsyncLoader::LoadTexture("images/Arena1/MonkeyBar.png");
+		Texture2D::sptr diffusecake = AsyncLoader::LoadTexture("images/Arena1/SliceOfCake.png");
+		Texture2D::sptr diffusesandbox = AsyncLoader::LoadTexture("images/Arena1/SandBox.png");
+		Texture2D::sptr diffuseroundabout = AsyncLoader::LoadTexture("images/Arena1/RoundAbout.png");
+		Texture2D::sptr diffusepinwheel = AsyncLoader::LoadTexture("images/Arena1/Pinwheel.png");
+		Texture2D::sptr diffuseBench = AsyncLoader::LoadTexture("images/Arena1/Bench.png");
+		Texture2D::sptr diffuseBottle = AsyncLoader::LoadTexture("images/Arena1/Bottle.png");
+		Texture2D::sptr diffuseBottleEmpty = AsyncLoader::LoadTexture("images/Arena1/Blue.png");
+		Texture2D::sptr diffuseWaterBeam = AsyncLoader::LoadTexture("images/Arena1/waterBeamTex.png");
 		#pragma endregion Arena1 diffuses
 
 		// Load the cube map
@@ -402,6 +481,12 @@ int main() {
 		GameScene::RegisterComponentType<BehaviourBinding>();
 		GameScene::RegisterComponentType<Camera>();
 
+		// Let the scheduler know what our behaviours touch, so it can spread them across threads. They only ever move
+		// their own entity, but the ones that poll GLFW for input have to stay on the main thread
+		SystemScheduler::DeclareBehaviour<SimpleMoveBehaviour>(ComponentAccess().Writes<Transform>().OnMainThread());
+		SystemScheduler::DeclareBehaviour<FollowPathBehaviour>(ComponentAccess().Writes<Transform>());
+		SystemScheduler::DeclareBehaviour<CameraControlBehaviour>(ComponentAccess().Writes<Transform>().OnMainThread());
+
 		// Create scenes, and set menu to be the active scene in the application
 		GameScene::sptr scene = GameScene::Create("test");
 		GameScene::sptr Arena1 = GameScene::Create("Arena1");
@@ -420,11 +505,13 @@ int main() {
 		Application::Instance().ActiveScene = Menu;
 
 		// We can create a group ahead of time to make iterating on the group faster
-		entt::basic_group<entt::entity, entt::exclude_t<>, entt::get_t<Transform>, RendererComponent> renderGroup =
-			scene->Registry().group<RendererComponent>(entt::get_t<Transform>());
+		// Instanced entities (such as the ones spawned by the EnvironmentGenerator) are drawn by the scene's InstancedRenderer instead
+		entt::basic_group<entt::entity, entt::exclude_t<InstancedTag>, entt::get_t<Transform>, RendererComponent> renderGroup =
+			scene->Registry().group<RendererComponent>(entt::get_t<Transform>(), entt::exclude_t<InstancedTag>());
 		
-		entt::basic_group<entt::entity, entt::exclude_t<>, entt::get_t<Transform>, RendererComponent> renderGroupArena =
-			Arena1->Registry().group<RendererComponent>(entt::get_t<Transform>());
+		// Static props get merged into batches once they've loaded, and stop drawing on their own (see StaticBatcher)
+		entt::basic_group<entt::entity, entt::exclude_t<StaticBatched, InstancedTag>, entt::get_t<Transform>, RendererComponent> renderGroupArena =
+			Arena1->Registry().group<RendererComponent>(entt::get_t<Transform>(), entt::exclude_t<StaticBatched, InstancedTag>());
 		
 		entt::basic_group<entt::entity, entt::exclude_t<>, entt::get_t<Transform>, RendererComponent> renderGroupPause =
 			Pause->Registry().group<RendererComponent>(entt::get_t<Transform>());
@@ -432,6 +519,17 @@ int main() {
 		entt::basic_group<entt::entity, entt::exclude_t<>, entt::get_t<Transform>, RendererComponent> renderGroupMenu =
 			Menu->Registry().group<RendererComponent>(entt::get_t<Transform>());
 
+		InstancedRenderer::sptr instancedRenderer = InstancedRenderer::Create();
+		instancedRenderer->SetShaderVariant(shader, instancedShader);
+		InstancedRenderer::sptr instancedRendererArena = InstancedRenderer::Create();
+		instancedRendererArena->SetShaderVariant(shader, instancedShader);
+
+		// Meshes in the arena share one set of buffers, and are drawn with a multi-draw call per material. The score counters
+		// and bottles go through instancedShader here, which gets its lighting from setSceneUniform
+		GeometryArena::sptr packedArena = GeometryArena::Create<VertexPosNormTexColPacked>();
+		IndirectRenderer::sptr indirectRendererArena = IndirectRenderer::Create();
+		indirectRendererArena->SetShaderVariant(shader, instancedShader);
+
 		#pragma endregion Scene Generation
 
 		// Create materials and set some properties for them
@@ -741,7 +839,7 @@ int main() {
 
 		GameObject objGround = scene->CreateEntity("Ground"); 
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Ground.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Ground.obj");
 			objGround.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialGround);
 			objGround.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			objGround.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -751,7 +849,7 @@ int main() {
 
 		GameObject objDunce = scene->CreateEntity("Dunce");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Dunce.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Dunce.obj");
 			objDunce.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialDunce);
 			objDunce.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.9f);
 			objDunce.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -760,7 +858,7 @@ int main() {
 
 		GameObject objDuncet = scene->CreateEntity("Duncet");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Duncet.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Duncet.obj");
 			objDuncet.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialDuncet);
 			objDuncet.get<Transform>().SetLocalPosition(2.0f, 0.0f, 0.8f);
 			objDuncet.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -770,7 +868,7 @@ int main() {
 
 		GameObject objSlide = scene->CreateEntity("Slide");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Slide.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Slide.obj");
 			objSlide.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialSlide);
 			objSlide.get<Transform>().SetLocalPosition(0.0f, 5.0f, 3.0f);
 			objSlide.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -780,7 +878,7 @@ int main() {
 		
 		GameObject objRedBalloon = scene->CreateEntity("Redballoon");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Balloon.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Balloon.obj");
 			objRedBalloon.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialredballoon);
 			objRedBalloon.get<Transform>().SetLocalPosition(2.5f, -10.0f, 3.0f);
 			objRedBalloon.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -799,7 +897,7 @@ int main() {
 		
 		GameObject objYellowBalloon = scene->CreateEntity("Yellowballoon");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Balloon.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Balloon.obj");
 			objYellowBalloon.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialyellowballoon);
 			objYellowBalloon.get<Transform>().SetLocalPosition(-2.5f, -10.0f, 3.0f);
 			objYellowBalloon.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -819,7 +917,7 @@ int main() {
 
 		GameObject objSwing = scene->CreateEntity("Swing");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Swing.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Swing.obj");
 			objSwing.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialSwing);
 			objSwing.get<Transform>().SetLocalPosition(-5.0f, 0.0f, 3.5f);
 			objSwing.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -829,7 +927,7 @@ int main() {
 
 		GameObject objTable = scene->CreateEntity("table");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/TableS.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/TableS.obj");
 			objTable.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialTable);
 			objTable.get<Transform>().SetLocalPosition(5.0f, 0.0f, 1.25f);
 			objTable.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
@@ -841,10 +939,10 @@ int main() {
 		#pragma region Arena1 Objects
 
 		/*VertexArrayObject::sptr vaoy = ObjLoader::LoadFromFile("models/TestScene/Dunce.obj");
-		VertexArrayObject::sptr vaox = ObjLoader::LoadFromFile("models/TestScene/Duncet.obj");*/
+		VertexArrayObject::sptr vaox = AsyncLoader::LoadMesh("models/TestScene/Duncet.obj");*/
 		GameObject objDunceArena = Arena1->CreateEntity("Dunce");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Dunce.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Dunce.obj");
 			objDunceArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialDunceArena);
 			objDunceArena.get<Transform>().SetLocalPosition(8.0f, 6.0f, 1.0f);
 			objDunceArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
@@ -853,7 +951,7 @@ int main() {
 		
 		GameObject objDuncetArena = Arena1->CreateEntity("Duncet");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Duncet.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Duncet.obj");
 			objDuncetArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialDuncetArena);
 			objDuncetArena.get<Transform>().SetLocalPosition(-8.0f, 6.0f, 1.0f);
 			objDuncetArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
@@ -862,8 +960,9 @@ int main() {
 		
 		GameObject objSlideArena = Arena1->CreateEntity("slide");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/Slide.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/Slide.obj");
 			objSlideArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialSlide);
+			objSlideArena.emplace<StaticTag>();
 			objSlideArena.get<Transform>().SetLocalPosition(3.0f, -2.0f, 2.0f);
 			objSlideArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			objSlideArena.get<Transform>().SetLocalScale(0.3f, 0.3f, 0.3f);
@@ -871,8 +970,9 @@ int main() {
 		
 		GameObject objSwingArena = Arena1->CreateEntity("swing");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/swing.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/swing.obj");
 			objSwingArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialSwing);
+			objSwingArena.emplace<StaticTag>();
 			objSwingArena.get<Transform>().SetLocalPosition(-3.0f, 1.0f, 2.0f);
 			objSwingArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			objSwingArena.get<Transform>().SetLocalScale(0.3f, 0.3f, 0.3f);
@@ -880,8 +980,9 @@ int main() {
 
 		GameObject objMonkeyBarArena = Arena1->CreateEntity("monkeybar");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/MonkeyBar.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/MonkeyBar.obj");
 			objMonkeyBarArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialMonkeyBar);
+			objMonkeyBarArena.emplace<StaticTag>();
 			objMonkeyBarArena.get<Transform>().SetLocalPosition(-2.0f, -2.5f, 3.0f);
 			objMonkeyBarArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			objMonkeyBarArena.get<Transform>().SetLocalScale(0.3f, 0.3f, 0.3f);
@@ -889,8 +990,9 @@ int main() {
 
 		GameObject objcakeArena = Arena1->CreateEntity("cake");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/SliceofCake.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/SliceofCake.obj");
 			objcakeArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialSliceOfCake);
+			objcakeArena.emplace<StaticTag>();
 			objcakeArena.get<Transform>().SetLocalPosition(7.5f, -2.0f, 4.0f);
 			objcakeArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			objcakeArena.get<Transform>().SetLocalScale(0.25f, 0.25f, 0.25f);
@@ -898,8 +1000,9 @@ int main() {
 
 		GameObject objSandBoxArena = Arena1->CreateEntity("sandBox");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/SandBox.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/SandBox.obj");
 			objSandBoxArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialSandBox);
+			objSandBoxArena.emplace<StaticTag>();
 			objSandBoxArena.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			objSandBoxArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			objSandBoxArena.get<Transform>().SetLocalScale(0.3f, 0.3f, 0.3f);
@@ -907,8 +1010,9 @@ int main() {
 		
 		GameObject objraArena = Arena1->CreateEntity("roundabout");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/RoundAbout.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/RoundAbout.obj");
 			objraArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialRA);
+			objraArena.emplace<StaticTag>();
 			objraArena.get<Transform>().SetLocalPosition(2.0f, 2.0f, 1.0f);
 			objraArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			objraArena.get<Transform>().SetLocalScale(0.3f, 0.3f, 0.3f);
@@ -916,8 +1020,9 @@ int main() {
 
 		GameObject objpinwheelArena = Arena1->CreateEntity("pinwheel");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/PinWheel.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/PinWheel.obj");
 			objpinwheelArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialPinwheel);
+			objpinwheelArena.emplace<StaticTag>();
 			objpinwheelArena.get<Transform>().SetLocalPosition(0.0f, -5.0f, 2.0f);
 			objpinwheelArena.get<Transform>().SetLocalRotation(0.0f, -90.0f, 180.0f);
 			objpinwheelArena.get<Transform>().SetLocalScale(0.25f, 0.25f, 0.25f);
@@ -925,8 +1030,9 @@ int main() {
 
 		GameObject objTables = Arena1->CreateEntity("table");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Table.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/Table.obj");
 			objTables.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialTable);
+			objTables.emplace<StaticTag>();
 			objTables.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			objTables.get<Transform>().SetLocalRotation(90.0f, 0.0f, 270.0f);
 			objTables.get<Transform>().SetLocalScale(0.25f, 0.25f, 0.28f);
@@ -934,8 +1040,9 @@ int main() {
 		
 		GameObject objBenches = Arena1->CreateEntity("Benches");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Bench.obj");
-			objBenches.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialBench);
+			MeshLodGroup::sptr lods = AsyncLoader::LoadMeshLods("models/Arena1/Bench.obj");
+			objBenches.emplace<RendererComponent>().SetLods(lods).SetMaterial(materialBench);
+			objBenches.emplace<StaticTag>();
 			objBenches.get<Transform>().SetLocalPosition(0.0f, 0.0f, -1.0f);
 			objBenches.get<Transform>().SetLocalRotation(90.0f, 0.0f, 270.0f);
 			objBenches.get<Transform>().SetLocalScale(0.25f, 0.4f, 0.25f);
@@ -943,8 +1050,9 @@ int main() {
 		
 		GameObject objBalloons = Arena1->CreateEntity("Balloons");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Balloons.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/Balloons.obj");
 			objBalloons.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialBalloons);
+			objBalloons.emplace<StaticTag>();
 			objBalloons.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			objBalloons.get<Transform>().SetLocalRotation(90.0f, 0.0f, 270.0f);
 			objBalloons.get<Transform>().SetLocalScale(0.22f, 0.23f, 0.28f);
@@ -952,8 +1060,9 @@ int main() {
 		
 		GameObject objTrees = Arena1->CreateEntity("trees");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Tree.obj");
-			objTrees.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialtrees);
+			MeshLodGroup::sptr lods = AsyncLoader::LoadMeshLods("models/Arena1/Tree.obj");
+			objTrees.emplace<RendererComponent>().SetLods(lods).SetMaterial(materialtrees);
+			objTrees.emplace<StaticTag>();
 			objTrees.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			objTrees.get<Transform>().SetLocalRotation(90.0f, 0.0f, 270.0f);
 			objTrees.get<Transform>().SetLocalScale(0.27f, 0.27f, 0.27f);
@@ -961,8 +1070,9 @@ int main() {
 		
 		GameObject objFlowers = Arena1->CreateEntity("flowers");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Flower.obj");
-			objFlowers.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialflowers);
+			MeshLodGroup::sptr lods = AsyncLoader::LoadMeshLods("models/Arena1/Flower.obj");
+			objFlowers.emplace<RendererComponent>().SetLods(lods).SetMaterial(materialflowers);
+			objFlowers.emplace<StaticTag>();
 			objFlowers.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			objFlowers.get<Transform>().SetLocalRotation(90.0f, 0.0f, 90.0f);
 			objFlowers.get<Transform>().SetLocalScale(0.23f, 0.23f, 0.23f);
@@ -970,8 +1080,9 @@ int main() {
 		
 		GameObject objHedge = Arena1->CreateEntity("Hedge");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Hedge.obj");
-			objHedge.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialHedge);
+			MeshLodGroup::sptr lods = AsyncLoader::LoadMeshLods("models/Arena1/Hedge.obj");
+			objHedge.emplace<RendererComponent>().SetLods(lods).SetMaterial(materialHedge);
+			objHedge.emplace<StaticTag>();
 			objHedge.get<Transform>().SetLocalPosition(0.0f, 0.0f, 3.0f);
 			objHedge.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			objHedge.get<Transform>().SetLocalScale(0.25f, 0.25f, 0.25f);
@@ -979,8 +1090,9 @@ int main() {
 		
 		GameObject objGroundArena = Arena1->CreateEntity("Ground");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Ground.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/Ground.obj");
 			objGroundArena.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialGroundArena);
+			objGroundArena.emplace<StaticTag>();
 			objGroundArena.get<Transform>().SetLocalPosition(0.0f, 0.0f, -4.0f);
 			objGroundArena.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			objGroundArena.get<Transform>().SetLocalScale(1.5f, 0.5f, 1.5f);
@@ -988,7 +1100,7 @@ int main() {
 		
 		GameObject objBottleText1 = Arena1->CreateEntity("BottleUItext");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/BottleText.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/BottleText.obj");
 			objBottleText1.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialBottleyellow);
 			objBottleText1.get<Transform>().SetLocalPosition(12.0f, 14.0f, 2.0f);
 			objBottleText1.get<Transform>().SetLocalRotation(0.0f, 180.0f, 180.0f);
@@ -997,7 +1109,7 @@ int main() {
 
 		GameObject objBottleText2 = Arena1->CreateEntity("BottleUItext");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/BottleText.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/BottleText.obj");
 			objBottleText2.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialBottlepink);
 			objBottleText2.get<Transform>().SetLocalPosition(-4.0f, 14.0f, 2.0f);
 			objBottleText2.get<Transform>().SetLocalRotation(0.0f, 180.0f, 180.0f);
@@ -1006,7 +1118,7 @@ int main() {
 		
 		GameObject ScoreText = Arena1->CreateEntity("Scoretext");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/Score.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/Score.obj");
 			ScoreText.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialred);
 			ScoreText.get<Transform>().SetLocalPosition(3.0f, -13.5f, 0.0f);
 			ScoreText.get<Transform>().SetLocalRotation(0.0f, 180.0f, 180.0f);
@@ -1015,7 +1127,7 @@ int main() {
 		
 		GameObject player1w = Arena1->CreateEntity("player1 win");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/p1wins.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/p1wins.obj");
 			player1w.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialyellow);
 			player1w.get<Transform>().SetLocalPosition(0.0f, 0.0f, -2.0f);
 			player1w.get<Transform>().SetLocalRotation(0.0f, 0.0f, 180.0f);
@@ -1024,7 +1136,7 @@ int main() {
 		
 		GameObject player2w = Arena1->CreateEntity("player2 win");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/p2wins.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/p2wins.obj");
 			player2w.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialpink);
 			player2w.get<Transform>().SetLocalPosition(0.0f, 0.0f, -2.0f);
 			player2w.get<Transform>().SetLocalRotation(0.0f, 0.0f, 180.0f);
@@ -1033,7 +1145,7 @@ int main() {
 		
 		/*GameObject objDunceAim = Arena1->CreateEntity("DunceAim");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/aimAssist.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/aimAssist.obj");
 			objDunceAim.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialred);
 			objDunceAim.get<Transform>().SetLocalPosition(8.0f, 6.0f, 1.0f);
 			objDunceAim.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
@@ -1042,7 +1154,7 @@ int main() {
 
 		GameObject objDuncetAim = Arena1->CreateEntity("DuncetAim");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/aimAssist.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/aimAssist.obj");
 			objDuncetAim.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialred);
 			objDuncetAim.get<Transform>().SetLocalPosition(-8.0f, 6.0f, 1.0f);
 			objDuncetAim.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
@@ -1050,8 +1162,9 @@ int main() {
 		}*/
 		
 
-		VertexArrayObject::sptr Fullscore = ObjLoader::LoadFromFile("models/Arena1/BalloonIcon.obj");
-		VertexArrayObject::sptr Emptyscore = ObjLoader::LoadFromFile("models/Arena1/ScoreOutline.obj");
+		// The score counters and bottles swap between a few small meshes, so they live in the arena and get drawn together
+		ArenaMesh::sptr Fullscore = AsyncLoader::LoadArenaMesh("models/Arena1/BalloonIcon.obj", packedArena);
+		ArenaMesh::sptr Emptyscore = AsyncLoader::LoadArenaMesh("models/Arena1/ScoreOutline.obj", packedArena);
 
 		std::vector<GameObject> scorecounter;
 		{
@@ -1059,9 +1172,9 @@ int main() {
 			{
 				scorecounter.push_back(Arena1->CreateEntity("scorecounter" + (std::to_string(i + 1))));
 				if (i < 3)
-				scorecounter[i].emplace<RendererComponent>().SetMesh(Emptyscore).SetMaterial(materialyellow);
+				scorecounter[i].emplace<ArenaRendererComponent>().SetMesh(Emptyscore).SetMaterial(materialyellow);
 				else
-				scorecounter[i].emplace<RendererComponent>().SetMesh(Emptyscore).SetMaterial(materialpink);
+				scorecounter[i].emplace<ArenaRendererComponent>().SetMesh(Emptyscore).SetMaterial(materialpink);
 			}
 
 			scorecounter[0].get<Transform>().SetLocalPosition(4.5f, -13.0f, 2.0f);//Score1
@@ -1089,14 +1202,14 @@ int main() {
 			scorecounter[5].get<Transform>().SetLocalRotation(0.0f, 0.0f, 180.0f);
 		}
 
-		VertexArrayObject::sptr FullBottle = ObjLoader::LoadFromFile("models/Arena1/waterBottle.obj");
-		VertexArrayObject::sptr EmptyBottle = ObjLoader::LoadFromFile("models/Arena1/BottleOutline.obj");
+		ArenaMesh::sptr FullBottle = AsyncLoader::LoadArenaMesh("models/Arena1/waterBottle.obj", packedArena);
+		ArenaMesh::sptr EmptyBottle = AsyncLoader::LoadArenaMesh("models/Arena1/BottleOutline.obj", packedArena);
 		std::vector<GameObject> Bottles;
 		{
 			for (int i = 0; i < NUM_BOTTLES_ARENA; i++)//NUM_HITBOXES_TEST is located at the top of the code
 			{
 				Bottles.push_back(Arena1->CreateEntity("Bottle" + (std::to_string(i + 1))));
-				Bottles[i].emplace<RendererComponent>().SetMesh(FullBottle).SetMaterial(materialwaterbottle);
+				Bottles[i].emplace<ArenaRendererComponent>().SetMesh(FullBottle).SetMaterial(materialwaterbottle);
 			}
 
 			Bottles[0].get<Transform>().SetLocalPosition(0.0f, 0.0f, 2.0f);//Middle
@@ -1125,7 +1238,7 @@ int main() {
 		
 		GameObject objBullet = Arena1->CreateEntity("Bullet1");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/waterBeam.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/waterBeam.obj");
 			objBullet.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialdropwater);
 			objBullet.get<Transform>().SetLocalPosition(8.0f, 6.0f, 0.0f);
 			objBullet.get<Transform>().SetLocalScale(1.0f, 1.0f, 1.0f);
@@ -1133,7 +1246,7 @@ int main() {
 		
 		GameObject objBullet2 = Arena1->CreateEntity("Bullet2");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Arena1/waterBeam.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/Arena1/waterBeam.obj");
 			objBullet2.emplace<RendererComponent>().SetMesh(vao).SetMaterial(materialdropwater);
 			objBullet2.get<Transform>().SetLocalPosition(-8.0f, 6.0f, 0.0f);
 			objBullet2.get<Transform>().SetLocalScale(1.0f, 1.0f, 1.0f);
@@ -1142,7 +1255,7 @@ int main() {
 		//HitBoxes generated using a for loop then each one is given a position
 		std::vector<GameObject> HitboxesArena;
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/TestScene/HitBox.obj");
+			VertexArrayObject::sptr vao = AsyncLoader::LoadMesh("models/TestScene/HitBox.obj");
 			for (int i = 0; i < NUM_HITBOXES; i++)//NUM_HITBOXES_TEST is located at the top of the code
 			{
 				HitboxesArena.push_back(Arena1->CreateEntity("Hitbox" + (std::to_string(i + 1))));
@@ -1289,6 +1402,9 @@ int main() {
 				});
 		}
 		
+		// Report how many of our asset loads were shared with an earlier load
+		AssetManager::LogStats();
+
 		// Initialize our timing instance and grab a reference for our use
 		Timing& time = Timing::Instance();
 		time.LastFrame = glfwGetTime();
@@ -1298,10 +1414,20 @@ int main() {
 		bool renderammoground1 = true, renderammoground2 = true, renderammoground3 = true, renderammoground4 = true, renderammo = true, renderammo2 = true, ammo = true, ammo2 = true;
 		float bottletime1 = 0.0f, bottletime2 = 0.0f, bottletime3 = 0.0f, bottletime4 = 0.0f;
 		int score1 = 0, score2 = 0;
+		// The arena's static props are merged into batches the first time it's drawn with everything loaded
+		bool arenaBatched = false;
 
 		///// Game loop /////
 		while (!glfwWindowShouldClose(BackendHandler::window)) {
 			glfwPollEvents();
+			VertexArrayObject::ResetStats();
+
+			// Upload any assets that have finished loading in the background. Only the menu can be shown while
+			// assets are still streaming in, the other scenes need everything to be loaded
+			AsyncLoader::Update();
+			if (Application::Instance().ActiveScene != Menu && !AsyncLoader::IsIdle()) {
+				AsyncLoader::Flush();
+			}
 
 			// Update the timing
 			time.CurrentFrame = glfwGetTime();
@@ -1370,12 +1496,12 @@ int main() {
 					ammo2 = true;
 				}
 
-				shader->SetUniform("u_lightoff", lightoff = 1);
-				shader->SetUniform("u_ambient", ambientonly = 0);
-				shader->SetUniform("u_specular", specularonly = 0);
-				shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-				shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
-				shader->SetUniform("u_Textures", Textures = 2);
+				setSceneUniform("u_lightoff", lightoff = 1);
+				setSceneUniform("u_ambient", ambientonly = 0);
+				setSceneUniform("u_specular", specularonly = 0);
+				setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+				setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
+				setSceneUniform("u_Textures", Textures = 2);
 
 				if (glfwGetKey(BackendHandler::window,GLFW_KEY_GRAVE_ACCENT) == GLFW_PRESS)
 				{
@@ -1398,20 +1524,11 @@ int main() {
 					}
 				}
 
-				// Iterate over all the behaviour binding components
-				Menu->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-					// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-					for (const auto& behaviour : binding.Behaviours) {
-						if (behaviour->Enabled) {
-							behaviour->Update(entt::handle(Menu->Registry(), entity));
-						}
-					}
-					});
+				// Update all the behaviours and systems in the scene, spread across threads where they do not conflict
+				Menu->Update();
 
-				// Update all world matrices for this frame
-				Menu->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
-					t.UpdateWorldMatrix();
-					});
+				// Update the world matrices of anything that moved this frame
+				TransformSystem::Get(Menu->Registry())->Update();
 
 				// Sort the renderers by shader and material, we will go for a minimizing context switches approach here,
 			// but you could for instance sort front to back to optimize for fill rate if you have intensive fragment shaders
@@ -1458,31 +1575,22 @@ int main() {
 					Application::Instance().ActiveScene = Pause;
 				}
 
-				shader->SetUniform("u_lightoff", lightoff = 0);
-				shader->SetUniform("u_ambient", ambientonly = 0);
-				shader->SetUniform("u_specular", specularonly = 0);
-				shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-				shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 1);
-				shader->SetUniform("u_Textures", Textures = 2);
-				shader->SetUniform("u_AmbientLightStrength", lightAmbientPow = 2.1);
+				setSceneUniform("u_lightoff", lightoff = 0);
+				setSceneUniform("u_ambient", ambientonly = 0);
+				setSceneUniform("u_specular", specularonly = 0);
+				setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+				setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 1);
+				setSceneUniform("u_Textures", Textures = 2);
+				setSceneUniform("u_AmbientLightStrength", lightAmbientPow = 2.1);
 
 				//Player Movemenet(seperate from camera controls)
 				PlayerMovement::player1and2move(objDunce.get<Transform>(), objDuncet.get<Transform>(), time.DeltaTime);
 
-				// Iterate over all the behaviour binding components
-				scene->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-					// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-					for (const auto& behaviour : binding.Behaviours) {
-						if (behaviour->Enabled) {
-							behaviour->Update(entt::handle(scene->Registry(), entity));
-						}
-					}
-				});
+				// Update all the behaviours and systems in the scene, spread across threads where they do not conflict
+				scene->Update();
 
-				// Update all world matrices for this frame
-				scene->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
-					t.UpdateWorldMatrix();
-				});
+				// Update the world matrices of anything that moved this frame
+				TransformSystem::Get(scene->Registry())->Update();
 
 				// Sort the renderers by shader and material, we will go for a minimizing context switches approach here,
 			// but you could for instance sort front to back to optimize for fill rate if you have intensive fragment shaders
@@ -1521,6 +1629,12 @@ int main() {
 					BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
 				});
 
+				// Draw everything that shares a mesh and material with one call per batch, this changes the bound shader
+				instancedRenderer->Update(scene->Registry(), camTransform.GetLocalPosition(), projection);
+				instancedRenderer->Render(view, projection);
+				current = nullptr;
+				currentMat = nullptr;
+
 				basicEffect->UnbindBuffer();
 
 				effects[activeEffect]->ApplyEffect(basicEffect);
@@ -1543,13 +1657,13 @@ int main() {
 					Application::Instance().ActiveScene = Pause;
 				}
 
-				shader->SetUniform("u_lightoff", lightoff = 0);
-				shader->SetUniform("u_ambient", ambientonly = 0);
-				shader->SetUniform("u_specular", specularonly = 0);
-				shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-				shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 1);
-				shader->SetUniform("u_Textures", Textures = 2);
-				shader->SetUniform("u_AmbientLightStrength", lightAmbientPow = 2.1);
+				setSceneUniform("u_lightoff", lightoff = 0);
+				setSceneUniform("u_ambient", ambientonly = 0);
+				setSceneUniform("u_specular", specularonly = 0);
+				setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+				setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 1);
+				setSceneUniform("u_Textures", Textures = 2);
+				setSceneUniform("u_AmbientLightStrength", lightAmbientPow = 2.1);
 
 				//yes += time.DeltaTime;
 
@@ -1652,28 +1766,28 @@ int main() {
 
 				if (score1 >= 1)
 				{
-					scorecounter[0].get<RendererComponent>().SetMesh(Fullscore);
+					scorecounter[0].get<ArenaRendererComponent>().SetMesh(Fullscore);
 				}
 				else
 				{
-					scorecounter[0].get<RendererComponent>().SetMesh(Emptyscore);
+					scorecounter[0].get<ArenaRendererComponent>().SetMesh(Emptyscore);
 
 				}
 				if (score1 >= 2)
 				{
-					scorecounter[1].get<RendererComponent>().SetMesh(Fullscore);
+					scorecounter[1].get<ArenaRendererComponent>().SetMesh(Fullscore);
 				}
 				else {
-					scorecounter[1].get<RendererComponent>().SetMesh(Emptyscore);
+					scorecounter[1].get<ArenaRendererComponent>().SetMesh(Emptyscore);
 				}
 				if (score1 >= 3)
 				{
-					scorecounter[2].get<RendererComponent>().SetMesh(Fullscore);
+					scorecounter[2].get<ArenaRendererComponent>().SetMesh(Fullscore);
 					p1win = true;
 				}
 				else
 				{
-					scorecounter[2].get<RendererComponent>().SetMesh(Emptyscore);
+					scorecounter[2].get<ArenaRendererComponent>().SetMesh(Emptyscore);
 				}
 				if (p1win)
 				{
@@ -1736,30 +1850,30 @@ int main() {
 
 				if (score2 >= 1)
 				{
-					scorecounter[3].get<RendererComponent>().SetMesh(Fullscore);
+					scorecounter[3].get<ArenaRendererComponent>().SetMesh(Fullscore);
 				}
 				else
 				{
-					scorecounter[3].get<RendererComponent>().SetMesh(Emptyscore);
+					scorecounter[3].get<ArenaRendererComponent>().SetMesh(Emptyscore);
 
 				}
 				if (score2 >= 2)
 				{
-					scorecounter[4].get<RendererComponent>().SetMesh(Fullscore);
+					scorecounter[4].get<ArenaRendererComponent>().SetMesh(Fullscore);
 				}
 				else
 				{
-					scorecounter[4].get<RendererComponent>().SetMesh(Emptyscore);
+					scorecounter[4].get<ArenaRendererComponent>().SetMesh(Emptyscore);
 
 				}
 				if (score2 >= 3)
 				{
-					scorecounter[5].get<RendererComponent>().SetMesh(Fullscore);
+					scorecounter[5].get<ArenaRendererComponent>().SetMesh(Fullscore);
 					p2win = true;
 				}
 				else
 				{
-					scorecounter[5].get<RendererComponent>().SetMesh(Emptyscore);
+					scorecounter[5].get<ArenaRendererComponent>().SetMesh(Emptyscore);
 
 				}
 				if (p2win)
@@ -1870,80 +1984,71 @@ int main() {
 				
 				if (!renderammoground1)
 				{
-					Bottles[0].get<RendererComponent>().SetMesh(EmptyBottle);
+					Bottles[0].get<ArenaRendererComponent>().SetMesh(EmptyBottle);
 					Bottles[0].get<Transform>().SetLocalPosition(0.0f, 1.0f, 2.0f);
 				}
 				else
 				{
-					Bottles[0].get<RendererComponent>().SetMesh(FullBottle);
+					Bottles[0].get<ArenaRendererComponent>().SetMesh(FullBottle);
 					Bottles[0].get<Transform>().SetLocalPosition(0.0f, 0.0f, 2.0f);
 				}
 				if (!renderammoground2)
 				{
-					Bottles[1].get<RendererComponent>().SetMesh(EmptyBottle);
+					Bottles[1].get<ArenaRendererComponent>().SetMesh(EmptyBottle);
 					Bottles[1].get<Transform>().SetLocalPosition(-10.0f, -5.0f, 2.0f);
 				}
 				else
 				{
-					Bottles[1].get<RendererComponent>().SetMesh(FullBottle);
+					Bottles[1].get<ArenaRendererComponent>().SetMesh(FullBottle);
 					Bottles[1].get<Transform>().SetLocalPosition(-10.0f, -5.0f, 2.0f);
 				}
 				if (!renderammoground3)
 				{
-					Bottles[2].get<RendererComponent>().SetMesh(EmptyBottle);
+					Bottles[2].get<ArenaRendererComponent>().SetMesh(EmptyBottle);
 					Bottles[2].get<Transform>().SetLocalPosition(10.0f, -5.0f, 2.0f);
 				}
 				else
 				{
-					Bottles[2].get<RendererComponent>().SetMesh(FullBottle);
+					Bottles[2].get<ArenaRendererComponent>().SetMesh(FullBottle);
 					Bottles[2].get<Transform>().SetLocalPosition(10.0f, -5.0f, 2.0f);
 				}
 				if (!renderammoground4)
 				{
-					Bottles[3].get<RendererComponent>().SetMesh(EmptyBottle);
+					Bottles[3].get<ArenaRendererComponent>().SetMesh(EmptyBottle);
 					Bottles[3].get<Transform>().SetLocalPosition(0.0f, 5.0f, 2.0f);
 				}
 				else
 				{
-					Bottles[3].get<RendererComponent>().SetMesh(FullBottle);
+					Bottles[3].get<ArenaRendererComponent>().SetMesh(FullBottle);
 					Bottles[3].get<Transform>().SetLocalPosition(0.0f, 4.0f, 2.0f);
 				}
 				if (!ammo)
 				{
-					Bottles[4].get<RendererComponent>().SetMesh(EmptyBottle);
+					Bottles[4].get<ArenaRendererComponent>().SetMesh(EmptyBottle);
 					Bottles[4].get<Transform>().SetLocalPosition(4.0f, 13.0f, 2.0f);
 				}
 				else
 				{
-					Bottles[4].get<RendererComponent>().SetMesh(FullBottle);
+					Bottles[4].get<ArenaRendererComponent>().SetMesh(FullBottle);
 					Bottles[4].get<Transform>().SetLocalPosition(4.0f, 14.0f, 2.0f);
 				}
 				if (!ammo2)
 				{
-					Bottles[5].get<RendererComponent>().SetMesh(EmptyBottle);
+					Bottles[5].get<ArenaRendererComponent>().SetMesh(EmptyBottle);
 					Bottles[5].get<Transform>().SetLocalPosition(-12.0f, 13.0f, 2.0f);
 				}
 				else
 				{
-					Bottles[5].get<RendererComponent>().SetMesh(FullBottle);
+					Bottles[5].get<ArenaRendererComponent>().SetMesh(FullBottle);
 					Bottles[5].get<Transform>().SetLocalPosition(-12.0f, 14.0f, 2.0f);
 				}
 
 				#pragma endregion BIG MESSY SPAGHETTI CODE AGAIN
 
-				// Iterate over all the behaviour binding components
-				Arena1->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-					// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-					for (const auto& behaviour : binding.Behaviours) {
-						if (behaviour->Enabled) {
-							behaviour->Update(entt::handle(Arena1->Registry(), entity));
-						}
-					}
-				});
+				// Update all the behaviours and systems in the scene, spread across threads where they do not conflict
+				Arena1->Update();
 
-				Arena1->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
-					t.UpdateWorldMatrix();
-				});
+				TransformSystem::Get(Arena1->Registry())->Update();
 
 				renderGroupArena.sort<RendererComponent>([](const RendererComponent& l, const RendererComponent& r) {
 					// Sort by render layer first, higher numbers get drawn last
@@ -1975,15 +2080,30 @@ int main() {
 						currentMat = renderer.Material;
 						currentMat->Apply();
 					}
-					// Render the mesh
-						BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
+					// Pick the level of detail for the prop's size on screen, then render the mesh
+					renderer.UpdateLod(transform, camTransform.GetLocalPosition(), projection);
+					BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
 				});
 
+				instancedRendererArena->Update(Arena1->Registry(), camTransform.GetLocalPosition(), projection);
+				instancedRendererArena->Render(view, projection);
+				indirectRendererArena->Update(Arena1->Registry());
+				indirectRendererArena->Render(view, projection);
+				current = nullptr;
+				currentMat = nullptr;
+
 				basicEffect->UnbindBuffer();
 
 				effects[activeEffect]->ApplyEffect(basicEffect);
 
 				effects[activeEffect]->DrawToScreen();
+
+				// Bake once everything has loaded, since the batcher reads the meshes back from the GPU. Props with levels
+				// of detail are merged level by level, and the batch switches levels as a whole
+				if (!arenaBatched && AsyncLoader::IsIdle()) {
+					StaticBatcher::Bake(Arena1);
+					arenaBatched = true;
+				}
 			}
 			#pragma endregion Arena 1 scene stuff
 
@@ -2023,27 +2143,18 @@ int main() {
 					}
 				}
 
-				shader->SetUniform("u_lightoff", lightoff = 1);
-				shader->SetUniform("u_ambient", ambientonly = 0);
-				shader->SetUniform("u_specular", specularonly = 0);
-				shader->SetUniform("u_ambientspecular", ambientandspecular = 0);
-				shader->SetUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
-				shader->SetUniform("u_Textures", Textures = 2);
+				setSceneUniform("u_lightoff", lightoff = 1);
+				setSceneUniform("u_ambient", ambientonly = 0);
+				setSceneUniform("u_specular", specularonly = 0);
+				setSceneUniform("u_ambientspecular", ambientandspecular = 0);
+				setSceneUniform("u_ambientspeculartoon", ambientspeculartoon = 0);
+				setSceneUniform("u_Textures", Textures = 2);
 
-				// Iterate over all the behaviour binding components
-				Pause->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-					// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-					for (const auto& behaviour : binding.Behaviours) {
-						if (behaviour->Enabled) {
-							behaviour->Update(entt::handle(Pause->Registry(), entity));
-						}
-					}
-					});
+				// Update all the behaviours and systems in the scene, spread across threads where they do not conflict
+				Pause->Update();
 
-				// Update all world matrices for this frame
-				Pause->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
-					t.UpdateWorldMatrix();
-					});
+				// Update the world matrices of anything that moved this frame
+				TransformSystem::Get(Pause->Registry())->Update();
 
 				// Sort the renderers by shader and material, we will go for a minimizing context switches approach here,
 			// but you could for instance sort front to back to optimize for fill rate if you have intensive fragment shaders
@@ -2107,6 +2218,10 @@ int main() {
 		}
 
 		EnvironmentGenerator::CleanUpPointers();
+		AsyncLoader::Shutdown();
+		// Release the cached assets while we still have an OpenGL context
+		AssetManager::Clear();
+		VertexFormat::ReleaseAll();
 		BackendHandler::ShutdownImGui();
 	}	
 
@@ -13,13 +13,130 @@ Really simple demo showing off entity creation + model rendering.
 #include "NOU/CMeshRenderer.h"
 #include "NOU/Shader.h"
 #include "NOU/GLTFLoader.h"
+#include "NOU/Animation.h"
+#include "NOU/FKEvaluator.h"
+#include "NOU/CSkinnedMeshRenderer.h"
+#include "NOU/CMorphMeshRenderer.h"
 
 #include "Logging.h"
 
+#include "GLM/gtx/transform.hpp"
+
 #include <memory>
+#include <string>
+
+//Uncomment to print how long the Animator takes to animate 10k transforms,
+//compared to sampling a clip for each one, before the demo starts.
+//#define BENCHMARK_ANIMATOR
+
+//Uncomment to print how long it takes to update 100 chains of 100 transforms with
+//RecomputeGlobal, DoFK, and an FKEvaluator, before the demo starts.
+//#define BENCHMARK_FK
+
+//Uncomment to print how many skinned ducks we could draw at 60 Hz when skinning on the GPU
+//and on the CPU, before the demo starts.
+//#define BENCHMARK_SKINNING
+
+//Uncomment to print how many morphing ducks we could draw at 60 Hz when blending
+//their targets on the GPU and on the CPU, before the demo starts.
+//#define BENCHMARK_MORPHING
 
 using namespace nou;
 
+#ifdef BENCHMARK_SKINNING
+//We don't have a skinned model in the sample's assets, so this builds one out of a regular mesh.
+//A chain of joints runs up the mesh from bottom to top, and each vertex is weighted
+//between the two joints closest to it.
+void MakeSkinnedMesh(const Mesh& mesh, SkinnedMesh& skinned, int jointCount)
+{
+	const std::vector<glm::vec3>& verts = mesh.GetVerts();
+
+	float minY = verts[0].y;
+	float maxY = verts[0].y;
+
+	for (const glm::vec3& vert : verts)
+	{
+		minY = glm::min(minY, vert.y);
+		maxY = glm::max(maxY, vert.y);
+	}
+
+	float spacing = (maxY - minY) / (jointCount - 1);
+
+	std::vector<SkinnedMesh::Joint> joints(jointCount);
+
+	for (int i = 0; i < jointCount; ++i)
+	{
+		joints[i].name = "Joint" + std::to_string(i);
+		joints[i].parent = i - 1;
+		joints[i].bindPose.pos = glm::vec3(0.0f, (i == 0) ? minY : spacing, 0.0f);
+		joints[i].inverseBind = glm::translate(glm::vec3(0.0f, -(minY + i * spacing), 0.0f));
+	}
+
+	std::vector<glm::vec4> influences;
+	std::vector<glm::vec4> weights;
+
+	for (const glm::vec3& vert : verts)
+	{
+		float height = (vert.y - minY) / spacing;
+		int joint = glm::clamp((int)height, 0, jointCount - 2);
+		float blend = glm::clamp(height - joint, 0.0f, 1.0f);
+
+		influences.push_back(glm::vec4((float)joint, (float)(joint + 1), 0.0f, 0.0f));
+		weights.push_back(glm::vec4(1.0f - blend, blend, 0.0f, 0.0f));
+	}
+
+	skinned.SetVerts(verts);
+	skinned.SetNormals(mesh.GetNormals());
+	skinned.SetUVs(mesh.GetUVs());
+	skinned.SetIndices(mesh.GetIndices());
+	skinned.SetJointInfluences(influences);
+	skinned.SetSkinWeights(weights);
+	skinned.SetJoints(joints);
+}
+#endif
+
+#ifdef BENCHMARK_MORPHING
+//We don't have a model with morph targets in the sample's assets either, so this gives
+//a regular mesh four targets that inflate, squash, stretch, and lean it.
+void MakeMorphMesh(const Mesh& mesh, MorphMesh& morph)
+{
+	const std::vector<glm::vec3>& verts = mesh.GetVerts();
+	const std::vector<glm::vec3>& normals = mesh.GetNormals();
+
+	float minY = verts[0].y;
+	float maxY = verts[0].y;
+
+	for (const glm::vec3& vert : verts)
+	{
+		minY = glm::min(minY, vert.y);
+		maxY = glm::max(maxY, vert.y);
+	}
+
+	float height = maxY - minY;
+
+	std::vector<glm::vec3> inflate, squash, stretch, lean;
+
+	for (size_t i = 0; i < verts.size(); ++i)
+	{
+		float up = verts[i].y - minY;
+
+		inflate.push_back(normals[i] * height * 0.1f);
+		squash.push_back(glm::vec3(0.0f, -up * 0.5f, 0.0f));
+		stretch.push_back(glm::vec3(verts[i].x * 0.5f, 0.0f, 0.0f));
+		lean.push_back(glm::vec3(up * 0.5f, 0.0f, 0.0f));
+	}
+
+	morph.SetVerts(verts);
+	morph.SetNormals(normals);
+	morph.SetUVs(mesh.GetUVs());
+	morph.SetIndices(mesh.GetIndices());
+	morph.AddTarget("Inflate", inflate);
+	morph.AddTarget("Squash", squash);
+	morph.AddTarget("Stretch", stretch);
+	morph.AddTarget("Lean", lean);
+}
+#endif
+
 int main()
 {
 	//Initialize our window.
@@ -102,16 +219,74 @@ int main()
 	boxEntity.Add<CMeshRenderer>(boxEntity, boxMesh, boxMat);
 	boxEntity.transform.m_pos = glm::vec3(-0.5f, 0.5f, 0.0f);
 	boxEntity.transform.m_scale = glm::vec3(0.5f, 0.5f, 0.5f);
+	//The box's root node turns it -90 degrees around X, which the loader bakes into the mesh,
+	//so the last rotation here turns it back.
 	boxEntity.transform.m_rotation = glm::angleAxis(glm::radians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * 
-									 glm::angleAxis(glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+									 glm::angleAxis(glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
+									 glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
 
 	Entity duckEntity = Entity::Create();
 	duckEntity.Add<CMeshRenderer>(duckEntity, duckMesh, duckMat);
-	duckEntity.transform.m_scale = glm::vec3(0.005f, 0.005f, 0.005f);
+	//The duck's root node already scales it down to 1/100th, which the loader bakes into the mesh.
+	duckEntity.transform.m_scale = glm::vec3(0.5f, 0.5f, 0.5f);
 	duckEntity.transform.m_pos = glm::vec3(0.0f, -1.0f, 0.0f);
 	duckEntity.transform.m_rotation = glm::angleAxis(glm::radians(-30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 	float duckRotateSpeed = 45.0f;
 
+	#ifdef BENCHMARK_ANIMATOR
+	Animator::Benchmark();
+	#endif
+
+	#ifdef BENCHMARK_FK
+	FKEvaluator::Benchmark();
+	#endif
+
+	#ifdef BENCHMARK_SKINNING
+	{
+		auto v_skinned = std::make_unique<Shader>("shaders/skinned.vert", GL_VERTEX_SHADER);
+		auto prog_skinned = ShaderProgram({ v_skinned.get(), f_texLit.get() });
+
+		Material skinnedMat(prog_skinned);
+		skinnedMat.AddTexture("albedo", duckTex);
+
+		SkinnedMesh skinnedDuck;
+		MakeSkinnedMesh(duckMesh, skinnedDuck, 4);
+
+		//The CPU skinned duck can use the regular duck material, since its shader never sees the joints.
+		Entity skinnedEntity = Entity::Create();
+		auto& skinnedRenderer = skinnedEntity.Add<CSkinnedMeshRenderer>(skinnedEntity, skinnedDuck, skinnedMat);
+		skinnedEntity.transform.m_pos = duckEntity.transform.m_pos;
+		skinnedEntity.transform.m_scale = duckEntity.transform.m_scale;
+		skinnedEntity.transform.RecomputeGlobal();
+
+		camEntity.Get<CCamera>().Update();
+		skinnedRenderer.Benchmark(skinnedMat, duckMat);
+	}
+	#endif
+
+	#ifdef BENCHMARK_MORPHING
+	{
+		auto v_morph = std::make_unique<Shader>("shaders/morph.vert", GL_VERTEX_SHADER);
+		auto prog_morph = ShaderProgram({ v_morph.get(), f_texLit.get() });
+
+		Material morphMat(prog_morph);
+		morphMat.AddTexture("albedo", duckTex);
+
+		MorphMesh morphDuck;
+		MakeMorphMesh(duckMesh, morphDuck);
+
+		//As with skinning, the CPU blended duck can use the regular duck material.
+		Entity morphEntity = Entity::Create();
+		auto& morphRenderer = morphEntity.Add<CMorphMeshRenderer>(morphEntity, morphDuck, duckMat);
+		morphEntity.transform.m_pos = duckEntity.transform.m_pos;
+		morphEntity.transform.m_scale = duckEntity.transform.m_scale;
+		morphEntity.transform.RecomputeGlobal();
+
+		camEntity.Get<CCamera>().Update();
+		morphRenderer.Benchmark(morphMat, duckMat);
+	}
+	#endif
+
 	//Tick right before we enter our main loop (to make sure we don't have a huge
 	//delta time jump during resource loading).
 	App::Tick();
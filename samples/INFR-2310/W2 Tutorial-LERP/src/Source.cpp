@@ -53,7 +53,8 @@ int main()
 	//Creating the duck entity.
 	Entity duckEntity = Entity::Create();
 	duckEntity.Add<CMeshRenderer>(duckEntity, duckMesh, duckMat);
-	duckEntity.transform.m_scale = glm::vec3(0.005f, 0.005f, 0.005f);
+	//The duck's root node already scales it down to 1/100th, which the loader bakes into the mesh.
+	duckEntity.transform.m_scale = glm::vec3(0.5f, 0.5f, 0.5f);
 	duckEntity.transform.m_pos = glm::vec3(0.0f, -1.0f, 0.0f);
 	duckEntity.transform.m_rotation = glm::angleAxis(glm::radians(-30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 